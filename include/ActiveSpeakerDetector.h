@@ -1,6 +1,8 @@
 #ifndef ACTIVESPEAKERDETECTOR_H
 #define ACTIVESPEAKERDETECTOR_H
 #include "config.h"
+#include "AudioLevelDetector.h"
+#include <vector>
 
 class ActiveSpeakerDetector
 {
@@ -14,6 +16,7 @@ public:
 	ActiveSpeakerDetector(Listener *listener) : listener(listener) {}
 	virtual ~ActiveSpeakerDetector() = default;
 	void Accumulate(uint32_t id, bool vad, uint8_t db, uint64_t now);
+	void Accumulate(const std::vector<AudioLevelDetector::Block>& blocks, uint64_t now);
 	void Release(uint32_t id);
 	void SetMinChangePeriod(uint32_t minChangePeriod)		{ this->minChangePeriod = minChangePeriod;		}
 	void SetMaxAccumulatedScore(uint64_t maxAcummulatedScore)	{ this->maxAcummulatedScore = maxAcummulatedScore;	}	
@@ -22,9 +25,12 @@ public:
 protected:
 	void Process(uint64_t now);
 	
+private:
+	void Update(uint32_t id, bool vad, uint8_t db, uint64_t now);
 private:
 	struct SpeakerInfo
 	{
+		uint32_t id;
 		uint64_t score;
 		uint64_t ts;
 	};
@@ -38,7 +44,8 @@ private:
 	uint64_t minActivationScore	= 0;
 	
 	Listener* listener;
-	std::map<uint32_t,SpeakerInfo> speakers;
+	//Flat table sorted by descending score, only speakers that have been active are on it
+	std::vector<SpeakerInfo> speakers;
 };
 
 #endif /* ACTIVESPEAKERDETECTOR_H */
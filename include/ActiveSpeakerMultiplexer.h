@@ -80,6 +80,8 @@ public:
 
 	void Stop();
 private:
+	bool IsSpeaking(const RTPPacket::shared& packet) const;
+	void Accumulate(const RTPIncomingMediaStream* incoming, const std::vector<RTPPacket::shared>& packets, uint64_t now);
 	void Process(uint64_t now);
 private:
 	Timer::shared timer;
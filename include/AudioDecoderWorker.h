@@ -9,7 +9,7 @@
 #define	AUDIODECODER_H
 #include "codecs.h"
 #include "audio.h"
-#include "waitqueue.h"
+#include "Executor.h"
 #include "rtp.h"
 
 class AudioDecoderWorker 
@@ -29,15 +29,11 @@ public:
 	void RemoveAudioOutput(AudioOutput* ouput);
 
 protected:
-	int Decode();
-
-private:
-	static void *startDecoding(void *par);
+	void Decode(const std::shared_ptr<AudioFrame>& frame);
 
 private:
 	std::set<AudioOutput*> outputs;
-	WaitQueue<std::shared_ptr<AudioFrame>> frames;
-	pthread_t thread = 0;
+	Executor::Strand::shared strand;
 	Mutex mutex;
 	bool		decoding	= false;
 	DWORD		rate		= 0;
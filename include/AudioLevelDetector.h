@@ -0,0 +1,69 @@
+#ifndef AUDIOLEVELDETECTOR_H
+#define AUDIOLEVELDETECTOR_H
+
+#include <memory>
+#include <vector>
+#include "config.h"
+#include "vad.h"
+
+/**
+ * Audio level and voice activity of all the participants of a mixer on each
+ * mixing cycle. The energy of every block is computed first in a single
+ * vectorized pass (AVX2 or SSE2 when available) and converted to the same
+ * -dBov scale used by the ssrc-audio-level header extension (RFC 6464), so
+ * the results can be fed to the ActiveSpeakerDetector as the levels received
+ * on rtp packets.
+ *
+ * Only the blocks louder than the silence threshold are run through the VAD,
+ * so muted or silent participants just cost the energy pass. When the VAD is
+ * not available or does not support the rate, the threshold is the decision.
+ */
+class AudioLevelDetector
+{
+public:
+	struct Block
+	{
+		uint32_t id		= 0;
+		//Mono samples of the block
+		const int16_t* samples	= nullptr;
+		DWORD numSamples	= 0;
+		DWORD rate		= 0;
+		//Results, level in -dBov from 0 to 127 (digital silence)
+		BYTE level		= 127;
+		bool vad		= false;
+	};
+
+public:
+	//Sum of the squares of the samples
+	static QWORD CalcEnergy(const int16_t* samples, DWORD numSamples);
+	//Level in -dBov of the samples
+	static BYTE CalcLevel(const int16_t* samples, DWORD numSamples);
+	static BYTE CalcLevel(QWORD energy, DWORD numSamples);
+	//Check which kernels are in use
+	static bool IsAVX2Accelerated();
+	static bool IsSSE2Accelerated();
+
+	//Calculate levels and vad of all the blocks
+	void Process(std::vector<Block>& blocks);
+	//Release vad state of a participant
+	void Release(uint32_t id);
+
+	//Blocks at this -dBov level or below it are considered silence, 50 by default
+	void SetSilenceThreshold(BYTE silenceThreshold)	{ this->silenceThreshold = silenceThreshold;	}
+
+private:
+	VAD* GetVAD(uint32_t id);
+
+private:
+	struct Participant
+	{
+		uint32_t id;
+		std::unique_ptr<VAD> vad;
+	};
+
+	BYTE silenceThreshold = 50;
+	//Participants sorted by id
+	std::vector<Participant> participants;
+};
+
+#endif /* AUDIOLEVELDETECTOR_H */
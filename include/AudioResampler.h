@@ -0,0 +1,71 @@
+#ifndef AUDIORESAMPLER_H
+#define AUDIORESAMPLER_H
+
+#include <memory>
+#include <vector>
+#include "config.h"
+
+/**
+ * Polyphase resampler for rates with a small rational ratio, like the ones
+ * between 8, 16, 32, 44.1 and 48 kHz. The windowed sinc filter is split in
+ * one bank per output phase, computed once per ratio and quality and shared
+ * by all the resamplers, so each output sample is a single dot product with
+ * the input history. Dot products use AVX2 or SSE2 when available, with
+ * dedicated stereo kernels sharing the coefficient loads of both channels.
+ *
+ * Quality sets the number of taps of each phase, trading stop band
+ * attenuation and transition width against cpu and latency.
+ */
+class AudioResampler
+{
+public:
+	enum class Quality
+	{
+		Low,	//16 taps, ~4 input samples of latency at 48kHz
+		Medium,	//32 taps
+		High	//64 taps
+	};
+
+	//Max number of phases of the filter bank, 441 is needed for 16kHz to 44.1kHz
+	static constexpr DWORD MaxPhases = 512;
+	static constexpr DWORD MaxChannels = 2;
+
+public:
+	AudioResampler() = default;
+
+	//Check if the ratio between the rates is supported
+	static bool IsSupported(DWORD inputRate, DWORD outputRate, DWORD numChannels);
+	//Check which kernels are in use
+	static bool IsAVX2Accelerated();
+	static bool IsSSE2Accelerated();
+
+	bool Open(DWORD inputRate, DWORD outputRate, DWORD numChannels, Quality quality = Quality::Medium);
+	void Reset();
+	void Close();
+	bool IsOpen() const	{ return bool(bank);	}
+
+	//Max number of output samples per channel for the given input ones
+	DWORD GetMaxOutputSamples(DWORD inputSamples) const;
+	//Delay introduced by the filter in input samples
+	DWORD GetLatency() const;
+
+	//Resample interleaved samples, returns the number of output samples per channel
+	DWORD Process(const int16_t* in, DWORD inputSamples, int16_t* out, DWORD maxOutputSamples);
+
+private:
+	struct FilterBank;
+	static std::shared_ptr<const FilterBank> GetFilterBank(DWORD interpolation, DWORD decimation, DWORD taps);
+
+private:
+	std::shared_ptr<const FilterBank> bank;
+	DWORD interpolation = 0;
+	DWORD decimation = 0;
+	DWORD numChannels = 0;
+	//Planar input history of each channel
+	std::vector<float> history[MaxChannels];
+	//Start of the input window and filter phase of the next output sample
+	DWORD pos = 0;
+	DWORD phase = 0;
+};
+
+#endif /* AUDIORESAMPLER_H */
@@ -0,0 +1,66 @@
+#ifndef AUDIOTRANSCODER_H
+#define AUDIOTRANSCODER_H
+
+#include <memory>
+#include <set>
+#include <vector>
+#include "config.h"
+#include "use.h"
+#include "audio.h"
+#include "fifo.h"
+#include "AudioTransrater.h"
+
+/**
+ * Decodes, resamples and encodes audio frames synchronously on the thread
+ * delivering them, typically the ingest loop, so transcoding a stream
+ * (i.e. AAC from RTMP to Opus) does not need an AudioPipe nor the decoder
+ * and encoder worker threads. Encoded frames are delivered to the listeners
+ * before returning from onMediaFrame and are only valid during the call.
+ */
+class AudioTranscoder :
+	public MediaFrame::Listener,
+	public MediaFrame::Producer
+{
+public:
+	AudioTranscoder(AudioCodec::Type codec, const Properties& properties);
+	virtual ~AudioTranscoder() = default;
+
+	void SetAACConfig(const uint8_t* data,const size_t size);
+
+	//MediaFrame::Producer interface
+	virtual void AddMediaListener(const MediaFrame::Listener::shared& listener) override;
+	virtual void RemoveMediaListener(const MediaFrame::Listener::shared& listener) override;
+
+	//MediaFrame::Listener interface
+	virtual void onMediaFrame(const MediaFrame& frame) override;
+	virtual void onMediaFrame(DWORD ssrc, const MediaFrame& frame) override { onMediaFrame(frame); }
+
+	DWORD GetRate() const		{ return rate;		}
+	DWORD GetNumChannels() const	{ return numChannels;	}
+private:
+	bool SetupEncoder(DWORD inputRate, DWORD inputChannels);
+	void Encode(const AudioBuffer::shared& audioBuffer, const AudioFrame& frame);
+private:
+	Mutex mutex;
+	std::set<MediaFrame::Listener::shared> listeners;
+
+	AudioCodec::Type codec;
+	Properties properties;
+	std::unique_ptr<AudioDecoder> audioDecoder;
+	std::unique_ptr<AudioEncoder> audioEncoder;
+	AudioTransrater transrater;
+
+	//Samples pending to be encoded and reused encoder input
+	fifo<SWORD,48000*4> samples;
+	std::vector<SWORD> pcm;
+	AudioBuffer::shared encoding;
+
+	DWORD inputRate = 0;
+	DWORD inputChannels = 0;
+	DWORD rate = 0;
+	DWORD numChannels = 0;
+	QWORD timestamp = 0;
+	bool  first = true;
+};
+
+#endif /* AUDIOTRANSCODER_H */
@@ -1,7 +1,9 @@
 #ifndef _AUDIOTRANSRATER_H_
 #define _AUDIOTRANSRATER_H_
+#include <vector>
 #include "speex/speex_resampler.h"
 #include "AudioBufferPool.h"
+#include "AudioResampler.h"
 
 class AudioTransrater
 {
@@ -13,12 +15,16 @@ public:
 	AudioBuffer::shared ProcessBuffer(const AudioBuffer::shared& audioBuffer);
 	void Close();
 
-	bool IsOpen()	{ return resampler!=NULL; }
+	bool IsOpen()	{ return resampler!=NULL || polyphase.IsOpen(); }
 	
 private:
 	static constexpr size_t InitialPoolSize = 30;
 	static constexpr size_t MaxPoolSize = InitialPoolSize + 2;
 	SpeexResamplerState *resampler;
+	//Used instead of speex for the common rates
+	AudioResampler polyphase;
+	//Reused output of polyphase resampler
+	std::vector<int16_t> resampled;
 	DWORD inputRate=0;
 	DWORD outputRate=0;
 	std::optional<QWORD> playPTSOffset;
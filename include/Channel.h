@@ -0,0 +1,142 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "config.h"
+#include "TimeService.h"
+
+/**
+ * Bounded multi producer single consumer channel of typed messages. Messages
+ * are moved into preallocated slots so pushing does not allocate nor type
+ * erase, and they are delivered in batches on the consumer time service.
+ */
+template <typename Message>
+class Channel : public ChannelBase
+{
+public:
+	using Handler = std::function<void(std::chrono::milliseconds, Message&)>;
+
+	static_assert(std::is_nothrow_move_constructible_v<Message>, "Channel messages must be nothrow move constructible");
+
+public:
+	Channel(TimeService& consumer, const std::weak_ptr<void>& owner, Handler handler, size_t capacity = 1024) :
+		ChannelBase(consumer),
+		owner(owner),
+		handler(std::move(handler))
+	{
+		//Round capacity to power of 2
+		size_t size = 2;
+		while (size<capacity)
+			size <<= 1;
+		mask = size - 1;
+		//Init slots
+		slots.reset(new Slot[size]);
+		for (size_t i=0;i<size;++i)
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	virtual ~Channel()
+	{
+		//Destroy undelivered messages
+		while (Pop([](Message&){}));
+	}
+
+	//Push message from any thread, returns false if the channel is full
+	bool Push(Message&& message)
+	{
+		Slot* slot;
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			slot = &slots[pos & mask];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+			//If the slot is free
+			if (diff==0)
+			{
+				//Try to get it
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			} else if (diff<0) {
+				//Full
+				return false;
+			} else {
+				//Another producer got it
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		//Store message
+		new (slot->storage) Message(std::move(message));
+		//Publish it
+		slot->sequence.store(pos + 1, std::memory_order_release);
+
+		//Schedule consumer if not already done
+		Arm();
+
+		return true;
+	}
+
+	size_t GetCapacity() const	{ return mask + 1; }
+
+	virtual bool IsEmpty() const override
+	{
+		return slots[dequeuePos & mask].sequence.load(std::memory_order_acquire)!=dequeuePos + 1;
+	}
+
+protected:
+	virtual size_t Drain(std::chrono::milliseconds now) override
+	{
+		//Only deliver while the owner is alive
+		auto locked = owner.lock();
+
+		size_t num = 0;
+		//Process at most a full ring so producers can not starve the consumer loop
+		while (num<=mask && Pop([&](Message& message) {
+			if (locked)
+				handler(now, message);
+		}))
+			num++;
+
+		return num;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		alignas(Message) BYTE storage[sizeof(Message)];
+	};
+
+	template <typename Func>
+	bool Pop(Func&& func)
+	{
+		Slot& slot = slots[dequeuePos & mask];
+		//Check if it has been published
+		if (slot.sequence.load(std::memory_order_acquire)!=dequeuePos + 1)
+			return false;
+		//Process and destroy it
+		Message* message = std::launder(reinterpret_cast<Message*>(slot.storage));
+		func(*message);
+		message->~Message();
+		//Free slot for next round
+		slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+		dequeuePos++;
+		return true;
+	}
+
+private:
+	std::weak_ptr<void> owner;
+	Handler handler;
+	std::unique_ptr<Slot[]> slots;
+	size_t mask = 0;
+	alignas(64) std::atomic<size_t> enqueuePos = 0;
+	//Only used by the consumer
+	alignas(64) size_t dequeuePos = 0;
+};
+
+#endif /* CHANNEL_H */
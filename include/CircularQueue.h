@@ -119,6 +119,23 @@ public:
 		return true;
 	}
 
+	bool pop_back()
+	{
+		// if buffer is empty, throw an error
+		if (empty())
+			return false;
+
+		// move tail backwards
+		tail = tail > 0 ? tail - 1 : queue.capacity() - 1;
+
+		//If it is last
+		if (head == tail)
+			//Empty
+			head = npos;
+
+		return true;
+	}
+
 	void grow(std::size_t size)
 	{
 		//Get current length and size
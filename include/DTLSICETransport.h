@@ -32,12 +32,14 @@
 #include "Endpoint.h"
 #include "SRTPSession.h"
 #include "SendSideBandwidthEstimation.h"
+#include "rtp/TransportWideReceivedPackets.h"
 
 class DTLSICETransport : 
 	public RTPSender,
 	public RTPReceiver,
 	public DTLSConnection::Listener,
 	public ICERemoteCandidate::Listener,
+	public RTCPCompoundPacket::Visitor,
 	public TimeServiceWrapper<DTLSICETransport>
 {
 public:
@@ -86,6 +88,7 @@ public:
 	virtual int SendPLI(DWORD ssrc) override;
 	virtual int Reset(DWORD ssrc) override;
 	virtual int Enqueue(const RTPPacket::shared& packet) override;
+	virtual int Enqueue(const std::vector<RTPPacket::shared>& packets) override;
 	int Dump(const char* filename, bool inbound = true, bool outbound = true, bool rtcp = true, bool rtpHeadersOnly = false);
 	int Dump(UDPDumper* dumper, bool inbound = true, bool outbound = true, bool rtcp = true, bool rtpHeadersOnly = false);
 	int StopDump();
@@ -138,9 +141,14 @@ private:
 	void CheckProbeTimer();
 	void Probe(QWORD now);
 	int Send(const RTPPacket::shared& packet);
+	//Serialize and encrypt packet on the buffer, it is returned to the pool on error
+	DWORD ProtectRTP(RTPOutgoingSourceGroup* group, const RTPPacket::shared& packet, Packet& buffer, QWORD now);
+	void SendRTP(ICERemoteCandidate* candidate, const RTPPacket::shared& packet, Packet&& buffer, DWORD len, QWORD now);
+	void OnSentRTP(RTPOutgoingSourceGroup* group, const RTPPacket::shared& packet, DWORD len);
 	int Send(const RTCPCompoundPacket::shared& rtcp);
+	int SendRTCP(Packet&& buffer, DWORD len);
+	int SendNACK(RTPIncomingSourceGroup* group, QWORD now);
 	void SetRTT(DWORD rtt,QWORD now);
-	void onRTCP(const RTCPCompoundPacket::shared &rtcp);
 	void ReSendPacket(RTPOutgoingSourceGroup* group,WORD seq);
 	DWORD SendProbe(const RTPPacket::shared& packet);
 	DWORD SendProbe(RTPOutgoingSourceGroup* group,BYTE padding);
@@ -149,6 +157,14 @@ private:
 	
 	int SetLocalCryptoSDES(const char* suite, const BYTE* key, const DWORD len);
 	int SetRemoteCryptoSDES(const char* suite, const BYTE* key, const DWORD len);
+	//From RTCPCompoundPacket::Visitor
+	virtual void onSenderReport(const RTCPSenderReport& sr) override;
+	virtual void onReport(const RTCPReport& report) override;
+	virtual void onBye(DWORD ssrc) override;
+	virtual void onNACK(DWORD ssrc, WORD pid, WORD blp) override;
+	virtual void onTransportWideFeedback(const RTCPRTPFeedback::TransportWideFeedbackMessageField& field) override;
+	virtual void onPLI(DWORD ssrc) override;
+	virtual void onREMB(DWORD ssrc, DWORD bitrate) override;
 	//Helpers
 	RTPIncomingSourceGroup*	GetIncomingSourceGroup(DWORD ssrc);
 	RTPOutgoingSourceGroup*	GetOutgoingSourceGroup(DWORD ssrc);
@@ -178,8 +194,6 @@ private:
 	SRTPSession	recv;
 	WORD		transportSeqNum			= 0;
 	WORD		feedbackPacketCount		= 0;
-	DWORD		lastFeedbackPacketExtSeqNum	= 0;
-	WORD		feedbackCycles			= 0;
 
 	std::map<DWORD, RTPOutgoingSourceGroup::shared> outgoing;
 	std::map<DWORD, RTPIncomingSourceGroup::shared> incoming;
@@ -200,7 +214,7 @@ private:
 	Acumulator<uint32_t, uint64_t> rtxBitrate;
 	Acumulator<uint32_t, uint64_t> probingBitrate;
 	
-	std::map<DWORD,PacketStats> transportWideReceivedPacketsStats;
+	TransportWideReceivedPackets transportWideReceivedPackets;
 	
 	std::unique_ptr<UDPDumper> dumper;
 	volatile bool dumpInRTP			= false;
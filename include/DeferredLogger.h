@@ -0,0 +1,257 @@
+#ifndef DEFERREDLOGGER_H
+#define DEFERREDLOGGER_H
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <stdio.h>
+#include <sys/types.h>
+#include "config.h"
+#include "tools.h"
+
+/**
+ * Logger that does not format nor write on the calling thread. The format
+ * pointer and the raw arguments are copied into a lock-free ring owned by the
+ * calling thread, and a background thread formats and writes them. C strings
+ * are copied as they may not be alive anymore when formatted, any other
+ * argument is stored as is, so formats must be string literals.
+ *
+ * Each thread limits the number of messages logged per second from the same
+ * call site (format), messages over the limit are counted and reported along
+ * the next one that gets logged.
+ */
+class DeferredLogger
+{
+public:
+	//Size of the ring of each thread, must be a power of 2
+	static constexpr size_t RingSize = 256*1024;
+	//Max length of a copied C string
+	static constexpr size_t MaxStringLength = 255;
+	//Max different call sites tracked for rate limiting on each thread
+	static constexpr size_t MaxCallSites = 256;
+
+	using Formatter = int (*)(char* out, size_t size, const char* format, const BYTE* args);
+
+	struct Record
+	{
+		DWORD size;		//Total size including the header, 0 for skipping to the ring start
+		DWORD suppressed;	//Messages from same call site dropped by the rate limit before this one
+		Formatter formatter;
+		const char* tag;
+		const char* format;
+		QWORD timestamp;
+		pid_t tid;
+		char name[16];
+		WORD prefixLength;	//Prefix string copied after the header
+		WORD argsOffset;	//Offset of the arguments from the start of the record
+	};
+
+public:
+	static DeferredLogger& GetInstance();
+
+	void Start();
+	void Stop();
+	//Wait until all records queued before calling it are written
+	void Flush();
+
+	bool IsRunning() const			{ return running;		}
+	void SetOutput(FILE* output)		{ this->output = output;	}
+	//Max messages per second from each call site on each thread, 0 for no limit
+	void SetRateLimit(DWORD rateLimit)	{ this->rateLimit = rateLimit;	}
+	QWORD GetWritten() const		{ return written;		}
+	QWORD GetDropped() const		{ return dropped;		}
+
+	//Queue message, returns false if it could not be queued and must be written synchronously
+	template<typename... Args>
+	bool Write(const char* tag, const char* prefix, const char* format, Args... args);
+
+private:
+	//Arguments are stored as they are except C strings, which are copied after them
+	template<typename T>
+	static constexpr bool IsString = std::is_same_v<T,char*> || std::is_same_v<T,const char*>;
+
+	struct StringRef
+	{
+		WORD offset;
+	};
+
+	template<typename T>
+	static size_t StringLength(T value)
+	{
+		if constexpr (IsString<T>)
+			return value ? strnlen(value, MaxStringLength) : 0;
+		else
+			return 0;
+	}
+
+	template<typename T>
+	using StoredType = std::conditional_t<IsString<T>, StringRef, T>;
+
+	template<typename... Args>
+	static int Format(char* out, size_t size, const char* format, const BYTE* args)
+	{
+		const auto& stored = *std::launder((const std::tuple<StoredType<Args>...>*)args);
+		//Strings are after the arguments
+		const BYTE* strings = args + sizeof(stored);
+		return std::apply([&](auto... values) {
+			return snprintf(out, size, format, Restore(values, strings)...);
+		}, stored);
+	}
+
+	template<typename T>
+	static T Restore(T value, const BYTE*)				{ return value;					}
+	static const char* Restore(StringRef ref, const BYTE* strings)	{ return (const char*)strings + ref.offset;	}
+
+	class Ring
+	{
+	public:
+		Ring();
+
+		//Get space for a record of the given size, nullptr if full
+		BYTE* Reserve(DWORD size);
+		void Commit();
+		//Read pending records
+		template<typename Func>
+		void Consume(Func&& func);
+		bool IsEmpty() const	{ return head.load(std::memory_order_acquire)==tail.load(std::memory_order_acquire); }
+
+		//Check rate limit for the call site, returns number of suppressed messages before this one or -1 if it must be dropped
+		int64_t CheckRateLimit(const char* format, QWORD now, DWORD limit);
+		//Get thread name, refreshed each second as it may be changed after the thread is started
+		const char* GetName(QWORD now);
+
+	public:
+		pid_t tid = 0;
+	private:
+		struct CallSite
+		{
+			const char* format = nullptr;
+			QWORD second = 0;
+			DWORD count = 0;
+			DWORD suppressed = 0;
+		};
+		std::unique_ptr<BYTE[]> buffer;
+		char name[16] = {};
+		QWORD nameSecond = 0;
+		//Written by the producer thread only
+		std::atomic<QWORD> head = 0;
+		QWORD reserved = 0;
+		//Written by the logger thread only, on its own cache line
+		alignas(64) std::atomic<QWORD> tail = 0;
+		std::array<CallSite,MaxCallSites> callSites;
+	};
+
+	static constexpr DWORD Align(DWORD size) { return (size + 7) & ~7u; }
+
+	DeferredLogger() = default;
+	Ring* GetRing();
+	void Run();
+	bool Drain();
+
+private:
+	std::mutex mutex;
+	std::vector<std::shared_ptr<Ring>> rings;
+	std::thread thread;
+	std::atomic<bool> running = false;
+	std::atomic<QWORD> written = 0;
+	std::atomic<QWORD> dropped = 0;
+	FILE* output = stdout;
+	DWORD rateLimit = 0;
+};
+
+template<typename... Args>
+bool DeferredLogger::Write(const char* tag, const char* prefix, const char* format, Args... args)
+{
+	static_assert((std::is_trivially_copyable_v<Args> && ...), "Log arguments must be trivially copyable");
+
+	//Over aligned arguments must be written synchronously
+	if constexpr (alignof(std::tuple<StoredType<Args>...>)>8)
+		return false;
+
+	//Get ring for this thread
+	Ring* ring = GetRing();
+	if (!ring)
+		return false;
+
+	//Get time
+	QWORD now = getTime();
+
+	//Check rate limit
+	int64_t suppressed = ring->CheckRateLimit(format, now, rateLimit);
+	if (suppressed<0)
+		//Dropped on purpose
+		return true;
+
+	//Get string lengths
+	size_t lengths[sizeof...(Args)+1] = {};
+	size_t stringsLength = 0;
+	size_t i = 0;
+	((lengths[i++] = StringLength(args)), ...);
+	for (size_t j=0;j<sizeof...(Args);++j)
+		stringsLength += lengths[j] ? lengths[j]+1 : 0;
+	WORD prefixLength = prefix ? strnlen(prefix, MaxStringLength) : 0;
+
+	//Calculate record size
+	using Tuple = std::tuple<StoredType<Args>...>;
+	DWORD argsOffset = Align(sizeof(Record) + prefixLength);
+	DWORD size = Align(argsOffset + sizeof(Tuple) + stringsLength + sizeof...(Args));
+
+	//Reserve space
+	BYTE* data = ring->Reserve(size);
+	if (!data)
+	{
+		//Ring full
+		dropped++;
+		return true;
+	}
+
+	//Write header
+	Record* record = (Record*)data;
+	record->size		= size;
+	record->suppressed	= suppressed;
+	record->formatter	= &Format<Args...>;
+	record->tag		= tag;
+	record->format		= format;
+	record->timestamp	= now;
+	record->tid		= ring->tid;
+	memcpy(record->name, ring->GetName(now), sizeof(record->name));
+	record->prefixLength	= prefixLength;
+	record->argsOffset	= argsOffset;
+	if (prefixLength)
+		memcpy(data+sizeof(Record), prefix, prefixLength);
+
+	//Copy strings and store arguments
+	BYTE* strings = data + argsOffset + sizeof(Tuple);
+	WORD offset = 0;
+	i = 0;
+	[[maybe_unused]] auto store = [&](auto arg) -> StoredType<decltype(arg)> {
+		if constexpr (IsString<decltype(arg)>)
+		{
+			StringRef ref = { offset };
+			size_t length = lengths[i++];
+			if (length)
+				memcpy(strings + offset, arg, length);
+			strings[offset+length] = 0;
+			offset += length + 1;
+			return ref;
+		} else {
+			i++;
+			return arg;
+		}
+	};
+	new (data + argsOffset) Tuple{ store(args)... };
+
+	//Publish it
+	ring->Commit();
+
+	return true;
+}
+
+#endif /* DEFERREDLOGGER_H */
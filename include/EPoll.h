@@ -0,0 +1,67 @@
+#ifndef EPOLL_H
+#define EPOLL_H
+
+#ifdef __linux__
+
+#include "Poll.h"
+#include "PollSignalling.h"
+#include "FileDescriptor.h"
+
+#include <sys/epoll.h>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+#include <functional>
+
+/**
+ * Concrete Poll implementation for Linux epoll mechanism.
+ *
+ * The interest set is kept by the kernel, so event masks are only passed to it
+ * when they change and each Wait() only returns the file descriptors with
+ * events, instead of copying and scanning all of them as SystemPoll does.
+ *
+ * Readiness is level triggered, as the EventLoop callbacks read and write in
+ * bounded batches and don't drain the sockets until they would block.
+ */
+class EPoll : public Poll
+{
+public:
+	EPoll();
+
+	void Signal() override;
+
+	bool AddFd(int fd) override;
+	bool RemoveFd(int fd) override;
+	void Clear() override;
+	int Wait(uint32_t timeOutMs) override;
+	bool SetEventMask(int fd, uint16_t eventMask) override;
+
+	void ForEachFd(std::function<void(int)> func) override;
+	std::pair<uint16_t, int> GetEvents(int fd) const override;
+
+private:
+	static constexpr size_t MaxEvents = 64;
+
+	struct Entry
+	{
+		uint32_t events = 0;
+		uint32_t revents = 0;
+	};
+
+	FileDescriptor epfd;
+	std::unordered_map<int, Entry> fds;
+
+	// Cache for constant time complexity
+	bool tempfdsDirty = true;
+	std::vector<int> tempfds;
+
+	// File descriptors with events on last wait
+	std::vector<int> ready;
+	epoll_event events[MaxEvents] = {};
+
+	PollSignalling signalling;
+};
+
+#endif
+
+#endif
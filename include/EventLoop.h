@@ -4,10 +4,12 @@
 #include <thread>
 #include <chrono>
 #include <optional>
+#include <atomic>
 #include "concurrentqueue.h"
 #include "TimeService.h"
 #include "FileDescriptor.h"
 #include "SystemPoll.h"
+#include "EPoll.h"
 
 using namespace std::chrono_literals;
 
@@ -52,7 +54,11 @@ private:
 	};
 	
 public:
+#ifdef __linux__
+	EventLoop(std::unique_ptr<Poll> poll = std::make_unique<EPoll>());
+#else
 	EventLoop(std::unique_ptr<Poll> poll = std::make_unique<SystemPoll>());
+#endif
 	virtual ~EventLoop();
 	
 	bool StartWithLoop(std::function<void(void)> loop);
@@ -69,6 +75,8 @@ public:
 	virtual void AsyncUnsafe(const std::function<void(std::chrono::milliseconds)>& func) override;
 	virtual void AsyncUnsafe(const std::function<void(std::chrono::milliseconds)>& func, const std::function<void(std::chrono::milliseconds)>& callback) override;
 	virtual std::future<void> FutureUnsafe(const std::function<void(std::chrono::milliseconds)>& func) override;
+	virtual void ScheduleChannel(const std::weak_ptr<ChannelBase>& channel) override;
+	virtual bool IsCurrentThread() const override { return std::this_thread::get_id()==thread.get_id(); }
 	
 	virtual void Run(const std::chrono::milliseconds &duration = std::chrono::milliseconds::max());
 	
@@ -94,6 +102,7 @@ protected:
 	void CancelTimer(TimerImpl::shared timer);
 	
 	void ProcessTasks(const std::chrono::milliseconds& now);
+	void ProcessChannels(const std::chrono::milliseconds& now);
 	void ProcessTriggers(const std::chrono::milliseconds& now);
 	int  GetNextTimeout(int defaultTimeout, const std::chrono::milliseconds& until = std::chrono::milliseconds::max()) const;
 
@@ -114,7 +123,14 @@ protected:
 	}
 	
 	/**
-	 * Get updated event mask for a file descriptor. 
+	 * Notify that the event mask of the file descriptors has changed. It can be called from any thread
+	 * and GetPollEventMask() will be called for each of them on the loop thread before the next wait.
+	 */
+	void UpdatePollEventMask();
+	
+	/**
+	 * Get updated event mask for a file descriptor. It is only called after a file descriptor is added
+	 * or UpdatePollEventMask() is called, not on every loop iteration.
 	 * 
 	 * Note if the return optional doesn't have value, the current event mask wouldn't be changed.
 	 */
@@ -157,9 +173,12 @@ private:
 			std::optional<std::function<void(std::chrono::milliseconds)>>
 		>
 	>  tasks;
+	moodycamel::ConcurrentQueue<std::weak_ptr<ChannelBase>> channels;
 	std::multimap<std::chrono::milliseconds,TimerImpl::shared> timers;
 	
 	std::optional<int> exitCode;
+	
+	std::atomic<bool> pollEventMaskChanged = true;
 };
 
 #endif /* EVENTLOOP_H */
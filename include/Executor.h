@@ -0,0 +1,135 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "config.h"
+
+/**
+ * Fixed pool of threads, sized to the number of cores by default, running
+ * serial task queues (strands) instead of having a dedicated thread per media
+ * worker. Each thread keeps its own queue of runnable strands and steals from
+ * the other threads when it runs out of work. Real time strands are kept in a
+ * shared queue sorted by the deadline of their next task and are always run
+ * before the normal ones.
+ */
+class Executor
+{
+public:
+	using Task = std::function<void()>;
+
+	static constexpr QWORD NoDeadline = std::numeric_limits<QWORD>::max();
+	//Max number of tasks run from a normal strand before yielding to others
+	static constexpr size_t MaxBatch = 16;
+
+	class Strand : public std::enable_shared_from_this<Strand>
+	{
+	public:
+		using shared = std::shared_ptr<Strand>;
+	public:
+		Strand(Executor& executor, bool realTime);
+
+		//Run task after all the previous ones without deadline
+		bool Post(Task&& task) { return Post(NoDeadline, std::move(task)); }
+		//Run task before any other pending one with a later deadline (in ms)
+		bool Post(QWORD deadline, Task&& task);
+		//Drop pending tasks and wait for the running one to finish, nothing will run afterwards
+		void Close();
+
+		bool IsRealTime() const	{ return realTime;	}
+		size_t GetPendingTasks();
+	private:
+		friend class Executor;
+
+		struct Entry
+		{
+			QWORD deadline;
+			QWORD seq;
+			Task task;
+		};
+		struct Later
+		{
+			bool operator()(const Entry& a, const Entry& b) const
+			{
+				return a.deadline > b.deadline || (a.deadline == b.deadline && a.seq > b.seq);
+			}
+		};
+
+		//Run up to max tasks, returns if there are still pending and the deadline of the next one
+		bool Run(size_t max, QWORD& next);
+	private:
+		Executor& executor;
+		bool realTime;
+
+		std::mutex mutex;
+		std::condition_variable idle;
+		std::vector<Entry> tasks;
+		QWORD seq		= 0;
+		bool scheduled		= false;
+		bool running		= false;
+		bool closed		= false;
+		std::thread::id runner;
+	};
+public:
+	static Executor& GetDefault();
+
+	explicit Executor(size_t numThreads = 0, const std::string& name = "executor");
+	~Executor();
+
+	Executor(const Executor&) = delete;
+	Executor& operator=(const Executor&) = delete;
+
+	Strand::shared CreateStrand(bool realTime = false);
+
+	size_t GetNumThreads() const	{ return workers.size();	}
+	//Only run workers when the cores are not used by any other thread, for background tasks
+	bool SetIdlePriority();
+
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Strand::shared> queue;
+		std::thread thread;
+	};
+
+	struct RealTimeEntry
+	{
+		QWORD deadline;
+		QWORD seq;
+		Strand::shared strand;
+
+		bool operator<(const RealTimeEntry& other) const
+		{
+			//Reversed for min heap
+			return deadline > other.deadline || (deadline == other.deadline && seq > other.seq);
+		}
+	};
+
+	void Schedule(Strand::shared&& strand, QWORD deadline);
+	Strand::shared Next(size_t index);
+	void Run(size_t index);
+
+private:
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::vector<RealTimeEntry> realTimeQueue;
+	std::atomic<size_t> realTimePending = 0;
+	//Can be briefly negative as strands are queued before being counted
+	std::atomic<int64_t> pending = 0;
+	std::atomic<size_t> roundRobin = 0;
+	QWORD realTimeSeq = 0;
+	bool running = true;
+};
+
+#endif /* EXECUTOR_H */
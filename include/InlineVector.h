@@ -0,0 +1,86 @@
+#ifndef INLINEVECTOR_H
+#define INLINEVECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * Vector with a fixed capacity stored inline, so it can be created, copied and
+ * filled without any heap allocation. Pushing past the capacity throws.
+ */
+template<typename T, std::size_t N>
+class InlineVector
+{
+public:
+	using value_type	= T;
+	using iterator		= T*;
+	using const_iterator	= const T*;
+public:
+	InlineVector() = default;
+	explicit InlineVector(std::size_t size, const T& value = T())
+	{
+		resize(size, value);
+	}
+	InlineVector(std::initializer_list<T> list)
+	{
+		for (const auto& value : list)
+			push_back(value);
+	}
+
+	void push_back(const T& value)
+	{
+		//Check capacity
+		if (count == N)
+			throw std::length_error("InlineVector capacity exceeded");
+		items[count++] = value;
+	}
+
+	void resize(std::size_t size, const T& value = T())
+	{
+		//Check capacity
+		if (size > N)
+			throw std::length_error("InlineVector capacity exceeded");
+		//Fill new items
+		for (std::size_t i = count; i < size; ++i)
+			items[i] = value;
+		count = size;
+	}
+
+	void clear()					{ count = 0;			}
+
+	std::size_t size() const			{ return count;			}
+	bool empty() const				{ return !count;		}
+	static constexpr std::size_t capacity()		{ return N;			}
+
+	T& operator[](std::size_t i)			{ return items[i];		}
+	const T& operator[](std::size_t i) const	{ return items[i];		}
+	T& front()					{ return items[0];		}
+	const T& front() const				{ return items[0];		}
+	T& back()					{ return items[count - 1];	}
+	const T& back() const				{ return items[count - 1];	}
+
+	iterator begin()				{ return items.data();		}
+	iterator end()					{ return items.data() + count;	}
+	const_iterator begin() const			{ return items.data();		}
+	const_iterator end() const			{ return items.data() + count;	}
+
+	friend bool operator==(const InlineVector& lhs, const InlineVector& rhs)
+	{
+		return lhs.count == rhs.count && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+	friend bool operator!=(const InlineVector& lhs, const InlineVector& rhs)
+	{
+		return !(lhs == rhs);
+	}
+private:
+	std::array<T, N> items = {};
+	//Use smallest counter possible to keep it compact
+	std::conditional_t<(N <= 255), uint8_t, std::size_t> count = 0;
+};
+
+#endif /* INLINEVECTOR_H */
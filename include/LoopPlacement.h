@@ -0,0 +1,50 @@
+#ifndef LOOPPLACEMENT_H
+#define LOOPPLACEMENT_H
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include "config.h"
+#include "TimeService.h"
+
+/**
+ * Chooses the loop where the sinks of a source are created. Sinks are placed
+ * on the loop of their source so packets are relayed by synchronous calls on
+ * the same thread, unless that loop is overloaded compared to the others, in
+ * which case the least loaded one is used.
+ */
+class LoopPlacement
+{
+public:
+	static LoopPlacement& GetInstance();
+
+	void AddLoop(TimeService* loop);
+	void RemoveLoop(TimeService* loop);
+
+	//Get loop for a sink of a source running on the given one and account its weight on it
+	TimeService* Place(TimeService* source, DWORD weight = 1);
+	//Release weight of a sink
+	void Release(TimeService* loop, DWORD weight = 1);
+
+	//Max ratio of the load of a loop over the average before moving sinks away from it
+	void SetMaxImbalance(double maxImbalance)	{ this->maxImbalance = maxImbalance;	}
+	//Load under which a loop is never considered overloaded
+	void SetMinLoad(QWORD minLoad)			{ this->minLoad = minLoad;		}
+	QWORD GetLoad(TimeService* loop) const;
+	//Most and least loaded loops if the imbalance is over the max, so a sink can be moved between them
+	std::optional<std::pair<TimeService*,TimeService*>> GetRebalance() const;
+
+private:
+	TimeService* GetLeastLoaded() const;
+	bool IsOverloaded(QWORD load, QWORD added) const;
+
+private:
+	mutable std::mutex mutex;
+	std::map<TimeService*,QWORD> loads;
+	QWORD total = 0;
+	double maxImbalance = 1.5;
+	QWORD minLoad = 4;
+};
+
+#endif /* LOOPPLACEMENT_H */
@@ -9,6 +9,7 @@
 #include "FrameDispatchCoordinator.h"
 
 #include <queue>
+#include <atomic>
 #include <memory>
 
 using namespace std::chrono_literals;
@@ -135,6 +136,8 @@ public:
 	long double avgWaitedTime = 0;
 	MinMaxAcumulator<uint32_t, uint64_t> waited;
 	volatile bool muted = false;
+	//Frames from other loops not processed yet
+	std::atomic<DWORD> pendingFrames = 0;
 	
 	std::chrono::milliseconds dispatchingDelayMs = std::chrono::milliseconds(0);
 	std::chrono::milliseconds maxDispatchingDelayMs = std::chrono::milliseconds(MaxDispatchingDelayMs);
@@ -142,6 +145,8 @@ public:
 	bool stopped = false;
 
 	uint32_t targetBitrateHint = 0;
+	//Last dependency descriptor structure sent by an SVC encoder
+	TemplateDependencyStructure::shared templateDependencyStructure;
 	
 	std::unique_ptr<TimestampChecker> tsChecker;
 	std::unique_ptr<TimestampChecker> ptsChecker;
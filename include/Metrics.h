@@ -0,0 +1,147 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "config.h"
+
+/**
+ * Process wide registry of counters, gauges and histograms.
+ *
+ * Counters and histograms are sharded so each thread updates its own cache
+ * line without contention, shards are only aggregated when taking a snapshot.
+ * Metrics are never removed once registered, so the returned references can be
+ * cached on a static at the call site:
+ *
+ *	static auto& lag = Metrics::GetInstance().GetHistogram("eventloop_timer_lag_ms","Delay of timers");
+ *	lag.Record(delay);
+ */
+class Metrics
+{
+public:
+	//Number of shards, threads over it will share them
+	static constexpr size_t Shards = 16;
+
+	class Counter
+	{
+	public:
+		void Add(QWORD value = 1)
+		{
+			shards[GetShard()].value.fetch_add(value, std::memory_order_relaxed);
+		}
+		QWORD GetValue() const;
+	private:
+		struct alignas(64) Shard
+		{
+			std::atomic<QWORD> value = 0;
+		};
+		std::array<Shard,Shards> shards;
+	};
+
+	class Gauge
+	{
+	public:
+		void Set(int64_t value)	{ this->value.store(value, std::memory_order_relaxed);		}
+		void Add(int64_t value)	{ this->value.fetch_add(value, std::memory_order_relaxed);	}
+		void Sub(int64_t value)	{ this->value.fetch_sub(value, std::memory_order_relaxed);	}
+		int64_t GetValue() const{ return value.load(std::memory_order_relaxed);			}
+	private:
+		std::atomic<int64_t> value = 0;
+	};
+
+	/**
+	 * Log linear histogram, values below SubBuckets are exact and bigger ones
+	 * are split in SubBuckets per power of 2, so relative error is 1/SubBuckets.
+	 */
+	class Histogram
+	{
+	public:
+		static constexpr BYTE SubBucketBits	= 3;
+		static constexpr QWORD SubBuckets	= 1 << SubBucketBits;
+		//Values are clamped to 2^MaxBits-1
+		static constexpr BYTE MaxBits		= 40;
+		static constexpr size_t Buckets		= SubBuckets + (MaxBits - SubBucketBits) * SubBuckets;
+
+		static size_t GetBucket(QWORD value);
+		//Max value stored on the bucket
+		static QWORD GetBucketUpperBound(size_t bucket);
+	public:
+		void Record(QWORD value);
+	private:
+		friend class Metrics;
+		struct alignas(64) Shard
+		{
+			std::atomic<QWORD> count = 0;
+			std::atomic<QWORD> sum = 0;
+			std::atomic<QWORD> max = 0;
+			std::array<std::atomic<QWORD>,Buckets> buckets = {};
+		};
+		std::array<Shard,Shards> shards;
+	};
+
+	struct Snapshot
+	{
+		struct Value
+		{
+			std::string name;
+			std::string help;
+			int64_t value = 0;
+		};
+		struct Distribution
+		{
+			std::string name;
+			std::string help;
+			QWORD count = 0;
+			QWORD sum = 0;
+			QWORD max = 0;
+			//Non empty buckets as upper bound and count
+			std::vector<std::pair<QWORD,QWORD>> buckets;
+
+			//Get value for the quantile, in [0,1]
+			QWORD GetQuantile(double quantile) const;
+		};
+
+		QWORD timestamp = 0;
+		std::vector<Value> counters;
+		std::vector<Value> gauges;
+		std::vector<Distribution> histograms;
+
+		//Prometheus text exposition format, histograms are exported as summaries
+		std::string ToPrometheus() const;
+	};
+
+public:
+	static Metrics& GetInstance();
+
+	Counter& GetCounter(const std::string& name, const std::string& help = "");
+	Gauge& GetGauge(const std::string& name, const std::string& help = "");
+	Histogram& GetHistogram(const std::string& name, const std::string& help = "");
+
+	Snapshot GetSnapshot() const;
+
+private:
+	static size_t GetShard();
+
+	template<typename T>
+	struct Entry
+	{
+		std::string help;
+		std::unique_ptr<T> metric;
+	};
+
+	template<typename T>
+	T& Get(std::map<std::string,Entry<T>>& metrics, const std::string& name, const std::string& help);
+
+private:
+	mutable std::mutex mutex;
+	std::map<std::string,Entry<Counter>> counters;
+	std::map<std::string,Entry<Gauge>> gauges;
+	std::map<std::string,Entry<Histogram>> histograms;
+};
+
+#endif /* METRICS_H */
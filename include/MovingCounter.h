@@ -1,8 +1,10 @@
 #ifndef MOVING_COUNTER_
 #define MOVING_COUNTER_
 
-#include <queue>
+#include <limits>
 #include <optional>
+#include <type_traits>
+#include "CircularQueue.h"
 
 // Implements moving max: can add samples to it and calculate maximum over some
 // fixed moving window.
@@ -11,11 +13,16 @@
 // Samples can be added with |Add()| and max over current window is returned by
 // |MovingMax|. |when| in successive calls to Add and MovingMax
 // should never decrease as if it's a wallclock time.
+//
+// If a bucket duration is set, samples are aggregated on buckets of that
+// duration so at most window/bucket samples are stored.
 template <typename  T>
 class MovingMaxCounter {
 public:
-	explicit MovingMaxCounter(uint64_t window)
-		: window(window) 
+	explicit MovingMaxCounter(uint64_t window, uint64_t bucket = 0)
+		: window(window),
+		  bucket(bucket),
+		  samples(bucket ? window/bucket + 1 : 0)
 	{
 	}
 
@@ -24,6 +31,9 @@ public:
 	T Add(uint64_t when, const T& sample)
 	{
 		RollWindow(when);
+		// Samples on same bucket share its start time
+		if (bucket)
+			when -= when % bucket;
 		// Remove samples that will never be maximum in any window: newly added sample
 		// will always be in all windows the previous samples are. Thus, smaller or
 		// equal samples could be removed. This will maintain the invariant - deque
@@ -75,14 +85,15 @@ public:
 
 private:
 	const uint64_t window;
+	const uint64_t bucket;
 
-	// This deque stores (timestamp, sample) pairs in chronological order; new
+	// This queue stores (timestamp, sample) pairs in chronological order; new
 	// pairs are only ever added at the end. However, because they can't affect
 	// the Max() calculation, pairs older than windoware discarded,
 	// and if an older pair has a sample that's smaller than that of a younger
 	// pair, the older pair is discarded. As a result, the sequence of timestamps
 	// is strictly increasing, and the sequence of samples is strictly decreasing.
-	std::deque<std::pair<uint64_t, T>> samples;
+	CircularQueue<std::pair<uint64_t, T>> samples;
 
 };
 
@@ -92,8 +103,8 @@ class MovingMinCounter :
 	private MovingMaxCounter<T>
 {
 public:
-	explicit MovingMinCounter(uint64_t window)
-		: MovingMaxCounter<T>(window)
+	explicit MovingMinCounter(uint64_t window, uint64_t bucket = 0)
+		: MovingMaxCounter<T>(window, bucket)
 	{
 	}
 
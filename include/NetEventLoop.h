@@ -106,6 +106,8 @@ private:
 	Listener*	listener	= nullptr;
 	State		state		= State::Normal;
 	moodycamel::ConcurrentQueue<SendBuffer>	sending;
+	//If waiting for write events, only changed when sending queue gets empty or not
+	std::atomic<bool> writing	= false;
 	ObjectPool<Packet> packetPool;
 	std::optional<RawTx> rawTx;
 	
@@ -8,6 +8,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <optional>
 #include <poll.h>
 #include <srtp2/srtp.h>
 #include "config.h"
@@ -69,6 +70,13 @@ public:
 	bool SetThreadName(const std::string& name) { return loop.SetThreadName(name);			}
 	bool SetPriority(int priority)		{ return loop.SetPriority(priority);			}
 	TimeService& GetTimeService()		{ return loop;						}
+
+	//Get bundle where the transport for a sink of a source received on the given one should be created and account its weight on it
+	static RTPBundleTransport* PlaceSink(RTPBundleTransport* source, DWORD weight = 1);
+	//Release weight of a sink placed on the bundle
+	static void ReleaseSink(RTPBundleTransport* bundle, DWORD weight = 1);
+	//Most and least loaded bundles if they are unbalanced, so a sink can be moved between them
+	static std::optional<std::pair<RTPBundleTransport*,RTPBundleTransport*>> GetRebalance();
 private:
 	void onTimer(std::chrono::milliseconds now);
 	void SendBindingRequest(Connection::shared connection,ICERemoteCandidate* candidate);
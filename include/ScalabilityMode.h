@@ -0,0 +1,79 @@
+#ifndef SCALABILITYMODE_H
+#define SCALABILITYMODE_H
+
+#include <optional>
+#include <string>
+#include "config.h"
+#include "rtp/DependencyDescriptor.h"
+
+/**
+ * Layering structure of an SVC encoding, named as in the WebRTC SVC spec (LxTy).
+ *
+ * Temporal layers follow the usual patterns (T2: 0,1 and T3: 0,2,1,2) which are
+ * restarted on each key frame, and each spatial layer is predicted from the lower
+ * one of the same superframe. Frame configs describe the reference buffers used
+ * by each layer frame so encoders with explicit reference control and the
+ * dependency descriptor template structure are always in sync.
+ */
+class ScalabilityMode
+{
+public:
+	static constexpr BYTE MaxSpatialLayers	= 3;
+	static constexpr BYTE MaxTemporalLayers	= 3;
+	//Buffers used: TL0 frames of each spatial layer, TL1 frames of each spatial layer and one for inter layer prediction only
+	static constexpr BYTE NumBuffers	= 2 * MaxSpatialLayers + 1;
+	static constexpr BYTE InterLayerBuffer	= NumBuffers - 1;
+
+	struct LayerFrameConfig
+	{
+		bool keyFrame = false;
+		BYTE spatialLayerId = 0;
+		BYTE temporalLayerId = 0;
+		//Buffer with the previous frame of the same spatial layer
+		std::optional<BYTE> temporalReference;
+		//Buffer with the frame of the lower spatial layer in the same superframe
+		std::optional<BYTE> interLayerReference;
+		//Buffer updated with this frame
+		std::optional<BYTE> update;
+		//Frame can be used to switch up to its temporal layer
+		bool layerSync = false;
+		//Template of the dependency descriptor structure for this frame
+		BYTE templateId = 0;
+	};
+
+public:
+	ScalabilityMode() = default;
+	ScalabilityMode(BYTE spatialLayers, BYTE temporalLayers);
+
+	static std::optional<ScalabilityMode> Parse(const std::string& name);
+
+	BYTE GetSpatialLayers() const	{ return spatialLayers;					}
+	BYTE GetTemporalLayers() const	{ return temporalLayers;				}
+	bool IsLayered() const		{ return spatialLayers>1 || temporalLayers>1;		}
+	std::string ToString() const;
+
+	//Number of frames in the temporal pattern
+	BYTE GetPeriodicity() const;
+	//Temporal layer of the frame at the position in the pattern
+	BYTE GetTemporalLayerId(DWORD index) const;
+	//Ratio between the input frame rate and the one of the temporal layer
+	BYTE GetRateDecimator(BYTE temporalLayerId) const;
+	//Ratio of the spatial layer bitrate used up to the temporal layer
+	double GetTemporalBitrateRatio(BYTE temporalLayerId) const;
+	//Ratio of the total bitrate used by the spatial layer
+	double GetSpatialBitrateRatio(BYTE spatialLayerId) const;
+	//Spatial layers are downscaled by powers of 2 from the top one
+	BYTE GetSpatialScaleShift(BYTE spatialLayerId) const { return spatialLayers - 1 - spatialLayerId; }
+
+	LayerFrameConfig GetLayerFrameConfig(bool keyFrame, DWORD index, BYTE spatialLayerId) const;
+	TemplateDependencyStructure GetTemplateDependencyStructure(uint32_t width, uint32_t height) const;
+
+private:
+	FrameDependencyTemplate GetFrameDependencyTemplate(bool keyFrame, BYTE index, BYTE spatialLayerId) const;
+
+private:
+	BYTE spatialLayers = 1;
+	BYTE temporalLayers = 1;
+};
+
+#endif /* SCALABILITYMODE_H */
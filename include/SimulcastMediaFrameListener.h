@@ -7,6 +7,7 @@
 #include "TimeService.h"
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <unordered_set>
@@ -26,6 +27,8 @@ public:
 	virtual ~SimulcastMediaFrameListener();
 
 	void SetNumLayers(DWORD numLayers);
+	//Max size of the queued frames before forwarding them without waiting for the other layers
+	void SetMaxQueueBytes(size_t maxQueueBytes);
 
 	//MediaFrame::Producer interface
 	virtual void AddMediaListener(const MediaFrame::Listener::shared& listener) override;
@@ -44,11 +47,13 @@ public:
 private:
 	//To be run on timerService thread
 	void PushAsync(std::chrono::milliseconds now, std::shared_ptr<VideoFrame>&& frame);
+	void PushTimestamp(DWORD ssrc, QWORD timestamp);
 
 	void ForwardFrame(VideoFrame& frame);
 
 	void Push(std::shared_ptr<VideoFrame>&& frame);
 	void Enqueue(std::shared_ptr<VideoFrame>&& frame);
+	std::shared_ptr<VideoFrame> Dequeue(bool front);
 	void Flush();
 private:
 	DWORD forwardSsrc = 0;
@@ -57,6 +62,8 @@ private:
 
 	uint32_t numLayers = 0;
 	uint32_t maxQueueSize = 0;
+	size_t maxQueueBytes = 0;
+	size_t queueBytes = 0;
 
 	bool initialised = false;
 	DWORD selectedSsrc = 0;
@@ -72,6 +79,11 @@ private:
 
 	// Latest timestamps for each layer
 	std::unordered_map<uint32_t, uint64_t> layerTimestamps;
+
+	//Read from the producer threads to drop the frames of the non selected layers before cloning them
+	std::atomic<DWORD> forwardingSsrc = 0;
+	//Intra frames not processed yet, which could change the selected layer
+	std::atomic<uint32_t> pendingIntraFrames = 0;
 };
 
 #endif /* SIMULCASTMEDIAFRAMELISTENER_H */
@@ -1,6 +1,7 @@
 #ifndef TIMESERVICE_H
 #define TIMESERVICE_H
 #include <stdint.h>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -28,6 +29,38 @@ private:
 	std::string name;
 };
 	
+class TimeService;
+
+/**
+ * Queue of messages consumed on a time service. Producers arm it when pushing
+ * and only the first one after it has been processed schedules it, so the
+ * consumer is signaled once per batch instead of once per message.
+ */
+class ChannelBase : public std::enable_shared_from_this<ChannelBase>
+{
+public:
+	ChannelBase(TimeService& consumer) : consumer(consumer) {}
+	virtual ~ChannelBase() = default;
+
+	//Run on the consumer, returns number of messages processed
+	size_t Process(std::chrono::milliseconds now);
+	//Check if there are no pending messages, only reliable on the consumer
+	virtual bool IsEmpty() const = 0;
+
+protected:
+	//Schedule it if not already done
+	void Arm();
+	//Process pending messages, at most a batch
+	virtual size_t Drain(std::chrono::milliseconds now) = 0;
+
+private:
+	TimeService& consumer;
+	std::atomic<bool> armed = false;
+};
+
+template <typename Message>
+class Channel;
+
 class TimeService
 {
 public:
@@ -40,13 +73,46 @@ public:
 	virtual void AsyncUnsafe(const std::function<void(std::chrono::milliseconds)>& func) = 0;
 	virtual void AsyncUnsafe(const std::function<void(std::chrono::milliseconds)>& func, const std::function<void(std::chrono::milliseconds)>& callback) = 0;
 	virtual std::future<void> FutureUnsafe(const std::function<void(std::chrono::milliseconds)>& func) = 0;
+	//Check if we are running on the thread of the time service, so calls can be done synchronously
+	virtual bool IsCurrentThread() const { return false; }
 	inline void SyncUnsafe(const std::function<void(std::chrono::milliseconds)>& func) 
 	{
 		//Run async and wait for future
 		FutureUnsafe(func).wait();
 	}
+	//Process channel on next iteration, by default it is run as a task
+	virtual void ScheduleChannel(const std::weak_ptr<ChannelBase>& channel)
+	{
+		AsyncUnsafe([channel](std::chrono::milliseconds now) {
+			if (auto locked = channel.lock())
+				locked->Process(now);
+		});
+	}
 };
 
+inline size_t ChannelBase::Process(std::chrono::milliseconds now)
+{
+	//Allow producers to schedule it again before draining so no message is missed
+	armed.store(false);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	//Process a batch
+	size_t num = Drain(now);
+
+	//If there are more pending, process them on next iteration
+	if (!IsEmpty())
+		Arm();
+
+	return num;
+}
+
+inline void ChannelBase::Arm()
+{
+	//Only first one schedules it
+	if (!armed.exchange(true))
+		consumer.ScheduleChannel(weak_from_this());
+}
+
 
 template <typename T>
 class TimeServiceWrapper : public std::enable_shared_from_this<T>
@@ -167,6 +233,21 @@ public:
 		});
 	}
 	
+	/**
+	 * Create channel for sending messages to this object from other threads.
+	 * Messages are only delivered while the object is alive, the handler is
+	 * called with (now, message) on the time service of the object.
+	 */
+	template <typename Message, typename Func>
+	std::shared_ptr<Channel<Message>> CreateChannelSafe(Func&& func, size_t capacity = 1024)
+	{
+		auto selfWeak = TimeServiceWrapper<T>::weak_from_this();
+		// If following assert failed, the function might be called in constructor. See OnCreated() description.
+		assert(!selfWeak.expired());
+
+		return std::make_shared<Channel<Message>>(timeService, selfWeak, std::forward<Func>(func), capacity);
+	}
+
 	TimeService& GetTimeService()	{ return timeService; }
 
 private:
@@ -0,0 +1,68 @@
+#ifndef VIDEOBUFFERSCALEDCACHE_H_
+#define VIDEOBUFFERSCALEDCACHE_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "config.h"
+#include "use.h"
+#include "VideoBuffer.h"
+#include "VideoBufferPool.h"
+#include "VideoBufferScaler.h"
+
+/**
+ * Scaled renditions of the video buffers of a single source shared between all
+ * its consumers. Each (width, height, aspect mode) rendition is computed at most
+ * once per input buffer, output buffers come from a per-rendition pool and the
+ * scaling contexts are kept alive across frames.
+ */
+class VideoBufferScaledCache
+{
+public:
+	using shared = std::shared_ptr<VideoBufferScaledCache>;
+
+	//Renditions not requested for this time are released
+	static constexpr QWORD MaxIdleTime = 2000;
+	static constexpr std::size_t PoolPreallocate = 2;
+	static constexpr std::size_t PoolMaxAllocate = 32;
+public:
+	VideoBufferScaledCache() = default;
+
+	VideoBuffer::const_shared GetScaled(const VideoBuffer::const_shared& input, DWORD width, DWORD height, bool keepAspectRatio = true);
+	void Clear();
+
+	std::size_t GetRenditions() const	{ return renditions.size();	}
+	QWORD GetScaledFrames() const		{ return scaledFrames;		}
+	QWORD GetCachedFrames() const		{ return cachedFrames;		}
+
+private:
+	struct Rendition
+	{
+		Rendition(DWORD width, DWORD height, bool keepAspectRatio) :
+			width(width),
+			height(height),
+			keepAspectRatio(keepAspectRatio),
+			pool(PoolPreallocate, PoolMaxAllocate)
+		{
+			pool.SetSize(width, height);
+		}
+
+		DWORD width;
+		DWORD height;
+		bool keepAspectRatio;
+		QWORD lastUsed = 0;
+
+		Mutex mutex;
+		VideoBufferPool pool;
+		VideoBufferScaler scaler;
+		std::weak_ptr<const VideoBuffer> input;
+		VideoBuffer::const_shared output;
+	};
+
+	Mutex mutex;
+	std::vector<std::shared_ptr<Rendition>> renditions;
+	std::atomic<QWORD> scaledFrames = 0;
+	std::atomic<QWORD> cachedFrames = 0;
+};
+
+#endif // !VIDEOBUFFERSCALEDCACHE_H_
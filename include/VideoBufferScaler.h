@@ -1,5 +1,5 @@
-#ifndef _FRAMESCALER_H_
-#define _FRAMESCALER_H_
+#ifndef _VIDEOBUFFERSCALER_H_
+#define _VIDEOBUFFERSCALER_H_
 extern "C" {
 #include <libswscale/swscale.h>
 #include <libavutil/opt.h>
@@ -10,7 +10,16 @@ extern "C" {
 class VideoBufferScaler
 {
 public:
+	VideoBufferScaler() = default;
+	~VideoBufferScaler();
+
+	VideoBufferScaler(const VideoBufferScaler&) = delete;
+	VideoBufferScaler& operator=(const VideoBufferScaler&) = delete;
+
 	int Resize(const VideoBuffer::const_shared& input, const VideoBuffer::shared& output, bool keepAspectRatio = true);
+private:
+	//Context is reused while input and output sizes do not change
+	SwsContext* resizeCtx = nullptr;
 };
 
 #endif
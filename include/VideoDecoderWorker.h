@@ -3,10 +3,11 @@
 
 #include "codecs.h"
 #include "video.h"
-#include "waitqueue.h"
+#include "Executor.h"
 #include "rtp.h"
 #include "Deinterlacer.h"
 #include "acumulator.h"
+#include "VideoBufferScaledCache.h"
 
 class VideoDecoderWorker 
 	: public MediaFrame::Listener
@@ -40,20 +41,19 @@ public:
 
 	Stats GetStats();
 protected:
-	int Decode();
-
-private:
-	static void *startDecoding(void *par);
+	void Decode(const std::shared_ptr<VideoFrame>& videoFrame);
 
 private:
 	std::set<VideoOutput*> outputs;
-	WaitQueue<std::shared_ptr<VideoFrame>> frames;
-	pthread_t thread = 0;
+	Executor::Strand::shared strand;
 	Mutex mutex;
 	bool decoding	= false;
 	bool muted	= false;
+	DWORD num	= 0;
+	uint64_t waitFrameStart = 0;
 	std::unique_ptr<VideoDecoder>	videoDecoder;
 	std::unique_ptr<Deinterlacer>	deinterlacer;
+	std::shared_ptr<VideoBufferScaledCache> scaledCache = std::make_shared<VideoBufferScaledCache>();
 
 	Stats stats;
 	Acumulator<uint16_t> bitrateAcu;
@@ -3,7 +3,7 @@
 
 #include <pthread.h>
 #include "video.h"
-#include "VideoBufferScaler.h"
+#include "VideoBufferScaledCache.h"
 #include "CircularQueue.h"
 
 class VideoPipe :
@@ -43,6 +43,7 @@ public:
 	/** VideoOutput */
 	size_t NextFrame(const VideoBuffer::const_shared& videoBuffer) override;
 	void ClearFrame() override;
+	void SetScaledCache(const std::shared_ptr<VideoBufferScaledCache>& scaledCache) override;
 
 private:
 	uint32_t videoWidth = 0;
@@ -60,7 +61,8 @@ private:
 	pthread_cond_t  newPicCond;
 
 	VideoBufferPool	videoBufferPool;
-	VideoBufferScaler scaler;
+	//Shared with the rest of outputs of the source when set, own one otherwise
+	std::shared_ptr<VideoBufferScaledCache> scaledCache;
 	AllowedDownScaling allowedDownScaling = AllowedDownScaling::Any;
 
 	uint64_t lastGrabbedTimestamp = NoTimestamp;
@@ -0,0 +1,65 @@
+#ifndef VIDEOTHUMBNAILER_H
+#define VIDEOTHUMBNAILER_H
+
+#include <atomic>
+#include <optional>
+#include <vector>
+#include "config.h"
+#include "use.h"
+#include "video.h"
+#include "Executor.h"
+
+/**
+ * Small JPEG or WebP snapshots of a video stream. Only intra frames are decoded,
+ * unless a snapshot is requested at a given time, in which case the frames from
+ * the last intra one up to that time are decoded. Decoders and encoders are only
+ * created while taking a snapshot, and they run on a single thread executor shared
+ * by all the thumbnailers running at idle priority, so snapshots never compete
+ * with the media workers.
+ * The latest snapshot of the stream is cached.
+ */
+class VideoThumbnailer :
+	public MediaFrame::Listener
+{
+public:
+	//Max number of frames buffered while waiting for the requested time
+	static constexpr size_t MaxPendingFrames = 300;
+public:
+	static Executor& GetExecutor();
+
+	VideoThumbnailer(VideoCodec::Type codec = VideoCodec::JPEG, DWORD width = 320, QWORD interval = 10000);
+	virtual ~VideoThumbnailer();
+
+	int Start();
+	int Stop();
+
+	// MediaFrame::Listener interface
+	virtual void onMediaFrame(const MediaFrame& frame) override;
+	virtual void onMediaFrame(DWORD ssrc, const MediaFrame& frame) override { onMediaFrame(frame); }
+
+	//Take snapshot of the first frame with a time equal or later than the requested one
+	void Request(QWORD time);
+	//Get latest snapshot, if any
+	VideoFrame::const_shared GetThumbnail();
+
+	QWORD GetSnapshots() const	{ return snapshots;	}
+protected:
+	//Decode the frames and encode the last picture, run on the executor
+	virtual VideoFrame* CreateSnapshot(const std::vector<VideoFrame::const_shared>& frames, bool intraOnly);
+private:
+	void Snapshot(const std::vector<VideoFrame::const_shared>& frames, bool intraOnly);
+private:
+	Mutex mutex;
+	Executor::Strand::shared strand;
+	VideoCodec::Type codec;
+	DWORD width;
+	QWORD interval;
+	QWORD last = 0;
+	std::atomic<bool> busy = false;
+	std::optional<QWORD> requested;
+	std::vector<VideoFrame::const_shared> pending;
+	VideoFrame::const_shared thumbnail;
+	std::atomic<QWORD> snapshots = 0;
+};
+
+#endif /* VIDEOTHUMBNAILER_H */
@@ -13,14 +13,22 @@
 #include "CircularQueue.h"
 #include "MovingCounter.h"
 
+/**
+ * Sum of the values updated within a moving time window. By default values are
+ * stored per timestamp and expire exactly when they leave the window. If a
+ * bucket duration is set, values within the same bucket are aggregated and
+ * expire together, so memory is fixed to window/bucket entries and updates are
+ * O(1), at the cost of a precision of one bucket.
+ */
 template <typename  V = uint32_t, typename T = uint64_t>
 class Acumulator
 {
 public:
-	Acumulator(uint32_t window, uint32_t base = 1000, uint32_t initialSize = 0) :
-		values(initialSize),
+	Acumulator(uint32_t window, uint32_t base = 1000, uint32_t initialSize = 0, uint32_t bucket = 0) :
+		values(bucket ? window/bucket + 1 : initialSize),
 		window(window),
-		base(base)
+		base(base),
+		bucket(bucket)
 	{
 		Reset(0);
 	}
@@ -29,6 +37,7 @@ public:
 	T GetInstant()			const { return instant;				}
 	uint64_t GetDiff()		const { return last - first;			}
 	uint32_t GetWindow()		const { return window;				}
+	uint32_t GetBucket()		const { return bucket;				}
 	bool  IsInWindow()		const { return inWindow;			}
 	long double GetInstantMedia()	const { return GetCount() ? GetInstant()/GetCount() : 0;	}
 	long double GetInstantAvg()	const { return GetInstant()*base/GetWindow();			}
@@ -87,6 +96,8 @@ public:
 		acumulated += val;
 		//And the instant one
 		instant += val;
+		//Get start of the bucket, or the exact time if not using them
+		uint64_t timestamp = bucket ? now - now % bucket : now;
 		//Check if last item has the same timestamp
 		if (!values.empty())
 		{
@@ -94,18 +105,18 @@ public:
 			auto& back = values.back();
 
 			//If it is happening at the same timestamp
-			if (back.timestamp == now)
+			if (back.timestamp == timestamp)
 			{
 				//Increase value and counter on existing value
 				back.count ++;
 				back.value +=val;
 			} else {
 				//Insert new value
-				values.emplace_back(now, 1, val);
+				values.emplace_back(timestamp, 1, val);
 			}
 		} else {
 			//Insert new value
-			values.emplace_back(now, 1, val);
+			values.emplace_back(timestamp, 1, val);
 		}
 		//Increase global window
 		count++;
@@ -146,6 +157,7 @@ protected:
 	uint32_t count;
 	uint32_t window;
 	uint32_t base;
+	uint32_t bucket;
 	bool  inWindow;
 	T acumulated;
 	T instant;
@@ -157,9 +169,9 @@ template <typename  V = uint32_t, typename T = uint64_t>
 class MaxAcumulator : public Acumulator<V, T>
 {
 public:
-	MaxAcumulator(uint32_t window, uint32_t base = 1000, uint32_t initialSize = 0) :
-		Acumulator<V, T>(window, base, initialSize),
-		maxCounter(window)
+	MaxAcumulator(uint32_t window, uint32_t base = 1000, uint32_t initialSize = 0, uint32_t bucket = 0) :
+		Acumulator<V, T>(window, base, initialSize, bucket),
+		maxCounter(window, bucket)
 	{
 		ResetMax();
 	}
@@ -225,9 +237,9 @@ template <typename  V = uint32_t, typename T = uint64_t>
 class MinMaxAcumulator : public MaxAcumulator<V, T>
 {
 public:
-	MinMaxAcumulator(uint32_t window, uint32_t base = 1000, uint32_t initialSize = 0) : 
-		MaxAcumulator<V,T>(window, base, initialSize),
-		minCounter(window)
+	MinMaxAcumulator(uint32_t window, uint32_t base = 1000, uint32_t initialSize = 0, uint32_t bucket = 0) : 
+		MaxAcumulator<V,T>(window, base, initialSize, bucket),
+		minCounter(window, bucket)
 	{
 		ResetMinMax();
 	}
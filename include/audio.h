@@ -26,6 +26,8 @@ public:
 	{
 		//Create new one with same data
 		AudioFrame *frame = new AudioFrame(codec,buffer);
+		//Share referenced data too
+		frame->CopySegments(*this);
 		//Set clock rate
 		frame->SetClockRate(GetClockRate());
 		//Set timestamp
@@ -90,6 +92,8 @@ public:
 	virtual DWORD GetRate()=0;
 	virtual DWORD GetNumChannels() { return 1; }
 	virtual DWORD GetClockRate()=0;
+	//Continue encoding from the state of other encoder of same type and config, false if not supported
+	virtual bool CopyState(const AudioEncoder& other) { return false; }
 	AudioCodec::Type	type;
 	int			numFrameSamples;
 };
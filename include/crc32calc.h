@@ -1,4 +1,4 @@
-/* 
+/*
  * File:   crc32.h
  * Author: Sergio
  *
@@ -10,43 +10,42 @@
 
 #include "config.h"
 
+/**
+ * CRC32 checksums used across the server. Each flavour has a portable
+ * slice-by-8 implementation and a hardware accelerated one (PCLMULQDQ folding
+ * for CRC-32 and CRC-32/MPEG-2, SSE4.2 crc32 instruction for CRC-32C) which is
+ * selected at startup depending on the cpu features.
+ *
+ * All the static methods can be chained by passing the result of the previous
+ * call as the crc of the next one.
+ */
 class CRC32Calc
 {
 public:
-	CRC32Calc()
-	{
-		//Check if inited globally
-		if (!inited)
-		{
-			for (DWORD i = 0; i < 256; ++i) {
-				DWORD c = i;
-				for (DWORD j = 0; j < 8; ++j) {
-					if (c & 1) {
-						c = 0xEDB88320 ^ (c >> 1);
-					} else {
-						c >>= 1;
-					}
-				}
-				table[i] = c;
-			}
-			//Initied
-			inited = true;
-		}
-
-		crc = 0;
-	}
+	CRC32Calc() = default;
 
 	DWORD Update(const BYTE *data, DWORD size)
 	{
-		DWORD c = crc ^ 0xFFFFFFFF;
-		for (DWORD i = 0; i < size; ++i) 
-			c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
-		crc =  c ^ 0xFFFFFFFF;
+		crc = IEEE(data,size,crc);
 		return crc;
 	}
-private:
-	static DWORD table[256];
-	static bool inited;
+
+public:
+	//CRC-32 (ISO-HDLC, reflected 0x04C11DB7), as used in STUN FINGERPRINT
+	static DWORD IEEE(const BYTE* data, size_t size, DWORD crc = 0);
+	//CRC-32/MPEG-2 (non reflected 0x04C11DB7, no final xor), as used in MPEG-TS PSI sections
+	static DWORD MPEG2(const BYTE* data, size_t size, DWORD crc = 0xFFFFFFFF);
+	//CRC-32C (Castagnoli, reflected 0x1EDC6F41), as used in SCTP
+	static DWORD CRC32C(const BYTE* data, size_t size, DWORD crc = 0);
+
+	//Portable versions, always available
+	static DWORD IEEESliceBy8(const BYTE* data, size_t size, DWORD crc = 0);
+	static DWORD MPEG2SliceBy8(const BYTE* data, size_t size, DWORD crc = 0xFFFFFFFF);
+	static DWORD CRC32CSliceBy8(const BYTE* data, size_t size, DWORD crc = 0);
+
+	//Check which implementation is in use
+	static bool IsCLMULAccelerated();
+	static bool IsSSE42Accelerated();
 private:
 	DWORD crc = 0;
 };
@@ -6,8 +6,10 @@
 #include <stdarg.h>
 #include <pthread.h>
 #include <sys/time.h>
+#include <type_traits>
 #include "config.h"
 #include "tools.h"
+#include "DeferredLogger.h"
 
 #if defined(__linux__)
 #include <sys/types.h>
@@ -61,6 +63,21 @@ public:
 	{
 		return getInstance().warning = warning;
 	}
+
+	static bool IsDeferredEnabled()
+	{
+		return DeferredLogger::GetInstance().IsRunning();
+	}
+
+	//Format and write logs on a background thread instead of the calling one
+	static bool EnableDeferred(bool deferred)
+	{
+		if (deferred)
+			DeferredLogger::GetInstance().Start();
+		else
+			DeferredLogger::GetInstance().Stop();
+		return deferred;
+	}
 	
 	inline int Log(const char *msg, ...)
 	{
@@ -95,139 +112,73 @@ private:
         void operator=(Logger const&);		// Don't implement
 };
 
-inline int Log(const char *msg, ...)
+template<typename... Args>
+inline void LogMessage(const char* tag, const char* prefix, bool flush, const char *msg, Args... args)
 {
-	if (Logger::IsLogEnabled())
-	{
-		struct timeval tv;
-		va_list ap;
-		gettimeofday(&tv,NULL);
+	//If all arguments can be copied, queue it on the deferred logger when running
+	if constexpr ((std::is_trivially_copyable_v<Args> && ...))
+		if (DeferredLogger::GetInstance().Write(tag, prefix, msg, args...))
+			return;
+
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
 #if defined(__linux__)
-		pid_t tid = gettid();
-		char name[16];
-		pthread_getname_np(pthread_self(), name,sizeof(name));
-		printf("[%-16s][0x%-4x][%.10ld.%.3ld][LOG]", name, tid, (long)tv.tv_sec, (long)tv.tv_usec / 1000);
+	pid_t tid = gettid();
+	char name[16];
+	pthread_getname_np(pthread_self(), name,sizeof(name));
+	printf("[%-16s][0x%-4x][%.10ld.%.3ld][%s]%s", name, tid, (long)tv.tv_sec, (long)tv.tv_usec / 1000, tag, prefix);
 #else
-		printf("[0x%lx][%.10ld.%.3ld][LOG]", (long)pthread_self(), (long)tv.tv_sec, (long)tv.tv_usec / 1000);
+	printf("[0x%lx][%.10ld.%.3ld][%s]%s", (long)pthread_self(), (long)tv.tv_sec, (long)tv.tv_usec / 1000, tag, prefix);
 #endif
-		va_start(ap, msg);
-		vprintf(msg, ap);
-		va_end(ap);
+	printf(msg, args...);
+	if (flush)
 		fflush(stdout);
-	}
+}
+
+template<typename... Args>
+inline int Log(const char *msg, Args... args)
+{
+	if (Logger::IsLogEnabled())
+		LogMessage("LOG", "", true, msg, args...);
 	return 1;
 }
 
-inline int Log2(const char* prefix,const char *msg, ...)
+template<typename... Args>
+inline int Log2(const char* prefix,const char *msg, Args... args)
 {
 	if (Logger::IsLogEnabled())
-	{
-		struct timeval tv;
-		va_list ap;
-		gettimeofday(&tv,NULL);
-#if defined(__linux__)
-		pid_t tid = gettid();
-		char name[16];
-		pthread_getname_np(pthread_self(), name,sizeof(name));
-		printf("[%-16s][0x%-4x][%.10ld.%.3ld][LOG]%s", name, tid, (long)tv.tv_sec, (long)tv.tv_usec / 1000, prefix);
-#else
-		printf("[0x%lx][%.10ld.%.3ld][LOG]%s", (long)pthread_self(), (long)tv.tv_sec, (long)tv.tv_usec / 1000, prefix);
-#endif
-		va_start(ap, msg);
-		vprintf(msg, ap);
-		va_end(ap);
-		fflush(stdout);
-	}
+		LogMessage("LOG", prefix, true, msg, args...);
 	return 1;
 }
 
-inline int UltraDebug(const char *msg, ...)
+template<typename... Args>
+inline int UltraDebug(const char *msg, Args... args)
 {
 	if (Logger::IsUltraDebugEnabled())
-	{
-		struct timeval tv;
-		va_list ap;
-		gettimeofday(&tv,NULL);
-#if defined(__linux__)
-		pid_t tid = gettid();
-		char name[16];
-		pthread_getname_np(pthread_self(), name,sizeof(name));
-		printf("[%-16s][0x%-4x][%.10ld.%.3ld][DBG]", name, tid, (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#else
-		printf("[0x%lx][%.10ld.%.3ld][DBG]", (long)pthread_self(), (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#endif
-		va_start(ap, msg);
-		vprintf(msg, ap);
-		va_end(ap);
-		fflush(stdout);
-	}
+		LogMessage("DBG", "", true, msg, args...);
 	return 1;
 }
 
-inline int Debug(const char *msg, ...)
+template<typename... Args>
+inline int Debug(const char *msg, Args... args)
 {
 	if (Logger::IsDebugEnabled())
-	{
-		struct timeval tv;
-		va_list ap;
-		gettimeofday(&tv,NULL);
-#if defined(__linux__)
-		pid_t tid = gettid();
-		char name[16];
-		pthread_getname_np(pthread_self(), name,sizeof(name));
-		printf("[%-16s][0x%-4x][%.10ld.%.3ld][DBG]", name, tid, (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#else
-		printf("[0x%lx][%.10ld.%.3ld][DBG]", (long)pthread_self(), (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#endif
-		va_start(ap, msg);
-		vprintf(msg, ap);
-		va_end(ap);
-		fflush(stdout);
-	}
+		LogMessage("DBG", "", true, msg, args...);
 	return 1;
 }
 
-inline int Warning(const char *msg, ...)
+template<typename... Args>
+inline int Warning(const char *msg, Args... args)
 {
 	if (Logger::IsWarningEnabled())
-	{
-		struct timeval tv;
-		va_list ap;
-		gettimeofday(&tv,NULL);
-#if defined(__linux__)
-		pid_t tid = gettid();
-		char name[16];
-		pthread_getname_np(pthread_self(), name,sizeof(name));
-		printf("[%-16s][0x%-4x][%.10ld.%.3ld][WRN]", name, tid, (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#else
-		printf("[0x%lx][%.10ld.%.3ld][WRN]", (long)pthread_self(), (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#endif
-		va_start(ap, msg);
-		vprintf(msg, ap);
-		va_end(ap);
-		fflush(stdout);
-	}
+		LogMessage("WRN", "", true, msg, args...);
 	return 0;
 }
 
-
-inline int Error(const char *msg, ...)
+template<typename... Args>
+inline int Error(const char *msg, Args... args)
 {
-	struct timeval tv;
-	va_list ap;
-	gettimeofday(&tv,NULL);
-#if defined(__linux__)
-	pid_t tid = gettid();
-	char name[16];
-	pthread_getname_np(pthread_self(), name,sizeof(name));
-	printf("[%-16s][0x%-4x][%.10ld.%.3ld][ERR]", name, tid, (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#else
-	printf("[0x%lx][%.10ld.%.3ld][ERR]", (long)pthread_self(), (long)tv.tv_sec, (long)tv.tv_usec / 1000);
-#endif
-	
-	va_start(ap, msg);
-	vprintf(msg, ap);
-	va_end(ap);
+	LogMessage("ERR", "", false, msg, args...);
 	return 0;
 }
 
@@ -6,6 +6,7 @@
 #include <vector>
 #include <string.h>
 #include <memory>
+#include <mutex>
 #include "Buffer.h"
 #include "BufferReader.h"
 
@@ -103,6 +104,14 @@ public:
 	};
 
 	typedef std::vector<RtpPacketization> RtpPacketizationInfo;
+
+	struct Segment
+	{
+		const BYTE* data;
+		DWORD size;
+		//Keeps the data alive even if the frame is coalesced afterwards
+		std::shared_ptr<const void> owner;
+	};
 public:
 	enum Type {Audio=0,Video=1,Text=2,Unknown=-1};
 
@@ -208,16 +217,20 @@ public:
 	DWORD GetDuration() const		{ return duration;		}
 	void SetDuration(DWORD duration)	{ this->duration = duration;	}
 
-	DWORD GetLength() const			{ return buffer->GetSize();			}
-	DWORD GetMaxMediaLength() const		{ return buffer->GetCapacity();			}
+	DWORD GetLength() const
+	{
+		std::lock_guard<std::mutex> lock(segmentsMutex);
+		return segments.empty() ? buffer->GetSize() : segmentedLength;
+	}
+	DWORD GetMaxMediaLength() const		{ Coalesce(); return buffer->GetCapacity();				}
 
 #ifndef SWIGGO
 	// the SWIG compiler can not handle correctly the 2 GetData signatures for the GoLang target
-	const BYTE* GetData() const		{ return buffer->GetData();			}
+	const BYTE* GetData() const		{ Coalesce(); return buffer->GetData();			}
 #endif
-	BYTE* GetData()				{ AdquireBuffer(); return buffer->GetData();	}
-	const Buffer::shared& GetBuffer() const	{ return buffer; }
-	void SetLength(DWORD length)		{ AdquireBuffer(); buffer->SetSize(length);	}
+	BYTE* GetData()				{ Coalesce(); AdquireBuffer(); return buffer->GetData();	}
+	const Buffer::shared& GetBuffer() const	{ Coalesce(); return buffer;				}
+	void SetLength(DWORD length)		{ Coalesce(); AdquireBuffer(); buffer->SetSize(length);	}
 	
 	void DisableSharedBuffer()		{ disableSharedBuffer = true;			}
 	
@@ -227,10 +240,15 @@ public:
 		buffer = std::make_shared<Buffer>(size);
 		//Owned buffer
 		ownedBuffer = true;
+		//Drop referenced data
+		segments.clear();
+		segmentedLength = 0;
 	}
 
 	void Alloc(DWORD size)
 	{
+		//Get contiguous data
+		Coalesce();
 		//Adquire buffer
 		AdquireBuffer();
 		//Allocate mem
@@ -239,6 +257,9 @@ public:
 
 	void SetMedia(const BYTE* data,DWORD size)
 	{
+		//Drop referenced data
+		segments.clear();
+		segmentedLength = 0;
 		//Adquire buffer
 		AdquireBuffer();
 		//Allocate mem
@@ -247,10 +268,25 @@ public:
 
 	DWORD AppendMedia(const BYTE* data,DWORD size)
 	{
-                //Get current pos
-                DWORD pos = buffer->GetSize();
+		//Get current pos
+		DWORD pos = GetLength();
 		//Adquire buffer
 		AdquireBuffer();
+		//If we are referencing other data
+		if (!segments.empty())
+		{
+			//Data will be appended at the end of our buffer
+			DWORD offset = buffer->GetSize();
+			//If last segment is also on our buffer and ends just there
+			if (!segments.back().owner && segments.back().pos+segments.back().size==offset)
+				//Grow it
+				segments.back().size += size;
+			else
+				//Add new one
+				segments.push_back({nullptr,nullptr,offset,size});
+			//Update length
+			segmentedLength += size;
+		}
 		//Append data
 		buffer->AppendData(data,size);
 		//Return previous pos
@@ -259,35 +295,146 @@ public:
 
 	DWORD AppendMedia(BufferReader& reader, DWORD size)
 	{
-		//Get current pos
-		DWORD pos = buffer->GetSize();
-		//Adquire buffer
-		AdquireBuffer();
-		//Append data
-		buffer->AppendData(reader.GetData(size), size);
-		//Return previous pos
-		return pos;
+		return AppendMedia(reader.GetData(size), size);
 	}
 
 	DWORD AppendMedia(const Buffer& append)
 	{
+		return AppendMedia(append.GetData(), append.GetSize());
+	}
+
+	DWORD AppendMedia(BufferReader& reader)
+	{
+		return AppendMedia(reader, reader.GetLeft());
+	}
+
+	// Append data without copying it, keeping a reference to its owner until the
+	// frame is reset. The data must not be modified while it is referenced.
+	DWORD AppendMediaReference(const std::shared_ptr<const void>& owner,const BYTE* data,DWORD size)
+	{
+		//If there is no owner
+		if (!owner)
+			//Copy it
+			return AppendMedia(data,size);
 		//Get current pos
-		DWORD pos = buffer->GetSize();
-		//Adquire buffer
-		AdquireBuffer();
-		//Append data
-		buffer->AppendData(append.GetData(), append.GetSize());
+		DWORD pos = GetLength();
+		//If it is the first reference and we had data already
+		if (segments.empty() && pos)
+			//It will be the first segment
+			segments.push_back({nullptr,nullptr,0,pos});
+		//Add reference
+		segments.push_back({owner,data,0,size});
+		//Update length
+		segmentedLength = pos + size;
 		//Return previous pos
 		return pos;
 	}
 
-	DWORD AppendMedia(BufferReader& reader)
+	// Overwrite already appended data
+	void UpdateMedia(DWORD pos,const BYTE* data,DWORD size)
 	{
-		return AppendMedia(reader, reader.GetLeft());
+		DWORD ini = 0;
+		//Find segment containing it
+		for (const auto& segment : segments)
+		{
+			//If it is inside this one
+			if (pos>=ini && pos+size<=ini+segment.size)
+			{
+				//If it is data of our own
+				if (!segment.owner)
+				{
+					//Adquire buffer
+					AdquireBuffer();
+					//Overwrite in place
+					memcpy(buffer->GetData()+segment.pos+pos-ini,data,size);
+					//Done
+					return;
+				}
+				//Referenced data is read only
+				break;
+			}
+			//Next
+			ini += segment.size;
+		}
+		//Copy on contiguous buffer
+		memcpy(GetData()+pos,data,size);
+	}
+
+	// Copy data into the output buffer, which must be big enough
+	DWORD CopyMedia(DWORD pos,DWORD size,BYTE* out) const
+	{
+		std::lock_guard<std::mutex> lock(segmentsMutex);
+		//If not segmented
+		if (segments.empty())
+		{
+			//Copy directly
+			memcpy(out,buffer->GetData()+pos,size);
+			//Done
+			return size;
+		}
+
+		DWORD ini = 0;
+		DWORD len = 0;
+		//For each segment
+		for (const auto& segment : segments)
+		{
+			//If we have it
+			if (len==size)
+				//Done
+				break;
+			//If it contains requested data
+			if (pos<ini+segment.size)
+			{
+				//Get offset inside segment
+				DWORD offset = pos>ini ? pos-ini : 0;
+				//Get how much we can copy from it
+				DWORD num = std::min(segment.size-offset,size-len);
+				//Copy
+				memcpy(out+len,GetSegmentData(segment)+offset,num);
+				//Inc copied length
+				len += num;
+			}
+			//Next
+			ini += segment.size;
+		}
+		//Return copied length
+		return len;
+	}
+
+	// Get scatter/gather list for the frame data, each segment holds a reference to its data
+	std::vector<Segment> GetSegments() const
+	{
+		std::lock_guard<std::mutex> lock(segmentsMutex);
+		std::vector<Segment> list;
+		//If not segmented
+		if (segments.empty())
+		{
+			//Only our buffer
+			if (buffer->GetSize())
+				list.push_back({buffer->GetData(),static_cast<DWORD>(buffer->GetSize()),buffer});
+			//Done
+			return list;
+		}
+		//Reserve
+		list.reserve(segments.size());
+		//For each segment
+		for (const auto& segment : segments)
+			//Add it
+			list.push_back({GetSegmentData(segment),segment.size,segment.owner ? segment.owner : buffer});
+		//Done
+		return list;
+	}
+
+	bool IsSegmented() const
+	{
+		std::lock_guard<std::mutex> lock(segmentsMutex);
+		return !segments.empty();
 	}
 
 	void PrependMedia(const BYTE* data,DWORD size)
 	{
+		//Get contiguous data
+		Coalesce();
 		//Store old buffer
 		auto old = buffer;
 		//New one
@@ -369,6 +516,61 @@ public:
 	}
 
 protected:
+	struct SegmentReference
+	{
+		//Owner of the referenced data, or null if it is on our own buffer
+		std::shared_ptr<const void> owner;
+		const BYTE* data;
+		DWORD pos;
+		DWORD size;
+	};
+
+	// Guards the segments from concurrent const accessors, it is not copied with the frame
+	struct SegmentsMutex : public std::mutex
+	{
+		SegmentsMutex() = default;
+		SegmentsMutex(const SegmentsMutex&) : std::mutex() {}
+		SegmentsMutex& operator=(const SegmentsMutex&) { return *this; }
+	};
+
+	const BYTE* GetSegmentData(const SegmentReference& segment) const
+	{
+		return segment.owner ? segment.data : buffer->GetData()+segment.pos;
+	}
+
+	void CopySegments(const MediaFrame& other)
+	{
+		std::lock_guard<std::mutex> lock(other.segmentsMutex);
+		//Share same buffer and references, as other may have been coalesced meanwhile
+		buffer = other.buffer;
+		ownedBuffer = false;
+		segments = other.segments;
+		segmentedLength = other.segmentedLength;
+	}
+
+	// Lazily copy referenced data into a contiguous buffer. As this may happen
+	// on a const frame shared by several listeners, it is done under the lock.
+	void Coalesce() const
+	{
+		std::lock_guard<std::mutex> lock(segmentsMutex);
+		//If not segmented
+		if (segments.empty())
+			//Nothing to do
+			return;
+		//Create new buffer with all data
+		auto coalesced = std::make_shared<Buffer>(segmentedLength);
+		//Copy all segments
+		for (const auto& segment : segments)
+			coalesced->AppendData(GetSegmentData(segment),segment.size);
+		//Use it
+		buffer = coalesced;
+		//We own the payload
+		ownedBuffer = true;
+		//Not segmented anymore
+		segments.clear();
+		segmentedLength = 0;
+	}
+
 	void AdquireBuffer()
 	{
 		//If already owning
@@ -390,8 +592,11 @@ protected:
 	DWORD ssrc			= 0;
 	int64_t timestampSkew 	= 0;
 	
-	Buffer::shared	buffer;
-	bool ownedBuffer		= false;
+	mutable Buffer::shared	buffer;
+	mutable bool ownedBuffer	= false;
+	mutable std::vector<SegmentReference> segments;
+	mutable DWORD segmentedLength	= 0;
+	mutable SegmentsMutex segmentsMutex;
 	bool disableSharedBuffer	= false;
 	
 	DWORD	duration		= 0;
@@ -47,6 +47,14 @@ public:
 	using shared = std::shared_ptr<RTPSender>;
 public:
 	virtual int Enqueue(const RTPPacket::shared& packet) = 0;
+	//Packets of the same batch, usually a frame, should be sent back to back
+	virtual int Enqueue(const std::vector<RTPPacket::shared>& packets)
+	{
+		int num = 0;
+		for (const auto& packet : packets)
+			num += Enqueue(packet) > 0;
+		return num;
+	}
 };
 
 class RTPReceiver
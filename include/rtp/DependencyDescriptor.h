@@ -2,17 +2,19 @@
 #define DEPENDENCYDESCRIPTOR_H
 
 #include "config.h"
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
+#include "InlineVector.h"
 #include "WrapExtender.h"
 #include "bitstream/BitReader.h"
 #include "bitstream/BitWriter.h"
 #include "rtp/LayerInfo.h"
 
 
-enum DecodeTargetIndication
+enum DecodeTargetIndication : uint8_t
 {
 	NotPresent	= 0,	// DecodeTargetInfo symbol '-'
 	Discardable	= 1,	// DecodeTargetInfo symbol 'D'
@@ -34,9 +36,17 @@ struct RenderResolution
 
 struct FrameDependencyTemplate : public LayerInfo
 {
-	std::vector<DecodeTargetIndication> decodeTargetIndications;
-	std::vector<uint32_t> frameDiffs;
-	std::vector<uint32_t> frameDiffsChains;
+	static constexpr int MaxDecodeTargets	= 32;
+	static constexpr int MaxFrameDiffs	= 16;
+
+	using DecodeTargetIndications	= InlineVector<DecodeTargetIndication,MaxDecodeTargets>;
+	//Frame diffs are up to 12 bits and chain diffs up to 8 bits
+	using FrameDiffs		= InlineVector<uint16_t,MaxFrameDiffs>;
+	using FrameDiffsChains		= InlineVector<uint8_t,MaxDecodeTargets>;
+
+	DecodeTargetIndications decodeTargetIndications;
+	FrameDiffs frameDiffs;
+	FrameDiffsChains frameDiffsChains;
 	
 	void Dump() const;
 	
@@ -52,6 +62,9 @@ struct FrameDependencyTemplate : public LayerInfo
 
 struct TemplateDependencyStructure
 {
+	//Immutable once parsed, shared by all the packets until it changes
+	using shared = std::shared_ptr<const TemplateDependencyStructure>;
+
 	uint32_t templateIdOffset = 0;
 	uint32_t dtsCount	  = 0;
 	uint32_t chainsCount	  = 0;
@@ -98,10 +111,13 @@ struct DependencyDescriptor
 {
 	static constexpr int MaxSpatialIds	= 4;
 	static constexpr int MaxTemporalIds	= 8;
-	static constexpr int MaxDecodeTargets	= 32;
+	static constexpr int MaxDecodeTargets	= FrameDependencyTemplate::MaxDecodeTargets;
 	static constexpr int MaxTemplates	= 64;
 
-	
+	using ActiveDecodeTargets	= InlineVector<bool,MaxDecodeTargets>;
+	using DecodeTargetIndications	= FrameDependencyTemplate::DecodeTargetIndications;
+	using FrameDiffs		= FrameDependencyTemplate::FrameDiffs;
+	using FrameDiffsChains		= FrameDependencyTemplate::FrameDiffsChains;
 	
 	//mandatory_descriptor_fields
 	bool startOfFrame			= true; 
@@ -109,17 +125,18 @@ struct DependencyDescriptor
 	uint32_t  frameDependencyTemplateId	= 0;
 	uint16_t  frameNumber			= 0;
 	
-	std::optional<TemplateDependencyStructure> templateDependencyStructure;
-	std::optional<std::vector<bool>> activeDecodeTargets;			
+	TemplateDependencyStructure::shared templateDependencyStructure;
+	std::optional<ActiveDecodeTargets> activeDecodeTargets;
 	
-	std::optional<std::vector<DecodeTargetIndication>> customDecodeTargetIndications;
-	std::optional<std::vector<uint32_t>> customFrameDiffs;
-	std::optional<std::vector<uint32_t>> customFrameDiffsChains;
+	std::optional<DecodeTargetIndications> customDecodeTargetIndications;
+	std::optional<FrameDiffs> customFrameDiffs;
+	std::optional<FrameDiffsChains> customFrameDiffsChains;
 	
 	bool Serialize(BitWriter& writter) const;
 	void Dump() const;
 	
-	static std::optional<DependencyDescriptor> Parse(BitReader& reader, const std::optional<TemplateDependencyStructure>& templateDependencyStructure = std::nullopt);
+	//If the parsed template structure is equal to the current one, the current one is reused
+	static std::optional<DependencyDescriptor> Parse(BitReader& reader, const TemplateDependencyStructure::shared& templateDependencyStructure = nullptr);
 
 	friend bool operator==(const DependencyDescriptor& lhs, const DependencyDescriptor& rhs)
 	{
@@ -127,7 +144,8 @@ struct DependencyDescriptor
 			lhs.endOfFrame == rhs.endOfFrame &&
 			lhs.frameDependencyTemplateId == rhs.frameDependencyTemplateId &&
 			lhs.frameNumber == rhs.frameNumber &&
-			lhs.templateDependencyStructure == rhs.templateDependencyStructure &&
+			(lhs.templateDependencyStructure == rhs.templateDependencyStructure ||
+				(lhs.templateDependencyStructure && rhs.templateDependencyStructure && *lhs.templateDependencyStructure == *rhs.templateDependencyStructure)) &&
 			lhs.activeDecodeTargets == rhs.activeDecodeTargets &&
 			lhs.customDecodeTargetIndications == rhs.customDecodeTargetIndications &&
 			lhs.customFrameDiffs == rhs.customFrameDiffs &&
@@ -16,6 +16,9 @@
 #include "config.h"
 #include "rtp/RTCPPacket.h"
 #include "rtp/RTCPCommonHeader.h"
+#include "rtp/RTCPReport.h"
+#include "rtp/RTCPSenderReport.h"
+#include "rtp/RTCPRTPFeedback.h"
 #include <vector>
 #include <memory>
 
@@ -23,6 +26,27 @@ class RTCPCompoundPacket
 {
 public:
 	using shared = std::shared_ptr<RTCPCompoundPacket>;
+
+	/**
+	 * Receives the most frequent RTCP messages decoded straight from the
+	 * incoming buffer, without allocating any packet or field object. Other
+	 * messages are skipped, use the object based Parse if they are needed.
+	 */
+	class Visitor
+	{
+	public:
+		virtual ~Visitor() = default;
+		//Sender info only, report blocks are passed to onReport
+		virtual void onSenderReport(const RTCPSenderReport& sr)			{}
+		//Report blocks from both sender and receiver reports
+		virtual void onReport(const RTCPReport& report)				{}
+		virtual void onBye(DWORD ssrc)						{}
+		virtual void onNACK(DWORD ssrc,WORD pid,WORD blp)			{}
+		virtual void onTransportWideFeedback(const RTCPRTPFeedback::TransportWideFeedbackMessageField& field) {}
+		//Both PLI and FIR feedback messages
+		virtual void onPLI(DWORD ssrc)						{}
+		virtual void onREMB(DWORD ssrc,DWORD bitrate)				{}
+	};
 	
 public:
 	static bool IsRTCP(const BYTE *data,DWORD size)
@@ -43,6 +67,7 @@ public:
 		return 1;
 	}
 	static RTCPCompoundPacket::shared Parse(const BYTE *data,DWORD size);
+	static bool Parse(const BYTE *data,DWORD size,Visitor& visitor);
 	static RTCPCompoundPacket::shared Create()
 	{
 		return  std::make_shared<RTCPCompoundPacket>();
@@ -50,7 +50,7 @@ public:
 		SetDelaySinceLastSR(dlsr);
 	}
 
-	DWORD GetDelaySinceLastSRMilis()
+	DWORD GetDelaySinceLastSRMilis() const
 	{
 		//Get the delay, expressed in units of 1/65536 seconds
 		DWORD dslr = GetDelaySinceLastSR();
@@ -1,7 +1,9 @@
 #ifndef RTPHEADEREXTENSION_H
 #define RTPHEADEREXTENSION_H
+#include <array>
 #include <optional>
 #include <cmath>
+#include <string>
 #include <vector>
 
 #include "config.h"
@@ -222,11 +224,38 @@ public:
 		std::optional<HDRMetadata> hdrMetadata;
 	};
 
+	//Max size of the extensions kept undecoded on the packet
+	static constexpr DWORD MaxRawSize = 256;
 public:
 	DWORD Parse(const RTPMap &extMap,const BYTE* data,const DWORD size);
-	bool  ParseDependencyDescriptor(const std::optional<TemplateDependencyStructure>& templateDependencyStructure);
+	bool  ParseDependencyDescriptor(const TemplateDependencyStructure::shared& templateDependencyStructure);
 	DWORD Serialize(const RTPMap &extMap,BYTE* data,const DWORD size) const;
 	void  Dump() const;
+
+	//Variable length extensions are only decoded on first access, not thread safe
+	std::string GetRId() const					{ return GetRawString(RTPStreamId);		}
+	std::string GetRepairedId() const				{ return GetRawString(RepairedRTPStreamId);	}
+	std::string GetMediaStreamId() const				{ return GetRawString(MediaStreamId);		}
+	const std::optional<struct ColorSpace>& GetColorSpace() const;
+	const std::optional<::VideoLayersAllocation>& GetVideoLayersAllocation() const;
+
+	void SetRId(const std::string& rid)				{ hasRId = SetRaw(RTPStreamId, rid);			}
+	void SetRepairedId(const std::string& repairedId)		{ hasRepairedId = SetRaw(RepairedRTPStreamId, repairedId);	}
+	void SetMediaStreamId(const std::string& mid)			{ hasMediaStreamId = SetRaw(MediaStreamId, mid);	}
+	void SetColorSpace(const struct ColorSpace& colorSpace);
+	void SetVideoLayersAllocation(const ::VideoLayersAllocation& videoLayersAllocation);
+private:
+	struct RawElement
+	{
+		WORD pos	= 0;
+		BYTE len	= 0;
+		bool present	= false;
+	};
+
+	bool SetRaw(Type type, const BYTE* data, DWORD size);
+	bool SetRaw(Type type, const std::string& str)			{ return SetRaw(type, (const BYTE*)str.data(), str.length());	}
+	const RawElement& GetRaw(Type type) const			{ return elements[type];				}
+	std::string GetRawString(Type type) const;
 public:
 	QWORD	absSentTime	= 0;
 	int	timeOffset	= 0;
@@ -235,15 +264,9 @@ public:
 	WORD	transportSeqNum	= 0;
 	VideoOrientation cvo;
 	FrameMarks frameMarks;
-	std::string rid;
-	std::string repairedId;
-	std::string mid;
-	std::optional<BufferReader> dependencyDescryptorReader;
 	std::optional<::DependencyDescriptor> dependencyDescryptor;
 	struct AbsoluteCaptureTime absoluteCaptureTime;
 	struct PlayoutDelay playoutDelay;
-	std::optional<struct ColorSpace> colorSpace;
-	std::optional<struct VideoLayersAllocation> videoLayersAllocation;
 	
 	bool	hasAbsSentTime		= false;
 	bool	hasTimeOffset		= false;
@@ -259,6 +282,14 @@ public:
 	bool	hasPlayoutDelay		= false;
 	bool	hasColorSpace		= false;
 	bool    hasVideoLayersAllocation= false;
+private:
+	//Undecoded extension data, copied as is when serializing if not modified
+	std::array<BYTE,MaxRawSize> raw;
+	WORD rawLength = 0;
+	std::array<RawElement,Reserved> elements = {};
+	//Decoded on demand
+	mutable std::optional<struct ColorSpace> colorSpace;
+	mutable std::optional<::VideoLayersAllocation> videoLayersAllocation;
 };
 
 #endif /* RTPHEADEREXTENSION_H */
@@ -0,0 +1,44 @@
+#ifndef RTPHEADERTEMPLATE_H
+#define RTPHEADERTEMPLATE_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "media.h"
+#include "rtp/RTPMap.h"
+#include "rtp/RTPHeaderExtension.h"
+
+class RTPPacket;
+
+/**
+ * Pre-serialized RTP header and extensions of an outgoing stream. Fields that
+ * are constant for the stream (ssrc, mid, rid, forced playout delay) are
+ * written once and per packet ones (marker, payload type, sequence number,
+ * timestamp, transport wide seq num, abs send time and audio level) are
+ * patched in place. Must be reset when the negotiated extensions change.
+ */
+class RTPHeaderTemplate
+{
+public:
+	void Init(MediaFrame::Type type, DWORD ssrc, const std::string& mid, const std::string& rid, const std::optional<struct RTPHeaderExtension::PlayoutDelay>& playoutDelay, const RTPMap& extMap);
+	void Reset();
+
+	bool IsInitialized() const	{ return initialized;	}
+	//Check if the packet only carries the extensions of the template
+	bool CanSerialize(const RTPPacket& packet) const;
+	//Write header and payload of the packet, returns 0 if the template can not be used for it
+	DWORD Serialize(BYTE* data, DWORD size, const RTPPacket& packet) const;
+
+private:
+	std::vector<BYTE> header;
+	bool initialized	= false;
+	//Position of the per packet extension values, 0 if not present
+	DWORD transportWideCCPos= 0;
+	DWORD absSentTimePos	= 0;
+	DWORD audioLevelPos	= 0;
+	bool hasPlayoutDelay	= false;
+};
+
+#endif /* RTPHEADERTEMPLATE_H */
@@ -35,6 +35,8 @@ public:
 			for (const auto& packet : packets)
 				onRTP(stream,packet);
 		};
+		//True if the batch onRTP is overriden to process the whole batch at once
+		virtual bool HandlesBatches() const { return false; }
 		virtual void onBye(const RTPIncomingMediaStream* stream) = 0;
 		virtual void onEnded(const RTPIncomingMediaStream* stream) = 0;
 	};
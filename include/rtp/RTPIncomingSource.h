@@ -77,7 +77,8 @@ struct RTPIncomingSource : public RTPSource
 	
 	void Update(QWORD now,DWORD seqNum,DWORD size,DWORD overheadSize,const std::vector<LayerInfo> &layerInfos, bool aggreagtedLayers, const std::optional<struct VideoLayersAllocation>& videoLayersAllocation);
 	
-	void Process(QWORD now, const RTCPSenderReport::shared& sr);
+	void Process(QWORD now, const RTCPSenderReport& sr);
+	void Process(QWORD now, const RTCPSenderReport::shared& sr) { Process(now, *sr); }
 	void SetLastTimestamp(QWORD now, QWORD timestamp, QWORD captureTimestamp = 0);
 	
 	virtual void Update(QWORD now,DWORD seqNum,DWORD size,DWORD overheadSize) override;
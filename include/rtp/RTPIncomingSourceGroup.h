@@ -49,6 +49,7 @@ public:
 	void UpdateAsync(std::function<void(std::chrono::milliseconds)> callback);
 	void SetRTT(DWORD rtt, QWORD now);
 	std::list<RTCPRTPFeedback::NACKField::shared>  GetNacks() { return losts.GetNacks(); }
+	DWORD WriteNacks(BYTE* data, DWORD size, QWORD now) { return losts.WriteNacks(data, size, now, rtt); }
 	
 	void Start(bool remb = false);
 	void Stop();
@@ -56,6 +57,7 @@ public:
 	WORD SetRTTRTX(uint64_t time);
 	
 	DWORD GetCurrentLost()			const { return losts.GetTotal();}
+	DWORD GetRecovered()			const { return losts.GetRecovered();}
 	DWORD GetMinWaitedTime()		const { return minWaitedTime;	}
 	DWORD GetMaxWaitedTime()		const { return maxWaitedTime;	}
 	long double GetAvgWaitedTime()		const {	return avgWaitedTime;	}
@@ -88,8 +90,8 @@ private:
 	RTPLostPackets	losts;
 	RTPBuffer	packets;
 	std::set<RTPIncomingMediaStream::Listener*>  listeners;
-	std::optional<std::vector<bool>> activeDecodeTargets;
-	std::optional<TemplateDependencyStructure> templateDependencyStructure;
+	std::optional<DependencyDescriptor::ActiveDecodeTargets> activeDecodeTargets;
+	TemplateDependencyStructure::shared templateDependencyStructure;
 	
 	bool  isRTXEnabled = true;
 	WORD  rttrtxSeq	 = 0 ;
@@ -2,6 +2,7 @@
 #define RTPLOSTPACKETS_H
 
 #include <list>
+#include <vector>
 
 #include "config.h"
 #include "rtp/RTPPacket.h"
@@ -10,23 +11,43 @@
 
 class RTPLostPackets
 {
+public:
+	//Max number of times a packet will be requested
+	static constexpr BYTE MaxRetransmissionAttempts = 10;
+	//Minimum time between two requests of same packet, used when rtt is lower
+	static constexpr DWORD MinRetransmissionInterval = 20;
 public:
 	RTPLostPackets(WORD num);
-	~RTPLostPackets();
 	void Reset();
 	WORD AddPacket(const RTPPacket::shared &packet);
 	std::list<RTCPRTPFeedback::NACKField::shared>  GetNacks() const;
+	//Serialize NACK fields for lost packets not requested within the last rtt, returns written bytes
+	DWORD WriteNacks(BYTE* data, DWORD size, QWORD now, DWORD rtt);
 	void Dump() const;
 	DWORD GetTotal() const {return total;}
+	DWORD GetRecovered() const {return recovered;}
 	
 private:
-	QWORD *packets;
+	DWORD GetIndex(DWORD extSeq) const	{ return extSeq % size;						}
+	bool IsReceived(DWORD index) const	{ return received[index >> 6] & (1ull << (index & 63));		}
+	void SetReceived(DWORD index)		{ received[index >> 6] |= 1ull << (index & 63);			}
+	void Clear(DWORD index)
+	{
+		received[index >> 6] &= ~(1ull << (index & 63));
+		attempts[index] = 0;
+		requested[index] = 0;
+	}
+private:
+	//Ring of received flags, retransmission attempts and last request time, indexed by seq num
+	std::vector<QWORD> received;
+	std::vector<BYTE>  attempts;
+	std::vector<QWORD> requested;
 	WORD size   = 0;
 	WORD len    = 0;
 	DWORD first = 0;
 	DWORD total = 0;
+	DWORD recovered = 0;
 };
 
 
 #endif /* RTPLOSTPACKETS_H */
-
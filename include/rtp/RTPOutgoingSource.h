@@ -49,7 +49,8 @@ struct RTPOutgoingSource :
 	virtual void Update(QWORD now) override;
 	
 	RTCPSenderReport::shared CreateSenderReport(QWORD time);
-	bool ProcessReceiverReport(QWORD time, const RTCPReport::shared& report);
+	bool ProcessReceiverReport(QWORD time, const RTCPReport& report);
+	bool ProcessReceiverReport(QWORD time, const RTCPReport::shared& report) { return ProcessReceiverReport(time, *report); }
 	bool IsLastSenderReportNTP(DWORD ntp);
 
 	void SetLastTimestamp(QWORD now, QWORD timestamp);
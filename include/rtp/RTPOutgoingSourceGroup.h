@@ -8,6 +8,7 @@
 #include "config.h"
 #include "rtp/RTPPacket.h"
 #include "rtp/RTPOutgoingSource.h"
+#include "rtp/RTPHeaderTemplate.h"
 #include "TimeService.h"
 #include "CircularBuffer.h"
 
@@ -63,10 +64,7 @@ public:
 		
 		return *forcedPlayoutDelay; 
 	}
-	void SetForcedPlayoutDelay(uint16_t min, uint16_t max)
-	{
-		forcedPlayoutDelay.emplace(min, max);
-	}
+	void SetForcedPlayoutDelay(uint16_t min, uint16_t max);
 	
 public:	
 	std::string rid;
@@ -76,6 +74,8 @@ public:
 	RTPOutgoingSource fec;
 	RTPOutgoingSource rtx;
 	QWORD lastUpdated = 0;
+	//Serialized headers of media packets, built and used by the transport
+	RTPHeaderTemplate headerTemplate;
 private:	
 	CircularBuffer<RTPPacket::shared, uint16_t, 512> packets;
 	CircularBuffer<QWORD, uint16_t, 512> rtxTimes;
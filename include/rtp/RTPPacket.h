@@ -36,12 +36,13 @@ public:
 	
 	DWORD Serialize(BYTE* data,DWORD size,const RTPMap& extMap) const;
 	
-	bool SetPayload(const BYTE *data,DWORD size)	{ return payload->SetPayload(data,size);	}
-	bool SkipPayload(DWORD skip)			{ return payload->SkipPayload(skip);		}
-	bool PrefixPayload(BYTE *data,DWORD size)	{ return payload->PrefixPayload(data,size);	}
+	bool SetPayload(const BYTE *data,DWORD size)	{ AdquireMediaData(); return payload->SetPayload(data,size);	}
+	bool SkipPayload(DWORD skip)			{ AdquireMediaData(); return payload->SkipPayload(skip);	}
+	bool PrefixPayload(BYTE *data,DWORD size)	{ AdquireMediaData(); return payload->PrefixPayload(data,size);	}
 	
 	bool RecoverOSN();
 	void SetOSN(DWORD extSeqNum);
+	bool HasOSN() const			{ return osn.has_value();	}
 
 	virtual void Dump() const;
 	
@@ -61,7 +62,7 @@ public:
 	void SetTimestampCycles(DWORD cycles)	{ this->timestampCycles = cycles;	}
 	void SetClockRate(DWORD rate)		{ this->clockRate = rate;		}
 
-	void SetMediaLength(DWORD len)		{ payload->SetMediaLength(len);		}
+	void SetMediaLength(DWORD len)		{ AdquireMediaData(); payload->SetMediaLength(len);	}
 	
 	//Getters
 	MediaFrame::Type GetMedia()	const { return media;				} //Deprecated
@@ -69,6 +70,8 @@ public:
 	BYTE  GetCodec()		const { return codec;				}
 	
 	BYTE* AdquireMediaData();
+	//Share payload with other objects (i.e. media frames), any later change on this packet will be done on a copy
+	const RTPPayload::shared& SharePayload()	{ ownedPayload = false; return payload;	}
 	const BYTE* GetMediaData()	const { return payload ? payload->GetMediaData()	: nullptr;	}
 	DWORD GetMediaLength()		const { return payload ? payload->GetMediaLength()	: 0; 		}
 	DWORD GetMaxMediaLength()	const { return payload ? payload->GetMaxMediaLength()	: 0;		}
@@ -91,18 +94,18 @@ public:
 	void  SetTimeOffset(int timeOffset)						{ header.extension = extension.hasTimeOffset		= true; extension.timeOffset = timeOffset;	}
 	void  SetTransportSeqNum(DWORD seq)						{ header.extension = extension.hasTransportWideCC	= true; extension.transportSeqNum = seq;	}
 	void  SetFrameMarkings(const RTPHeaderExtension::FrameMarks& frameMarks )	{ header.extension = extension.hasFrameMarking		= true; extension.frameMarks = frameMarks;	}
-	void  SetRId(const std::string &rid)						{ header.extension = extension.hasRId			= true; extension.rid = rid;			}
-	void  SetRepairedId(const std::string &repairedId)				{ header.extension = extension.hasRepairedId		= true; extension.repairedId = repairedId;	}
-	void  SetMediaStreamId(const std::string &mid)					{ header.extension = extension.hasMediaStreamId		= true; extension.mid = mid;			}
+	void  SetRId(const std::string &rid)						{ header.extension = true; extension.SetRId(rid);			}
+	void  SetRepairedId(const std::string &repairedId)				{ header.extension = true; extension.SetRepairedId(repairedId);		}
+	void  SetMediaStreamId(const std::string &mid)					{ header.extension = true; extension.SetMediaStreamId(mid);		}
 	void  SetDependencyDescriptor(DependencyDescriptor& dependencyDescriptor)	{ header.extension = extension.hasDependencyDescriptor	= true; extension.dependencyDescryptor = dependencyDescriptor;		}
 	void  SetAbsoluteCaptureTimestamp(QWORD ntp)					{ header.extension = extension.hasAbsoluteCaptureTime	= true; extension.absoluteCaptureTime.SetAbsoluteCaptureTimestamp(ntp); }
 	void  SetAbsoluteCaptureTime(QWORD ms)						{ header.extension = extension.hasAbsoluteCaptureTime	= true; extension.absoluteCaptureTime.SetAbsoluteCaptureTime(ms);	}
 	void  SetPlayoutDelay(uint16_t min, uint16_t max)				{ header.extension = extension.hasPlayoutDelay		= true; extension.playoutDelay.SetPlayoutDelay(min, max);		}
 	void  SetPlayoutDelay(const struct RTPHeaderExtension::PlayoutDelay& playoutDelay)	{ header.extension = extension.hasPlayoutDelay		= true; extension.playoutDelay = playoutDelay;				}
-	void  SetColorSpace(const struct RTPHeaderExtension::ColorSpace& colorSpace)		{ header.extension = extension.hasColorSpace		= true; extension.colorSpace = colorSpace;				}
-	void  SetVideoLayersAllocation(const VideoLayersAllocation& videoLayersAllocation)	{ header.extension = extension.hasVideoLayersAllocation = true; extension.videoLayersAllocation = videoLayersAllocation;	}
+	void  SetColorSpace(const struct RTPHeaderExtension::ColorSpace& colorSpace)		{ header.extension = true; extension.SetColorSpace(colorSpace);				}
+	void  SetVideoLayersAllocation(const VideoLayersAllocation& videoLayersAllocation)	{ header.extension = true; extension.SetVideoLayersAllocation(videoLayersAllocation);	}
 	
-	bool  ParseDependencyDescriptor(const std::optional<TemplateDependencyStructure>& templateDependencyStructure, std::optional<std::vector<bool>>& activeDecodeTargets);
+	bool  ParseDependencyDescriptor(const TemplateDependencyStructure::shared& templateDependencyStructure, const std::optional<DependencyDescriptor::ActiveDecodeTargets>& activeDecodeTargets);
 	
 	//Disable extensions
 	void  DisableAbsSentTime()		{ extension.hasAbsSentTime		= false; CheckExtensionMark(); }
@@ -124,18 +127,18 @@ public:
 	bool  GetVAD()				const	{ return extension.vad;				}
 	BYTE  GetLevel()			const	{ return extension.level;			}
 	WORD  GetTransportSeqNum()		const	{ return extension.transportSeqNum;		}
-	const std::string& GetRId()		const	{ return extension.rid;				}
-	const std::string& GetRepairedId()	const	{ return extension.repairedId;			}
-	const std::string& GetMediaStreamId()	const	{ return extension.mid;				}
+	std::string GetRId()			const	{ return extension.GetRId();			}
+	std::string GetRepairedId()		const	{ return extension.GetRepairedId();		}
+	std::string GetMediaStreamId()		const	{ return extension.GetMediaStreamId();		}
 	
 	const RTPHeaderExtension::FrameMarks&			GetFrameMarks()			 const { return extension.frameMarks;		}
 	const std::optional<DependencyDescriptor>&		GetDependencyDescriptor()	 const { return extension.dependencyDescryptor;	}
-	const std::optional<TemplateDependencyStructure>&	GetTemplateDependencyStructure() const { return templateDependencyStructure;	}
-	const std::optional<std::vector<bool>>&			GetActiveDecodeTargets()	 const { return activeDecodeTargets;		}
+	const TemplateDependencyStructure::shared&		GetTemplateDependencyStructure() const { return templateDependencyStructure;	}
+	const std::optional<DependencyDescriptor::ActiveDecodeTargets>& GetActiveDecodeTargets() const { return activeDecodeTargets;		}
 	const VideoOrientation&					GetVideoOrientation()		 const { return extension.cvo;			}
 	const struct RTPHeaderExtension::PlayoutDelay&		GetPlayoutDelay()		 const { return extension.playoutDelay;		}
-	const std::optional<struct RTPHeaderExtension::ColorSpace>&    GetColorSpace()		 const { return extension.colorSpace;		}
-	const std::optional<struct VideoLayersAllocation>&	GetVideoLayersAllocation()	 const { return extension.videoLayersAllocation;}
+	const std::optional<struct RTPHeaderExtension::ColorSpace>&    GetColorSpace()		 const { return extension.GetColorSpace();	}
+	const std::optional<struct VideoLayersAllocation>&	GetVideoLayersAllocation()	 const { return extension.GetVideoLayersAllocation();}
 	
 	bool  HasAudioLevel()			const	{ return extension.hasAudioLevel;		}
 	bool  HasAbsSentTime()			const	{ return extension.hasAbsSentTime;		}
@@ -152,16 +155,16 @@ public:
 	bool  HasVideoOrientation()		const	{ return extension.hasVideoOrientation;		}
 	bool  HasAbsoluteCaptureTime()		const	{ return extension.hasAbsoluteCaptureTime;	}
 	bool  HasPlayoutDelay()			const   { return extension.hasPlayoutDelay;		}
-	bool  HasColorSpace()			const   { return extension.hasColorSpace && extension.colorSpace;		}
-	bool  HasVideoLayersAllocation()	const	{ return extension.hasVideoLayersAllocation && extension.videoLayersAllocation; }
+	bool  HasColorSpace()			const   { return extension.hasColorSpace && extension.GetColorSpace();		}
+	bool  HasVideoLayersAllocation()	const	{ return extension.hasVideoLayersAllocation && extension.GetVideoLayersAllocation(); }
 
 	
-	void  OverrideActiveDecodeTargets(const std::optional<std::vector<bool>>& activeDecodeTargets) 
+	void  OverrideActiveDecodeTargets(const std::optional<DependencyDescriptor::ActiveDecodeTargets>& activeDecodeTargets) 
 	{
 		if (extension.dependencyDescryptor)
 			extension.dependencyDescryptor->activeDecodeTargets = activeDecodeTargets;
 	}
-	void OverrideTemplateDependencyStructure(const std::optional<TemplateDependencyStructure>& templateDependencyStructure)
+	void OverrideTemplateDependencyStructure(const TemplateDependencyStructure::shared& templateDependencyStructure)
 	{
 		this->templateDependencyStructure = templateDependencyStructure;
 	}
@@ -198,8 +201,8 @@ public:
 	std::optional<VP9PayloadDescription>	vp9PayloadDescriptor;
 	std::optional<H264SeqParameterSet>	h264SeqParameterSet;
 	std::optional<H264PictureParameterSet>	h264PictureParameterSet;
-	std::optional<std::vector<bool>>	activeDecodeTargets;
-	std::optional<TemplateDependencyStructure> templateDependencyStructure;
+	std::optional<DependencyDescriptor::ActiveDecodeTargets> activeDecodeTargets;
+	TemplateDependencyStructure::shared	templateDependencyStructure;
 	Buffer::shared				config;
 
 	bool rewitePictureIds = false;
@@ -39,16 +39,16 @@ struct LayerSource : LayerInfo
 	std::optional<uint8_t>  targetFps;
 	
 	LayerSource() :
-		acumulator(1E3, 1E3, 1E3),
-		acumulatorTotalBitrate(1E3, 1E3, 1E3)
+		acumulator(1E3, 1E3, 0, 100),
+		acumulatorTotalBitrate(1E3, 1E3, 0, 100)
 	{
 		
 	}
 	virtual ~LayerSource() = default;
 	
 	LayerSource(const LayerInfo& layerInfo) : 
-		acumulator(1E3, 1E3, 1E3),
-		acumulatorTotalBitrate(1E3, 1E3, 1E3)
+		acumulator(1E3, 1E3, 0, 100),
+		acumulatorTotalBitrate(1E3, 1E3, 0, 100)
 	{
 		spatialLayerId  = layerInfo.spatialLayerId;
 		temporalLayerId = layerInfo.temporalLayerId; 
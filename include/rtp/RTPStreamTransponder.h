@@ -17,6 +17,7 @@
 #include "rtp.h"
 #include "VideoLayerSelector.h"
 #include "WrapExtender.h"
+#include "Channel.h"
 
 class RTPStreamTransponder :
 	public TimeServiceWrapper<RTPStreamTransponder>,
@@ -36,6 +37,8 @@ protected:
 public:
 	virtual ~RTPStreamTransponder();
 
+	virtual void OnCreated() override;
+
 	void ResetIncoming();
 	void SetIncoming(const RTPIncomingMediaStream::shared& incoming, const RTPReceiver::shared& receiver, bool smooth = false);
 	bool AppendH264ParameterSets(const std::string& sprop);
@@ -43,6 +46,8 @@ public:
 
 	// RTPIncomingMediaStream::Listener interface
 	virtual void onRTP(const RTPIncomingMediaStream* stream, const RTPPacket::shared& packet) override;
+	virtual void onRTP(const RTPIncomingMediaStream* stream, const std::vector<RTPPacket::shared>& packets) override;
+	virtual bool HandlesBatches() const override { return true; }
 	virtual void onBye(const RTPIncomingMediaStream* stream) override;
 	virtual void onEnded(const RTPIncomingMediaStream* stream) override;
 
@@ -62,11 +67,20 @@ protected:
 	void RequestPLI();
 
 	//Async
+	void onRTPAsync(std::chrono::milliseconds now, const RTPIncomingMediaStream* stream, const std::vector<RTPPacket::shared>& packets);
 	void onRTPAsync(std::chrono::milliseconds now, const RTPIncomingMediaStream* stream, const RTPPacket::shared& packet);
 
 private:
+	struct RTPMessage
+	{
+		const RTPIncomingMediaStream* stream;
+		std::vector<RTPPacket::shared> packets;
+	};
+
+	std::shared_ptr<Channel<RTPMessage>> rtpChannel;
 	RTPOutgoingSourceGroup::shared  outgoing;
 	RTPSender::shared		sender;
+	std::vector<RTPPacket::shared>	outgoingPackets;
 	RTPIncomingMediaStream::shared  incoming;
 	RTPReceiver::shared		receiver;
 	RTPIncomingMediaStream::shared  incomingNext;
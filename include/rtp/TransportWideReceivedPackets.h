@@ -0,0 +1,61 @@
+#ifndef TRANSPORTWIDERECEIVEDPACKETS_H
+#define TRANSPORTWIDERECEIVEDPACKETS_H
+
+#include <array>
+
+#include "config.h"
+#include "WrapExtender.h"
+
+/**
+ * Arrival times of the packets received with a transport wide sequence number
+ * pending to be reported, stored in a fixed ring indexed by sequence number.
+ * Feedback messages are encoded straight from the ring and their cadence
+ * adapts to the incoming bitrate so they take a bounded share of it.
+ */
+class TransportWideReceivedPackets
+{
+public:
+	//Max packets reported on a single feedback message, keeps it below the MTU
+	static constexpr WORD MaxPackets = 256;
+	//Limits of the interval between feedback messages in ms
+	static constexpr QWORD MinFeedbackInterval = 20;
+	static constexpr QWORD MaxFeedbackInterval = 100;
+	//Max share of the incoming bitrate used by feedback messages and their expected size in bytes
+	static constexpr double MaxFeedbackOverhead = 0.05;
+	static constexpr DWORD EstimatedFeedbackSize = 68;
+public:
+	//Returns false if the packet does not fit in the pending feedback, which must be written first
+	bool AddPacket(WORD transportSeqNum, QWORD time, DWORD size);
+	//Encode the packet status chunks and deltas of the pending packets, returns written bytes
+	DWORD WriteFeedback(BYTE* data, DWORD size, BYTE feedbackPacketCount, QWORD now);
+	void Reset();
+
+	bool HasPending() const			{ return pending;					}
+	WORD GetPendingCount() const		{ return pending;					}
+	//Only valid if there are pending packets
+	QWORD GetFirstPendingTime() const	{ return firstPendingTime;				}
+	bool IsFeedbackDue(QWORD now) const	{ return pending && now >= firstPendingTime + GetFeedbackInterval()*1000;	}
+	QWORD GetFeedbackInterval() const;
+	DWORD GetBitrate() const		{ return bitrate;					}
+
+private:
+	//Arrival time in 250us units plus one, 0 if not received
+	std::array<DWORD,MaxPackets> arrivals = {};
+	//Scratch space for encoding
+	std::array<BYTE,MaxPackets> statuses = {};
+	std::array<int16_t,MaxPackets> deltas = {};
+
+	WrapExtender<uint16_t,uint64_t> extender;
+	QWORD first		= 0;
+	QWORD last		= 0;
+	WORD pending		= 0;
+	bool initialized	= false;
+	QWORD firstPendingTime	= 0;
+
+	//Incoming bitrate for calculating the feedback interval
+	QWORD bytes		= 0;
+	QWORD lastFeedbackTime	= 0;
+	DWORD bitrate		= 0;
+};
+
+#endif /* TRANSPORTWIDERECEIVEDPACKETS_H */
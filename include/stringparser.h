@@ -293,7 +293,7 @@ public:
 	
 	void Dump(const char *msg)
 	{
-		Debug(msg);
+		Debug("%s", msg);
 		::Dump((BYTE*)buffer,16>size*sizeof(_CharT)?size*sizeof(_CharT):16);
 	}
 	
@@ -13,7 +13,8 @@
 #include <pthread.h>
 #include <stdarg.h>
 
-int Log(const char *msg, ...);
+template<typename... Args>
+int Log(const char *msg, Args... args);
 
 /*************************************
 * blocksignals
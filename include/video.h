@@ -5,6 +5,7 @@
 #include "media.h"
 #include "codecs.h"
 #include "rtp/LayerInfo.h"
+#include "rtp/DependencyDescriptor.h"
 #include "VideoBuffer.h"
 #include "VideoBufferPool.h"
 
@@ -15,6 +16,8 @@ struct LayerFrame
 	uint32_t width	= 0;
 	uint32_t height	= 0;
 	LayerInfo info;
+	//Set by SVC encoders so it can be added to the rtp packets of the layer frame
+	std::optional<DependencyDescriptor> dependencyDescriptor;
 };
 
 class VideoFrame : public MediaFrame
@@ -51,6 +54,8 @@ public:
 	{
 		//Create new one with same data
 		VideoFrame *frame = new VideoFrame(codec,buffer);
+		//Share referenced data too
+		frame->CopySegments(*this);
 		//Size
 		frame->SetWidth(width);
 		frame->SetHeight(height);
@@ -108,6 +113,7 @@ public:
 	bool	HasLayerFrames() const				{ return !layers.empty();	}
 	const std::vector<LayerFrame>& GetLayerFrames() const	{ return layers;		}
 	void AddLayerFrame(const LayerFrame& layer)		{ layers.push_back(layer);	}
+	void ClearLayerFrames()					{ layers.clear();		}
 	
 	void SetVideoOrientation(const VideoOrientation cvo)		{ this->cvo = cvo;	}
 	std::optional<VideoOrientation> GetVideoOrientation() const	{ return this->cvo;	}
@@ -170,6 +176,8 @@ public:
 	virtual int   StopVideoCapture()=0;
 };
 
+class VideoBufferScaledCache;
+
 class VideoOutput
 {
 public:
@@ -179,6 +187,9 @@ public:
 
 	// Returns the current occupancy of the frame buffer queue
 	virtual size_t NextFrame(const VideoBuffer::const_shared& videoBuffer)=0;
+
+	// Scaled renditions shared with the other outputs of the same source, if any
+	virtual void SetScaledCache(const std::shared_ptr<VideoBufferScaledCache>& scaledCache) {}
 };
 
 
@@ -204,6 +215,8 @@ public:
 	virtual ~VideoDecoder() = default;
 	virtual int Decode(const VideoFrame::const_shared &frame) = 0;
 	virtual VideoBuffer::shared GetFrame() = 0;
+	//Only intra frames will be decoded for previews, so decoders can trade quality for speed
+	virtual void SetPreview(bool preview) {}
 public:
 	VideoCodec::Type type;
 
@@ -8,19 +8,40 @@ static const uint64_t MinInterval = 10;
 
 void ActiveSpeakerDetector::Accumulate(uint32_t id, bool vad, uint8_t db, uint64_t now)
 {
-	//Search for the speacker
-	auto it = speakers.find(id);
-  
+	//Update speaker score
+	Update(id,vad,db,now);
+	
+	//Process vads and check new 
+	Process(now);
+}
+
+void ActiveSpeakerDetector::Accumulate(const std::vector<AudioLevelDetector::Block>& blocks, uint64_t now)
+{
+	//Update all speakers
+	for (const auto& block : blocks)
+		Update(block.id,block.vad,block.level,now);
+	
+	//Process vads once for all of them
+	Process(now);
+}
+
+void ActiveSpeakerDetector::Update(uint32_t id, bool vad, uint8_t db, uint64_t now)
+{
 	//Check voice is detected and not muted
 	auto speaking = vad && db!=127 && (!noiseGatingThreshold || db<noiseGatingThreshold);
+	
+	//Search for the speacker
+	auto it = std::find_if(speakers.begin(),speakers.end(),[id](const SpeakerInfo& speaker) { return speaker.id==id; });
   
 	//Check if we had that speakcer before
 	if (it==speakers.end())
 	{
-		//Store 1s of initial bump if vad
-		speakers[id] = { speaking ? ScorePerMiliScond*1000ul : 0ul,now};
+		//Store 1s of initial bump if vad, silent ones start accumulating from now
+		speakers.push_back({id,speaking ? ScorePerMiliScond*1000ul : 0ul,now});
+		//Get it
+		it = std::prev(speakers.end());
 	} 
-	//Accumulate only if audio has been detected 
+	//Accumulate only if audio has been detected
 	else if (speaking)
 	{
 		// The audio level is expressed in -dBov, with values from 0 to 127
@@ -31,27 +52,27 @@ void ActiveSpeakerDetector::Accumulate(uint32_t id, bool vad, uint8_t db, uint64
 		WORD level = 64 + (127-db)/2;
 
 		//Get time diff from last score, we consider 1s as max to coincide with initial bump
-		uint64_t diff = std::min(now-it->second.ts,(uint64_t)1000ul);
-		//UltraDebug("-ActiveSpeakerDetector::Accumulate [id:%u,vad:%d,speaking:%d,diff:%u,level:%u,score:%lu]\n",id,vad,speaking,diff,level,speakers[id].score);
+		uint64_t diff = std::min(now-it->ts,(uint64_t)1000ul);
+		//UltraDebug("-ActiveSpeakerDetector::Accumulate [id:%u,vad:%d,speaking:%d,diff:%u,level:%u,score:%lu]\n",id,vad,speaking,diff,level,it->score);
 		//Do not accumulate too much so we can switch faster
-		it->second.score = std::min(it->second.score+diff*level/ScorePerMiliScond,maxAcummulatedScore);
+		it->score = std::min(it->score+diff*level/ScorePerMiliScond,maxAcummulatedScore);
 		//Set last update time
-		it->second.ts = now;
+		it->ts = now;
 	}
 	
-	//UltraDebug("-ActiveSpeakerDetector::Accumulat e [id:%u,vad:%d,dbs:%u,score:%lu]\n",id,vad,db,speakers[id].score);
-	
-	//Process vads and check new 
-	Process(now);
+	//UltraDebug("-ActiveSpeakerDetector::Accumulate [id:%u,vad:%d,dbs:%u,score:%lu]\n",id,vad,db,it->score);
 	
+	//Score only increases, so move it up until the table is sorted again
+	for (;it!=speakers.begin() && std::prev(it)->score<it->score;--it)
+		std::iter_swap(it,std::prev(it));
 }
 
 void ActiveSpeakerDetector::Release(uint32_t id)
 {
 	Debug("-ActiveSpeakerDetector::Release() [id:%id]\n",id);
 		
-	//Remove speaker
-	speakers.erase(id);
+	//Remove speaker, keeping the order of the rest
+	speakers.erase(std::remove_if(speakers.begin(),speakers.end(),[id](const SpeakerInfo& speaker) { return speaker.id==id; }),speakers.end());
 	//If it was last active
 	if (lastActive==id)
 	{
@@ -80,28 +101,27 @@ void ActiveSpeakerDetector::Process(uint64_t now)
 	//Reduce accumulated voice activity
 	uint64_t decay = diff*ScorePerMiliScond;
 	
-	//For each 
-	for (auto& entry : speakers)
+	//For each, same decay for all keeps the table sorted
+	for (auto& speaker : speakers)
 	{
-		//UltraDebug(">ActiveSpeakerDetector::Process() | part [id:%u,score:%llu,decay:%llu]\n",entry.first,entry.second.score,decay);
+		//UltraDebug(">ActiveSpeakerDetector::Process() | part [id:%u,score:%llu,decay:%llu]\n",speaker.id,speaker.score,decay);
 		
 		//Decay
-		if (entry.second.score>decay)
+		if (speaker.score>decay)
 			//Decrease score
-			entry.second.score -= decay;
+			speaker.score -= decay;
 		else
 			//None
-			entry.second.score = 0;
-		
-		//UltraDebug("<ActiveSpeakerDetector::Process() | part [id:%u,score:%llu,decay:%llu]\n",entry.first,entry.second.score,decay);
+			speaker.score = 0;
 		
-		//Check if it is active speaker
-		if (maxScore<entry.second.score)
-		{
-			//New active
-			active = entry.first;
-			maxScore = entry.second.score;
-		}
+		//UltraDebug("<ActiveSpeakerDetector::Process() | part [id:%u,score:%llu,decay:%llu]\n",speaker.id,speaker.score,decay);
+	}
+	
+	//Active speaker is the first one
+	if (!speakers.empty() && speakers.front().score)
+	{
+		active = speakers.front().id;
+		maxScore = speakers.front().score;
 	}
 	//onActiveSpeakerChanded("-ActiveSpeakerDetector::Process() |  current [maxSocre:%llu,activation:%llu,active:%u,lastActive:%u,now:%llu,blockedUntil:%llu]\n",maxScore,minActivationScore,active,lastActive,now,blockedUntil);
 	//IF active has changed and we are out of the block period
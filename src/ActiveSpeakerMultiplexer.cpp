@@ -144,68 +144,88 @@ void ActiveSpeakerMultiplexer::RemoveIncomingSourceGroup(RTPIncomingMediaStream:
 	});
 }
 
-void ActiveSpeakerMultiplexer::onRTP(const RTPIncomingMediaStream* stream, const std::vector<RTPPacket::shared>& packets)
+bool ActiveSpeakerMultiplexer::IsSpeaking(const RTPPacket::shared& packet) const
 {
-	//For each packet
+	//Level is parsed from the header extension, no need to decode audio
+	if (!packet || !packet->HasAudioLevel())
+		return false;
+
+	//Get vad level
+	auto vad = packet->GetVAD();
+	auto db	 = packet->GetLevel();
+
+	//Check voice is detected and not muted
+	return vad && db != 127 && (!noiseGatingThreshold || db < noiseGatingThreshold);
+}
+
+void ActiveSpeakerMultiplexer::onRTP(const RTPIncomingMediaStream* incoming, const std::vector<RTPPacket::shared>& packets)
+{
+	std::vector<RTPPacket::shared> speaking;
+
+	//Only packets with voice are accumulated, so silent streams never reach the loop
 	for (const auto& packet : packets)
-		//handle rtp packet
-		onRTP(stream, packet);
+		if (IsSpeaking(packet))
+			speaking.push_back(packet);
+
+	if (speaking.empty())
+		//Exit
+		return;
+
+	AsyncSafe([=, packets = std::move(speaking)](auto now) {
+		//Accumulate all of them
+		Accumulate(incoming, packets, now.count());
+	});
 }
+
 void ActiveSpeakerMultiplexer::onRTP(const RTPIncomingMediaStream* incoming, const RTPPacket::shared& packet)
 {
 	//Log
 	//Debug("-ActiveSpeakerMultiplexer::onRTP() [ssrc:%d,seqnum:%u]\n", packet->GetSSRC(), packet->GetSeqNum());
 
-	if (!packet)
+	//Accumulate only if audio has been detected 
+	if (!IsSpeaking(packet))
 		//Exit
 		return;
 
 	AsyncSafe([=, packet = packet](auto now) {
-		//Double check we have audio level
-		if (!packet->HasAudioLevel())
-			return;
-
-		//Get vad level
-		auto vad = packet->GetVAD();
-		auto db	 = packet->GetLevel();
+		//Accumulate it
+		Accumulate(incoming, { packet }, now.count());
+	});
+}
 
-		//Check voice is detected and not muted
-		auto speaking = vad && db != 127 && (!noiseGatingThreshold || db < noiseGatingThreshold);
+void ActiveSpeakerMultiplexer::Accumulate(const RTPIncomingMediaStream* incoming, const std::vector<RTPPacket::shared>& packets, uint64_t now)
+{
+	// Note: Checks for existence of "incoming" pointer are important to ensure it is still valid on exec!
+	//Get incoming source
+	auto it = sources.find(incoming);
+	//check it was present
+	if (it == sources.end())
+		//Do nothing
+		return;
 
-		//Debug("-ActiveSpeakerMultiplexer::onRTP() [vad:%d,db:%d,speaking:%d]\n", vad,db,speaking);
+	//For each packet
+	for (const auto& packet : packets)
+	{
+		// The audio level is expressed in -dBov, with values from 0 to 127
+		// representing 0 to -127 dBov. dBov is the level, in decibels, relative
+		// to the overload point of the system.
+		// The audio level for digital silence, for example for a muted audio
+		// source, MUST be represented as 127 (-127 dBov).
+		WORD level = 64 + (127 - packet->GetLevel()) / 2;
+
+		//Get time diff from last score, we consider 1s as max to coincide with initial bump
+		uint64_t diff = std::min(now - it->second.ts, (uint64_t)1000ul);
+	
+		//Do not accumulate too much so we can switch faster
+		it->second.score = std::min(it->second.score + diff * level / ScorePerMiliScond, maxAcummulatedScore);
+		//Set last update time
+		it->second.ts = now;
+		//Add packets for forwarding in case it is selected for multiplex
+		it->second.packets.push_back(packet);
 
-		//Accumulate only if audio has been detected 
-		if (speaking)
-		{
-			// Note: Checks for existence of "incoming" pointer are important to ensure it is still valid on exec!
-			//Get incoming source
-			auto it = sources.find(incoming);
-			//check it was present
-			if (it == sources.end())
-				//Do nothing
-				return;
-
-			// The audio level is expressed in -dBov, with values from 0 to 127
-			// representing 0 to -127 dBov. dBov is the level, in decibels, relative
-			// to the overload point of the system.
-			// The audio level for digital silence, for example for a muted audio
-			// source, MUST be represented as 127 (-127 dBov).
-			WORD level = 64 + (127 - db) / 2;
-
-			//Get time diff from last score, we consider 1s as max to coincide with initial bump
-			uint64_t diff = std::min(now.count() - it->second.ts, (uint64_t)1000ul);
-		
-			//Do not accumulate too much so we can switch faster
-			it->second.score = std::min(it->second.score + diff * level / ScorePerMiliScond, maxAcummulatedScore);
-			//Set last update time
-			it->second.ts = now.count();
-			//Add packets for forwarding in case it is selected for multiplex
-			it->second.packets.push_back(packet);
-
-			//Log
-			//Debug("-ActiveSpeakerMultiplexer::onRTP() Accumulate [id:%u,vad:%d,dbs:%u,score:%lu]\n",it->second.id,vad,db,it->second.score);
-		}
-	});
+		//Log
+		//Debug("-ActiveSpeakerMultiplexer::onRTP() Accumulate [id:%u,vad:%d,dbs:%u,score:%lu]\n",it->second.id,packet->GetVAD(),packet->GetLevel(),it->second.score);
+	}
 }
 
 void ActiveSpeakerMultiplexer::onBye(const RTPIncomingMediaStream* group)
@@ -298,8 +318,10 @@ void ActiveSpeakerMultiplexer::Process(uint64_t now)
 	//	if (source)
 	//		Debug("-ActiveSpeakerMultiplexer::Process() | candidates [id:%d,score:%d]\n", source->id, source->score);
 
-	//Get top candidates by score
-	std::partial_sort_copy(candidates.begin(), candidates.end(), top.begin(), top.end());
+	//Get top candidates by descending score
+	std::partial_sort_copy(candidates.begin(), candidates.end(), top.begin(), top.end(), [](const Source* a, const Source* b) {
+		return a->score > b->score;
+	});
 	
 	//for (auto source : top)
 	//	if (source)
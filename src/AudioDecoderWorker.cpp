@@ -2,6 +2,7 @@
 #include "media.h"
 #include "aac/AACDecoder.h"
 #include "AudioCodecFactory.h"
+#include "tools.h"
 
 AudioDecoderWorker::~AudioDecoderWorker()
 {
@@ -22,22 +23,12 @@ int AudioDecoderWorker::Start()
 	//Start decoding
 	decoding = 1;
 
-	//launc thread
-	createPriorityThread(&thread,startDecoding,this,0);
+	//Decode frames on the shared executor, ordered by their playout deadline
+	ScopedLock scope(mutex);
+	strand = Executor::GetDefault().CreateStrand(true);
 
 	return 1;
 }
-void * AudioDecoderWorker::startDecoding(void *par)
-{
-	//Get worker
-	AudioDecoderWorker *worker = (AudioDecoderWorker *)par;
-	//Block all signals
-	blocksignals();
-	//Run
-	worker->Decode();
-	//Exit
-	return NULL;;
-}
 
 int  AudioDecoderWorker::Stop()
 {
@@ -49,11 +40,27 @@ int  AudioDecoderWorker::Stop()
 	//Stop
 	decoding=0;
 
-	//Cancel any pending wait
-	frames.Cancel();
+	Executor::Strand::shared stopped;
+	{
+		ScopedLock scope(mutex);
+		//No more frames will be posted
+		stopped = std::move(strand);
+	}
+
+	//Drop pending frames and wait for current one, without holding the lock as decoding needs it
+	stopped->Close();
 
-	//Esperamos
-	pthread_join(thread,NULL);
+	//SYNC
+	{
+		//Stop playing
+		ScopedLock scope(mutex);
+		//Check codec
+		if (audioDecoder)
+			//For each output
+			for (auto output : outputs)
+				//Stop it
+				output->StopPlaying();
+	}
 
 	Log("<AudioDecoderWorker::Stop()\n");
 
@@ -122,111 +129,72 @@ void AudioDecoderWorker::SetAACConfig(const uint8_t* data,const size_t size)
 }
 
 
-int AudioDecoderWorker::Decode()
+void AudioDecoderWorker::Decode(const std::shared_ptr<AudioFrame>& frame)
 {
-	Log(">AudioDecoderWorker::Decode()\n");
+	//Lock
+	ScopedLock scope(mutex);
 
-	//Mientras tengamos que capturar
-	while(decoding)
+	//If we don't have codec
+	if (!audioDecoder || (frame->GetCodec()!=audioDecoder->type))
 	{
-		//Obtenemos el paquete
-		if (!frames.Wait(0))
-			//Done
-			break;
-
-		//Get packet in queue
-		auto frame = frames.Pop();
-
-		//Check
-		if (!frame)
-			//Check condition again
-			continue;
-		//SYNC
-		{
-			//Lock
-			ScopedLock scope(mutex);
+		//If got a previous codec
+		if (audioDecoder)
+			//For each output
+			for (auto output : outputs)
+				//Stop it
+				output->StopPlaying();
 
-			//If we don't have codec
-			if (!audioDecoder || (frame->GetCodec()!=audioDecoder->type))
-			{
-				//If got a previous codec
-				if (audioDecoder)
-					//For each output
-					for (auto output : outputs)
-						//Stop it
-						output->StopPlaying();
-
-				//Create new codec from pacekt
-				audioDecoder.reset(AudioCodecFactory::CreateDecoder((AudioCodec::Type)frame->GetCodec()));
-
-				//Check we found one
-				if (!audioDecoder)
-					//Skip
-					continue;
-
-				//Update rate
-				rate = audioDecoder->GetRate();
-				numChannels = audioDecoder->GetNumChannels();
-
-				//Ensure that we have rate and samples
-				if (!rate || !numChannels)
-					//skip
-					continue;
-
-				//For each output
-				for (auto output : outputs)
-					//Start playing again
-					output->StartPlaying(rate, numChannels);
-			}
+		//Create new codec from pacekt
+		audioDecoder.reset(AudioCodecFactory::CreateDecoder((AudioCodec::Type)frame->GetCodec()));
 
-			if(!audioDecoder->Decode(frame))
-				continue;
-			while (auto audioBuffer = audioDecoder->GetDecodedAudioFrame())
-			{
-				//Check if we have a different channel count
-				if (numChannels != audioDecoder->GetNumChannels())
-				{
-					//Update rate
-					rate = audioDecoder->GetRate();
-					numChannels = audioDecoder->GetNumChannels();
-
-					//For each output
-					for (auto output : outputs)
-					{
-						//Stop it
-						output->StopPlaying();
-						//Start playing again
-						output->StartPlaying(rate, numChannels);
-					}
-				}
-
-				audioBuffer->SetTimestamp(frame->GetTimestamp());
-				audioBuffer->SetClockRate(frame->GetClockRate());
-				//For each output
-				for (auto output : outputs)
-					//Send buffer
-					output->PlayBuffer(audioBuffer);
-			}	
-		}
+		//Check we found one
+		if (!audioDecoder)
+			//Skip
+			return;
+
+		//Update rate
+		rate = audioDecoder->GetRate();
+		numChannels = audioDecoder->GetNumChannels();
+
+		//Ensure that we have rate and samples
+		if (!rate || !numChannels)
+			//skip
+			return;
+
+		//For each output
+		for (auto output : outputs)
+			//Start playing again
+			output->StartPlaying(rate, numChannels);
 	}
 
-	//SYNC
+	if(!audioDecoder->Decode(frame))
+		return;
+	while (auto audioBuffer = audioDecoder->GetDecodedAudioFrame())
 	{
-		//Stop playing
-		ScopedLock scope(mutex);
-		//Check codec
-		if (audioDecoder)
+		//Check if we have a different channel count
+		if (numChannels != audioDecoder->GetNumChannels())
+		{
+			//Update rate
+			rate = audioDecoder->GetRate();
+			numChannels = audioDecoder->GetNumChannels();
+
 			//For each output
 			for (auto output : outputs)
+			{
 				//Stop it
 				output->StopPlaying();
-	}
-
-
-	Log("<AudioDecoderWorker::Decode()\n");
+				//Start playing again
+				output->StartPlaying(rate, numChannels);
+			}
+		}
 
-	//Exit
-	return 0;
+		audioBuffer->SetTimestamp(frame->GetTimestamp());
+		audioBuffer->SetClockRate(frame->GetClockRate());
+		//For each output
+		for (auto output : outputs)
+			//Send buffer
+			output->PlayBuffer(audioBuffer);
+	}
 }
 
 void AudioDecoderWorker::onMediaFrame(const MediaFrame& frame)
@@ -238,6 +206,17 @@ void AudioDecoderWorker::onMediaFrame(const MediaFrame& frame)
 		return;
 	}
 
-	//Put it on the queue
-	frames.Add(std::shared_ptr<AudioFrame>(static_cast<AudioFrame*>(frame.Clone())));
+	//Clone frame
+	std::shared_ptr<AudioFrame> audioFrame(static_cast<AudioFrame*>(frame.Clone()));
+
+	//Get frame duration in ms, assume 20ms if unknown
+	QWORD duration = frame.GetDuration() && frame.GetClockRate() ? (QWORD)frame.GetDuration()*1000/frame.GetClockRate() : 20;
+
+	ScopedLock scope(mutex);
+	//Check we are decoding
+	if (!strand)
+		//Ignore
+		return;
+	//It must be decoded before the next one is due
+	strand->Post(getTimeMS() + duration, [this,audioFrame]() { Decode(audioFrame); });
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "AudioLevelDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LEVEL_X86 1
+#endif
+
+namespace
+{
+
+using EnergyFunc = QWORD (*)(const int16_t* samples, DWORD numSamples);
+
+QWORD EnergyScalar(const int16_t* samples, DWORD numSamples)
+{
+	QWORD energy = 0;
+	for (DWORD i = 0; i < numSamples; ++i)
+		energy += (int32_t)samples[i] * samples[i];
+	return energy;
+}
+
+#ifdef LEVEL_X86
+
+__attribute__((target("sse2")))
+QWORD EnergySSE2(const int16_t* samples, DWORD numSamples)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = _mm_setzero_si128();
+	DWORD i = 0;
+	for (; i + 8 <= numSamples; i += 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(samples + i));
+		//Sum of pairs of squares, up to 2^31 so they are widened as unsigned
+		__m128i sq = _mm_madd_epi16(x, x);
+		acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+		acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+	}
+	alignas(16) QWORD sum[2];
+	_mm_store_si128((__m128i*)sum, acc);
+	return sum[0] + sum[1] + EnergyScalar(samples + i, numSamples - i);
+}
+
+__attribute__((target("avx2")))
+QWORD EnergyAVX2(const int16_t* samples, DWORD numSamples)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc0 = _mm256_setzero_si256();
+	__m256i acc1 = _mm256_setzero_si256();
+	DWORD i = 0;
+	for (; i + 16 <= numSamples; i += 16)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i*)(samples + i));
+		//Sum of pairs of squares, up to 2^31 so they are widened as unsigned
+		__m256i sq = _mm256_madd_epi16(x, x);
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(sq, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(sq, zero));
+	}
+	__m256i acc = _mm256_add_epi64(acc0, acc1);
+	alignas(32) QWORD sum[4];
+	_mm256_store_si256((__m256i*)sum, acc);
+	return (sum[0] + sum[1]) + (sum[2] + sum[3]) + EnergyScalar(samples + i, numSamples - i);
+}
+
+#endif
+
+struct Kernels
+{
+	EnergyFunc energy = EnergyScalar;
+	bool avx2 = false;
+	bool sse2 = false;
+
+	Kernels()
+	{
+#ifdef LEVEL_X86
+		__builtin_cpu_init();
+		avx2 = __builtin_cpu_supports("avx2");
+		sse2 = __builtin_cpu_supports("sse2");
+		if (avx2)
+			energy = EnergyAVX2;
+		else if (sse2)
+			energy = EnergySSE2;
+#endif
+	}
+};
+
+const Kernels& GetKernels()
+{
+	static const Kernels kernels;
+	return kernels;
+}
+
+}
+
+bool AudioLevelDetector::IsAVX2Accelerated()
+{
+	return GetKernels().avx2;
+}
+
+bool AudioLevelDetector::IsSSE2Accelerated()
+{
+	return GetKernels().sse2;
+}
+
+QWORD AudioLevelDetector::CalcEnergy(const int16_t* samples, DWORD numSamples)
+{
+	return GetKernels().energy(samples, numSamples);
+}
+
+BYTE AudioLevelDetector::CalcLevel(const int16_t* samples, DWORD numSamples)
+{
+	return CalcLevel(CalcEnergy(samples, numSamples), numSamples);
+}
+
+BYTE AudioLevelDetector::CalcLevel(QWORD energy, DWORD numSamples)
+{
+	//Digital silence
+	if (!energy || !numSamples)
+		return 127;
+
+	//Mean power relative to the overload point
+	double dbov = 10 * std::log10((double)energy / numSamples / (32768.0 * 32768.0));
+
+	//Expressed as -dBov, from 0 to 127
+	return (BYTE)std::clamp(std::lround(-dbov), 0l, 127l);
+}
+
+void AudioLevelDetector::Process(std::vector<Block>& blocks)
+{
+	//Get kernel once for all the blocks
+	const auto energy = GetKernels().energy;
+
+	//Calculate levels of all blocks
+	for (auto& block : blocks)
+		block.level = CalcLevel(energy(block.samples, block.numSamples), block.numSamples);
+
+	//For each block
+	for (auto& block : blocks)
+	{
+		//Silent blocks skip the vad
+		if (block.level >= silenceThreshold)
+		{
+			block.vad = false;
+			continue;
+		}
+
+		//Get vad for the participant
+		VAD* vad = GetVAD(block.id);
+
+		//If not supported, level is the only thing we have
+		if (!vad->IsRateSupported(block.rate))
+		{
+			block.vad = true;
+			continue;
+		}
+
+		//Feed it, samples are copied into the vad fifo until there are 20ms
+		vad->CalcVad(const_cast<int16_t*>(block.samples), block.numSamples, block.rate);
+		//Use last decision, so blocks shorter than 20ms keep it
+		block.vad = vad->GetVAD() > 0;
+	}
+}
+
+VAD* AudioLevelDetector::GetVAD(uint32_t id)
+{
+	//Find participant
+	auto it = std::lower_bound(participants.begin(), participants.end(), id, [](const Participant& participant, uint32_t id) {
+		return participant.id < id;
+	});
+
+	//If not found
+	if (it == participants.end() || it->id != id)
+		//Create it
+		it = participants.insert(it, Participant{ id, std::make_unique<VAD>() });
+
+	return it->vad.get();
+}
+
+void AudioLevelDetector::Release(uint32_t id)
+{
+	//Find participant
+	auto it = std::lower_bound(participants.begin(), participants.end(), id, [](const Participant& participant, uint32_t id) {
+		return participant.id < id;
+	});
+
+	//Remove it
+	if (it != participants.end() && it->id == id)
+		participants.erase(it);
+}
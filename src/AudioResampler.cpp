@@ -0,0 +1,389 @@
+#include "AudioResampler.h"
+#include "log.h"
+#include "use.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <tuple>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RESAMPLER_X86 1
+#endif
+
+struct AudioResampler::FilterBank
+{
+	DWORD taps = 0;
+	//Coefficients of each phase, reversed so they are applied to the input window in order
+	std::vector<float> coeffs;
+};
+
+namespace
+{
+
+using DotFunc = float (*)(const float* coeffs, const float* in, DWORD taps);
+using Dot2Func = void (*)(const float* coeffs, const float* left, const float* right, DWORD taps, float& l, float& r);
+
+//Taps are always a multiple of this, so kernels don't need a tail loop
+constexpr DWORD TapsAlign = 16;
+
+float DotScalar(const float* coeffs, const float* in, DWORD taps)
+{
+	float acc[4] = {};
+	for (DWORD i = 0; i < taps; i += 4)
+		for (DWORD j = 0; j < 4; ++j)
+			acc[j] += coeffs[i + j] * in[i + j];
+	return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+void Dot2Scalar(const float* coeffs, const float* left, const float* right, DWORD taps, float& l, float& r)
+{
+	l = DotScalar(coeffs, left, taps);
+	r = DotScalar(coeffs, right, taps);
+}
+
+#ifdef RESAMPLER_X86
+
+__attribute__((target("sse2")))
+inline float HorizontalSum(__m128 x)
+{
+	x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+
+__attribute__((target("sse2")))
+float DotSSE2(const float* coeffs, const float* in, DWORD taps)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	for (DWORD i = 0; i < taps; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(coeffs + i), _mm_loadu_ps(in + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(coeffs + i + 4), _mm_loadu_ps(in + i + 4)));
+	}
+	return HorizontalSum(_mm_add_ps(acc0, acc1));
+}
+
+__attribute__((target("sse2")))
+void Dot2SSE2(const float* coeffs, const float* left, const float* right, DWORD taps, float& l, float& r)
+{
+	__m128 accl = _mm_setzero_ps();
+	__m128 accr = _mm_setzero_ps();
+	for (DWORD i = 0; i < taps; i += 4)
+	{
+		//Load coefficients once for both channels
+		__m128 c = _mm_loadu_ps(coeffs + i);
+		accl = _mm_add_ps(accl, _mm_mul_ps(c, _mm_loadu_ps(left + i)));
+		accr = _mm_add_ps(accr, _mm_mul_ps(c, _mm_loadu_ps(right + i)));
+	}
+	l = HorizontalSum(accl);
+	r = HorizontalSum(accr);
+}
+
+__attribute__((target("avx2,fma")))
+inline float HorizontalSum(__m256 x)
+{
+	__m128 s = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+	s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+	return _mm_cvtss_f32(s);
+}
+
+__attribute__((target("avx2,fma")))
+float DotAVX2(const float* coeffs, const float* in, DWORD taps)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	for (DWORD i = 0; i < taps; i += 16)
+	{
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(coeffs + i), _mm256_loadu_ps(in + i), acc0);
+		acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(coeffs + i + 8), _mm256_loadu_ps(in + i + 8), acc1);
+	}
+	return HorizontalSum(_mm256_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx2,fma")))
+void Dot2AVX2(const float* coeffs, const float* left, const float* right, DWORD taps, float& l, float& r)
+{
+	__m256 accl = _mm256_setzero_ps();
+	__m256 accr = _mm256_setzero_ps();
+	for (DWORD i = 0; i < taps; i += 8)
+	{
+		//Load coefficients once for both channels
+		__m256 c = _mm256_loadu_ps(coeffs + i);
+		accl = _mm256_fmadd_ps(c, _mm256_loadu_ps(left + i), accl);
+		accr = _mm256_fmadd_ps(c, _mm256_loadu_ps(right + i), accr);
+	}
+	l = HorizontalSum(accl);
+	r = HorizontalSum(accr);
+}
+
+#endif
+
+struct Kernels
+{
+	DotFunc dot = DotScalar;
+	Dot2Func dot2 = Dot2Scalar;
+	bool avx2 = false;
+	bool sse2 = false;
+
+	Kernels()
+	{
+#ifdef RESAMPLER_X86
+		__builtin_cpu_init();
+		avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		sse2 = __builtin_cpu_supports("sse2");
+		if (avx2)
+		{
+			dot = DotAVX2;
+			dot2 = Dot2AVX2;
+		} else if (sse2) {
+			dot = DotSSE2;
+			dot2 = Dot2SSE2;
+		}
+#endif
+	}
+};
+
+const Kernels& GetKernels()
+{
+	static const Kernels kernels;
+	return kernels;
+}
+
+//Zeroth order modified Bessel function of the first kind, for the Kaiser window
+double BesselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (DWORD k = 1; k < 50 && term > sum * 1e-12; ++k)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+inline int16_t Saturate(float sample)
+{
+	return (int16_t)std::clamp<long>(std::lrint(sample), -32768, 32767);
+}
+
+DWORD GetBaseTaps(AudioResampler::Quality quality)
+{
+	switch (quality)
+	{
+		case AudioResampler::Quality::Low:
+			return 16;
+		case AudioResampler::Quality::High:
+			return 64;
+		default:
+			return 32;
+	}
+}
+
+}
+
+bool AudioResampler::IsSupported(DWORD inputRate, DWORD outputRate, DWORD numChannels)
+{
+	//Check input
+	if (!inputRate || !outputRate || inputRate==outputRate || !numChannels || numChannels>MaxChannels)
+		return false;
+
+	//Get reduced ratio
+	DWORD gcd = std::gcd(inputRate, outputRate);
+
+	//Check we don't need too many phases
+	return outputRate / gcd <= MaxPhases && inputRate / gcd <= MaxPhases;
+}
+
+bool AudioResampler::IsAVX2Accelerated()
+{
+	return GetKernels().avx2;
+}
+
+bool AudioResampler::IsSSE2Accelerated()
+{
+	return GetKernels().sse2;
+}
+
+std::shared_ptr<const AudioResampler::FilterBank> AudioResampler::GetFilterBank(DWORD interpolation, DWORD decimation, DWORD taps)
+{
+	static Mutex mutex;
+	static std::map<std::tuple<DWORD,DWORD,DWORD>, std::weak_ptr<const FilterBank>> banks;
+
+	ScopedLock scope(mutex);
+
+	//Check if it is already computed
+	auto key = std::make_tuple(interpolation, decimation, taps);
+	if (auto bank = banks[key].lock())
+		return bank;
+
+	auto bank = std::make_shared<FilterBank>();
+	bank->taps = taps;
+	bank->coeffs.resize(interpolation * taps);
+
+	//Prototype filter runs at the interpolated rate, cut before nyquist of the slowest rate
+	DWORD length = interpolation * taps;
+	double center = (length - 1) / 2.0;
+	//Wider filters have a narrower transition band, so they can cut closer to nyquist
+	double rolloff = taps >= 64 ? 0.95 : taps >= 32 ? 0.91 : 0.85;
+	double beta = taps >= 64 ? 9.0 : taps >= 32 ? 7.0 : 5.0;
+	double cutoff = rolloff * 0.5 / std::max(interpolation, decimation);
+	double norm = BesselI0(beta);
+
+	for (DWORD phase = 0; phase < interpolation; ++phase)
+	{
+		float* coeffs = bank->coeffs.data() + phase * taps;
+		double sum = 0;
+		for (DWORD k = 0; k < taps; ++k)
+		{
+			double x = phase + k * interpolation - center;
+			double sinc = x != 0 ? std::sin(2 * M_PI * cutoff * x) / (M_PI * x) : 2 * cutoff;
+			double w = 2.0 * x / (length - 1);
+			double window = BesselI0(beta * std::sqrt(std::max(0.0, 1.0 - w * w))) / norm;
+			//Reverse so it is applied to input from oldest to newest
+			coeffs[taps - 1 - k] = sinc * window;
+			sum += sinc * window;
+		}
+		//Unity gain on each phase so there is no ripple at dc
+		for (DWORD k = 0; k < taps; ++k)
+			coeffs[k] /= sum;
+	}
+
+	//Store it
+	banks[key] = bank;
+
+	return bank;
+}
+
+bool AudioResampler::Open(DWORD inputRate, DWORD outputRate, DWORD numChannels, Quality quality)
+{
+	//Close previous one
+	Close();
+
+	//Check
+	if (!IsSupported(inputRate, outputRate, numChannels))
+		return Error("-AudioResampler::Open() | Unsupported resampling [in:%u,out:%u,channels:%u]\n", inputRate, outputRate, numChannels);
+
+	//Get reduced ratio
+	DWORD gcd = std::gcd(inputRate, outputRate);
+	interpolation = outputRate / gcd;
+	decimation = inputRate / gcd;
+
+	//When downsampling the filter must be wider to keep the same number of zero crossings
+	DWORD taps = GetBaseTaps(quality);
+	if (decimation > interpolation)
+		taps = taps * decimation / interpolation;
+	//Round up so kernels don't need tail loops
+	taps = (taps + TapsAlign - 1) / TapsAlign * TapsAlign;
+
+	//Get bank
+	bank = GetFilterBank(interpolation, decimation, taps);
+	this->numChannels = numChannels;
+
+	Debug("-AudioResampler::Open() [in:%u,out:%u,channels:%u,phases:%u,taps:%u,avx2:%d]\n", inputRate, outputRate, numChannels, interpolation, taps, IsAVX2Accelerated());
+
+	//Init history
+	Reset();
+
+	return true;
+}
+
+void AudioResampler::Reset()
+{
+	//Check
+	if (!bank)
+		return;
+
+	//Prefill the filter so there is an output sample for each input one from the start, delayed by the latency
+	for (DWORD ch = 0; ch < numChannels; ++ch)
+		history[ch].assign(bank->taps - 1, 0.0f);
+
+	pos = 0;
+	phase = 0;
+}
+
+void AudioResampler::Close()
+{
+	bank.reset();
+	for (auto& channel : history)
+		channel.clear();
+	interpolation = 0;
+	decimation = 0;
+	numChannels = 0;
+	pos = 0;
+	phase = 0;
+}
+
+DWORD AudioResampler::GetMaxOutputSamples(DWORD inputSamples) const
+{
+	//Check
+	if (!bank)
+		return 0;
+
+	//Pending fraction of the previous input could produce one more
+	return ((QWORD)(inputSamples + 1) * interpolation + decimation - 1) / decimation + 1;
+}
+
+DWORD AudioResampler::GetLatency() const
+{
+	return bank ? bank->taps / 2 : 0;
+}
+
+DWORD AudioResampler::Process(const int16_t* in, DWORD inputSamples, int16_t* out, DWORD maxOutputSamples)
+{
+	//Check
+	if (!bank)
+		return 0;
+
+	const Kernels& kernels = GetKernels();
+	const DWORD taps = bank->taps;
+	const float* coeffs = bank->coeffs.data();
+
+	//Deinterleave input into the history of each channel
+	for (DWORD ch = 0; ch < numChannels; ++ch)
+	{
+		auto& channel = history[ch];
+		size_t size = channel.size();
+		channel.resize(size + inputSamples);
+		float* dst = channel.data() + size;
+		for (DWORD i = 0; i < inputSamples; ++i)
+			dst[i] = in[i * numChannels + ch];
+	}
+
+	DWORD num = 0;
+	DWORD size = history[0].size();
+
+	//While we have a full window of input
+	while (pos + taps <= size && num < maxOutputSamples)
+	{
+		const float* bankPhase = coeffs + phase * taps;
+
+		if (numChannels == 1)
+		{
+			out[num] = Saturate(kernels.dot(bankPhase, history[0].data() + pos, taps));
+		} else {
+			float l, r;
+			kernels.dot2(bankPhase, history[0].data() + pos, history[1].data() + pos, taps, l, r);
+			out[num * 2] = Saturate(l);
+			out[num * 2 + 1] = Saturate(r);
+		}
+		num++;
+
+		//Advance to next output
+		phase += decimation;
+		pos += phase / interpolation;
+		phase %= interpolation;
+	}
+
+	//Remove consumed input
+	DWORD consumed = std::min(pos, size);
+	for (DWORD ch = 0; ch < numChannels; ++ch)
+		history[ch].erase(history[ch].begin(), history[ch].begin() + consumed);
+	pos -= consumed;
+
+	return num;
+}
@@ -0,0 +1,246 @@
+#include "AudioTranscoder.h"
+#include "log.h"
+#include "AudioCodecFactory.h"
+#include "aac/AACDecoder.h"
+#include "opus/OpusEncoder.h"
+
+AudioTranscoder::AudioTranscoder(AudioCodec::Type codec, const Properties& properties) :
+	codec(codec),
+	properties(properties)
+{
+	Log("-AudioTranscoder::AudioTranscoder() [codec:%s]\n", AudioCodec::GetNameFor(codec));
+}
+
+void AudioTranscoder::AddMediaListener(const MediaFrame::Listener::shared& listener)
+{
+	Debug("-AudioTranscoder::AddMediaListener() [this:%p,listener:%p]\n", this, listener.get());
+
+	ScopedLock scope(mutex);
+	//Add listener to set
+	listeners.insert(listener);
+}
+
+void AudioTranscoder::RemoveMediaListener(const MediaFrame::Listener::shared& listener)
+{
+	Debug("-AudioTranscoder::RemoveMediaListener() [this:%p,listener:%p]\n", this, listener.get());
+
+	ScopedLock scope(mutex);
+	//Remove listener
+	listeners.erase(listener);
+}
+
+void AudioTranscoder::SetAACConfig(const uint8_t* data,const size_t size)
+{
+	ScopedLock scope(mutex);
+
+	//If we don't have an AAC decoder
+	if (!audioDecoder || audioDecoder->type!=AudioCodec::AAC)
+	{
+		//Create new AAC decoder
+		audioDecoder.reset(AudioCodecFactory::CreateDecoder(AudioCodec::AAC));
+
+		//Check we found one
+		if (!audioDecoder)
+			//Skip
+			return;
+	}
+
+	//Convert it to AAC decoder
+	auto aac = static_cast<AACDecoder*>(audioDecoder.get());
+	//Set config there
+	aac->SetConfig(data,size);
+}
+
+void AudioTranscoder::onMediaFrame(const MediaFrame& frame)
+{
+	//Ensure it is audio
+	if (frame.GetType()!=MediaFrame::Audio)
+	{
+		Warning("-AudioTranscoder::onMediaFrame() | Got wrong frame type: %s [this:%p]\n", MediaFrame::TypeToString(frame.GetType()), this);
+		return;
+	}
+
+	//Get audio frame
+	const AudioFrame& audioFrame = static_cast<const AudioFrame&>(frame);
+
+	//Frame is decoded before returning, so no need to clone it
+	AudioFrame::const_shared input(AudioFrame::const_shared(), &audioFrame);
+
+	ScopedLock scope(mutex);
+
+	//If we don't have decoder or codec has changed
+	if (!audioDecoder || audioFrame.GetCodec()!=audioDecoder->type)
+	{
+		//Create new decoder
+		audioDecoder.reset(AudioCodecFactory::CreateDecoder(audioFrame.GetCodec()));
+
+		//Check we found one
+		if (!audioDecoder)
+		{
+			Error("-AudioTranscoder::onMediaFrame() | Could not create decoder [codec:%s]\n", AudioCodec::GetNameFor(audioFrame.GetCodec()));
+			return;
+		}
+
+		//Encoder must be set up for the new decoded rate
+		inputRate = 0;
+	}
+
+	//Decode it
+	if (!audioDecoder->Decode(input))
+		//Skip
+		return;
+
+	//Get all decoded buffers
+	while (auto audioBuffer = audioDecoder->GetDecodedAudioFrame())
+	{
+		//If input format has changed
+		if (audioDecoder->GetRate()!=inputRate || audioBuffer->GetNumChannels()!=inputChannels)
+			//Set up encoder and resampler again
+			if (!SetupEncoder(audioDecoder->GetRate(), audioBuffer->GetNumChannels()))
+				//Skip
+				return;
+
+		//Set input timing, needed by the resampler
+		audioBuffer->SetTimestamp(audioFrame.GetTimestamp());
+		audioBuffer->SetClockRate(audioFrame.GetClockRate());
+
+		//Resample and encode it
+		Encode(audioBuffer, audioFrame);
+	}
+}
+
+bool AudioTranscoder::SetupEncoder(DWORD inputRate, DWORD inputChannels)
+{
+	Log("-AudioTranscoder::SetupEncoder() [codec:%s,inputRate:%u,inputChannels:%u]\n", AudioCodec::GetNameFor(codec), inputRate, inputChannels);
+
+	//Not valid until set up
+	this->inputRate = 0;
+
+	//Check input
+	if (!inputRate || !inputChannels)
+		return Error("-AudioTranscoder::SetupEncoder() | Wrong input format\n");
+
+	//If we don't have an encoder yet
+	if (!audioEncoder)
+	{
+		//Create it
+		audioEncoder.reset(AudioCodecFactory::CreateEncoder(codec, properties));
+
+		//Check we found one
+		if (!audioEncoder)
+			return Error("-AudioTranscoder::SetupEncoder() | Could not create encoder [codec:%s]\n", AudioCodec::GetNameFor(codec));
+	}
+
+	//Try to use input rate, encoder keeps previous one if it is not supported
+	DWORD encoderRate = audioEncoder->TrySetRate(inputRate, inputChannels);
+
+	//If not supported, set channels with the encoder rate
+	if (encoderRate && encoderRate!=inputRate)
+		encoderRate = audioEncoder->TrySetRate(encoderRate, inputChannels);
+
+	//Check
+	if (!encoderRate)
+		return Error("-AudioTranscoder::SetupEncoder() | Could not set encoder rate\n");
+
+	//Opus needs to signal the input format
+	if (codec==AudioCodec::OPUS)
+		static_cast<OpusEncoder*>(audioEncoder.get())->SetConfig(encoderRate, inputChannels);
+
+	//Resample only if rates are different
+	transrater.Close();
+	if (encoderRate!=inputRate && !transrater.Open(inputRate, encoderRate, inputChannels))
+		return Error("-AudioTranscoder::SetupEncoder() | Could not open resampler\n");
+
+	//Pending samples are from previous format
+	samples.clear();
+
+	//Encoder input reused for all frames
+	pcm.resize(audioEncoder->numFrameSamples * inputChannels);
+	encoding = std::make_shared<AudioBuffer>(audioEncoder->numFrameSamples, inputChannels);
+
+	//Store format
+	this->inputRate		= inputRate;
+	this->inputChannels	= inputChannels;
+	this->rate		= encoderRate;
+	this->numChannels	= inputChannels;
+
+	//Restart timestamps
+	first = true;
+
+	return true;
+}
+
+void AudioTranscoder::Encode(const AudioBuffer::shared& audioBuffer, const AudioFrame& frame)
+{
+	//If it is the first one
+	if (first)
+	{
+		//Keep input timeline in encoder clock rate
+		timestamp = frame.GetClockRate() ? frame.GetTimestamp() * audioEncoder->GetClockRate() / frame.GetClockRate() : 0;
+		//Not first anymore
+		first = false;
+	}
+
+	//Resample if needed
+	AudioBuffer::shared resampled = transrater.IsOpen() ? transrater.ProcessBuffer(audioBuffer) : audioBuffer;
+
+	//Check
+	if (!resampled)
+		return;
+
+	//Append to pending samples
+	if (!samples.push(resampled->GetData(), resampled->GetNumSamples()))
+	{
+		Warning("-AudioTranscoder::Encode() | Too many pending samples, dropping them\n");
+		//Drop all
+		samples.clear();
+		return;
+	}
+
+	//Number of interleaved samples of each encoded frame
+	int frameSamples = audioEncoder->numFrameSamples * numChannels;
+	//Duration of each frame in encoder clock rate
+	DWORD duration = (QWORD)audioEncoder->numFrameSamples * audioEncoder->GetClockRate() / rate;
+
+	//While we have enough samples
+	while (samples.length()>=frameSamples)
+	{
+		//Get samples of the frame
+		samples.pop(pcm.data(), frameSamples);
+		//Fill encoder input
+		encoding->SetSamples(pcm.data(), frameSamples);
+
+		//Encode it
+		AudioFrame::shared encoded = audioEncoder->Encode(encoding);
+
+		//Timestamp is increased even on errors to keep the timeline
+		QWORD ts = timestamp;
+		timestamp += duration;
+
+		//Check
+		if (!encoded)
+		{
+			Warning("-AudioTranscoder::Encode() | Error encoding audio\n");
+			continue;
+		}
+
+		encoded->SetClockRate(audioEncoder->GetClockRate());
+		//Set frame timestamp
+		encoded->SetTimestamp(ts);
+		encoded->SetSenderTime(ts * 1000 / audioEncoder->GetClockRate());
+		//Set time of the input frame
+		encoded->SetTime(frame.GetTime());
+		//Set frame duration
+		encoded->SetDuration(duration);
+		//Set number of channels
+		encoded->SetNumChannels(numChannels);
+		//Single rtp packet
+		encoded->ClearRTPPacketizationInfo();
+		encoded->AddRtpPacket(0,encoded->GetLength(),NULL,0);
+
+		//For each listener
+		for (auto& listener : listeners)
+			//Deliver it synchronously, encoded frame is reused by the encoder
+			listener->onMediaFrame(*encoded);
+	}
+}
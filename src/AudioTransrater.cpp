@@ -32,6 +32,18 @@ int AudioTransrater::Open(DWORD inputRate, DWORD outputRate, DWORD numChannels)
 		//Exit
 		return Log("-No resampling needed, same sample rate [in:%d,out:%d]\n",inputRate,outputRate);
 
+	//Use polyphase filter bank if the ratio is supported
+	if (AudioResampler::IsSupported(inputRate, outputRate, numChannels))
+	{
+		//Open it
+		if (!polyphase.Open(inputRate, outputRate, numChannels))
+			return Error("-AudioTransrater: failed to init polyphase resampler\n");
+		this->inputRate = inputRate;
+		this->outputRate = outputRate;
+		//OK
+		return 1;
+	}
+
 	//Create resampler
 	resampler = mcu_resampler_init(numChannels, inputRate, outputRate, 10, &err);
 
@@ -52,6 +64,8 @@ int AudioTransrater::Open(DWORD inputRate, DWORD outputRate, DWORD numChannels)
 
 void AudioTransrater::Close()
 {
+	//Close polyphase resampler
+	polyphase.Close();
 	//Check if opened
 	if (resampler)
 	{
@@ -67,7 +81,9 @@ AudioBuffer::shared AudioTransrater::ProcessBuffer(const AudioBuffer::shared& au
 	auto in = audioBuffer->GetData();
 	auto sizeIn = static_cast<uint32_t>(audioBuffer->GetNumSamples()/audioBuffer->GetNumChannels());
 
-	auto bufferSize = static_cast<uint32_t>(std::ceil(static_cast<double>(outputRate) / inputRate * sizeIn));	
+	auto bufferSize = polyphase.IsOpen()
+		? polyphase.GetMaxOutputSamples(sizeIn)
+		: static_cast<uint32_t>(std::ceil(static_cast<double>(outputRate) / inputRate * sizeIn));
 	audioBufferPool.SetSize(bufferSize, audioBuffer->GetNumChannels());
 	auto resampledBuffer = audioBufferPool.Acquire();
 	auto resampleSize = bufferSize;
@@ -75,12 +91,22 @@ AudioBuffer::shared AudioTransrater::ProcessBuffer(const AudioBuffer::shared& au
 	if (!playPTSOffset.has_value())
 		playPTSOffset = audioBuffer->GetTimestamp();
 
-	int err = mcu_resampler_process_interleaved_int(resampler, (spx_int16_t*)in, (spx_uint32_t*)&sizeIn, (spx_int16_t*)out, (spx_uint32_t*)&resampleSize);
-	//Check error
-	if (err)
+	//If using polyphase filter bank
+	if (polyphase.IsOpen())
 	{
-		Error("-AudioTransrater: resampling error. ErrCode = %d.\n", err);
-		return {};
+		//Resample into scratch buffer, as audio buffer data is not writable
+		resampled.resize(bufferSize*audioBuffer->GetNumChannels());
+		resampleSize = polyphase.Process(in, sizeIn, resampled.data(), bufferSize);
+		//Copy resampled samples
+		resampledBuffer->SetSamples(resampled.data(), resampleSize*audioBuffer->GetNumChannels());
+	} else {
+		int err = mcu_resampler_process_interleaved_int(resampler, (spx_int16_t*)in, (spx_uint32_t*)&sizeIn, (spx_int16_t*)out, (spx_uint32_t*)&resampleSize);
+		//Check error
+		if (err)
+		{
+			Error("-AudioTransrater: resampling error. ErrCode = %d.\n", err);
+			return {};
+		}
 	}
 
 	if (resampleSize != bufferSize)
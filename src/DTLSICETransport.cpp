@@ -40,16 +40,17 @@
 #include "EventLoop.h"
 #include "Endpoint.h"
 #include "VideoLayerSelector.h"
+#include "Metrics.h"
 #include <algorithm>
 
 constexpr auto IceTimeout			= 30000ms;
 constexpr auto ProbingInterval			= 5ms;
 constexpr auto MaxRTXOverhead			= 0.70f;
-constexpr auto TransportWideCCMaxPackets	= 100;
-constexpr auto TransportWideCCMaxInterval	= 5E4;	//50ms
 constexpr auto MaxProbingHistorySize		= 50;
 constexpr auto RtxRttThresholdMs 		= 300;
 
+static Metrics::Gauge& ActiveTransports = Metrics::GetInstance().GetGauge("dtls_ice_transports", "DTLS ICE transports alive");
+
 DTLSICETransport::DTLSICETransport(Sender *sender,TimeService& timeService, ObjectPool<Packet>& packetPool) :
 	TimeServiceWrapper<DTLSICETransport>(timeService),
 	sender(sender),
@@ -58,12 +59,13 @@ DTLSICETransport::DTLSICETransport(Sender *sender,TimeService& timeService, Obje
 	dtls(DTLSConnection::Create(*this,timeService,endpoint.GetTransport())),
 	history(MaxProbingHistorySize, false),
 	fecProbeGenerator(history, sendMaps.ext),
-	outgoingBitrate(250, 1E3, 250),
-	rtxBitrate(250, 1E3, 250),
-	probingBitrate(250, 1E3, 250),
+	outgoingBitrate(250, 1E3, 0, 25),
+	rtxBitrate(250, 1E3, 0, 25),
+	probingBitrate(250, 1E3, 0, 25),
 	senderSideBandwidthEstimator(new SendSideBandwidthEstimation())
 {
 	Debug(">DTLSICETransport::DTLSICETransport() [this:%p]\n", this);
+	ActiveTransports.Add(1);
 }
 
 DTLSICETransport::~DTLSICETransport()
@@ -72,6 +74,8 @@ DTLSICETransport::~DTLSICETransport()
 	
 	//Stop
 	Stop();
+
+	ActiveTransports.Sub(1);
 }
 
 void DTLSICETransport::onDTLSPendingData()
@@ -142,11 +146,8 @@ int DTLSICETransport::onData(const ICERemoteCandidate* candidate,const BYTE* dat
 			//Write udp packet
 			dumper->WriteUDP(now/1000,candidate->GetIPAddress(),candidate->GetPort(),0x7F000001,5004,data,len);
 
-		//Parse it
-		auto rtcp = RTCPCompoundPacket::Parse(data,len);
-
-		//Check packet
-		if (!rtcp)
+		//Parse it and process it in place
+		if (!RTCPCompoundPacket::Parse(data,len,*this))
 		{
 			//Debug
 			Debug("-DTLSICETransport::onData() | RTCP wrong data\n");
@@ -156,9 +157,6 @@ int DTLSICETransport::onData(const ICERemoteCandidate* candidate,const BYTE* dat
 			return 1;
 		}
 
-		//Process it
-		this->onRTCP(rtcp);
-
 		//Skip
 		return 1;
 	}
@@ -210,37 +208,29 @@ int DTLSICETransport::onData(const ICERemoteCandidate* candidate,const BYTE* dat
 		// Get current seq mum
 		WORD transportSeqNum = packet->GetTransportSeqNum();
 
-		//Get max seq num so far, it is either last one if queue is empy or last one of the queue
-		DWORD maxFeedbackPacketExtSeqNum = transportWideReceivedPacketsStats.size() ? transportWideReceivedPacketsStats.rbegin()->first : lastFeedbackPacketExtSeqNum;
+		//Get time relative to the start of the transport
+		QWORD time = now - initTime;
 
-		//Check if we have a sequence wrap
-		if (transportSeqNum < 0x00FF && (maxFeedbackPacketExtSeqNum & 0xFFFF)>0xFF00)
+		//If it does not fit on the pending feedback
+		if (!transportWideReceivedPackets.AddPacket(transportSeqNum, time, size))
 		{
-			//Increase cycles
-			feedbackCycles++;
-			//If looping
-			if (feedbackCycles)
-				//Send feedback now
-				SendTransportWideFeedbackMessage(ssrc);
+			//Send pending ones now
+			SendTransportWideFeedbackMessage(ssrc);
+			//Add it again
+			transportWideReceivedPackets.AddPacket(transportSeqNum, time, size);
 		}
 
-		//Get extended value
-		DWORD transportExtSeqNum = feedbackCycles << 16 | transportSeqNum;
-
-		//Add packets to the transport wide stats
-		transportWideReceivedPacketsStats[transportExtSeqNum] = PacketStats::Create(packet, size, now);
-
-		//If we have enought or timeout 
-		if (packet->GetMark() || transportWideReceivedPacketsStats.size() > TransportWideCCMaxPackets || (now - transportWideReceivedPacketsStats.begin()->second.time) > TransportWideCCMaxInterval)
+		//If it is time for the feedback according to incoming bitrate
+		if (transportWideReceivedPackets.IsFeedbackDue(time))
 			//Send feedback message
 			SendTransportWideFeedbackMessage(ssrc);
 		//Schedule for later
-		if (transportWideReceivedPacketsStats.size())
+		if (transportWideReceivedPackets.HasPending())
 		{
 			//If timer is still valid and has not been scheduled already
 			if (sseTimer && !sseTimer->IsScheduled())
 				//Schedule
-				sseTimer->Reschedule(std::chrono::milliseconds((int)(TransportWideCCMaxInterval/1000)), 0ms);
+				sseTimer->Reschedule(std::chrono::milliseconds(transportWideReceivedPackets.GetFeedbackInterval()), 0ms);
 		//If timer is still valid and still scheduled
 		} else if (sseTimer && sseTimer->IsScheduled()) {
 			//Cancel it
@@ -501,23 +491,14 @@ int DTLSICETransport::onData(const ICERemoteCandidate* candidate,const BYTE* dat
 	{
 		//UltraDebug("-DTLSICETransport::onData() | Lost packets [ssrc:%u,ssrc:%u,seq:%d,lost:%d,total:%u]\n",ssrc,packet->GetSSRC(),packet->GetSeqNum(),lost,group->GetCurrentLost());
 
-		//Create rtcp sender retpor
-		auto rtcp = RTCPCompoundPacket::Create();
-
-		//Create NACK
-		auto nack = rtcp->CreatePacket<RTCPRTPFeedback>(RTCPRTPFeedback::NACK,mainSSRC,packet->GetSSRC());
-
-		//Get nacks for lost
-		for (auto field : group->GetNacks())
-			//Add it
-			nack->AddField(field);
-		//Send packet
-		Send(rtcp);
-
-		//Update last time nacked
-		source->lastNACKed = now;
-		//Update nacked packets
-		source->totalNACKs++;
+		//Send nacks for the lost packets not requested recently
+		if (SendNACK(group,now)>0)
+		{
+			//Update last time nacked
+			source->lastNACKed = now;
+			//Update nacked packets
+			source->totalNACKs++;
+		}
 	}
 	
 	//Check if we need to send RR (1 per second)
@@ -1468,6 +1449,13 @@ void DTLSICETransport::SetLocalProperties(const Properties& properties)
 	//Clear extension
 	extensions.clear();
 
+	//Serialized headers are not valid anymore
+	AsyncSafe([=](auto now){
+		//For each outgoing group
+		for (const auto& [ssrc,group] : outgoing)
+			//Build them again on next packet
+			group->headerTemplate.Reset();
+	});
 }
 
 void DTLSICETransport::SetSRTPProtectionProfiles(const std::string& profiles)
@@ -2165,13 +2153,21 @@ int DTLSICETransport::Send(const RTCPCompoundPacket::shared &rtcp)
 		return Error("-DTLSICETransport::Send() | Error serializing RTCP packet [len:%d,size:%d]\n",len,size);
 	}
 	
+	//Send it
+	return SendRTCP(std::move(buffer),len);
+}
+
+int DTLSICETransport::SendRTCP(Packet&& buffer, DWORD len)
+{
+	BYTE* data = buffer.GetData();
+
 	//If we don't have an active candidate yet
 	if (!active)
 	{
 		//Return packet to pool
 		packetPool.release(std::move(buffer));
 		//Log
-		return Debug("-DTLSICETransport::Send() | We don't have an active candidate yet\n");
+		return Debug("-DTLSICETransport::SendRTCP() | We don't have an active candidate yet\n");
 	}
 
 	//Get current time
@@ -2191,7 +2187,7 @@ int DTLSICETransport::Send(const RTCPCompoundPacket::shared &rtcp)
 		//Return packet to pool
 		packetPool.release(std::move(buffer));
 		//Error
-		return Error("-DTLSICETransport::Send() | Error protecting RTCP packet [%s]\n",send.GetLastError());
+		return Error("-DTLSICETransport::SendRTCP() | Error protecting RTCP packet [%s]\n",send.GetLastError());
 	}
 
 	//Store active candidate1889
@@ -2209,6 +2205,45 @@ int DTLSICETransport::Send(const RTCPCompoundPacket::shared &rtcp)
 	return len;
 }
 
+int DTLSICETransport::SendNACK(RTPIncomingSourceGroup* group, QWORD now)
+{
+	//Check if we have an active DTLS connection yet
+	if (!send.IsSetup())
+		//Log 
+		return Debug("-DTLSICETransport::SendNACK() | We don't have an DTLS setup yet\n");
+
+	//Pick one packet buffer from the pool
+	Packet buffer = packetPool.pick();
+	BYTE* 	data = buffer.GetData();
+	//Leave room for SRTCP trailer
+	DWORD	size = std::min<DWORD>(buffer.GetCapacity()-SRTP_MAX_TRAILER_LEN,RTPPAYLOADSIZE);
+
+	//Write NACK fields directly after the header and sender/media ssrcs
+	DWORD len = group->WriteNacks(data+12,size-12,now/1000);
+
+	//If all the lost ones have been requested recently
+	if (!len)
+	{
+		//Return packet to pool
+		packetPool.release(std::move(buffer));
+		//Nothing to send
+		return 0;
+	}
+
+	//Generic NACK header
+	RTCPCommonHeader header;
+	header.count	  = RTCPRTPFeedback::NACK;
+	header.packetType = RTCPPacket::RTPFeedback;
+	header.length	  = 12+len;
+	header.Serialize(data,4);
+	//Set ssrcs
+	set4(data,4,mainSSRC);
+	set4(data,8,group->media.ssrc);
+
+	//Send it
+	return SendRTCP(std::move(buffer),12+len);
+}
+
 int DTLSICETransport::SendPLI(DWORD ssrc)
 {
 	//Log
@@ -2313,9 +2348,36 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 		//Error
 		return Warning("-DTLSICETransport::Send() | Outgoind source not registered for ssrc:%u\n",packet->GetSSRC());
 	
+	//Get time
+	auto now = getTime();
+
+	//Pick one packet buffer from the pool
+	Packet buffer = packetPool.pick();
+
+	//Serialize and encrypt it
+	DWORD len = ProtectRTP(group, packet, buffer, now);
+
+	//If failed, buffer is already back on the pool
+	if (!len)
+		return 0;
+
+	//Send it
+	SendRTP(active, packet, std::move(buffer), len, now);
+
+	//Update stats, rtx history and probing
+	OnSentRTP(group, packet, len);
+
+	return true;
+}
+
+DWORD DTLSICETransport::ProtectRTP(RTPOutgoingSourceGroup* group, const RTPPacket::shared& packet, Packet& buffer, QWORD now)
+{
+	//Get ssrc
+	DWORD ssrc = packet->GetSSRC();
+
 	//Get outgoing source
 	RTPOutgoingSource& source = group->media;
-	
+
         //Update headers
         packet->SetExtSeqNum(source.CorrectExtSeqNum(packet->GetExtSeqNum()));
         packet->SetSSRC(source.ssrc);
@@ -2332,9 +2394,6 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 		//Disable transport wide cc
 		packet->DisableTransportSeqNum();
 
-	//Get time
-	auto now = getTime();
-	
 	//If we are using abs send time for sending
 	if (sendMaps.ext.GetTypeForCodec(RTPHeaderExtension::AbsoluteSendTime)!=RTPMap::NotFound)
 		//Set abs send time
@@ -2343,30 +2402,6 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 		//Disable it
 		packet->DisableAbsSentTime();
 	
-	//Disable repair id
-	packet->DisableRepairedId();
-	
-	//Update mid
-	if (!group->mid.empty())
-	{
-		//Set new mid
-		packet->SetMediaStreamId(group->mid);
-
-		if (!group->rid.empty()) 
-		{
-			//Set new rid
-			packet->SetRId(group->rid);
-		} else {
-			//Disable rid
-			packet->DisableRId();
-		}
-	} else {
-		//Disable it
-		packet->DisableMediaStreamId();
-		//Disable rid & repair id
-		packet->DisableRId();
-	}
-	
 	//No frame markings
 	packet->DisableFrameMarkings();
 
@@ -2378,15 +2413,56 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 		//Disable playout delay
 		packet->DisablePlayoutDelay();
 
-	//if (group->type==MediaFrame::Video) UltraDebug("-DTLSICETransport::Send() | Sending RTP on media:%s sssrc:%u seq:%u pt:%u ts:%lu codec:%s\n",MediaFrame::TypeToString(group->type),source.ssrc,packet->GetSeqNum(),packet->GetPayloadType(),packet->GetTimestamp(),GetNameForCodec(group->type,packet->GetCodec()));
+	//If we don't have the serialized headers for the group yet
+	if (!group->headerTemplate.IsInitialized())
+		//Build them with current extensions
+		group->headerTemplate.Init(
+			group->type,
+			source.ssrc,
+			group->mid,
+			group->rid,
+			group->HasForcedPlayoutDelay() ? std::make_optional(group->GetForcedPlayoutDelay()) : std::nullopt,
+			sendMaps.ext
+		);
+
+	//Check if the headers can be patched on the template, mid and rid are already there
+	bool useTemplate = group->headerTemplate.CanSerialize(*packet);
+
+	//If we need to serialize all the headers
+	if (!useTemplate)
+	{
+		//Disable repair id
+		packet->DisableRepairedId();
+
+		//Update mid
+		if (!group->mid.empty())
+		{
+			//Set new mid
+			packet->SetMediaStreamId(group->mid);
+
+			if (!group->rid.empty()) 
+			{
+				//Set new rid
+				packet->SetRId(group->rid);
+			} else {
+				//Disable rid
+				packet->DisableRId();
+			}
+		} else {
+			//Disable it
+			packet->DisableMediaStreamId();
+			//Disable rid & repair id
+			packet->DisableRId();
+		}
+	}
+
+	//if (group->type==MediaFrame::Video) UltraDebug("-DTLSICETransport::ProtectRTP() | Sending RTP on media:%s sssrc:%u seq:%u pt:%u ts:%lu codec:%s\n",MediaFrame::TypeToString(group->type),source.ssrc,packet->GetSeqNum(),packet->GetPayloadType(),packet->GetTimestamp(),GetNameForCodec(group->type,packet->GetCodec()));
 	
-	//Pick one packet buffer from the pool
-	Packet buffer = packetPool.pick();
 	BYTE* 	data = buffer.GetData();
 	DWORD	size = buffer.GetCapacity();
 	
 	//Serialize data
-	int len = packet->Serialize(data,size,sendMaps.ext);
+	int len = useTemplate ? group->headerTemplate.Serialize(data,size,*packet) : packet->Serialize(data,size,sendMaps.ext);
 	
 	//IF failed
 	if (!len)
@@ -2394,7 +2470,7 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 		//Return packet to pool
 		packetPool.release(std::move(buffer));
 		//Log warning and exit
-		return Warning("-DTLSICETransport::Send() | Could not serialize packet\n");
+		return Warning("-DTLSICETransport::ProtectRTP() | Could not serialize packet\n");
 	}
 
 	//Add packet for RTX
@@ -2406,7 +2482,8 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 		//Return packet to pool
 		packetPool.release(std::move(buffer));
 		//Error
-		return Debug("-DTLSICETransport::Send() | We don't have an active candidate yet\n");
+		Debug("-DTLSICETransport::ProtectRTP() | We don't have an active candidate yet\n");
+		return 0;
 	}
 
 	//If dumping
@@ -2430,12 +2507,14 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 		return Error("-RTPTransport::Send() | Error protecting RTP packet [ssrc:%u,%s]\n",ssrc,send.GetLastError());
 	}
 
-	//Store candidate
-	ICERemoteCandidate* candidate = active;
-
 	//Set buffer size
 	buffer.SetSize(len);
 
+	return len;
+}
+
+void DTLSICETransport::SendRTP(ICERemoteCandidate* candidate, const RTPPacket::shared& packet, Packet&& buffer, DWORD len, QWORD now)
+{
 	//Check if we are using transport wide for this packet
 	if (packet->HasTransportWideCC() && senderSideEstimationEnabled)
 		//Send packet and update stats in callback
@@ -2458,9 +2537,15 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 	else
 		//Send packet
 		sender->Send(candidate, std::move(buffer));
+}
+
+void DTLSICETransport::OnSentRTP(RTPOutgoingSourceGroup* group, const RTPPacket::shared& packet, DWORD len)
+{
+	//Get outgoing source
+	RTPOutgoingSource& source = group->media;
 
 	//Get time
-	now = getTime();
+	auto now = getTime();
 	//Update bitrate
 	outgoingBitrate.Update(now/1000,len);
 	
@@ -2506,321 +2591,132 @@ int DTLSICETransport::Send(const RTPPacket::shared& packet)
 	if (rtx)
 		//Append it to the end of the packet history
 		history.push_back(packet);
-	
-	return true;
 }
 
-void DTLSICETransport::onRTCP(const RTCPCompoundPacket::shared& rtcp)
+void DTLSICETransport::onSenderReport(const RTCPSenderReport& sr)
 {
-	TRACE_EVENT("rtp", "DTLSICETransport::onRTCP", "size", rtcp->GetSize());
+	//Get ssrc
+	DWORD ssrc = sr.GetSSRC();
 
-	//Get current time
-	uint64_t now = getTime();
+	TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::SR", "ssrc", ssrc);
+
+	//Get source
+	RTPIncomingSource* source = GetIncomingSource(ssrc);
 	
-	//For each packet
-	for (DWORD i = 0; i<rtcp->GetPacketCount();i++)
+	//If not found
+	if (!source)
 	{
-		//Get pacekt
-		auto packet = rtcp->GetPacket(i);
-		//Check packet type
-		switch (packet->GetType())
-		{
-			case RTCPPacket::SenderReport:
-			{
-				//Get sender report
-				auto sr = std::static_pointer_cast<RTCPSenderReport>(packet);
-				
-				//Get ssrc
-				DWORD ssrc = sr->GetSSRC();
+		Warning("-DTLSICETransport::onRTCP() | Could not find incoming source for RTCP SR [ssrc:%u]\n",ssrc);
+		return;
+	}
+	
+	//Update source
+	source->Process(getTime(), sr);
+}
 
-				TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::SR", "size", sr->GetSize(), "ssrc", ssrc);
+void DTLSICETransport::onReport(const RTCPReport& report)
+{
+	//Check ssrc
+	DWORD ssrc = report.GetSSRC();
 
-				//Get source
-				RTPIncomingSource* source = GetIncomingSource(ssrc);
-				
-				//If not found
-				if (!source)
-				{
-					Warning("-DTLSICETransport::onRTCP() | Could not find incoming source for RTCP SR [ssrc:%u]\n",ssrc);
-					rtcp->Dump();
-					continue;
-				}
-				
-				//Update source
-				source->Process(now, sr);
-				
-				//Process all the Sender Reports
-				for (DWORD j=0;j<sr->GetCount();j++)
-				{
-					//Get report
-					auto report = sr->GetReport(j);
-					//Check ssrc
-					DWORD ssrc = report->GetSSRC();
-					
-					//Get group
-					RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(ssrc);
-					//If found
-					if (group)
-					{
-						//Get media
-						RTPOutgoingSource* source = group->GetSource(ssrc);
-						//Check ssrc
-						if (source)
-						{
-							RTPOutgoingSource* source = group->GetSource(ssrc);
-							//Check we have it
-							if (source)
-							{
-								//Process report
-								if (source->ProcessReceiverReport(now/1000, report))
-									//We need to update rtt
-									SetRTT(source->rtt, now);
-							}
-						}
-					}
-				}
-				break;
-			}
-			case RTCPPacket::ReceiverReport:
-			{
-				//Get receiver report
-				auto rr = std::static_pointer_cast<RTCPReceiverReport>(packet);
+	TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::RR", "ssrc", ssrc);
 
-				TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::RR", "size", rr->GetSize(), "count", rr->GetCount());
+	//Get media
+	RTPOutgoingSource* source = GetOutgoingSource(ssrc);
+	//Check we have it
+	if (!source)
+		return;
 
-				//Process all the receiver Reports
-				for (DWORD j=0;j<rr->GetCount();j++)
-				{
-					//Get report
-					auto report = rr->GetReport(j);
-					//Check ssrc
-					DWORD ssrc = report->GetSSRC();
-					
-					//Get group
-					RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(ssrc);
-					//If found
-					if (group)
-					{
-						//Get media
-						RTPOutgoingSource* source = group->GetSource(ssrc);
-						//Check ssrc
-						if (source)
-						{
-							RTPOutgoingSource* source = group->GetSource(ssrc);
-							//Check we have it
-							if (source)
-							{
-								//Process report
-								if (source->ProcessReceiverReport(now/1000, report))
-									//We need to update rtt
-									SetRTT(source->rtt,now);
-							}
-						}
-					}
-				}
-				break;
-			}
-			case RTCPPacket::ExtendedJitterReport:
-				break;
-			case RTCPPacket::SDES:
-				break;
-			case RTCPPacket::Bye:
-			{
-				//Get bye
-				auto bye = std::static_pointer_cast<RTCPBye>(packet);
-				//For each ssrc
-				for (auto& ssrc : bye->GetSSRCs())
-				{
-					//Get media
-					auto group = GetIncomingSourceGroup(ssrc);
+	//Get current time
+	QWORD now = getTime();
+	//Process report
+	if (source->ProcessReceiverReport(now/1000, report))
+		//We need to update rtt
+		SetRTT(source->rtt,now);
+}
 
-					//Debug
-					Debug("-DTLSICETransport::onRTCP() | Got BYE [ssrc:%u,group:%p,this:%p]\n", ssrc, group, this);
+void DTLSICETransport::onBye(DWORD ssrc)
+{
+	//Get media
+	auto group = GetIncomingSourceGroup(ssrc);
 
-					//If found
-					if (group)
-						//Reset it
-						group->Bye(ssrc);
-				}
-				break;
-			}
-			case RTCPPacket::App:
-				break;
-			case RTCPPacket::RTPFeedback:
-			{
-				//Get feedback packet
-				auto fb = std::static_pointer_cast<RTCPRTPFeedback>(packet);
-				//Get SSRC for media
-				DWORD ssrc = fb->GetMediaSSRC();
+	//Debug
+	Debug("-DTLSICETransport::onRTCP() | Got BYE [ssrc:%u,group:%p,this:%p]\n", ssrc, group, this);
 
-				TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::FB", "size", fb->GetSize(), "ssrc", ssrc);
+	//If found
+	if (group)
+		//Reset it
+		group->Bye(ssrc);
+}
 
-				//Check feedback type
-				switch(fb->GetFeedbackType())
-				{
-					case RTCPRTPFeedback::NACK:
-					{
-						//Get media
-						RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(ssrc);
-						//If not found
-						if (!group)
-						{
-							//Dump
-							fb->Dump();
-							//Debug
-							Warning("-DTLSICETransport::onRTCP() | Got NACK feedback message for unknown media  [ssrc:%u]\n", ssrc);
-							//Ups! Skip
-							break;
-						}
-						for (DWORD i = 0; i < fb->GetFieldCount(); i++)
-						{
-							//Get field
-							auto field = fb->GetField<RTCPRTPFeedback::NACKField>(i);
-							//Resent it
-							ReSendPacket(group, field->pid);
-							//Check each bit of the mask
-							for (BYTE i = 0; i < 16; i++)
-								//Check it bit is present to rtx the packets
-								if ((field->blp >> i) & 1)
-									//Resent it
-									ReSendPacket(group, field->pid + i + 1);
-						}
-						break;
-					}
-					case RTCPRTPFeedback::TempMaxMediaStreamBitrateRequest:
-						UltraDebug("-DTLSICETransport::onRTCP() | TempMaxMediaStreamBitrateRequest\n");
-						break;
-					case RTCPRTPFeedback::TempMaxMediaStreamBitrateNotification:
-						UltraDebug("-DTLSICETransport::onRTCP() | TempMaxMediaStreamBitrateNotification\n");
-						break;
-					case RTCPRTPFeedback::TransportWideFeedbackMessage:
-						//If sender side estimation is enabled
-						if (senderSideEstimationEnabled)
-							//Get each fiedl
-							for (DWORD i=0;i<fb->GetFieldCount();i++)
-							{
-								//Get field
-								auto field = fb->GetField<RTCPRTPFeedback::TransportWideFeedbackMessageField>(i);
-								//Pass it to the estimator
-								senderSideBandwidthEstimator->ReceivedFeedback(field->feedbackPacketCount,field->packets,now);
-							}
-						break;
-					case RTCPRTPFeedback::UNKNOWN:
-						UltraDebug("-DTLSICETransport::onRTCP() | RTCPRTPFeedback type unknown\n");
-						break;
-				}
-				break;
-			}
-			case RTCPPacket::PayloadFeedback:
-			{
-				//Get feedback packet
-				auto fb = std::static_pointer_cast<RTCPPayloadFeedback>(packet);
-				//Get SSRC for media
-				DWORD ssrc = fb->GetMediaSSRC();
+void DTLSICETransport::onNACK(DWORD ssrc, WORD pid, WORD blp)
+{
+	TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::NACK", "ssrc", ssrc, "pid", pid);
+
+	//Get media
+	RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(ssrc);
+	//If not found
+	if (!group)
+	{
+		//Debug
+		Warning("-DTLSICETransport::onRTCP() | Got NACK feedback message for unknown media  [ssrc:%u]\n", ssrc);
+		//Ups! Skip
+		return;
+	}
+	//Resent it
+	ReSendPacket(group, pid);
+	//Check each bit of the mask
+	for (BYTE i = 0; i < 16; i++)
+		//Check it bit is present to rtx the packets
+		if ((blp >> i) & 1)
+			//Resent it
+			ReSendPacket(group, pid + i + 1);
+}
 
-				TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::PFB", "size", fb->GetSize(), "ssrc", ssrc);
+void DTLSICETransport::onTransportWideFeedback(const RTCPRTPFeedback::TransportWideFeedbackMessageField& field)
+{
+	TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::TWCC", "count", field.packets.size());
 
-				//Check feedback type
-				switch(fb->GetFeedbackType())
-				{
-					case RTCPPayloadFeedback::PictureLossIndication:
-					case RTCPPayloadFeedback::FullIntraRequest:
-					{
-						//Get media
-						RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(ssrc);
-						
-						//Debug
-						Debug("-DTLSICETransport::onRTCP() | FPU requested [ssrc:%u,group:%p,this:%p]\n",ssrc,group,this);
-						
-						//If not found
-						if (!group)
-						{
-							//Dump
-							fb->Dump();
-							//Debug
-							Warning("-Got feedback message for unknown media  [ssrc:%u]\n",ssrc);
-							//Ups! Skip
-							continue;
-						}
-						//Call listeners
-						group->onPLIRequest(ssrc);
-						break;
-					}
-					case RTCPPayloadFeedback::SliceLossIndication:
-						Debug("-DTLSICETransport::onRTCP() | SliceLossIndication\n");
-						break;
-					case RTCPPayloadFeedback::ReferencePictureSelectionIndication:
-						Debug("-DTLSICETransport::onRTCP() | ReferencePictureSelectionIndication\n");
-						break;
-					case RTCPPayloadFeedback::TemporalSpatialTradeOffRequest:
-						Debug("-DTLSICETransport::onRTCP() | TemporalSpatialTradeOffRequest\n");
-						break;
-					case RTCPPayloadFeedback::TemporalSpatialTradeOffNotification:
-						Debug("-DTLSICETransport::onRTCP() | TemporalSpatialTradeOffNotification\n");
-						break;
-					case RTCPPayloadFeedback::VideoBackChannelMessage:
-						Debug("-DTLSICETransport::onRTCP() | VideoBackChannelMessage\n");
-						break;
-					case RTCPPayloadFeedback::ApplicationLayerFeeedbackMessage:
-						//For all message fields
-						for (DWORD i=0;i<fb->GetFieldCount();i++)
-						{
-							//Get feedback
-							auto msg = fb->GetField<RTCPPayloadFeedback::ApplicationLayerFeeedbackField>(i);
-							//Get size and payload
-							DWORD len		= msg->GetLength();
-							const BYTE* payload	= msg->GetPayload();
-							//Check if it is a REMB
-							if (len>8 && payload[0]=='R' && payload[1]=='E' && payload[2]=='M' && payload[3]=='B')
-							{
-								//Get SSRC count
-								BYTE num = payload[4];
-								//GEt exponent
-								BYTE exp = payload[5] >> 2;
-								DWORD mantisa = payload[5] & 0x03;
-								mantisa = mantisa << 8 | payload[6];
-								mantisa = mantisa << 8 | payload[7];
-								//Get bitrate
-								DWORD bitrate = mantisa << exp;
-								//For each
-								for (DWORD i=0;i<num;++i)
-								{
-									//Check length
-									if (len<8+4*i+4)
-										//wrong format
-										break;
-									//Get ssrc
-									DWORD target = get4(payload,8+4*i);
-									//Get media
-									RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(target);
-
-									//Debug
-									Debug("-DTLSICETransport::onRTCP() | REMB received [bitrate:%d,target:%u,group:%p,this:%p]\n", bitrate, target, group, this);
-									
-									//If found
-									if (group)
-										//Call listener
-										group->onREMB(target,bitrate);
-								}
-							}
-						}
-						break;
-					case RTCPPayloadFeedback::UNKNOWN:
-						Debug("-DTLSICETransport::onRTCP() | RTCPPayloadFeedback type unknown\n");
-						break;
-				}
-				break;
-			}
-			case RTCPPacket::FullIntraRequest:
-				//THis is deprecated
-				Debug("-DTLSICETransport::onRTCP() | FullIntraRequest!\n");
-				break;
-			case RTCPPacket::NACK:
-				//THis is deprecated
-				Debug("-DTLSICETransport::onRTCP() | NACK!\n");
-				break;
-		}
+	//If sender side estimation is enabled
+	if (senderSideEstimationEnabled)
+		//Pass it to the estimator
+		senderSideBandwidthEstimator->ReceivedFeedback(field.feedbackPacketCount,field.packets,getTime());
+}
+
+void DTLSICETransport::onPLI(DWORD ssrc)
+{
+	TRACE_EVENT("rtp", "DTLSICETransport::onRTCP::PLI", "ssrc", ssrc);
+
+	//Get media
+	RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(ssrc);
+	
+	//Debug
+	Debug("-DTLSICETransport::onRTCP() | FPU requested [ssrc:%u,group:%p,this:%p]\n",ssrc,group,this);
+	
+	//If not found
+	if (!group)
+	{
+		//Debug
+		Warning("-Got feedback message for unknown media  [ssrc:%u]\n",ssrc);
+		//Ups! Skip
+		return;
 	}
+	//Call listeners
+	group->onPLIRequest(ssrc);
+}
+
+void DTLSICETransport::onREMB(DWORD ssrc, DWORD bitrate)
+{
+	//Get media
+	RTPOutgoingSourceGroup* group = GetOutgoingSourceGroup(ssrc);
+
+	//Debug
+	Debug("-DTLSICETransport::onRTCP() | REMB received [bitrate:%d,target:%u,group:%p,this:%p]\n", bitrate, ssrc, group, this);
+	
+	//If found
+	if (group)
+		//Call listener
+		group->onREMB(ssrc,bitrate);
 }
 
 
@@ -2903,43 +2799,46 @@ void DTLSICETransport::SendTransportWideFeedbackMessage(DWORD ssrc)
 {
 	//Debug
 	//UltraDebug("-DTLSICETransport::SendTransportWideFeedbackMessage() [ssrc:%d]\n", ssrc);
-	//RTCP packet
-	auto rtcp = RTCPCompoundPacket::Create();
-
-	//Create rtcp transport wide feedback
-	auto feedback = rtcp->CreatePacket<RTCPRTPFeedback>(RTCPRTPFeedback::TransportWideFeedbackMessage,mainSSRC,ssrc);
-
-	//Create trnasport field
-	auto field = feedback->CreateField<RTCPRTPFeedback::TransportWideFeedbackMessageField>(++feedbackPacketCount);
-
-	//Proccess and delete all elements
-	for (auto it =transportWideReceivedPacketsStats.cbegin();
-		  it!=transportWideReceivedPacketsStats.cend();
-		  it = transportWideReceivedPacketsStats.erase(it))
-	{
-		//Get stat
-		auto& stats = it->second;
-		//Get transport seq
-		DWORD transportExtSeqNum = it->first;
-		//Get relative time
-		QWORD time = stats.time - initTime;
-
-		//if not first and not out of order
-		if (lastFeedbackPacketExtSeqNum && transportExtSeqNum>lastFeedbackPacketExtSeqNum)
-			//For each lost
-			for (DWORD i = lastFeedbackPacketExtSeqNum+1; i<transportExtSeqNum; ++i)
-				//Add it
-				field->packets.insert(std::make_pair(i,0));
 
-		//Store last
-		lastFeedbackPacketExtSeqNum = transportExtSeqNum;
+	//Check if we have an active DTLS connection yet
+	if (!send.IsSetup())
+	{
+		//Drop pending arrivals, they can't be reported and would prevent new ones from being added
+		transportWideReceivedPackets.Reset();
+		//Log 
+		return (void)Debug("-DTLSICETransport::SendTransportWideFeedbackMessage() | We don't have an DTLS setup yet\n");
+	}
+
+	//Pick one packet buffer from the pool
+	Packet buffer = packetPool.pick();
+	BYTE* 	data = buffer.GetData();
+	//Leave room for SRTCP trailer
+	DWORD	size = std::min<DWORD>(buffer.GetCapacity()-SRTP_MAX_TRAILER_LEN,RTPPAYLOADSIZE);
+
+	//Write feedback field directly after the header and sender/media ssrcs
+	DWORD len = transportWideReceivedPackets.WriteFeedback(data+12,size-12,++feedbackPacketCount,getTime()-initTime);
 
-		//Add this one
-		field->packets.insert(std::make_pair(transportExtSeqNum,time));
+	//If nothing to report
+	if (!len)
+	{
+		//Return packet to pool
+		packetPool.release(std::move(buffer));
+		//Nothing to send
+		return;
 	}
 
-	//Send packet
-	Send(rtcp);
+	//Transport wide feedback header
+	RTCPCommonHeader header;
+	header.count	  = RTCPRTPFeedback::TransportWideFeedbackMessage;
+	header.packetType = RTCPPacket::RTPFeedback;
+	header.length	  = 12+len;
+	header.Serialize(data,4);
+	//Set ssrcs
+	set4(data,4,mainSSRC);
+	set4(data,8,ssrc);
+
+	//Send it
+	SendRTCP(std::move(buffer),12+len);
 }
 
 void DTLSICETransport::Start()
@@ -3054,6 +2953,77 @@ int DTLSICETransport::Enqueue(const RTPPacket::shared& packet)
 	return 1;
 }
 
+int DTLSICETransport::Enqueue(const std::vector<RTPPacket::shared>& packets)
+{
+	//Trace
+	TRACE_EVENT("rtp", "DTLSICETransport::Enqueue RTP batch",
+		"packets", packets.size());
+
+	//Check if we have an active DTLS connection yet
+	if (!send.IsSetup())
+	{
+		//Nothing sent
+		Debug("-DTLSICETransport::Enqueue() | We don't have an DTLS setup yet\n");
+		return 0;
+	}
+
+	//Get time
+	auto now = getTime();
+
+	//Serialized and encrypted packets
+	std::vector<std::tuple<RTPOutgoingSourceGroup*,RTPPacket::shared,Packet,DWORD>> protectedPackets;
+	protectedPackets.reserve(packets.size());
+
+	//Batches are usually a frame of a single ssrc, so only look up the group when it changes
+	DWORD ssrc = 0;
+	RTPOutgoingSourceGroup* group = nullptr;
+
+	//Serialize and encrypt all of them first
+	for (const auto& packet : packets)
+	{
+		//Check packet
+		if (!packet)
+		{
+			Error("-DTLSICETransport::Enqueue() | Error null packet\n");
+			continue;
+		}
+
+		//Get outgoing group if ssrc has changed
+		if (!group || packet->GetSSRC()!=ssrc)
+		{
+			ssrc = packet->GetSSRC();
+			group = GetOutgoingSourceGroup(ssrc);
+		}
+
+		//If not found
+		if (!group)
+		{
+			Warning("-DTLSICETransport::Enqueue() | Outgoind source not registered for ssrc:%u\n",ssrc);
+			continue;
+		}
+
+		//Pick one packet buffer from the pool
+		Packet buffer = packetPool.pick();
+
+		//Serialize and encrypt it, buffer is back on the pool if it fails
+		DWORD len = ProtectRTP(group, packet, buffer, now);
+
+		//If done
+		if (len)
+			protectedPackets.emplace_back(group, packet, std::move(buffer), len);
+	}
+
+	//Send them back to back, so they are queued together on the loop and flushed with a single sendmmsg
+	for (auto& [group, packet, buffer, len] : protectedPackets)
+		SendRTP(active, packet, std::move(buffer), len, now);
+
+	//Update stats, rtx history and probing
+	for (auto& [group, packet, buffer, len] : protectedPackets)
+		OnSentRTP(group, packet, len);
+
+	return protectedPackets.size();
+}
+
 void DTLSICETransport::Probe(QWORD now)
 {
 	TRACE_EVENT("transport", "DTLSICETransport::Probe", "now", now);
@@ -3327,4 +3297,4 @@ void DTLSICETransport::CheckProbeTimer()
 			probingTimer->Cancel();
 		}
 	});
-}
\ No newline at end of file
+}
\ No newline at end of file
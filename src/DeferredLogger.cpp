@@ -0,0 +1,266 @@
+#include "DeferredLogger.h"
+#include <chrono>
+#include <pthread.h>
+#include <unistd.h>
+
+DeferredLogger& DeferredLogger::GetInstance()
+{
+	//Leaked on purpose so it can be used while other statics are destroyed
+	static DeferredLogger* instance = new DeferredLogger();
+	return *instance;
+}
+
+DeferredLogger::Ring::Ring() :
+	buffer(new BYTE[RingSize])
+{
+	tid = gettid();
+}
+
+BYTE* DeferredLogger::Ring::Reserve(DWORD size)
+{
+	//Check it could ever fit
+	if (size>RingSize)
+		return nullptr;
+
+	//Get current write position
+	QWORD start = head.load(std::memory_order_relaxed);
+	DWORD pos = start % RingSize;
+	//Space left until the end of the buffer
+	DWORD contiguous = RingSize - pos;
+	//If it does not fit we have to skip to the begining
+	DWORD skip = contiguous<size ? contiguous : 0;
+
+	//Check there is enough free space
+	if (start + skip + size - tail.load(std::memory_order_acquire) > RingSize)
+		//Full
+		return nullptr;
+
+	//If skipping
+	if (skip)
+	{
+		//Mark it so reader goes to the ring start
+		((Record*)(buffer.get()+pos))->size = 0;
+		pos = 0;
+	}
+
+	//Pending record end
+	reserved = start + skip + size;
+
+	return buffer.get()+pos;
+}
+
+void DeferredLogger::Ring::Commit()
+{
+	//Make it visible to the logger thread
+	head.store(reserved, std::memory_order_release);
+}
+
+template<typename Func>
+void DeferredLogger::Ring::Consume(Func&& func)
+{
+	//Get available data
+	QWORD end = head.load(std::memory_order_acquire);
+	QWORD start = tail.load(std::memory_order_relaxed);
+
+	while (start<end)
+	{
+		DWORD pos = start % RingSize;
+		const Record* record = (const Record*)(buffer.get()+pos);
+		//If it is a skip marker
+		if (!record->size)
+		{
+			//Go to the ring start
+			start += RingSize - pos;
+			continue;
+		}
+		//Process it
+		func(*record);
+		//Next
+		start += record->size;
+	}
+
+	//Release space
+	tail.store(start, std::memory_order_release);
+}
+
+int64_t DeferredLogger::Ring::CheckRateLimit(const char* format, QWORD now, DWORD limit)
+{
+	//No limit
+	if (!limit)
+		return 0;
+
+	//Get call site slot, formats are literals so the pointer identifies it
+	CallSite& callSite = callSites[((uintptr_t)format >> 3) % MaxCallSites];
+	QWORD second = now/1000000;
+
+	//If it is a different call site or a new second
+	if (callSite.format!=format)
+	{
+		//Take over the slot
+		callSite.format = format;
+		callSite.second = second;
+		callSite.count = 0;
+		callSite.suppressed = 0;
+	} else if (callSite.second!=second) {
+		//Start counting again
+		callSite.second = second;
+		callSite.count = 0;
+	}
+
+	//Check limit
+	if (++callSite.count>limit)
+	{
+		//Drop it
+		callSite.suppressed++;
+		return -1;
+	}
+
+	//Report the suppressed ones on this message
+	int64_t suppressed = callSite.suppressed;
+	callSite.suppressed = 0;
+	return suppressed;
+}
+
+const char* DeferredLogger::Ring::GetName(QWORD now)
+{
+	QWORD second = now/1000000;
+	//Refresh it
+	if (nameSecond!=second)
+	{
+		pthread_getname_np(pthread_self(), name, sizeof(name));
+		nameSecond = second;
+	}
+	return name;
+}
+
+DeferredLogger::Ring* DeferredLogger::GetRing()
+{
+	//Ring of current thread, shared with the logger so pending records are written after the thread ends
+	thread_local std::shared_ptr<Ring> ring;
+
+	//If not running
+	if (!running)
+		//Write synchronously
+		return nullptr;
+
+	//Create it on first use
+	if (!ring)
+	{
+		ring = std::make_shared<Ring>();
+		//Register it
+		std::lock_guard<std::mutex> lock(mutex);
+		rings.push_back(ring);
+	}
+
+	return ring.get();
+}
+
+void DeferredLogger::Start()
+{
+	//Check not already running
+	if (running.exchange(true))
+		return;
+
+	//Start logger thread
+	thread = std::thread([this](){ Run(); });
+	pthread_setname_np(thread.native_handle(), "logger");
+}
+
+void DeferredLogger::Stop()
+{
+	//Check it was running
+	if (!running.exchange(false))
+		return;
+
+	//Wait for logger thread
+	if (thread.joinable())
+		thread.join();
+
+	//Write anything left
+	Drain();
+}
+
+void DeferredLogger::Flush()
+{
+	//Wait until the logger thread has written everything
+	while (running)
+	{
+		bool empty = true;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (const auto& ring : rings)
+				empty = empty && ring->IsEmpty();
+		}
+		if (empty)
+			break;
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	fflush(output);
+}
+
+void DeferredLogger::Run()
+{
+	while (running)
+		//Drain pending records and sleep if there was none
+		if (!Drain())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+bool DeferredLogger::Drain()
+{
+	char line[4096];
+	QWORD num = 0;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto it = rings.begin(); it!=rings.end(); )
+	{
+		//Write all pending records
+		(*it)->Consume([&](const Record& record) {
+			//Same prefix as synchronous logs
+			int len = snprintf(line, sizeof(line), "[%-16s][0x%-4x][%.10ld.%.3ld][%s]%.*s",
+				record.name,
+				record.tid,
+				(long)(record.timestamp/1000000),
+				(long)(record.timestamp%1000000)/1000,
+				record.tag,
+				record.prefixLength,
+				(const char*)&record+sizeof(Record));
+			//Format message
+			if (len>0 && len<(int)sizeof(line))
+			{
+				int res = record.formatter(line+len, sizeof(line)-len, record.format, (const BYTE*)&record+record.argsOffset);
+				if (res>0)
+					len = std::min<int>(len+res, sizeof(line)-1);
+			}
+			//Write it
+			if (len>0)
+				fwrite(line, 1, std::min<int>(len, sizeof(line)-1), output);
+			//Report rate limited ones
+			if (record.suppressed)
+				fprintf(output, "[%-16s][0x%-4x][%.10ld.%.3ld][%s]%u similar messages suppressed\n",
+					record.name,
+					record.tid,
+					(long)(record.timestamp/1000000),
+					(long)(record.timestamp%1000000)/1000,
+					record.tag,
+					record.suppressed);
+			num++;
+		});
+
+		//Remove rings of ended threads once they are empty
+		if (it->use_count()==1 && (*it)->IsEmpty())
+			it = rings.erase(it);
+		else
+			++it;
+	}
+
+	//If anything was written
+	if (num)
+	{
+		fflush(output);
+		written += num;
+	}
+
+	return num;
+}
@@ -0,0 +1,248 @@
+#include "EPoll.h"
+
+#ifdef __linux__
+
+#include "config.h"
+#include "tools.h"
+#include "log.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+EPoll::EPoll() :
+	epfd(epoll_create1(EPOLL_CLOEXEC))
+{
+	if (!epfd.isValid())
+	{
+		throw std::runtime_error("Failed to create epoll fd\n");
+	}
+
+	if (!EPoll::AddFd(signalling.GetFd()))
+	{
+		throw std::runtime_error("Failed to add signaling fd to event poll\n");
+	}
+
+	if (!EPoll::SetEventMask(signalling.GetFd(), Poll::Event::In))
+	{
+		throw std::runtime_error("Failed to set event mask\n");
+	}
+}
+
+void EPoll::Signal()
+{
+	signalling.Signal();
+}
+
+bool EPoll::AddFd(int fd)
+{
+	if (fd == FD_INVALID)
+	{
+		return Error("-EPoll::AddFd() | Invalid fd\n");
+	}
+
+	// Already added
+	if (fds.find(fd) != fds.end())
+	{
+		return true;
+	}
+
+	//Set non blocking so we can get an error when we are closed by end
+	int fsflags = fcntl(fd,F_GETFL,0);
+	fsflags |= O_NONBLOCK;
+
+	if (auto error = fcntl(fd,F_SETFL,fsflags) < 0)
+		return Error("-EPoll::AddFd() | Failed to set flag: fd: %d, error: %d\n", fd, error);
+
+	// No events until the mask is set, errors are always reported
+	epoll_event event = {};
+	event.data.fd = fd;
+
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) < 0)
+		return Error("-EPoll::AddFd() | Failed to add fd: %d, errno: %d\n", fd, errno);
+
+	fds.emplace(fd, Entry{});
+
+	tempfdsDirty = true;
+
+	return true;
+}
+
+bool EPoll::RemoveFd(int fd)
+{
+	if (fds.erase(fd) == 0)
+	{
+		return Error("-EPoll::RemoveFd() | Failed to erase fd: %d\n", fd);
+	}
+
+	// Fd could have been closed already, which removes it from the epoll set
+	if (epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr) < 0 && errno != EBADF && errno != ENOENT)
+		Warning("-EPoll::RemoveFd() | Failed to remove fd: %d, errno: %d\n", fd, errno);
+
+	tempfdsDirty = true;
+
+	return true;
+}
+
+void EPoll::Clear()
+{
+	if (fds.empty()) return;
+
+	// Clear except the signalling fd
+	for (auto it = fds.begin(); it != fds.end();)
+	{
+		if (it->first == signalling.GetFd())
+		{
+			++it;
+		}
+		else
+		{
+			(void)epoll_ctl(epfd, EPOLL_CTL_DEL, it->first, nullptr);
+			it = fds.erase(it);
+		}
+	}
+
+	tempfdsDirty = true;
+}
+
+void EPoll::ForEachFd(std::function<void(int)> func)
+{
+	if (tempfdsDirty)
+	{
+		tempfds.clear();
+		for (auto& [fd, entry] : fds)
+		{
+			if (fd != signalling.GetFd())
+			{
+				tempfds.push_back(fd);
+			}
+		}
+
+		tempfdsDirty = false;
+	}
+
+	for (auto& fd : tempfds)
+	{
+		func(fd);
+	}
+}
+
+bool EPoll::SetEventMask(int fd, uint16_t eventMask)
+{
+	auto it = fds.find(fd);
+	if (it == fds.end()) return Error("-EPoll::SetEventMask() | fd is not found\n");
+
+	uint32_t events = 0;
+
+	if (eventMask & Event::In)
+	{
+		events |= EPOLLIN;
+	}
+
+	if (eventMask & Event::Out)
+	{
+		events |= EPOLLOUT;
+	}
+
+	// Nothing to do if not changed
+	if (it->second.events == events)
+	{
+		return true;
+	}
+
+	epoll_event event = {};
+	event.events = events;
+	event.data.fd = fd;
+
+	if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &event) < 0)
+		return Error("-EPoll::SetEventMask() | Failed to modify fd: %d, errno: %d\n", fd, errno);
+
+	it->second.events = events;
+
+	return true;
+}
+
+std::pair<uint16_t, int> EPoll::GetEvents(int fd) const
+{
+	auto it = fds.find(fd);
+	if (it == fds.end()) return std::make_pair<>(0, 0);
+
+	uint16_t events = 0;
+	uint32_t revents = it->second.revents;
+
+	if ((revents & EPOLLHUP) || (revents & EPOLLERR))
+	{
+		Error("-EPoll::GetEvents() | Error events: 0x%x fd: %d errno: %d\n", revents, fd, errno);
+		return std::make_pair<>(0, -1);
+	}
+
+	if (revents & EPOLLIN)
+	{
+		events |= Event::In;
+	}
+
+	if (revents & EPOLLOUT)
+	{
+		events |= Event::Out;
+	}
+
+	return std::make_pair<>(events, 0);
+}
+
+int EPoll::Wait(uint32_t timeOutMs)
+{
+	// Clear events from last wait
+	for (auto fd : ready)
+	{
+		auto it = fds.find(fd);
+		if (it != fds.end())
+		{
+			it->second.revents = 0;
+		}
+	}
+	ready.clear();
+
+	// Wait for events
+	int num = epoll_wait(epfd, events, MaxEvents, timeOutMs);
+	if (num < 0)
+	{
+		// Interrupted by a signal, no events
+		if (errno == EINTR)
+			return 0;
+
+		Error("-EPoll::Wait() | epoll_wait() error. errno: %d\n", errno);
+		return -1;
+	}
+
+	// Copy back
+	for (int i = 0; i < num; i++)
+	{
+		int fd = events[i].data.fd;
+		auto revents = events[i].events;
+
+		if (fd == signalling.GetFd())
+		{
+			if ((revents & EPOLLHUP) || (revents & EPOLLERR))
+			{
+				signalling.ClearSignal();
+				Error("-EPoll::Wait() | Error events: 0x%x fd: %d errno: %d\n", revents, fd, errno);
+				return -1;
+			}
+			else if (revents & EPOLLIN)
+			{
+				signalling.ClearSignal();
+			}
+		}
+
+		auto it = fds.find(fd);
+		if (it != fds.end())
+		{
+			it->second.revents = revents;
+			ready.push_back(fd);
+		}
+	}
+
+	return 0;
+}
+
+#endif
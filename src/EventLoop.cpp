@@ -15,6 +15,7 @@
 #include <cmath>
 
 #include "log.h"
+#include "Metrics.h"
 
 #if __APPLE__
 #include <mach/mach.h>
@@ -301,6 +302,15 @@ void EventLoop::AsyncUnsafe(const std::function<void(std::chrono::milliseconds)>
 }
 
 
+void EventLoop::ScheduleChannel(const std::weak_ptr<ChannelBase>& channel)
+{
+	//Add to pending channels, it is processed on next iteration even if on the same thread
+	channels.enqueue(channel);
+
+	//Signal the thread this will cause the poll call to exit
+	Signal();
+}
+
 std::future<void> EventLoop::FutureUnsafe(const std::function<void(std::chrono::milliseconds)>& func)
 {
 	//UltraDebug(">EventLoop::Future()\n");
@@ -463,6 +473,9 @@ bool EventLoop::AddFd(int fd, std::optional<uint16_t> eventMask)
 		return poll->SetEventMask(fd, *eventMask);
 	}
 	
+	//Get it from GetPollEventMask() on next iteration
+	pollEventMaskChanged = true;
+	
 	return true;
 }
 
@@ -479,6 +492,15 @@ void EventLoop::ForEachFd(const std::function<void(int)>& func)
 	});
 }
 
+void EventLoop::UpdatePollEventMask()
+{
+	//Set flag before signaling so the loop sees it after waking up
+	pollEventMaskChanged = true;
+	
+	//Exit poll wait if we are not in the loop thread
+	Signal();
+}
+
 void EventLoop::Signal()
 {
 	TRACE_EVENT("eventloop", "EventLoop::Signal");
@@ -509,12 +531,16 @@ void EventLoop::Run(const std::chrono::milliseconds &duration)
 	{
 		//TRACE_EVENT("eventloop", "EventLoop::Run::Iteration");
 		
-		poll->ForEachFd([this](int fd) {
-			
-			auto events = GetPollEventMask(fd);
-			if (events)
-				poll->SetEventMask(fd, *events);
-		});
+		//Only if any event mask has changed
+		if (pollEventMaskChanged.exchange(false))
+		{
+			poll->ForEachFd([this](int fd) {
+				
+				auto events = GetPollEventMask(fd);
+				if (events)
+					poll->SetEventMask(fd, *events);
+			});
+		}
 		
 		//Until signaled or one each 10 seconds to prevent deadlocks
 		int timeout = GetNextTimeout(10E3, until);
@@ -553,6 +579,9 @@ void EventLoop::Run(const std::chrono::milliseconds &duration)
 		//Process pendint tasks
 		ProcessTasks(now);
 
+		//Process messages from channels
+		ProcessChannels(now);
+
 		//Timers triggered
 		ProcessTriggers(now);
 		
@@ -562,6 +591,7 @@ void EventLoop::Run(const std::chrono::milliseconds &duration)
 	
 	//Run queued tasks before exiting
 	ProcessTasks(now);
+	ProcessChannels(now);
 
 	OnLoopExit(exitCode.has_value() ? *exitCode : 0);
 	//Log("<EventLoop::Run()\n");
@@ -571,8 +601,8 @@ int EventLoop::GetNextTimeout(int defaultTimeout, const std::chrono::millisecond
 {
 	int timeout = defaultTimeout;
 
-	//Check if we have any pending task to wait or exit poll inmediatelly
-	if (tasks.size_approx())
+	//Check if we have any pending task or channel to wait or exit poll inmediatelly
+	if (tasks.size_approx() || channels.size_approx())
 	{
 		//No wait
 		timeout = 0;
@@ -599,6 +629,7 @@ void EventLoop::ProcessTasks(const std::chrono::milliseconds& now)
 {
 	//Run queued task
 	TRACE_EVENT_BEGIN("eventloop", "EventLoop::ProcessTasks");
+	static auto& processed = Metrics::GetInstance().GetCounter("eventloop_tasks_total", "Tasks run on event loops");
 	std::pair<std::function<void(std::chrono::milliseconds)>,std::optional<std::function<void(std::chrono::milliseconds)>>> task;
 	//Get all pending taks
 	while (tasks.try_dequeue(task))
@@ -606,6 +637,7 @@ void EventLoop::ProcessTasks(const std::chrono::milliseconds& now)
 		//UltraDebug(">EventLoop::Run() | task pending\n");
 		//Execute it
 		task.first(now);
+		processed.Add();
 		//If we had a callback
 		if (task.second.has_value())
 			//Run now
@@ -615,6 +647,31 @@ void EventLoop::ProcessTasks(const std::chrono::milliseconds& now)
 	TRACE_EVENT_END("eventloop");
 }
 
+void EventLoop::ProcessChannels(const std::chrono::milliseconds& now)
+{
+	TRACE_EVENT_BEGIN("eventloop", "EventLoop::ProcessChannels");
+	std::weak_ptr<ChannelBase> channels[16];
+	//Only process the ones scheduled before starting, rescheduled ones will be run on next iteration
+	size_t pending = this->channels.size_approx();
+	//Get scheduled channels, each one is only scheduled once until processed
+	while (pending)
+	{
+		size_t num = this->channels.try_dequeue_bulk(channels, std::min(pending, std::size(channels)));
+		if (!num)
+			break;
+		pending -= num;
+		for (size_t i = 0; i < num; ++i)
+		{
+			//If still alive
+			if (auto channel = channels[i].lock())
+				//Deliver pending messages
+				channel->Process(now);
+			channels[i].reset();
+		}
+	}
+	TRACE_EVENT_END("eventloop");
+}
+
 void EventLoop::ProcessTriggers(const std::chrono::milliseconds& now)
 {
 	//Run triggered timers
@@ -633,12 +690,17 @@ void EventLoop::ProcessTriggers(const std::chrono::milliseconds& now)
 		it = timers.erase(it);
 	}
 
+	static auto& lag = Metrics::GetInstance().GetHistogram("eventloop_timer_lag_ms", "Delay between the scheduled and actual execution time of timers in milliseconds");
+
 	//Now process all timers triggered
 	for (auto timer : triggered)
 	{
 		//Get scheduled time
 		auto scheduled = timer->next;
 
+		//Record how late we are
+		lag.Record((now - scheduled).count());
+
 		//UltraDebug(">EventLoop::Run() | timer [%s] triggered at ll%u scheduled at %lld\n",timer->GetName().c_str(),now.count(),scheduled.count());
 	
 		//We are executing
@@ -0,0 +1,303 @@
+#include "Executor.h"
+#include <algorithm>
+#include "log.h"
+#include "tools.h"
+
+//Worker thread of the executor running current thread, if any
+static thread_local Executor* currentExecutor = nullptr;
+static thread_local size_t currentIndex = 0;
+
+Executor::Strand::Strand(Executor& executor, bool realTime) :
+	executor(executor),
+	realTime(realTime)
+{
+}
+
+bool Executor::Strand::Post(QWORD deadline, Task&& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		//If closed
+		if (closed)
+			//Drop it
+			return false;
+
+		//Add task
+		tasks.push_back({deadline, seq++, std::move(task)});
+		std::push_heap(tasks.begin(), tasks.end(), Later());
+
+		//If it is already scheduled or running
+		if (scheduled)
+			//Will be run later
+			return true;
+
+		//Schedule it now
+		scheduled = true;
+		//Get first task deadline
+		deadline = tasks.front().deadline;
+	}
+	//Make it runnable
+	executor.Schedule(shared_from_this(), deadline);
+	//Done
+	return true;
+}
+
+bool Executor::Strand::Run(size_t max, QWORD& next)
+{
+	for (size_t i = 0; i < max; ++i)
+	{
+		Task task;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			//If there are no more tasks
+			if (tasks.empty())
+			{
+				//Not runnable anymore
+				scheduled = false;
+				//Done
+				return false;
+			}
+			//Get next task
+			std::pop_heap(tasks.begin(), tasks.end(), Later());
+			task = std::move(tasks.back().task);
+			tasks.pop_back();
+			//We are running it
+			running = true;
+			runner = std::this_thread::get_id();
+		}
+
+		//Run it
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			//Not running anymore
+			running = false;
+		}
+		//Signal anyone waiting on close
+		idle.notify_all();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	//If there are no more tasks
+	if (tasks.empty())
+	{
+		//Not runnable anymore
+		scheduled = false;
+		//Done
+		return false;
+	}
+	//Get next deadline
+	next = tasks.front().deadline;
+	//Still runnable
+	return true;
+}
+
+void Executor::Strand::Close()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	//Closed
+	closed = true;
+	//Drop pending tasks
+	tasks.clear();
+	//If it is called from a task of this strand
+	if (running && runner == std::this_thread::get_id())
+		//Can't wait for ourself
+		return;
+	//Wait for the current task to finish
+	idle.wait(lock, [this]() { return !running; });
+}
+
+size_t Executor::Strand::GetPendingTasks()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return tasks.size();
+}
+
+Executor& Executor::GetDefault()
+{
+	static Executor executor;
+	return executor;
+}
+
+Executor::Executor(size_t numThreads, const std::string& name)
+{
+	//Use as many threads as cores by default
+	if (!numThreads)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	Log("-Executor::Executor() [name:%s,threads:%zu]\n", name.c_str(), numThreads);
+
+	//Block signals to avoid exiting on SIGUSR1
+	blocksignals();
+
+	//Create workers first so they can steal from each other
+	for (size_t i = 0; i < numThreads; ++i)
+		workers.push_back(std::make_unique<Worker>());
+
+	//Launch them
+	for (size_t i = 0; i < numThreads; ++i)
+	{
+		workers[i]->thread = std::thread([this, i]() { Run(i); });
+		//Set name, max 15 chars
+		pthread_setname_np(workers[i]->thread.native_handle(), (name.substr(0, 10) + "-" + std::to_string(i)).c_str());
+	}
+}
+
+Executor::~Executor()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		//Stop
+		running = false;
+	}
+	//Wake up all workers
+	wakeup.notify_all();
+
+	//Wait for them
+	for (auto& worker : workers)
+		worker->thread.join();
+}
+
+bool Executor::SetIdlePriority()
+{
+#ifdef SCHED_IDLE
+	sched_param param = {
+		.sched_priority = 0
+	};
+	bool ok = true;
+	//Set it on all workers
+	for (auto& worker : workers)
+		ok = !pthread_setschedparam(worker->thread.native_handle(), SCHED_IDLE, &param) && ok;
+	return ok;
+#else
+	return false;
+#endif
+}
+
+Executor::Strand::shared Executor::CreateStrand(bool realTime)
+{
+	return std::make_shared<Strand>(*this, realTime);
+}
+
+void Executor::Schedule(Strand::shared&& strand, QWORD deadline)
+{
+	//Real time strands are run by deadline order
+	if (strand->IsRealTime())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			//Add to heap
+			realTimeQueue.push_back({deadline, realTimeSeq++, std::move(strand)});
+			std::push_heap(realTimeQueue.begin(), realTimeQueue.end());
+			realTimePending++;
+			pending++;
+		}
+		//Wake up one worker
+		wakeup.notify_one();
+		//Done
+		return;
+	}
+
+	//If we are on one of our workers use its queue, otherwise distribute them
+	size_t index = currentExecutor == this ? currentIndex : roundRobin++ % workers.size();
+
+	{
+		auto& worker = *workers[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		//Run in order, so strands that have used their batch run again after the ones already waiting
+		worker.queue.push_back(std::move(strand));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		//One more
+		pending++;
+	}
+	//Wake up one worker
+	wakeup.notify_one();
+}
+
+Executor::Strand::shared Executor::Next(size_t index)
+{
+	//Real time strands first
+	if (realTimePending)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		//Check again
+		if (!realTimeQueue.empty())
+		{
+			//Get earliest deadline
+			std::pop_heap(realTimeQueue.begin(), realTimeQueue.end());
+			auto strand = std::move(realTimeQueue.back().strand);
+			realTimeQueue.pop_back();
+			realTimePending--;
+			pending--;
+			return strand;
+		}
+	}
+
+	//Then from our own queue, oldest first
+	{
+		auto& worker = *workers[index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.queue.empty())
+		{
+			auto strand = std::move(worker.queue.front());
+			worker.queue.pop_front();
+			pending--;
+			return strand;
+		}
+	}
+
+	//Steal newest one from the others, as it will be the last one they run
+	for (size_t i = 1; i < workers.size(); ++i)
+	{
+		auto& worker = *workers[(index + i) % workers.size()];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.queue.empty())
+		{
+			auto strand = std::move(worker.queue.back());
+			worker.queue.pop_back();
+			pending--;
+			return strand;
+		}
+	}
+
+	//Nothing to do
+	return nullptr;
+}
+
+void Executor::Run(size_t index)
+{
+	//Store current worker
+	currentExecutor = this;
+	currentIndex = index;
+
+	while (true)
+	{
+		//Get next runnable strand
+		auto strand = Next(index);
+
+		//If there was nothing
+		if (!strand)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			//Wait for more work
+			wakeup.wait(lock, [this]() { return pending > 0 || !running; });
+			//Check if we have been stopped
+			if (!running)
+				//Exit
+				break;
+			//Try again
+			continue;
+		}
+
+		QWORD next = NoDeadline;
+		//Run real time strands one task at a time so deadlines are checked often
+		if (strand->Run(strand->IsRealTime() ? 1 : MaxBatch, next))
+			//Reschedule it
+			Schedule(std::move(strand), next);
+	}
+}
@@ -0,0 +1,117 @@
+#include "LoopPlacement.h"
+#include "log.h"
+
+LoopPlacement& LoopPlacement::GetInstance()
+{
+	static LoopPlacement instance;
+	return instance;
+}
+
+void LoopPlacement::AddLoop(TimeService* loop)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	loads.emplace(loop, 0);
+}
+
+void LoopPlacement::RemoveLoop(TimeService* loop)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	//Find it
+	auto it = loads.find(loop);
+	//If not found
+	if (it==loads.end())
+		return;
+	//Remove its load
+	total -= it->second;
+	loads.erase(it);
+}
+
+TimeService* LoopPlacement::Place(TimeService* source, DWORD weight)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	//Check we have loops
+	if (loads.empty())
+		return source;
+
+	//Find source loop
+	auto it = loads.find(source);
+
+	//Keep it on the source loop unless it gets too loaded
+	TimeService* loop = it!=loads.end() && !IsOverloaded(it->second, weight) ? source : GetLeastLoaded();
+
+	//Account it
+	loads[loop] += weight;
+	total += weight;
+
+	//Debug
+	if (loop!=source)
+		UltraDebug("-LoopPlacement::Place() | placed on another loop than source [source:%p,loop:%p]\n", source, loop);
+
+	return loop;
+}
+
+void LoopPlacement::Release(TimeService* loop, DWORD weight)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	//Find it
+	auto it = loads.find(loop);
+	//If not found
+	if (it==loads.end())
+		return;
+	//Do not underflow
+	weight = std::min<QWORD>(weight, it->second);
+	it->second -= weight;
+	total -= weight;
+}
+
+QWORD LoopPlacement::GetLoad(TimeService* loop) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = loads.find(loop);
+	return it!=loads.end() ? it->second : 0;
+}
+
+std::optional<std::pair<TimeService*,TimeService*>> LoopPlacement::GetRebalance() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	//Nothing to balance
+	if (loads.size()<2)
+		return std::nullopt;
+
+	auto most = loads.begin();
+	auto least = loads.begin();
+	for (auto it = loads.begin(); it!=loads.end(); ++it)
+	{
+		if (it->second>most->second)
+			most = it;
+		if (it->second<least->second)
+			least = it;
+	}
+
+	//Check if most loaded one is over the limit
+	if (!IsOverloaded(most->second, 0))
+		return std::nullopt;
+
+	return std::make_pair(most->first, least->first);
+}
+
+TimeService* LoopPlacement::GetLeastLoaded() const
+{
+	auto least = loads.begin();
+	for (auto it = loads.begin(); it!=loads.end(); ++it)
+		if (it->second<least->second)
+			least = it;
+	return least->first;
+}
+
+bool LoopPlacement::IsOverloaded(QWORD load, QWORD added) const
+{
+	//Keep first sinks colocated
+	if (load + added <= minLoad)
+		return false;
+	//Average load after adding it
+	double average = (double)(total + added) / loads.size();
+	return load + added > maxImbalance * average;
+}
@@ -4,6 +4,10 @@
 #include "audio.h"
 #include "MediaFrameListenerBridge.h"
 #include "VideoLayerSelector.h"
+#include "Metrics.h"
+
+static Metrics::Counter& relayedFrames = Metrics::GetInstance().GetCounter("media_frame_bridge_frames_total", "Media frames received by frame listener bridges");
+static Metrics::Counter& crossLoopFrames = Metrics::GetInstance().GetCounter("media_frame_bridge_cross_loop_hops_total", "Media frames received by frame listener bridges from another loop");
 
 using namespace std::chrono_literals;
 
@@ -184,7 +188,20 @@ void MediaFrameListenerBridge::SetFrameDispatchCoordinator(const std::shared_ptr
 
 void MediaFrameListenerBridge::onMediaFrame(DWORD ignored, const MediaFrame& frame)
 {
+	relayedFrames.Add();
+
+	//If source is colocated on our loop, process it synchronously unless there are queued frames that would be overtaken
+	if (GetTimeService().IsCurrentThread() && !pendingFrames)
+	{
+		onMediaFrameAsync(GetTimeService().GetNow(), ignored, std::shared_ptr<MediaFrame>(frame.Clone()));
+		return;
+	}
+
+	crossLoopFrames.Add();
+	pendingFrames++;
+
 	AsyncSafe([=, frame = std::shared_ptr<MediaFrame>(frame.Clone())] (auto now){
+		pendingFrames--;
 		onMediaFrameAsync(now, ignored, frame);
 	});
 }
@@ -298,7 +315,6 @@ void  MediaFrameListenerBridge::onMediaFrameAsync(std::chrono::milliseconds now,
 	//Get info
 	const MediaFrame::RtpPacketizationInfo& info = frame->GetRtpPacketizationInfo();
 
-	const BYTE *frameData = NULL;
 	DWORD frameSize = 0;
 	QWORD rate = 1000;
 	uint32_t pendingDuration = 0;
@@ -313,8 +329,6 @@ void  MediaFrameListenerBridge::onMediaFrameAsync(std::chrono::milliseconds now,
 			AudioFrame* audio = (AudioFrame*)frame.get();
 			// Note: This may truncate UNKNOWN but we do that many places elsewhere treating -1 == 0xFF == UNKNOWN so being consistent here as well
 			codec = audio->GetCodec();
-			//Get data
-			frameData = audio->GetData();
 			//Get size
 			frameSize = audio->GetLength();
 			//Set correct clock rate for audio codec
@@ -329,8 +343,6 @@ void  MediaFrameListenerBridge::onMediaFrameAsync(std::chrono::milliseconds now,
 			VideoFrame* video = (VideoFrame*)frame.get();
 			// Note: This may truncate UNKNOWN but we do that many places elsewhere treating -1 == 0xFF == UNKNOWN so being consistent here as well
 			codec = video->GetCodec();
-			//Get data
-			frameData = video->GetData();
 			//Get size
 			frameSize = video->GetLength();
 			//Set clock rate
@@ -426,8 +438,9 @@ void  MediaFrameListenerBridge::onMediaFrameAsync(std::chrono::milliseconds now,
 		//Set src
 		packet->SetSSRC(ssrc);
 		packet->SetExtSeqNum(extSeqNum++);
-		//Set data
-		packet->SetPayload(frameData+rtp.GetPos(),rtp.GetSize());
+		//Set data, copying it directly from the frame segments if not contiguous
+		frame->CopyMedia(rtp.GetPos(),rtp.GetSize(),packet->AdquireMediaData());
+		packet->SetMediaLength(rtp.GetSize());
 		//Add prefix
 		packet->PrefixPayload(rtp.GetPrefixData(),rtp.GetPrefixLen());
 		//Calculate timestamp
@@ -457,6 +470,28 @@ void  MediaFrameListenerBridge::onMediaFrameAsync(std::chrono::milliseconds now,
 			//get Video frame
 			VideoFrame* video = (VideoFrame*)frame.get();
 
+			//Find the layer frame of the packet
+			for (const auto& layer : video->GetLayerFrames())
+			{
+				//If it has been set by an svc encoder and the packet is on it
+				if (layer.dependencyDescriptor && rtp.GetPos()>=layer.pos && rtp.GetPos()<layer.pos+layer.size)
+				{
+					DependencyDescriptor dependencyDescriptor = *layer.dependencyDescriptor;
+					//Set frame boundaries
+					dependencyDescriptor.startOfFrame = rtp.GetPos()==layer.pos;
+					dependencyDescriptor.endOfFrame = rtp.GetPos()+rtp.GetSize()>=layer.pos+layer.size;
+					//Structure is only sent on first packet
+					if (!dependencyDescriptor.startOfFrame)
+						dependencyDescriptor.templateDependencyStructure.reset();
+					else if (dependencyDescriptor.templateDependencyStructure)
+						templateDependencyStructure = dependencyDescriptor.templateDependencyStructure;
+					//Set it
+					packet->SetDependencyDescriptor(dependencyDescriptor);
+					packet->OverrideTemplateDependencyStructure(templateDependencyStructure);
+					break;
+				}
+			}
+
 			//TODO: move out of here
 			VideoLayerSelector::GetLayerIds(packet);
 				
@@ -0,0 +1,187 @@
+#include "Metrics.h"
+#include "tools.h"
+#include <algorithm>
+#include <cmath>
+
+Metrics& Metrics::GetInstance()
+{
+	//Leaked on purpose so it can be used while other statics are destroyed
+	static Metrics* instance = new Metrics();
+	return *instance;
+}
+
+size_t Metrics::GetShard()
+{
+	static std::atomic<size_t> next = 0;
+	//Assign shards to threads round robin
+	thread_local size_t shard = next++ % Shards;
+	return shard;
+}
+
+QWORD Metrics::Counter::GetValue() const
+{
+	QWORD value = 0;
+	//Aggregate all shards
+	for (const auto& shard : shards)
+		value += shard.value.load(std::memory_order_relaxed);
+	return value;
+}
+
+size_t Metrics::Histogram::GetBucket(QWORD value)
+{
+	//Clamp value
+	value = std::min<QWORD>(value, (1ull << MaxBits) - 1);
+	//Small values are exact
+	if (value<SubBuckets)
+		return value;
+	//Get power of 2 and sub bucket inside it
+	BYTE msb = 63 - __builtin_clzll(value);
+	BYTE shift = msb - SubBucketBits;
+	return SubBuckets + shift * SubBuckets + ((value >> shift) - SubBuckets);
+}
+
+QWORD Metrics::Histogram::GetBucketUpperBound(size_t bucket)
+{
+	//Small values are exact
+	if (bucket<SubBuckets)
+		return bucket;
+	//Get power of 2 and sub bucket
+	BYTE shift = (bucket - SubBuckets) / SubBuckets;
+	QWORD mantissa = SubBuckets + (bucket - SubBuckets) % SubBuckets;
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void Metrics::Histogram::Record(QWORD value)
+{
+	Shard& shard = shards[GetShard()];
+	//Update it
+	shard.count.fetch_add(1, std::memory_order_relaxed);
+	shard.sum.fetch_add(value, std::memory_order_relaxed);
+	shard.buckets[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+	//Update max, only contended when threads share the shard
+	QWORD max = shard.max.load(std::memory_order_relaxed);
+	while (value>max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+}
+
+template<typename T>
+T& Metrics::Get(std::map<std::string,Entry<T>>& metrics, const std::string& name, const std::string& help)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	//Find it
+	auto it = metrics.find(name);
+	//If not found
+	if (it==metrics.end())
+		//Create it
+		it = metrics.emplace(name, Entry<T>{help, std::make_unique<T>()}).first;
+	return *it->second.metric;
+}
+
+Metrics::Counter& Metrics::GetCounter(const std::string& name, const std::string& help)
+{
+	return Get(counters, name, help);
+}
+
+Metrics::Gauge& Metrics::GetGauge(const std::string& name, const std::string& help)
+{
+	return Get(gauges, name, help);
+}
+
+Metrics::Histogram& Metrics::GetHistogram(const std::string& name, const std::string& help)
+{
+	return Get(histograms, name, help);
+}
+
+Metrics::Snapshot Metrics::GetSnapshot() const
+{
+	Snapshot snapshot;
+	snapshot.timestamp = getTimeMS();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (const auto& [name, entry] : counters)
+		snapshot.counters.push_back({name, entry.help, (int64_t)entry.metric->GetValue()});
+
+	for (const auto& [name, entry] : gauges)
+		snapshot.gauges.push_back({name, entry.help, entry.metric->GetValue()});
+
+	for (const auto& [name, entry] : histograms)
+	{
+		Snapshot::Distribution distribution;
+		distribution.name = name;
+		distribution.help = entry.help;
+
+		//Aggregate shards
+		std::array<QWORD,Histogram::Buckets> buckets = {};
+		for (const auto& shard : entry.metric->shards)
+		{
+			distribution.count += shard.count.load(std::memory_order_relaxed);
+			distribution.sum += shard.sum.load(std::memory_order_relaxed);
+			distribution.max = std::max(distribution.max, shard.max.load(std::memory_order_relaxed));
+			for (size_t i=0;i<Histogram::Buckets;++i)
+				buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+		}
+
+		//Only store non empty buckets
+		for (size_t i=0;i<Histogram::Buckets;++i)
+			if (buckets[i])
+				distribution.buckets.emplace_back(Histogram::GetBucketUpperBound(i), buckets[i]);
+
+		snapshot.histograms.push_back(std::move(distribution));
+	}
+
+	return snapshot;
+}
+
+QWORD Metrics::Snapshot::Distribution::GetQuantile(double quantile) const
+{
+	//Check we have values
+	if (!count)
+		return 0;
+
+	//Get rank of the value
+	QWORD rank = std::max<QWORD>(1, std::ceil(std::clamp(quantile, 0.0, 1.0) * count));
+
+	QWORD accumulated = 0;
+	for (const auto& [upper, num] : buckets)
+	{
+		accumulated += num;
+		//Bucket bound may be bigger than any recorded value
+		if (accumulated>=rank)
+			return std::min(upper, max);
+	}
+	return max;
+}
+
+std::string Metrics::Snapshot::ToPrometheus() const
+{
+	std::string out;
+
+	auto header = [&](const std::string& name, const std::string& help, const char* type) {
+		if (!help.empty())
+			out += "# HELP " + name + " " + help + "\n";
+		out += "# TYPE " + name + " " + type + "\n";
+	};
+
+	for (const auto& counter : counters)
+	{
+		header(counter.name, counter.help, "counter");
+		out += counter.name + " " + std::to_string(counter.value) + "\n";
+	}
+
+	for (const auto& gauge : gauges)
+	{
+		header(gauge.name, gauge.help, "gauge");
+		out += gauge.name + " " + std::to_string(gauge.value) + "\n";
+	}
+
+	for (const auto& histogram : histograms)
+	{
+		header(histogram.name, histogram.help, "summary");
+		for (const char* quantile : { "0.5", "0.9", "0.99", "0.999" })
+			out += histogram.name + "{quantile=\"" + quantile + "\"} " + std::to_string(histogram.GetQuantile(atof(quantile))) + "\n";
+		out += histogram.name + "_sum " + std::to_string(histogram.sum) + "\n";
+		out += histogram.name + "_count " + std::to_string(histogram.count) + "\n";
+	}
+
+	return out;
+}
@@ -75,14 +75,16 @@ void NetEventLoop::Send(const uint32_t ipAddr, const uint16_t port, Packet&& pac
 	//Move it back to sending queue
 	sending.enqueue(std::move(send));
 	
-	//Signal the thread this will cause the poll call to exit
-	Signal();
+	//If queue was empty
+	if (!writing.exchange(true))
+		//Wait also for write events, this will cause the poll call to exit
+		UpdatePollEventMask();
 }
 
 std::optional<uint16_t> NetEventLoop::GetPollEventMask(int fd) const
 {
 	//If we have anything to send set to wait also for write events
-	return sending.size_approx() ? (Poll::Event::In | Poll::Event::Out) : Poll::Event::In;
+	return writing ? (Poll::Event::In | Poll::Event::Out) : Poll::Event::In;
 }
 
 void NetEventLoop::OnPollIn(int fd)
@@ -235,6 +237,22 @@ void NetEventLoop::OnPollOut(int fd)
 	items.clear();
 	//Copy elements to retry
 	std::move(retry.begin(), retry.end(), std::back_inserter(items));
+	
+	//If there is still something to send
+	if (!items.empty() || sending.size_approx())
+		//Keep waiting for write events
+		return;
+	
+	//Sending queue is empty
+	writing = false;
+	
+	//Check again in case a packet was enqueued before clearing the flag, as it would not have updated the mask
+	if (sending.size_approx() && !writing.exchange(true))
+		//Keep waiting for write events
+		return;
+	
+	//Stop waiting for write events
+	UpdatePollEventMask();
 }
 
 void NetEventLoop::OnPollError(int fd, int errorCode)
@@ -33,6 +33,34 @@
 #include "ICERemoteCandidate.h"
 #include "EventLoop.h"
 #include "MacAddress.h"
+#include "LoopPlacement.h"
+
+//Bundles by loop, to map placements back to them
+static std::mutex bundlesMutex;
+static std::map<TimeService*,RTPBundleTransport*> bundles;
+
+static void AddBundle(RTPBundleTransport* bundle)
+{
+	std::lock_guard<std::mutex> lock(bundlesMutex);
+	bundles[&bundle->GetTimeService()] = bundle;
+	//Available for placing sinks
+	LoopPlacement::GetInstance().AddLoop(&bundle->GetTimeService());
+}
+
+static void RemoveBundle(RTPBundleTransport* bundle)
+{
+	std::lock_guard<std::mutex> lock(bundlesMutex);
+	//Not available for new sinks anymore
+	LoopPlacement::GetInstance().RemoveLoop(&bundle->GetTimeService());
+	bundles.erase(&bundle->GetTimeService());
+}
+
+static RTPBundleTransport* GetBundle(TimeService* loop)
+{
+	std::lock_guard<std::mutex> lock(bundlesMutex);
+	auto it = bundles.find(loop);
+	return it!=bundles.end() ? it->second : nullptr;
+}
 
 #ifndef __linux__
 void RTPBundleTransport::SetRawTx(int32_t ifindex, unsigned int sndbuf, bool skipQdisc, const std::string& selfLladdr, uint32_t defaultSelfAddr, const std::string& defaultDstLladdr, uint16_t port)
@@ -349,6 +377,8 @@ int RTPBundleTransport::Init()
 		Log("-RTPBundleTransport::Init() | Got port [%d]\n",port);
 		//Start receiving
 		loop.StartWithFd(socket);
+		//Available for placing sinks
+		AddBundle(this);
 		//Create ice timer
 		iceTimer = loop.CreateTimerUnsafe([=](std::chrono::milliseconds now){ this->onTimer(now); });
 		//Set name for debug
@@ -422,6 +452,8 @@ int RTPBundleTransport::Init(int port)
 	this->port = port;
 	//Start receiving
 	loop.StartWithFd(socket);
+	//Available for placing sinks
+	AddBundle(this);
 	
 	//Create ice timer
 	iceTimer = loop.CreateTimerUnsafe([=](std::chrono::milliseconds now){ this->onTimer(now); });
@@ -452,6 +484,9 @@ int RTPBundleTransport::End()
 		//Cancel it
 		iceTimer->Cancel();
 
+	//Not available for new sinks anymore
+	RemoveBundle(this);
+
 	//Stop loop
 	loop.Stop();
 
@@ -934,3 +969,39 @@ void RTPBundleTransport::onTimer(std::chrono::milliseconds now)
 			SendBindingRequest(connection, active);
 	}
 }
+
+RTPBundleTransport* RTPBundleTransport::PlaceSink(RTPBundleTransport* source, DWORD weight)
+{
+	//Get loop for the sink
+	auto loop = LoopPlacement::GetInstance().Place(&source->GetTimeService(), weight);
+	//Get its bundle
+	auto bundle = GetBundle(loop);
+	//If it has been ended meanwhile
+	if (!bundle)
+	{
+		//Do not account it
+		LoopPlacement::GetInstance().Release(loop, weight);
+		//Keep it with the source
+		return source;
+	}
+	return bundle;
+}
+
+void RTPBundleTransport::ReleaseSink(RTPBundleTransport* bundle, DWORD weight)
+{
+	LoopPlacement::GetInstance().Release(&bundle->GetTimeService(), weight);
+}
+
+std::optional<std::pair<RTPBundleTransport*,RTPBundleTransport*>> RTPBundleTransport::GetRebalance()
+{
+	//Check if loads are balanced
+	auto rebalance = LoopPlacement::GetInstance().GetRebalance();
+	if (!rebalance)
+		return std::nullopt;
+	//Get bundles
+	auto from = GetBundle(rebalance->first);
+	auto to = GetBundle(rebalance->second);
+	if (!from || !to)
+		return std::nullopt;
+	return std::make_pair(from, to);
+}
@@ -3,7 +3,25 @@
 #include <string.h>
 #include <algorithm>
 #include <arpa/inet.h>
+#include <chrono>
 #include "log.h"
+#include "Metrics.h"
+
+namespace
+{
+
+//Time spent on srtp, in nanoseconds
+Metrics::Histogram& ProtectTime		= Metrics::GetInstance().GetHistogram("srtp_protect_time_ns", "Time to protect an RTP packet in nanoseconds");
+Metrics::Histogram& UnprotectTime	= Metrics::GetInstance().GetHistogram("srtp_unprotect_time_ns", "Time to unprotect an RTP packet in nanoseconds");
+Metrics::Counter& ProtectErrors		= Metrics::GetInstance().GetCounter("srtp_protect_errors_total", "RTP and RTCP packets failed to be protected");
+Metrics::Counter& UnprotectErrors	= Metrics::GetInstance().GetCounter("srtp_unprotect_errors_total", "RTP and RTCP packets failed to be unprotected");
+
+QWORD GetElapsed(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
 
 SRTPSession::~SRTPSession()
 {
@@ -150,8 +168,12 @@ void SRTPSession::RemoveStream(uint32_t ssrc)
 size_t SRTPSession::ProtectRTP(uint8_t* data, size_t size)
 {
 	TRACE_EVENT("srtp", "SRTPSession::ProtectRTP", "size", size);
+	auto start = std::chrono::steady_clock::now();
 	int len = size;
 	err = (Status)srtp_protect(srtp,(uint8_t*)data,&len);
+	ProtectTime.Record(GetElapsed(start));
+	if (err!=Status::OK)
+		ProtectErrors.Add();
 	return err == Status::OK && len > 0 ? static_cast<size_t>(len) : 0;
 }
 
@@ -160,14 +182,20 @@ size_t SRTPSession::ProtectRTCP(uint8_t* data, size_t size)
 	TRACE_EVENT("srtp", "SRTPSession::ProtectRTCP", "size", size);
 	int len = size;
 	err = (Status)srtp_protect_rtcp(srtp,(uint8_t*)data,&len);
+	if (err!=Status::OK)
+		ProtectErrors.Add();
 	return err==Status::OK && len>0 ? static_cast<size_t>(len) : 0;
 }
 
 size_t SRTPSession::UnprotectRTP(uint8_t* data, size_t size)
 {
 	TRACE_EVENT("srtp", "SRTPSession::UnprotectRTP", "size", size);
+	auto start = std::chrono::steady_clock::now();
 	int len = size;
 	err = (Status)srtp_unprotect(srtp,(uint8_t*)data,&len);
+	UnprotectTime.Record(GetElapsed(start));
+	if (err!=Status::OK)
+		UnprotectErrors.Add();
 	return err==Status::OK && len>0 ? len : 0;
 }
 
@@ -177,6 +205,8 @@ size_t SRTPSession::UnprotectRTCP(uint8_t* data, size_t size)
 	TRACE_EVENT("srtp", "SRTPSession::UnprotectRTCP", "size", size);
 	int len = size;
 	err = (Status)srtp_unprotect_rtcp(srtp,(uint8_t*)data,&len);
+	if (err!=Status::OK)
+		UnprotectErrors.Add();
 	return err == Status::OK && len > 0 ? static_cast<size_t>(len) : 0;
 }
 
@@ -0,0 +1,202 @@
+#include "ScalabilityMode.h"
+#include <algorithm>
+
+ScalabilityMode::ScalabilityMode(BYTE spatialLayers, BYTE temporalLayers) :
+	spatialLayers(std::clamp<BYTE>(spatialLayers, 1, MaxSpatialLayers)),
+	temporalLayers(std::clamp<BYTE>(temporalLayers, 1, MaxTemporalLayers))
+{
+}
+
+std::optional<ScalabilityMode> ScalabilityMode::Parse(const std::string& name)
+{
+	//Only LxTy modes are supported
+	if (name.size()!=4 || name[0]!='L' || name[2]!='T')
+		return std::nullopt;
+
+	BYTE spatialLayers = name[1] - '0';
+	BYTE temporalLayers = name[3] - '0';
+
+	//Check limits
+	if (spatialLayers<1 || spatialLayers>MaxSpatialLayers || temporalLayers<1 || temporalLayers>MaxTemporalLayers)
+		return std::nullopt;
+
+	return ScalabilityMode(spatialLayers, temporalLayers);
+}
+
+std::string ScalabilityMode::ToString() const
+{
+	return "L" + std::to_string(spatialLayers) + "T" + std::to_string(temporalLayers);
+}
+
+BYTE ScalabilityMode::GetPeriodicity() const
+{
+	return temporalLayers==3 ? 4 : temporalLayers;
+}
+
+BYTE ScalabilityMode::GetTemporalLayerId(DWORD index) const
+{
+	switch (temporalLayers)
+	{
+		case 2:
+			return index % 2;
+		case 3:
+		{
+			static constexpr BYTE pattern[4] = { 0, 2, 1, 2 };
+			return pattern[index % 4];
+		}
+		default:
+			return 0;
+	}
+}
+
+BYTE ScalabilityMode::GetRateDecimator(BYTE temporalLayerId) const
+{
+	return 1 << (temporalLayers - 1 - std::min<BYTE>(temporalLayerId, temporalLayers - 1));
+}
+
+double ScalabilityMode::GetTemporalBitrateRatio(BYTE temporalLayerId) const
+{
+	//Accumulated ratios
+	static constexpr double ratios[MaxTemporalLayers][MaxTemporalLayers] = {
+		{ 1.0, 1.0, 1.0 },
+		{ 0.6, 1.0, 1.0 },
+		{ 0.4, 0.6, 1.0 },
+	};
+	return ratios[temporalLayers - 1][std::min<BYTE>(temporalLayerId, temporalLayers - 1)];
+}
+
+double ScalabilityMode::GetSpatialBitrateRatio(BYTE spatialLayerId) const
+{
+	//Each spatial layer doubles the bitrate of the lower one
+	return (double)(1 << spatialLayerId) / ((1 << spatialLayers) - 1);
+}
+
+ScalabilityMode::LayerFrameConfig ScalabilityMode::GetLayerFrameConfig(bool keyFrame, DWORD index, BYTE spatialLayerId) const
+{
+	LayerFrameConfig config;
+
+	//Position in the temporal pattern, restarted on key frames
+	BYTE position = keyFrame ? 0 : index % GetPeriodicity();
+
+	config.keyFrame = keyFrame;
+	config.spatialLayerId = spatialLayerId;
+	config.temporalLayerId = GetTemporalLayerId(position);
+
+	//Base temporal layer frames are always referenced by the next ones
+	if (config.temporalLayerId==0)
+		config.update = spatialLayerId;
+	//Middle temporal layer frames are referenced by the top ones
+	else if (config.temporalLayerId==1 && temporalLayers==3)
+		config.update = MaxSpatialLayers + spatialLayerId;
+	//Top temporal layer frames are only referenced by the upper spatial layer
+	else if (spatialLayerId+1<spatialLayers)
+		config.update = InterLayerBuffer;
+
+	//Only the last frame of the pattern references the middle temporal layer
+	if (!keyFrame)
+		config.temporalReference = temporalLayers==3 && position==3 ? MaxSpatialLayers + spatialLayerId : spatialLayerId;
+
+	//Upper spatial layers are predicted from the lower one
+	if (spatialLayerId)
+		config.interLayerReference = GetLayerFrameConfig(keyFrame, position, spatialLayerId - 1).update;
+
+	//Frames only depending on the base temporal layer allow switching up
+	config.layerSync = config.temporalLayerId && config.temporalReference==spatialLayerId;
+
+	//Templates are ordered by spatial and temporal layer, with the key frame first on each spatial layer
+	config.templateId = spatialLayerId * (1 + GetPeriodicity());
+	if (!keyFrame)
+		for (BYTE i=0;i<GetPeriodicity();++i)
+			if (GetTemporalLayerId(i)<config.temporalLayerId || (GetTemporalLayerId(i)==config.temporalLayerId && i<=position))
+				config.templateId++;
+
+	return config;
+}
+
+FrameDependencyTemplate ScalabilityMode::GetFrameDependencyTemplate(bool keyFrame, BYTE position, BYTE spatialLayerId) const
+{
+	FrameDependencyTemplate frameDependencyTemplate;
+
+	auto config = GetLayerFrameConfig(keyFrame, position, spatialLayerId);
+	frameDependencyTemplate.spatialLayerId = config.spatialLayerId;
+	frameDependencyTemplate.temporalLayerId = config.temporalLayerId;
+
+	//Decode targets are ordered by spatial and temporal layer
+	for (BYTE s=0;s<spatialLayers;++s)
+	{
+		for (BYTE t=0;t<temporalLayers;++t)
+		{
+			DecodeTargetIndication dti;
+			if (s<config.spatialLayerId || t<config.temporalLayerId)
+				dti = DecodeTargetIndication::NotPresent;
+			else if (keyFrame)
+				dti = DecodeTargetIndication::Switch;
+			//Upper spatial layers need it for inter layer prediction
+			else if (s>config.spatialLayerId)
+				dti = DecodeTargetIndication::Required;
+			//Referenced by next frames of the same spatial layer in the decode target
+			else if (config.temporalLayerId==0 || (t>config.temporalLayerId && config.update && config.update!=InterLayerBuffer))
+				dti = DecodeTargetIndication::Switch;
+			else
+				dti = DecodeTargetIndication::Discardable;
+			frameDependencyTemplate.decodeTargetIndications.push_back(dti);
+		}
+	}
+
+	//Frame numbers are increased on each layer frame, so superframes span over all the spatial layers
+	if (config.temporalReference)
+	{
+		//Distance in superframes to the referenced frame
+		BYTE distance = config.temporalLayerId==0 ? GetPeriodicity() : config.temporalReference==spatialLayerId ? position : 1;
+		frameDependencyTemplate.frameDiffs.push_back(distance * spatialLayers);
+	}
+	if (config.interLayerReference)
+		frameDependencyTemplate.frameDiffs.push_back(1);
+
+	//There is a chain for each spatial layer including its base temporal layer frames and the ones below
+	for (BYTE chain=0;chain<spatialLayers;++chain)
+	{
+		if (config.temporalLayerId==0 && spatialLayerId)
+			//Last one is on this superframe
+			frameDependencyTemplate.frameDiffsChains.push_back(spatialLayerId - std::min<BYTE>(spatialLayerId - 1, chain));
+		else if (keyFrame)
+			//Chain starts here
+			frameDependencyTemplate.frameDiffsChains.push_back(0);
+		else if (config.temporalLayerId==0)
+			//Last one is on previous base temporal layer superframe
+			frameDependencyTemplate.frameDiffsChains.push_back(GetPeriodicity() * spatialLayers - chain);
+		else
+			//Last one is on the base temporal layer superframe at the start of the pattern
+			frameDependencyTemplate.frameDiffsChains.push_back(position * spatialLayers + spatialLayerId - chain);
+	}
+
+	return frameDependencyTemplate;
+}
+
+TemplateDependencyStructure ScalabilityMode::GetTemplateDependencyStructure(uint32_t width, uint32_t height) const
+{
+	TemplateDependencyStructure structure;
+	structure.dtsCount = spatialLayers * temporalLayers;
+	structure.chainsCount = spatialLayers;
+
+	for (BYTE s=0;s<spatialLayers;++s)
+	{
+		//Templates are sorted by layer as required by the serialization
+		structure.frameDependencyTemplates.push_back(GetFrameDependencyTemplate(true, 0, s));
+		for (BYTE t=0;t<temporalLayers;++t)
+			for (BYTE i=0;i<GetPeriodicity();++i)
+				if (GetTemporalLayerId(i)==t)
+					structure.frameDependencyTemplates.push_back(GetFrameDependencyTemplate(false, i, s));
+
+		//Decode targets of the spatial layer are protected by its chain
+		for (BYTE t=0;t<temporalLayers;++t)
+			structure.decodeTargetProtectedByChain.push_back(s);
+
+		//Set resolution
+		structure.resolutions.push_back({ width >> GetSpatialScaleShift(s), height >> GetSpatialScaleShift(s) });
+	}
+
+	structure.CalculateLayerMapping();
+
+	return structure;
+}
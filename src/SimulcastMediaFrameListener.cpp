@@ -10,6 +10,10 @@ static constexpr uint32_t MaxWaitingTimeFindingFirstBestLayerMs = 300;
 // additional layer increases the max queue size by this value
 static constexpr uint32_t MaxQueueSizeFactor = 5;
 
+// Max size of the queued frames, so high bitrate layers do not grow the
+// queue unbounded while waiting for the other layers
+static constexpr size_t DefaultMaxQueueBytes = 32 * 1024 * 1024;
+
 constexpr uint32_t calcMaxQueueSize(DWORD numLayers)
 {
 	return numLayers > 0 ? (numLayers - 1) * MaxQueueSizeFactor : 0;
@@ -20,7 +24,8 @@ SimulcastMediaFrameListener::SimulcastMediaFrameListener(TimeService& timeServic
 	TimeServiceWrapper<SimulcastMediaFrameListener>(timeService),
 	forwardSsrc(ssrc),
 	numLayers(numLayers),
-	maxQueueSize(calcMaxQueueSize(numLayers))
+	maxQueueSize(calcMaxQueueSize(numLayers)),
+	maxQueueBytes(DefaultMaxQueueBytes)
 {
 }
 
@@ -104,6 +109,7 @@ void SimulcastMediaFrameListener::SetNumLayers(DWORD numLayers)
 		maxQueueSize = calcMaxQueueSize(numLayers);
 		initialised = false;
 		selectedSsrc = 0;
+		forwardingSsrc = 0;
 		lastEnqueueTimeMs = 0;
 		lastForwaredFrameTimeMs = 0;
 		lastForwardedTimestamp.reset();
@@ -112,10 +118,18 @@ void SimulcastMediaFrameListener::SetNumLayers(DWORD numLayers)
 		initialTimestamps.clear();
 		layerDimensions.clear();
 		queue.clear();
+		queueBytes = 0;
 		layerTimestamps.clear();
 	});
 }
 
+void SimulcastMediaFrameListener::SetMaxQueueBytes(size_t maxQueueBytes)
+{
+	Sync([this, maxQueueBytes](std::chrono::milliseconds) {
+		this->maxQueueBytes = maxQueueBytes;
+	});
+}
+
 
 void SimulcastMediaFrameListener::onMediaFrame(DWORD ssrc, const MediaFrame& frame)
 {
@@ -124,10 +138,31 @@ void SimulcastMediaFrameListener::onMediaFrame(DWORD ssrc, const MediaFrame& fra
 		//Uh?
 		return;
 
-	//Get cloned video frame
+	//Get video frame
+	const VideoFrame& videoFrame = static_cast<const VideoFrame&>(frame);
+
+	//Once a layer is selected, only intra frames of other layers can be forwarded.
+	//Pending intra frames are checked first, as they may change the selected layer
+	if (!videoFrame.IsIntra() && !pendingIntraFrames)
+	{
+		DWORD forwarding = forwardingSsrc;
+		//If it is from another layer
+		if (forwarding && ssrc!=forwarding)
+		{
+			//Drop it without cloning, but the layer timestamp is still needed to know when queued frames can be forwarded
+			PushTimestamp(ssrc, videoFrame.GetTimeStamp());
+			return;
+		}
+	}
+
+	//Get cloned video frame, sharing the media buffer
 	std::shared_ptr<VideoFrame> cloned(static_cast<VideoFrame*>(frame.Clone()));
 	cloned->SetSSRC(ssrc);
-	
+
+	//Until it is processed
+	if (cloned->IsIntra())
+		pendingIntraFrames++;
+
 	Push(std::move(cloned));
 }
 
@@ -155,7 +190,24 @@ void SimulcastMediaFrameListener::ForwardFrame(VideoFrame& frame)
 void SimulcastMediaFrameListener::Push(std::shared_ptr<VideoFrame>&& frame)
 {
 	AsyncSafe([this, frame = std::move(frame)](std::chrono::milliseconds now) mutable {
+		bool intra = frame->IsIntra();
 		PushAsync(now, std::move(frame));
+		//Update selected layer before releasing the intra frame
+		forwardingSsrc = initialised ? selectedSsrc : 0;
+		if (intra)
+			pendingIntraFrames--;
+	});
+}
+
+void SimulcastMediaFrameListener::PushTimestamp(DWORD ssrc, QWORD timestamp)
+{
+	AsyncSafe([this, ssrc, timestamp](std::chrono::milliseconds) {
+		//Check we have the initial timestamp of the layer
+		auto it = initialTimestamps.find(ssrc);
+		if (it == initialTimestamps.end())
+			return;
+		// Update the layer latest relative timestamp
+		layerTimestamps[ssrc] = int64_t(timestamp) > it->second ? int64_t(timestamp) - it->second : 0;
 	});
 }
 
@@ -237,7 +289,7 @@ void SimulcastMediaFrameListener::PushAsync(std::chrono::milliseconds now, std::
 		selectedSsrc = (*bestLayerFrame)->GetSSRC();
 		while(!queue.empty() && queue.front()->GetSSRC() != selectedSsrc)
 		{
-			queue.pop_front();
+			Dequeue(true);
 		}
 
 		initialised = true;
@@ -251,9 +303,10 @@ void SimulcastMediaFrameListener::Enqueue(std::shared_ptr<VideoFrame>&& frame)
 	// Check the queue to remove frames newer than current one
 	while(!queue.empty() && queue.back()->GetTimeStamp() >= frame->GetTimeStamp())
 	{
-		queue.pop_back();
+		Dequeue(false);
 	}
 
+	queueBytes += frame->GetLength();
 	queue.push_back(std::move(frame));
 
 	while (!queue.empty() && initialised)
@@ -267,10 +320,9 @@ void SimulcastMediaFrameListener::Enqueue(std::shared_ptr<VideoFrame>&& frame)
 
 		// forward the front frame if the queue is full or the time indicates the front
 		// is the earliest possible eligible frame
-		if (queue.size() > maxQueueSize || allLayersRecievedAtTimestamp)
+		if (queue.size() > maxQueueSize || queueBytes > maxQueueBytes || allLayersRecievedAtTimestamp)
 		{
-			auto f = std::move(queue.front());
-			queue.pop_front();
+			auto f = Dequeue(true);
 			ForwardFrame(*f);
 			lastForwardedTimestamp = f->GetTimeStamp();
 		}
@@ -281,12 +333,28 @@ void SimulcastMediaFrameListener::Enqueue(std::shared_ptr<VideoFrame>&& frame)
 	}
 }
 
+std::shared_ptr<VideoFrame> SimulcastMediaFrameListener::Dequeue(bool front)
+{
+	std::shared_ptr<VideoFrame> frame;
+	if (front)
+	{
+		frame = std::move(queue.front());
+		queue.pop_front();
+	}
+	else
+	{
+		frame = std::move(queue.back());
+		queue.pop_back();
+	}
+	queueBytes -= frame->GetLength();
+	return frame;
+}
+
 void SimulcastMediaFrameListener::Flush()
 {
 	while(!queue.empty())
 	{
-		auto f = std::move(queue.front());
-		queue.pop_front();
+		auto f = Dequeue(true);
 // Ignore coverity error: Attempting to access the managed object of an empty smart pointer "f".
 // coverity[dereference]
 		ForwardFrame(*f);
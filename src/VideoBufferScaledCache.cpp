@@ -0,0 +1,95 @@
+#include "VideoBufferScaledCache.h"
+#include "log.h"
+#include "tools.h"
+
+VideoBuffer::const_shared VideoBufferScaledCache::GetScaled(const VideoBuffer::const_shared& input, DWORD width, DWORD height, bool keepAspectRatio)
+{
+	//Check input
+	if (!input)
+		//Nothing to scale
+		return nullptr;
+
+	//If it is already on the requested size
+	if (input->GetWidth()==width && input->GetHeight()==height)
+		//Use it directly
+		return input;
+
+	//Get now
+	QWORD now = getTimeMS();
+
+	std::shared_ptr<Rendition> rendition;
+	{
+		ScopedLock scope(mutex);
+
+		//Find rendition and release the ones not used anymore
+		for (auto it = renditions.begin(); it!=renditions.end();)
+		{
+			//If it is the one we want
+			if ((*it)->width==width && (*it)->height==height && (*it)->keepAspectRatio==keepAspectRatio)
+			{
+				//Got it
+				rendition = *it;
+				//Update last usage
+				rendition->lastUsed = now;
+				//Next
+				++it;
+			} else if (now > (*it)->lastUsed + MaxIdleTime) {
+				//Remove it, any pending scaling will still hold a reference
+				it = renditions.erase(it);
+			} else {
+				//Next
+				++it;
+			}
+		}
+
+		//If not found
+		if (!rendition)
+		{
+			Debug("-VideoBufferScaledCache::GetScaled() | New rendition [width:%u,height:%u,keepAspectRatio:%d]\n",width,height,keepAspectRatio);
+			//Create new one
+			rendition = std::make_shared<Rendition>(width, height, keepAspectRatio);
+			//Set last usage
+			rendition->lastUsed = now;
+			//Add it
+			renditions.push_back(rendition);
+		}
+	}
+
+	//Only one consumer will scale each rendition
+	ScopedLock scope(rendition->mutex);
+
+	//Check if it has been already scaled for this input, buffers from pools are different objects after each reuse
+	if (rendition->output && !rendition->input.expired() && !rendition->input.owner_before(input) && !input.owner_before(rendition->input))
+	{
+		//Cache hit
+		cachedFrames++;
+		//Done
+		return rendition->output;
+	}
+
+	//Get new buffer
+	VideoBuffer::shared output = rendition->pool.Acquire();
+
+	//Rescale
+	if (!rendition->scaler.Resize(input, output, keepAspectRatio))
+		//Error
+		return nullptr;
+
+	//Copy timing
+	output->CopyTimingInfo(input);
+
+	//Store it
+	rendition->input = input;
+	rendition->output = output;
+	scaledFrames++;
+
+	//Done
+	return output;
+}
+
+void VideoBufferScaledCache::Clear()
+{
+	ScopedLock scope(mutex);
+	//Release all renditions
+	renditions.clear();
+}
@@ -11,6 +11,13 @@ extern "C" {
 #include <libavutil/common.h>
 }
 
+VideoBufferScaler::~VideoBufferScaler()
+{
+	//Free ctx
+	if (resizeCtx)
+		sws_freeContext(resizeCtx);
+}
+
 int VideoBufferScaler::Resize(const VideoBuffer::const_shared& input, const VideoBuffer::shared& output, bool keepAspectRatio)
 {
 	//Get planes
@@ -76,8 +83,9 @@ int VideoBufferScaler::Resize(const VideoBuffer::const_shared& input, const Vide
 		}
 	}
 
-	//Resize context
-	SwsContext* resizeCtx = sws_getContext(
+	//Get resize context, reusing previous one if sizes have not changed
+	resizeCtx = sws_getCachedContext(
+		resizeCtx,
 		srcWidth,
 		srcHeight,
 		AV_PIX_FMT_YUV420P,
@@ -120,15 +128,8 @@ int VideoBufferScaler::Resize(const VideoBuffer::const_shared& input, const Vide
 
 	// Resize frame 
 	if (sws_scale(resizeCtx, srcData, srcStride, 0, srcHeight, dstData, dstStride)<0)
-	{
-		//Free ctx
-		sws_freeContext(resizeCtx);
 		// Exit 
 		return Error("-VideoBufferScaler::Resize() | Scaling failed\n");
-	}
-	
-	//Free ctx
-	sws_freeContext(resizeCtx);
 
 	//Done
 	return 1;
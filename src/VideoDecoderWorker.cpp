@@ -1,6 +1,7 @@
 #include "VideoDecoderWorker.h"
 #include "media.h"
 #include "VideoCodecFactory.h"
+#include "Metrics.h"
 
 VideoDecoderWorker::VideoDecoderWorker() :
 	bitrateAcu(1000),
@@ -28,23 +29,16 @@ int VideoDecoderWorker::Start()
 	//Start decoding
 	decoding = 1;
 
-	//launc thread
-	createPriorityThread(&thread,startDecoding,this,0);
+	//Reset counters
+	num = 0;
+	waitFrameStart = getTimeMS();
+
+	//Decode frames in order on the shared executor
+	ScopedLock scope(mutex);
+	strand = Executor::GetDefault().CreateStrand();
 
 	return 1;
 }
-void * VideoDecoderWorker::startDecoding(void *par)
-{
-	Log("VideoDecoderThread [%lu]\n",pthread_self());
-	//Get worker
-	VideoDecoderWorker *worker = (VideoDecoderWorker *)par;
-	//Block all signals
-	blocksignals();
-	//Run
-	worker->Decode();
-	//Exit
-	return NULL;;
-}
 
 int  VideoDecoderWorker::Stop()
 {
@@ -56,11 +50,15 @@ int  VideoDecoderWorker::Stop()
 	//Stop
 	decoding=0;
 
-	//Cancel any pending wait
-	frames.Cancel();
+	Executor::Strand::shared stopped;
+	{
+		ScopedLock scope(mutex);
+		//No more frames will be posted
+		stopped = std::move(strand);
+	}
 
-	//Esperamos
-	pthread_join(thread,NULL);
+	//Drop pending frames and wait for current one, without holding the lock as decoding needs it
+	stopped->Close();
 
 	Log("<VideoDecoderWorker::Stop()\n");
 
@@ -77,6 +75,8 @@ void VideoDecoderWorker::AddVideoOutput(VideoOutput* output)
 	ScopedLock scope(mutex);
 	//Add it
 	outputs.insert(output);
+	//Share scaled renditions between all outputs
+	output->SetScaledCache(scaledCache);
 
 }
 
@@ -84,34 +84,18 @@ void VideoDecoderWorker::RemoveVideoOutput(VideoOutput* output)
 {
 	ScopedLock scope(mutex);
 	//Remove from ouput
-	outputs.erase(output);
+	if (outputs.erase(output))
+		//Not shared anymore
+		output->SetScaledCache(nullptr);
 }
 
-int VideoDecoderWorker::Decode()
+void VideoDecoderWorker::Decode(const std::shared_ptr<VideoFrame>& videoFrame)
 {
-	DWORD num = 0;
-
-	Log(">VideoDecoderWorker::Decode()\n");
+	static auto& decodingTime = Metrics::GetInstance().GetHistogram("video_decoding_time_ms", "Time to decode a video frame in milliseconds");
 
-	//Waif for frame time init
-	uint64_t waitFrameStart = getTimeMS();
-
-	//Mientras tengamos que capturar
-	while(decoding)
+	//Run the decoding once, so we can return at any point
+	do
 	{
-		//Wait for an incoming frame
-		if (!frames.Wait(0))
-			//Done
-			break;
-
-		//Get frame from queue
-		auto videoFrame = frames.Pop();
-
-		//Check
-		if (!videoFrame)
-			//Check condition again
-			continue;
-
 		//Get waif time end
 		uint64_t waitFrameEnd = getTimeMS();
 
@@ -127,7 +111,7 @@ int VideoDecoderWorker::Decode()
 			//Check we found one
 			if (!videoDecoder)
 				//Skip
-				continue;
+				break;
 		}
 		
 		//Get time before decode
@@ -136,7 +120,7 @@ int VideoDecoderWorker::Decode()
 		//Decode packet
 		if(!videoDecoder->Decode(videoFrame))
 			//Skip
-			continue;
+			break;
 			
 		//Increase deocder frames
 		num ++;
@@ -146,6 +130,7 @@ int VideoDecoderWorker::Decode()
 
 		//Calculate encoding time
 		decodingTimeAcu.Update(decodeEndTime, decodeEndTime - decodeStartTime);
+		decodingTime.Record(decodeEndTime - decodeStartTime);
 
 		//Increase frame counter
 		fpsAcu.Update(decodeEndTime, 1);
@@ -234,14 +219,10 @@ int VideoDecoderWorker::Decode()
 			}
 		}
 
-		//Waif for frame time init
-		waitFrameStart = getTimeMS();
-	}
-
-	Log("<VideoDecoderWorker::Decode()\n");
+	} while(false);
 
-	//Exit
-	return 0;
+	//Waif for frame time init
+	waitFrameStart = getTimeMS();
 }
 
 void VideoDecoderWorker::onMediaFrame(const MediaFrame& frame)
@@ -253,8 +234,16 @@ void VideoDecoderWorker::onMediaFrame(const MediaFrame& frame)
 		return;
 	}
 
-	//Put it on the queue
-	frames.Add(std::shared_ptr<VideoFrame>(static_cast<VideoFrame*>(frame.Clone())));
+	//Clone frame
+	std::shared_ptr<VideoFrame> videoFrame(static_cast<VideoFrame*>(frame.Clone()));
+
+	ScopedLock scope(mutex);
+	//Check we are decoding
+	if (!strand)
+		//Ignore
+		return;
+	//Decode it on the strand
+	strand->Post([this,videoFrame]() { Decode(videoFrame); });
 }
 
 VideoDecoderWorker::Stats VideoDecoderWorker::GetStats()
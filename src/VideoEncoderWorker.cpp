@@ -10,6 +10,7 @@
 #include "tools.h"
 #include "acumulator.h"
 #include "VideoCodecFactory.h"
+#include "Metrics.h"
 
 VideoEncoderWorker::VideoEncoderWorker() :
 	bitrateAcu(1000),
@@ -147,6 +148,8 @@ int VideoEncoderWorker::Encode()
 	
 	DWORD num = 0;
 
+	static auto& encodingTime = Metrics::GetInstance().GetHistogram("video_encoding_time_ms", "Time to encode a video frame in milliseconds");
+
 	Log(">VideoEncoderWorker::Encode() [width:%d,height:%d,bitrate:%d,fps:%d,intra:%d]\n",width,height,bitrate,fps,intraPeriod);
 
 	//Create encoder
@@ -242,6 +245,7 @@ int VideoEncoderWorker::Encode()
 
 		//Calculate encoding time
 		encodingTimeAcu.Update(encodeEndTime, encodeEndTime - encodeStartTime);
+		encodingTime.Record(encodeEndTime - encodeStartTime);
 		
 		//Increase frame counter
 		fpsAcu.Update(encodeEndTime, 1);
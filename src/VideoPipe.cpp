@@ -7,7 +7,8 @@
 VideoPipe::VideoPipe() : 
 	// Want a non growing queue
 	queue(MaxOutstandingFramesDefault, false),
-	videoBufferPool(MaxOutstandingFramesDefault, MaxOutstandingFramesDefault + 2)
+	videoBufferPool(MaxOutstandingFramesDefault, MaxOutstandingFramesDefault + 2),
+	scaledCache(std::make_shared<VideoBufferScaledCache>())
 {
 	//Init mutex
 	pthread_mutex_init(&newPicMutex,0);
@@ -292,21 +293,16 @@ VideoBuffer::const_shared VideoPipe::GrabFrame(uint32_t timeout)
 
 	//If we got a frame and it is from a different size
 	if (videoBuffer->GetWidth() != videoWidth || videoBuffer->GetHeight() != videoHeight)
-	{
-		//Get new buffer
-		VideoBuffer::shared resized = videoBufferPool.Acquire();
-
-		//Rescale
-		scaler.Resize(videoBuffer, resized, true);
-
-		resized->CopyTimingInfo(videoBuffer);
-
-		//Swap buffers
-		videoBuffer = std::move(resized);
-	}
+		//Rescale, or reuse the rendition already scaled by other output of the same source
+		videoBuffer = scaledCache->GetScaled(videoBuffer, videoWidth, videoHeight, true);
   
 	//Unlock
 	pthread_mutex_unlock(&newPicMutex);
+
+	//Check scaling didn't fail
+	if (!videoBuffer)
+		//Skip frame
+		return nullptr;
   
 	//If we got timestamps in the video buffer
 	if (videoBuffer->HasTimestamp())
@@ -405,6 +401,18 @@ size_t VideoPipe::NextFrame(const VideoBuffer::const_shared& videoBuffer)
 	return qsize;
 }
 
+void VideoPipe::SetScaledCache(const std::shared_ptr<VideoBufferScaledCache>& scaledCache)
+{
+	//Lock
+	pthread_mutex_lock(&newPicMutex);
+
+	//Use shared one or go back to our own
+	this->scaledCache = scaledCache ? scaledCache : std::make_shared<VideoBufferScaledCache>();
+
+	//Unlock
+	pthread_mutex_unlock(&newPicMutex);
+}
+
 void VideoPipe::ClearFrame()
 {
 	//Get new buffer
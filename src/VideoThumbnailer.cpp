@@ -0,0 +1,289 @@
+#include "VideoThumbnailer.h"
+#include "log.h"
+#include "tools.h"
+#include "VideoCodecFactory.h"
+#include "VideoBufferScaler.h"
+#include "Metrics.h"
+
+Executor& VideoThumbnailer::GetExecutor()
+{
+	//Use a small pool so snapshots of all the streams never take over the cores used by the media workers
+	static Executor executor(std::max(1u, std::thread::hardware_concurrency() / 4), "thumbnailer");
+	//And only run them when the cores are not needed by anything else
+	static bool idle = executor.SetIdlePriority();
+	//Check
+	if (!idle)
+		Warning("-VideoThumbnailer::GetExecutor() | Could not set idle priority on snapshot threads\n");
+	return executor;
+}
+
+VideoThumbnailer::VideoThumbnailer(VideoCodec::Type codec, DWORD width, QWORD interval) :
+	codec(codec),
+	width(width),
+	interval(interval)
+{
+}
+
+VideoThumbnailer::~VideoThumbnailer()
+{
+	Stop();
+}
+
+int VideoThumbnailer::Start()
+{
+	Log("-VideoThumbnailer::Start() [codec:%s,width:%u,interval:%llu]\n", VideoCodec::GetNameFor(codec), width, interval);
+
+	ScopedLock scope(mutex);
+	//Check if already started
+	if (strand)
+		return 0;
+	//Snapshots of this stream are taken in order
+	strand = GetExecutor().CreateStrand();
+
+	return 1;
+}
+
+int VideoThumbnailer::Stop()
+{
+	Executor::Strand::shared stopped;
+	{
+		ScopedLock scope(mutex);
+		//No more snapshots will be posted
+		stopped = std::move(strand);
+		//Drop buffered frames
+		pending.clear();
+		requested.reset();
+	}
+
+	//Check if it was started
+	if (!stopped)
+		return 0;
+
+	Log("-VideoThumbnailer::Stop()\n");
+
+	//Drop pending snapshots and wait for current one, without holding the lock as snapshots need it
+	stopped->Close();
+
+	//Not taking any snapshot
+	busy = false;
+
+	return 1;
+}
+
+void VideoThumbnailer::Request(QWORD time)
+{
+	ScopedLock scope(mutex);
+	//Start buffering from next intra frame
+	requested = time;
+	pending.clear();
+}
+
+VideoFrame::const_shared VideoThumbnailer::GetThumbnail()
+{
+	ScopedLock scope(mutex);
+	return thumbnail;
+}
+
+void VideoThumbnailer::onMediaFrame(const MediaFrame& frame)
+{
+	//Ensure it is video
+	if (frame.GetType()!=MediaFrame::Video)
+		return;
+
+	//Get video frame
+	const VideoFrame& video = static_cast<const VideoFrame&>(frame);
+
+	ScopedLock scope(mutex);
+
+	//Check we are started
+	if (!strand)
+		//Ignore
+		return;
+
+	//If we are waiting for a requested time
+	if (requested)
+	{
+		//Restart decoding from each intra frame
+		if (video.IsIntra())
+			pending.clear();
+
+		//We can only decode from an intra frame
+		if (pending.empty() && !video.IsIntra())
+			//Wait for next one
+			return;
+
+		//Check we don't buffer too much
+		if (pending.size()>=MaxPendingFrames)
+		{
+			Warning("-VideoThumbnailer::onMediaFrame() | Too many frames before requested time, waiting for next intra frame [time:%llu,requested:%llu]\n", video.GetTime(), *requested);
+			//Drop them
+			pending.clear();
+			return;
+		}
+
+		//Buffer it
+		pending.emplace_back(static_cast<VideoFrame*>(video.Clone()));
+
+		//If not reached yet
+		if (video.GetTime()<*requested)
+			//Wait
+			return;
+
+		//Done
+		requested.reset();
+		last = getTimeMS();
+		busy = true;
+
+		//Decode all frames up to the requested one
+		strand->Post([this,frames = std::move(pending)]() {
+			Snapshot(frames, false);
+		});
+		pending.clear();
+		return;
+	}
+
+	//Only intra frames are decoded
+	if (!video.IsIntra())
+		return;
+
+	//Get now
+	QWORD now = getTimeMS();
+
+	//Skip if previous one is still being processed or it is too early
+	if (busy || (last && now<last+interval))
+		return;
+
+	//Take snapshot
+	last = now;
+	busy = true;
+
+	//Clone frame
+	VideoFrame::const_shared intra(static_cast<VideoFrame*>(video.Clone()));
+
+	//Decode it alone
+	strand->Post([this,intra]() {
+		Snapshot({intra}, true);
+	});
+}
+
+void VideoThumbnailer::Snapshot(const std::vector<VideoFrame::const_shared>& frames, bool intraOnly)
+{
+	static auto& snapshotTime = Metrics::GetInstance().GetHistogram("video_thumbnail_time_ms", "Time to decode, scale and encode a video thumbnail in milliseconds");
+
+	//Get start time
+	QWORD start = getTimeMS();
+
+	//Take it
+	VideoFrame* snapshot = CreateSnapshot(frames, intraOnly);
+
+	//Record time
+	snapshotTime.Record(getTimeMS() - start);
+
+	ScopedLock scope(mutex);
+
+	//If we got it
+	if (snapshot)
+	{
+		//Set time of the stream frame
+		snapshot->SetTime(frames.back()->GetTime());
+		snapshot->SetTimestamp(frames.back()->GetTimestamp());
+		snapshot->SetClockRate(frames.back()->GetClockRate());
+		//Store it
+		thumbnail.reset(snapshot);
+		snapshots++;
+	}
+
+	//Ready for next one
+	busy = false;
+}
+
+VideoFrame* VideoThumbnailer::CreateSnapshot(const std::vector<VideoFrame::const_shared>& frames, bool intraOnly)
+{
+	//Create decoder only for this snapshot
+	std::unique_ptr<VideoDecoder> decoder(VideoCodecFactory::CreateDecoder(frames.front()->GetCodec()));
+
+	//Check we found one
+	if (!decoder)
+		//Skip
+		return nullptr;
+
+	//Errors will not propagate if only decoding intra frames, so favour speed over quality
+	decoder->SetPreview(intraOnly);
+
+	VideoBuffer::shared picture;
+
+	//Decode all frames, keeping last picture
+	for (const auto& frame : frames)
+	{
+		//Decode it
+		decoder->Decode(frame);
+		//Get decoded pictures
+		while (auto videoBuffer = decoder->GetFrame())
+			picture = videoBuffer;
+	}
+
+	//Flush decoder
+	decoder->Decode(nullptr);
+	//Get remaining pictures
+	while (auto videoBuffer = decoder->GetFrame())
+		picture = videoBuffer;
+
+	//Check we got something
+	if (!picture || !picture->GetWidth() || !picture->GetHeight())
+	{
+		Warning("-VideoThumbnailer::CreateSnapshot() | Could not decode frame [codec:%s,frames:%zu]\n", VideoCodec::GetNameFor(frames.front()->GetCodec()), frames.size());
+		return nullptr;
+	}
+
+	//Get display aspect ratio
+	double aspectRatio = (double)picture->GetWidth() / picture->GetHeight();
+	//Correct non square pixels
+	if (picture->HasNonSquarePixelAspectRatio() && picture->GetPixelAspectRatio().second)
+		aspectRatio = aspectRatio * picture->GetPixelAspectRatio().first / picture->GetPixelAspectRatio().second;
+
+	//Never upscale, dimensions must be even
+	DWORD thumbnailWidth = std::min<DWORD>(width, picture->GetWidth()) & ~1;
+	DWORD thumbnailHeight = (DWORD)(thumbnailWidth / aspectRatio) & ~1;
+
+	//Check size
+	if (!thumbnailWidth || !thumbnailHeight)
+		return nullptr;
+
+	VideoBuffer::const_shared scaled = picture;
+
+	//If it needs to be resized
+	if (thumbnailWidth!=picture->GetWidth() || thumbnailHeight!=picture->GetHeight())
+	{
+		//Create output buffer, not pooled as thumbnails are sparse
+		auto output = std::make_shared<VideoBuffer>(thumbnailWidth, thumbnailHeight);
+		VideoBufferScaler scaler;
+		//Aspect ratio is already handled by the output size
+		if (!scaler.Resize(picture, output, false))
+			return nullptr;
+		//Copy timing
+		output->CopyTimingInfo(picture);
+		scaled = output;
+	}
+
+	//Create encoder only for this snapshot
+	Properties properties;
+	std::unique_ptr<VideoEncoder> encoder(VideoCodecFactory::CreateEncoder(codec, properties));
+
+	//Check we found one
+	if (!encoder)
+		return nullptr;
+
+	//Set size and rate
+	if (!encoder->SetSize(thumbnailWidth, thumbnailHeight) || !encoder->SetFrameRate(1, 0, 0))
+		return nullptr;
+
+	//Encode it
+	VideoFrame* encoded = encoder->EncodeFrame(scaled);
+
+	//Check
+	if (!encoded)
+		return nullptr;
+
+	//Copy it, as encoded one is owned by the encoder
+	return static_cast<VideoFrame*>(encoded->Clone());
+}
@@ -121,8 +121,8 @@ MediaFrame* AV1Depacketizer::AddPacket(const RTPPacket::shared& packet)
 			}
 		}
 		
-		//Add payload
-		AddPayload(packet->GetMediaData(), packet->GetMediaLength());
+		//Add payload, referencing packet data instead of copying it
+		AddPayload(packet->GetMediaData(), packet->GetMediaLength(), packet->SharePayload());
 
 		//IF it is the first last packet of the layer frame
 		if (dependencyDescriptor && dependencyDescriptor->endOfFrame)
@@ -134,8 +134,8 @@ MediaFrame* AV1Depacketizer::AddPacket(const RTPPacket::shared& packet)
 
 		}
 	} else {
-		//Add payload
-		AddPayload(packet->GetMediaData(), packet->GetMediaLength());
+		//Add payload, referencing packet data instead of copying it
+		AddPayload(packet->GetMediaData(), packet->GetMediaLength(), packet->SharePayload());
 	}
 
 
@@ -181,6 +181,12 @@ MediaFrame* AV1Depacketizer::AddPacket(const RTPPacket::shared& packet)
 }
 
 MediaFrame* AV1Depacketizer::AddPayload(const BYTE* payload, DWORD len)
+{
+	//No owner, data will be copied
+	return AddPayload(payload, len, nullptr);
+}
+
+MediaFrame* AV1Depacketizer::AddPayload(const BYTE* payload, DWORD len, const RTPPayload::shared& owner)
 {
 	//Check length
 	if (!len)
@@ -273,8 +279,8 @@ MediaFrame* AV1Depacketizer::AddPayload(const BYTE* payload, DWORD len)
 				{
 					//We have a complete obu in the fragment
 					BufferReader obu(fragment);
-					// add to frame
-					AddObu(obu);
+					// add to frame, copying it as the fragment buffer is reused
+					AddObu(obu, nullptr);
 					//Reset fragment data
 					fragment.Reset();
 				}
@@ -290,7 +296,7 @@ MediaFrame* AV1Depacketizer::AddPayload(const BYTE* payload, DWORD len)
 		//It is a complete obu element
 		} else {
 			//Add obu to frame
-			AddObu(element);
+			AddObu(element, owner);
 		}
 
 		//One more obu
@@ -301,7 +307,7 @@ MediaFrame* AV1Depacketizer::AddPayload(const BYTE* payload, DWORD len)
 }
 
 
-void AV1Depacketizer::AddObu(BufferReader& obu)
+void AV1Depacketizer::AddObu(BufferReader& obu, const RTPPayload::shared& owner)
 {
 	//Get obu header
 	uint8_t header = obu.Get1();
@@ -369,5 +375,6 @@ void AV1Depacketizer::AddObu(BufferReader& obu)
 	}
 
 	//Write the rest of the obu
-	frame.AppendMedia(obu);
+	DWORD size = obu.GetLeft();
+	frame.AppendMediaReference(owner, obu.GetData(size), size);
 }
\ No newline at end of file
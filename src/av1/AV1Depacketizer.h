@@ -14,7 +14,8 @@ public:
 	virtual MediaFrame* AddPayload(const BYTE* payload,DWORD payload_len) override;
 	virtual void ResetFrame() override;
 private:
-	void AddObu(BufferReader& obu);
+	MediaFrame* AddPayload(const BYTE* payload,DWORD payloadLen,const RTPPayload::shared& owner);
+	void AddObu(BufferReader& obu,const RTPPayload::shared& owner);
 private:
 	Buffer fragment;
 	VideoFrame frame;
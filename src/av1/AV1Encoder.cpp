@@ -48,6 +48,14 @@ AV1Encoder::AV1Encoder(const Properties& properties) : frame(VideoCodec::AV1)
 	noiseReductionSensitivity = properties.GetProperty("av1.noise_sensitivity", 0);
 	aqMode = properties.GetProperty("av1.aq_mode", 3);
 
+	//Get scalability mode
+	std::string mode = properties.GetProperty("av1.scalability_mode", std::string("L1T1"));
+	//Parse it
+	if (auto parsed = ScalabilityMode::Parse(mode))
+		scalabilityMode = *parsed;
+	else
+		Warning("-AV1Encoder::AV1Encoder() | Unknown scalability mode, not using layers [mode:%s]\n", mode.c_str());
+
 	//Disable sharing buffer on clone
 	frame.DisableSharedBuffer();
 
@@ -84,6 +92,9 @@ int AV1Encoder::SetSize(int width, int height)
 	this->width = width;
 	this->height = height;
 
+	//Resolutions have changed
+	templateDependencyStructure.reset();
+
 	// Open codec
 	return OpenCodec();
 }
@@ -113,7 +124,8 @@ int AV1Encoder::SetFrameRate(int frames, int kbits, int intraPeriod)
 		//Reconfig parameters
 		UltraDebug("AV1Encoder::SetFrameRate() | Reset codec config with bitrate: %d, frames: %d, max_keyframe_bitrate_pct: %d\n", bitrate, frames, maxKeyFrameBitratePct);
 		config.rc_target_bitrate = bitrate;
-		config.kf_mode = intraPeriod ? AOM_KF_AUTO : AOM_KF_DISABLED;
+		//Key frames are forced by us when using layers
+		config.kf_mode = intraPeriod && !scalabilityMode.IsLayered() ? AOM_KF_AUTO : AOM_KF_DISABLED;
 		config.kf_max_dist = intraPeriod;
 		//Reconfig
 		if (aom_codec_enc_config_set(&encoder, &config) != AOM_CODEC_OK)
@@ -126,6 +138,8 @@ int AV1Encoder::SetFrameRate(int frames, int kbits, int intraPeriod)
 		//	beyond the codec's built-in algorithm.
 		//	For example, to allocate no more than 4.5 frames worth of bitrate to a keyframe, set this to 450.
 		aom_codec_control(&encoder, AOME_SET_MAX_INTRA_BITRATE_PCT, maxKeyFrameBitratePct);
+		//Set layer bitrates
+		ConfigureLayers();
 	}
 
 	return 1;
@@ -166,7 +180,7 @@ int AV1Encoder::OpenCodec()
 	config.rc_dropframe_thresh = 0;
 	config.rc_end_usage = endUsage;
 	config.g_pass = AOM_RC_ONE_PASS;
-	config.kf_mode = intraPeriod ? AOM_KF_AUTO : AOM_KF_DISABLED;
+	config.kf_mode = intraPeriod && !scalabilityMode.IsLayered() ? AOM_KF_AUTO : AOM_KF_DISABLED;
 	config.kf_min_dist = 0;
 	config.kf_max_dist = intraPeriod;
 	config.rc_min_quantizer = minQuantizer;
@@ -331,6 +345,9 @@ int AV1Encoder::OpenCodec()
 	SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_MAX_REFERENCE_FRAMES, 3);
 #endif
 
+	//Set spatial and temporal layers
+	ConfigureLayers();
+
 	// We are opened
 	opened = true;
 
@@ -340,6 +357,36 @@ int AV1Encoder::OpenCodec()
 	return 1;
 }
 
+void AV1Encoder::ConfigureLayers()
+{
+	//Check if we are using svc
+	if (!scalabilityMode.IsLayered())
+		return;
+
+	aom_svc_params_t svc = {};
+	svc.number_spatial_layers = scalabilityMode.GetSpatialLayers();
+	svc.number_temporal_layers = scalabilityMode.GetTemporalLayers();
+	for (BYTE s=0;s<scalabilityMode.GetSpatialLayers();++s)
+	{
+		//Each spatial layer halves the resolution of the upper one
+		svc.scaling_factor_num[s] = 1;
+		svc.scaling_factor_den[s] = 1 << scalabilityMode.GetSpatialScaleShift(s);
+		for (BYTE t=0;t<scalabilityMode.GetTemporalLayers();++t)
+		{
+			BYTE i = s * scalabilityMode.GetTemporalLayers() + t;
+			svc.max_quantizers[i] = maxQuantizer;
+			svc.min_quantizers[i] = minQuantizer;
+			//Bitrate of each temporal layer is accumulated inside each spatial layer
+			svc.layer_target_bitrate[i] = bitrate * scalabilityMode.GetSpatialBitrateRatio(s) * scalabilityMode.GetTemporalBitrateRatio(t);
+		}
+	}
+	for (BYTE t=0;t<scalabilityMode.GetTemporalLayers();++t)
+		svc.framerate_factor[t] = scalabilityMode.GetRateDecimator(t);
+
+	if (aom_codec_control(&encoder, AV1E_SET_SVC_PARAMS, &svc) != AOM_CODEC_OK)
+		Error("-AV1Encoder::ConfigureLayers() | Error setting svc params [error %d:%s]\n", encoder.err, encoder.err_detail);
+}
+
 int AV1Encoder::FastPictureUpdate()
 {
 	forceKeyFrame = true;
@@ -367,6 +414,15 @@ VideoFrame* AV1Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 		forceKeyFrame = false;
 	}
 
+	//Check if key frames are due
+	if (scalabilityMode.IsLayered() && intraPeriod && layerIndex>=(DWORD)intraPeriod)
+		flags = AOM_EFLAG_FORCE_KF;
+
+	//Restart pattern on key frames
+	bool keyFrame = flags & AOM_EFLAG_FORCE_KF || !layerIndex;
+	if (keyFrame)
+		layerIndex = 0;
+
 	uint32_t duration = 1000 / fps;
 
 	if (videoBuffer)
@@ -423,42 +479,75 @@ VideoFrame* AV1Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 				//Unknown
 				pic->cs = AOM_CS_UNKNOWN;
 		}*/
+	}
 
-		if (aom_codec_encode(&encoder, pic, pts, duration, flags) != AOM_CODEC_OK)
-		{
-			//Error
-			Error("-AV1Encoder::EncodeFrame() | Encode error [error %d:%s]\n", encoder.err, encoder.err_detail);
+	//Set width and height
+	frame.SetWidth(width);
+	frame.SetHeight(height);
+
+	//Emtpy rtp info
+	frame.ClearRTPPacketizationInfo();
+	frame.ClearLayerFrames();
+
+	//Emtpy
+	frame.SetLength(0);
+	frame.SetIntra(false);
+
+	//Encode each spatial layer on its own with the same timestamp, only first one is intra
+	for (BYTE spatialLayerId=0; spatialLayerId<scalabilityMode.GetSpatialLayers(); ++spatialLayerId)
+		if (!EncodeLayerFrame(videoBuffer, duration, spatialLayerId ? flags & ~AOM_EFLAG_FORCE_KF : flags, scalabilityMode.GetLayerFrameConfig(keyFrame, layerIndex, spatialLayerId)))
 			//Exit
 			return nullptr;
-		}
-	}
-	// end of stream, flushing buffered encoded frame
-	else
+
+	//Increase timestamp
+	pts += duration;
+	//Next frame in pattern
+	layerIndex++;
+
+	//Debug("<AV1Encoder::EncodeFrame()\n");
+
+	return &frame;
+}
+
+bool AV1Encoder::EncodeLayerFrame(const VideoBuffer::const_shared& videoBuffer, uint32_t duration, int flags, const ScalabilityMode::LayerFrameConfig& layer)
+{
+	//Set layer and references to use
+	if (scalabilityMode.IsLayered())
 	{
-		if (aom_codec_encode(&encoder, nullptr, pts, duration, flags) != AOM_CODEC_OK)
+		aom_svc_layer_id_t layerId = {};
+		layerId.spatial_layer_id = layer.spatialLayerId;
+		layerId.temporal_layer_id = layer.temporalLayerId;
+		aom_codec_control(&encoder, AV1E_SET_SVC_LAYER_ID, &layerId);
+
+		aom_svc_ref_frame_config_t refFrameConfig = {};
+		//Previous frame of the same spatial layer is used as LAST
+		if (layer.temporalReference)
 		{
-			//Error
-			Error("-AV1Encoder::EncodeFrame() | Encode error [error %d:%s]\n", encoder.err, encoder.err_detail);
-			//Exit
-			return nullptr;
+			refFrameConfig.reference[0] = 1;
+			refFrameConfig.ref_idx[0] = *layer.temporalReference;
+		}
+		//Frame of the lower spatial layer is used as GOLDEN
+		if (layer.interLayerReference)
+		{
+			refFrameConfig.reference[3] = 1;
+			refFrameConfig.ref_idx[3] = *layer.interLayerReference;
 		}
+		//Buffer to store the frame into
+		if (layer.update)
+			refFrameConfig.refresh[*layer.update] = 1;
+		aom_codec_control(&encoder, AV1E_SET_SVC_REF_FRAME_CONFIG, &refFrameConfig);
 	}
 
-	//Increase timestamp
-	pts += duration;
+	//Encode, or flush buffered encoded frame on end of stream
+	if (aom_codec_encode(&encoder, videoBuffer ? pic : nullptr, pts, duration, flags) != AOM_CODEC_OK)
+		//Error
+		return Error("-AV1Encoder::EncodeFrame() | Encode error [error %d:%s]\n", encoder.err, encoder.err_detail);
 
 	aom_codec_iter_t iter = NULL;
 	const aom_codec_cx_pkt_t* pkt = NULL;
 
-	//Set width and height
-	frame.SetWidth(width);
-	frame.SetHeight(height);
-
-	//Emtpy rtp info
-	frame.ClearRTPPacketizationInfo();
-
-	//Emtpy
-	frame.SetLength(0);
+	//Get start of the layer frame
+	DWORD start = frame.GetLength();
 
 	//For each packet
 	while ((pkt = aom_codec_get_cx_data(&encoder, &iter)) != NULL)
@@ -473,7 +562,7 @@ VideoFrame* AV1Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 			//Copy data to frame
 			auto ini = frame.AppendMedia((uint8_t*)pkt->data.frame.buf, pkt->data.frame.sz);
 			//Get reader for av1 encoded packet
-			BufferReader reader(*frame.GetBuffer());
+			BufferReader reader(frame.GetBuffer()->GetData() + ini, pkt->data.frame.sz);
 
 			//Get initial position of reader
 			auto mark = reader.Mark();
@@ -562,9 +651,34 @@ VideoFrame* AV1Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 		}
 	}
 
-	//Debug("<AV1Encoder::EncodeFrame()\n");
+	//Add layer frame info
+	if (scalabilityMode.IsLayered() && frame.GetLength()>start)
+	{
+		LayerFrame layerFrame;
+		layerFrame.pos = start;
+		layerFrame.size = frame.GetLength() - start;
+		layerFrame.width = width >> scalabilityMode.GetSpatialScaleShift(layer.spatialLayerId);
+		layerFrame.height = height >> scalabilityMode.GetSpatialScaleShift(layer.spatialLayerId);
+		layerFrame.info = LayerInfo(layer.temporalLayerId, layer.spatialLayerId);
+
+		//Dependencies are described by the template of the frame
+		DependencyDescriptor dependencyDescriptor;
+		dependencyDescriptor.frameDependencyTemplateId = layer.templateId;
+		dependencyDescriptor.frameNumber = frameNumber++;
+		//Send structure on key frames
+		if (layer.keyFrame && !layer.spatialLayerId)
+		{
+			//Create it if not already done for current size
+			if (!templateDependencyStructure)
+				templateDependencyStructure = std::make_shared<const TemplateDependencyStructure>(scalabilityMode.GetTemplateDependencyStructure(width, height));
+			dependencyDescriptor.templateDependencyStructure = templateDependencyStructure;
+		}
+		layerFrame.dependencyDescriptor = dependencyDescriptor;
 
-	return &frame;
+		frame.AddLayerFrame(layerFrame);
+	}
+
+	return true;
 }
 
 
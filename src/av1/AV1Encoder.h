@@ -6,6 +6,7 @@
 #include "aom/aom_encoder.h"
 #include "aom/aomcx.h"
 #include "av1/AV1.h"
+#include "ScalabilityMode.h"
 
 class AV1Encoder : public VideoEncoder
 {
@@ -19,6 +20,8 @@ public:
 
 private:
 	int OpenCodec();
+	void ConfigureLayers();
+	bool EncodeLayerFrame(const VideoBuffer::const_shared& videoBuffer, uint32_t duration, int flags, const ScalabilityMode::LayerFrameConfig& layer);
 
 
 private:
@@ -53,6 +56,10 @@ private:
 	int bufferOptimalSize = 0;
 	int noiseReductionSensitivity = 0;
 	int aqMode = 0;
+	ScalabilityMode scalabilityMode;
+	DWORD layerIndex = 0;
+	uint16_t frameNumber = 0;
+	TemplateDependencyStructure::shared templateDependencyStructure;
 	
 
 };
@@ -1,4 +1,297 @@
 #include "crc32calc.h"
 
-DWORD CRC32Calc::table[256];
-bool CRC32Calc::inited = false;
\ No newline at end of file
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC32_X86 1
+#endif
+
+namespace
+{
+
+//Reflected polynomials
+constexpr DWORD IEEEPolynomial		= 0xEDB88320;
+constexpr DWORD CRC32CPolynomial	= 0x82F63B78;
+//Non reflected polynomial
+constexpr DWORD MPEG2Polynomial		= 0x04C11DB7;
+
+struct Tables
+{
+	DWORD ieee[8][256];
+	DWORD crc32c[8][256];
+	DWORD mpeg2[8][256];
+	//Folding constants for non reflected PCLMULQDQ, x^n mod P
+	QWORD mpeg2Fold4[2];
+	QWORD mpeg2Fold1[2];
+	bool clmul = false;
+	bool sse42 = false;
+
+	Tables()
+	{
+		for (DWORD i = 0; i < 256; ++i)
+		{
+			DWORD a = i;
+			DWORD b = i;
+			DWORD c = i << 24;
+			for (DWORD j = 0; j < 8; ++j)
+			{
+				a = (a & 1) ? IEEEPolynomial ^ (a >> 1) : a >> 1;
+				b = (b & 1) ? CRC32CPolynomial ^ (b >> 1) : b >> 1;
+				c = (c & 0x80000000) ? MPEG2Polynomial ^ (c << 1) : c << 1;
+			}
+			ieee[0][i] = a;
+			crc32c[0][i] = b;
+			mpeg2[0][i] = c;
+		}
+		//Slice tables
+		for (DWORD k = 1; k < 8; ++k)
+		{
+			for (DWORD i = 0; i < 256; ++i)
+			{
+				ieee[k][i] = (ieee[k-1][i] >> 8) ^ ieee[0][ieee[k-1][i] & 0xFF];
+				crc32c[k][i] = (crc32c[k-1][i] >> 8) ^ crc32c[0][crc32c[k-1][i] & 0xFF];
+				mpeg2[k][i] = (mpeg2[k-1][i] << 8) ^ mpeg2[0][mpeg2[k-1][i] >> 24];
+			}
+		}
+		//Low qword multiplies the low half of the block, high qword the high one
+		mpeg2Fold4[0] = XPowModP(512);
+		mpeg2Fold4[1] = XPowModP(512+64);
+		mpeg2Fold1[0] = XPowModP(128);
+		mpeg2Fold1[1] = XPowModP(128+64);
+#ifdef CRC32_X86
+		__builtin_cpu_init();
+		clmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#ifdef __x86_64__
+		sse42 = __builtin_cpu_supports("sse4.2");
+#endif
+#endif
+	}
+
+	static DWORD XPowModP(DWORD n)
+	{
+		DWORD r = 1;
+		for (DWORD i = 0; i < n; ++i)
+			r = (r & 0x80000000) ? MPEG2Polynomial ^ (r << 1) : r << 1;
+		return r;
+	}
+};
+
+const Tables& GetTables()
+{
+	static const Tables tables;
+	return tables;
+}
+
+inline DWORD GetLE32(const BYTE* data)
+{
+	return (DWORD)data[0] | (DWORD)data[1] << 8 | (DWORD)data[2] << 16 | (DWORD)data[3] << 24;
+}
+
+inline DWORD GetBE32(const BYTE* data)
+{
+	return (DWORD)data[0] << 24 | (DWORD)data[1] << 16 | (DWORD)data[2] << 8 | (DWORD)data[3];
+}
+
+//Process input with the raw (non inverted) reflected crc register
+DWORD ReflectedSliceBy8(const DWORD table[8][256], const BYTE* data, size_t size, DWORD c)
+{
+	for (; size >= 8; size -= 8, data += 8)
+	{
+		DWORD one = GetLE32(data) ^ c;
+		DWORD two = GetLE32(data + 4);
+		c =	table[7][one & 0xFF] ^ table[6][(one >> 8) & 0xFF] ^ table[5][(one >> 16) & 0xFF] ^ table[4][one >> 24] ^
+			table[3][two & 0xFF] ^ table[2][(two >> 8) & 0xFF] ^ table[1][(two >> 16) & 0xFF] ^ table[0][two >> 24];
+	}
+	for (; size; --size, ++data)
+		c = table[0][(c ^ *data) & 0xFF] ^ (c >> 8);
+	return c;
+}
+
+DWORD NonReflectedSliceBy8(const DWORD table[8][256], const BYTE* data, size_t size, DWORD c)
+{
+	for (; size >= 8; size -= 8, data += 8)
+	{
+		DWORD one = GetBE32(data) ^ c;
+		DWORD two = GetBE32(data + 4);
+		c =	table[7][one >> 24] ^ table[6][(one >> 16) & 0xFF] ^ table[5][(one >> 8) & 0xFF] ^ table[4][one & 0xFF] ^
+			table[3][two >> 24] ^ table[2][(two >> 16) & 0xFF] ^ table[1][(two >> 8) & 0xFF] ^ table[0][two & 0xFF];
+	}
+	for (; size; --size, ++data)
+		c = (c << 8) ^ table[0][(c >> 24) ^ *data];
+	return c;
+}
+
+#ifdef CRC32_X86
+
+/**
+ * Fold the input with carry-less multiplications until 128 bits are left, following
+ * Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ". The folded
+ * value is congruent with the input, so the crc of the remaining 16 bytes is computed
+ * with the tables. Requires at least 64 bytes, consumes a multiple of 16 bytes.
+ */
+__attribute__((target("pclmul,sse4.1")))
+DWORD IEEECLMUL(const Tables& tables, const BYTE* data, size_t size, DWORD c)
+{
+	//Reflected folding constants for 4 blocks and 1 block distances
+	const __m128i fold4 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+	const __m128i fold1 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+
+	__m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(data + 0x00)), _mm_cvtsi32_si128(c));
+	__m128i x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+	__m128i x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+	__m128i x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+	data += 64;
+	size -= 64;
+
+	//Fold by 4 blocks
+	for (; size >= 64; size -= 64, data += 64)
+	{
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold4, 0x00), _mm_clmulepi64_si128(x1, fold4, 0x11)), _mm_loadu_si128((const __m128i*)(data + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x2, fold4, 0x00), _mm_clmulepi64_si128(x2, fold4, 0x11)), _mm_loadu_si128((const __m128i*)(data + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x3, fold4, 0x00), _mm_clmulepi64_si128(x3, fold4, 0x11)), _mm_loadu_si128((const __m128i*)(data + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x4, fold4, 0x00), _mm_clmulepi64_si128(x4, fold4, 0x11)), _mm_loadu_si128((const __m128i*)(data + 0x30)));
+	}
+
+	//Fold into 128 bits
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), x2);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), x3);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), x4);
+
+	//Single block folding
+	for (; size >= 16; size -= 16, data += 16)
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), _mm_loadu_si128((const __m128i*)data));
+
+	//Reduce the remaining block
+	BYTE block[16];
+	_mm_storeu_si128((__m128i*)block, x1);
+	return ReflectedSliceBy8(tables.ieee, block, sizeof(block), 0);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+DWORD MPEG2CLMUL(const Tables& tables, const BYTE* data, size_t size, DWORD c)
+{
+	//Reverse bytes so first byte of the block is the highest degree term
+	const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m128i fold4 = _mm_loadu_si128((const __m128i*)tables.mpeg2Fold4);
+	const __m128i fold1 = _mm_loadu_si128((const __m128i*)tables.mpeg2Fold1);
+
+	__m128i x1 = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x00)), bswap), _mm_set_epi32(c, 0, 0, 0));
+	__m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x10)), bswap);
+	__m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x20)), bswap);
+	__m128i x4 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x30)), bswap);
+	data += 64;
+	size -= 64;
+
+	//Fold by 4 blocks
+	for (; size >= 64; size -= 64, data += 64)
+	{
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold4, 0x00), _mm_clmulepi64_si128(x1, fold4, 0x11)), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x00)), bswap));
+		x2 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x2, fold4, 0x00), _mm_clmulepi64_si128(x2, fold4, 0x11)), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x10)), bswap));
+		x3 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x3, fold4, 0x00), _mm_clmulepi64_si128(x3, fold4, 0x11)), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x20)), bswap));
+		x4 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x4, fold4, 0x00), _mm_clmulepi64_si128(x4, fold4, 0x11)), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0x30)), bswap));
+	}
+
+	//Fold into 128 bits
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), x2);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), x3);
+	x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), x4);
+
+	//Single block folding
+	for (; size >= 16; size -= 16, data += 16)
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, fold1, 0x00), _mm_clmulepi64_si128(x1, fold1, 0x11)), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), bswap));
+
+	//Reduce the remaining block
+	BYTE block[16];
+	_mm_storeu_si128((__m128i*)block, _mm_shuffle_epi8(x1, bswap));
+	return NonReflectedSliceBy8(tables.mpeg2, block, sizeof(block), 0);
+}
+
+#ifdef __x86_64__
+__attribute__((target("sse4.2")))
+DWORD CRC32CSSE42(const BYTE* data, size_t size, DWORD c)
+{
+	QWORD c64 = c;
+	for (; size >= 8; size -= 8, data += 8)
+	{
+		QWORD value;
+		memcpy(&value, data, sizeof(value));
+		c64 = _mm_crc32_u64(c64, value);
+	}
+	c = (DWORD)c64;
+	for (; size; --size, ++data)
+		c = _mm_crc32_u8(c, *data);
+	return c;
+}
+#endif
+
+#endif
+
+}
+
+DWORD CRC32Calc::IEEESliceBy8(const BYTE* data, size_t size, DWORD crc)
+{
+	return ~ReflectedSliceBy8(GetTables().ieee, data, size, ~crc);
+}
+
+DWORD CRC32Calc::MPEG2SliceBy8(const BYTE* data, size_t size, DWORD crc)
+{
+	return NonReflectedSliceBy8(GetTables().mpeg2, data, size, crc);
+}
+
+DWORD CRC32Calc::CRC32CSliceBy8(const BYTE* data, size_t size, DWORD crc)
+{
+	return ~ReflectedSliceBy8(GetTables().crc32c, data, size, ~crc);
+}
+
+DWORD CRC32Calc::IEEE(const BYTE* data, size_t size, DWORD crc)
+{
+	const Tables& tables = GetTables();
+	DWORD c = ~crc;
+#ifdef CRC32_X86
+	if (tables.clmul && size >= 64)
+	{
+		//Only whole blocks are folded
+		size_t folded = size & ~(size_t)15;
+		c = IEEECLMUL(tables, data, folded, c);
+		data += folded;
+		size -= folded;
+	}
+#endif
+	return ~ReflectedSliceBy8(tables.ieee, data, size, c);
+}
+
+DWORD CRC32Calc::MPEG2(const BYTE* data, size_t size, DWORD crc)
+{
+	const Tables& tables = GetTables();
+#ifdef CRC32_X86
+	if (tables.clmul && size >= 64)
+	{
+		//Only whole blocks are folded
+		size_t folded = size & ~(size_t)15;
+		crc = MPEG2CLMUL(tables, data, folded, crc);
+		data += folded;
+		size -= folded;
+	}
+#endif
+	return NonReflectedSliceBy8(tables.mpeg2, data, size, crc);
+}
+
+DWORD CRC32Calc::CRC32C(const BYTE* data, size_t size, DWORD crc)
+{
+	const Tables& tables = GetTables();
+#if defined(CRC32_X86) && defined(__x86_64__)
+	if (tables.sse42)
+		return ~CRC32CSSE42(data, size, ~crc);
+#endif
+	return ~ReflectedSliceBy8(tables.crc32c, data, size, ~crc);
+}
+
+bool CRC32Calc::IsCLMULAccelerated()
+{
+	return GetTables().clmul;
+}
+
+bool CRC32Calc::IsSSE42Accelerated()
+{
+	return GetTables().sse42;
+}
@@ -13,6 +13,8 @@ public:
 	virtual DWORD TrySetRate(DWORD rate, DWORD numChannels) { return numChannels==1 ? 8000 : 0;	}
 	virtual DWORD GetRate()			{ return 8000;	}
 	virtual DWORD GetClockRate()		{ return 8000;	}
+	//Stateless
+	virtual bool CopyState(const AudioEncoder& other) { return other.type==type;	}
 private:
 	AudioFrame::shared audioFrame;
 };
@@ -39,6 +41,8 @@ public:
 	virtual DWORD TrySetRate(DWORD rate, DWORD numChannels) { return numChannels == 1 ? 8000 : 0; }
 	virtual DWORD GetRate()			{ return 8000;	}
 	virtual DWORD GetClockRate()		{ return 8000;	}
+	//Stateless
+	virtual bool CopyState(const AudioEncoder& other) { return other.type==type;	}
 private:
 	AudioFrame::shared audioFrame;
 };
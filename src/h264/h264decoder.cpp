@@ -74,6 +74,20 @@ int H264Decoder::Decode(const VideoFrame::const_shared& frame)
 	return 1;
 }
 
+void H264Decoder::SetPreview(bool preview)
+{
+	//Check codec
+	if (!ctx)
+		return;
+	//Skip deblocking, artifacts will not be propagated without inter frames
+	ctx->skip_loop_filter = preview ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+	//Allow non spec compliant speedup tricks
+	if (preview)
+		ctx->flags2 |= AV_CODEC_FLAG2_FAST;
+	else
+		ctx->flags2 &= ~AV_CODEC_FLAG2_FAST;
+}
+
 VideoBuffer::shared H264Decoder::GetFrame()
 {
 
@@ -14,6 +14,7 @@ public:
 	virtual ~H264Decoder();
 	virtual int Decode(const VideoFrame::const_shared& frame);
 	virtual VideoBuffer::shared GetFrame();
+	virtual void SetPreview(bool preview);
 private:
 	const AVCodec*	codec	= nullptr;
 	AVCodecContext*	ctx	= nullptr;
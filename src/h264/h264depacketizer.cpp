@@ -66,8 +66,8 @@ MediaFrame* H264Depacketizer::AddPacket(const RTPPacket::shared& packet)
 	
 	//Set SSRC
 	frame.SetSSRC(packet->GetSSRC());
-	//Add payload
-	AddPayload(packet->GetMediaData(),packet->GetMediaLength());
+	//Add payload, referencing packet data instead of copying it
+	AddPayload(packet->GetMediaData(),packet->GetMediaLength(),packet->SharePayload());
 	//If it is last return frame
 	if (!packet->GetMark())
 		return NULL;
@@ -80,6 +80,12 @@ MediaFrame* H264Depacketizer::AddPacket(const RTPPacket::shared& packet)
 }
 
 MediaFrame* H264Depacketizer::AddPayload(const BYTE* payload, DWORD payloadLen)
+{
+	//No owner, data will be copied
+	return AddPayload(payload,payloadLen,nullptr);
+}
+
+MediaFrame* H264Depacketizer::AddPayload(const BYTE* payload, DWORD payloadLen, const RTPPayload::shared& owner)
 {
 	H264SeqParameterSet sps;
 	BYTE nalHeader[4];
@@ -219,7 +225,7 @@ MediaFrame* H264Depacketizer::AddPayload(const BYTE* payload, DWORD payloadLen)
 				frame.AppendMedia(nalHeader, sizeof (nalHeader));
 				
 				//Append data and get current post
-				pos = frame.AppendMedia(payload,nalSize);
+				pos = frame.AppendMediaReference(owner,payload,nalSize);
 				//Add RTP packet
 				frame.AddRtpPacket(pos,nalSize,NULL,0);
 				
@@ -289,7 +295,7 @@ MediaFrame* H264Depacketizer::AddPayload(const BYTE* payload, DWORD payloadLen)
 				return NULL;
 
 			//Append data and get current post
-			pos = frame.AppendMedia(payload+2,nalSize);
+			pos = frame.AppendMediaReference(owner,payload+2,nalSize);
 			//Add rtp payload
 			frame.AddRtpPacket(pos,nalSize,payload,2);
 
@@ -305,10 +311,12 @@ MediaFrame* H264Depacketizer::AddPayload(const BYTE* payload, DWORD payloadLen)
 				//Check if doing annex b
 				if (annexB)
 					//Set annex b start code
-					set4(frame.GetData(), iniFragNALU, AnnexBStartCode);
+					set4(nalHeader, 0, AnnexBStartCode);
 				else
 					//Set size
-					set4(frame.GetData(), iniFragNALU, nalSize);
+					set4(nalHeader, 0, nalSize);
+				//Update header
+				frame.UpdateMedia(iniFragNALU, nalHeader, sizeof(nalHeader));
 				//Done with fragment
 				iniFragNALU = 0;
 				startedFrag = false;
@@ -366,7 +374,7 @@ MediaFrame* H264Depacketizer::AddPayload(const BYTE* payload, DWORD payloadLen)
 			//Append data
 			frame.AppendMedia(nalHeader, sizeof (nalHeader));
 			//Append data and get current post
-			pos = frame.AppendMedia(payload, nalSize);
+			pos = frame.AppendMediaReference(owner, payload, nalSize);
 			//Add RTP packet
 			frame.AddRtpPacket(pos,nalSize,NULL,0);
 			//Done
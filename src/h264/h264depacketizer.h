@@ -19,6 +19,8 @@ public:
 	virtual MediaFrame* AddPacket(const RTPPacket::shared& packet) override;
 	virtual MediaFrame* AddPayload(const BYTE* payload,DWORD payload_len) override;
 	virtual void ResetFrame() override;
+private:
+	MediaFrame* AddPayload(const BYTE* payload,DWORD payloadLen,const RTPPayload::shared& owner);
 private:
 	VideoFrame frame;
 	AVCDescriptor config;
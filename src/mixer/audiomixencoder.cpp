@@ -0,0 +1,433 @@
+#include "log.h"
+#include "tools.h"
+#include "audiomixencoder.h"
+#include "sidebar.h"
+#include <algorithm>
+
+bool AudioMixEncoder::SetEncoding(DWORD rate, DWORD maxSamples, const Factory& factory)
+{
+	//Remove encoders created with previous codec
+	sidebarEncoders.clear();
+	for (auto& [id,participant] : participants)
+	{
+		participant.encoder.reset();
+		participant.individual = false;
+		participant.active = false;
+	}
+
+	//Store new config
+	this->rate = rate;
+	this->maxSamples = maxSamples;
+	this->factory = factory;
+	shareable = false;
+	//Start new frame
+	frameSamples = 0;
+	pendingSamples = 0;
+	audioBuffer.reset();
+
+	//If not encoding anymore
+	if (!factory)
+		//Done
+		return true;
+
+	//Create two encoders to check if state can be copied between them
+	auto first = CreateEncoder();
+	auto second = CreateEncoder();
+
+	//Check
+	if (!first || !second)
+	{
+		//Stop encoding
+		this->factory = nullptr;
+		//Error
+		return Error("-AudioMixEncoder::SetEncoding() | Could not create encoder\n");
+	}
+
+	//Only share encoders if outputs can be moved between them
+	shareable = second->codec->CopyState(*first->codec);
+
+	//Create buffer for the frames
+	audioBuffer = std::make_shared<AudioBuffer>(frameSamples,1);
+
+	Debug("-AudioMixEncoder::SetEncoding() [rate:%d,frameSamples:%d,shareable:%d]\n",rate,frameSamples,shareable);
+
+	return true;
+}
+
+std::unique_ptr<AudioMixEncoder::Encoder> AudioMixEncoder::CreateEncoder()
+{
+	//Create codec
+	std::unique_ptr<Encoder> encoder = std::make_unique<Encoder>();
+	encoder->codec.reset(factory());
+
+	//Check
+	if (!encoder->codec)
+	{
+		//Error
+		Error("-AudioMixEncoder::CreateEncoder() | Could not open encoder\n");
+		return nullptr;
+	}
+
+	//Mixed audio is mono at mixer rate
+	if (encoder->codec->TrySetRate(rate,1)!=rate)
+	{
+		//Error
+		Error("-AudioMixEncoder::CreateEncoder() | Could not set encoder rate [rate:%d]\n",rate);
+		return nullptr;
+	}
+
+	//Check frame fits on the encoder buffer
+	if (encoder->codec->numFrameSamples<=0 || static_cast<DWORD>(encoder->codec->numFrameSamples)>maxSamples)
+	{
+		//Error
+		Error("-AudioMixEncoder::CreateEncoder() | Wrong frame size [%d]\n",encoder->codec->numFrameSamples);
+		return nullptr;
+	}
+
+	//Get frame size from first one, all are created equal
+	if (!frameSamples)
+		frameSamples = encoder->codec->numFrameSamples;
+
+	//Room for a frame and a mixing round
+	encoder->buffer.resize(frameSamples+maxSamples,0);
+
+	return encoder;
+}
+
+AudioMixEncoder::Encoder* AudioMixEncoder::GetSidebarEncoder(Sidebar* sidebar)
+{
+	//Get shared encoder for the sidebar
+	auto it = sidebarEncoders.find(sidebar);
+	//If found
+	if (it!=sidebarEncoders.end())
+		return it->second.get();
+	//Create it
+	auto encoder = CreateEncoder();
+	//Check
+	if (!encoder)
+		return nullptr;
+	//Add it
+	return sidebarEncoders.emplace(sidebar,std::move(encoder)).first->second.get();
+}
+
+bool AudioMixEncoder::Seed(Encoder* encoder, const Encoder* from)
+{
+	//Samples of current frame are the same ones
+	std::copy_n(from->buffer.begin(),pendingSamples,encoder->buffer.begin());
+	encoder->silence = from->silence;
+	//Continue from same state
+	return encoder->codec->CopyState(*from->codec);
+}
+
+bool AudioMixEncoder::HasSharing(Sidebar* sidebar) const
+{
+	for (const auto& [id,participant] : participants)
+		if (participant.active && !participant.individual && participant.sidebar==sidebar)
+			return true;
+	return false;
+}
+
+bool AudioMixEncoder::Update(int id, Sidebar* sidebar, bool contributing, DWORD numSamples)
+{
+	//Find participant
+	auto it = participants.find(id);
+	//Check it is encoded
+	if (!factory || it==participants.end() || !sidebar)
+		return false;
+
+	Participant& participant = it->second;
+
+	//Get shared encoder for the sidebar
+	Encoder* shared = GetSidebarEncoder(sidebar);
+	//Check
+	if (!shared)
+		return false;
+
+	//Updated on this round
+	participant.updated = true;
+
+	//If its output is starting, there is no previous state to keep
+	if (!participant.active)
+	{
+		//Share if possible
+		participant.sidebar = sidebar;
+		participant.quiet = contributing ? 0 : numSamples;
+		participant.individual = !shareable || contributing;
+		//If encoded alone
+		if (participant.individual)
+		{
+			//Create individual encoder if not done yet
+			if (!participant.encoder && !(participant.encoder = CreateEncoder()))
+				return false;
+			//Start from the current frame of the shared one, state is not needed
+			Seed(participant.encoder.get(),shared);
+		}
+		//Started
+		participant.active = true;
+		return participant.individual;
+	}
+
+	//Update trailing samples not contributing
+	participant.quiet = contributing ? 0 : participant.quiet + numSamples;
+
+	//If it was sharing but now it is contributing or listening to another sidebar
+	if (!participant.individual && (contributing || participant.sidebar!=sidebar))
+	{
+		//Create individual encoder if not done yet
+		if (!participant.encoder && !(participant.encoder = CreateEncoder()))
+			return false;
+		//Get the encoder it was sharing
+		Encoder* current = GetSidebarEncoder(participant.sidebar);
+		//Continue from it
+		if (!current || !Seed(participant.encoder.get(),current))
+			Warning("-AudioMixEncoder::Update() | Could not copy encoder state [id:%d]\n",id);
+		//Encode it alone from now on
+		participant.individual = true;
+	}
+
+	//Store sidebar
+	participant.sidebar = sidebar;
+
+	return participant.individual;
+}
+
+void AudioMixEncoder::Append(int id, const SWORD* samples, DWORD numSamples)
+{
+	//Find participant
+	auto it = participants.find(id);
+	//Check it is encoded alone
+	if (it==participants.end() || !it->second.individual || !it->second.encoder)
+		return;
+	//Append to its frame
+	std::copy_n(samples,std::min(numSamples,maxSamples),it->second.encoder->buffer.begin()+pendingSamples);
+}
+
+void AudioMixEncoder::Process(DWORD numSamples)
+{
+	//Check we are encoding
+	if (!factory || !frameSamples)
+		return;
+
+	//At most the maximum
+	numSamples = std::min(numSamples,maxSamples);
+
+	//Participants not updated on this round have no output until they are again
+	for (auto& [id,participant] : participants)
+	{
+		if (!participant.updated)
+			participant.active = false;
+		participant.updated = false;
+	}
+
+	//Append mix once for each shared encoder
+	for (auto& [sidebar,encoder] : sidebarEncoders)
+		std::copy_n(sidebar->GetBuffer(),numSamples,encoder->buffer.begin()+pendingSamples);
+
+	//Increase samples in current frame
+	pendingSamples += numSamples;
+
+	//Encode complete frames
+	while (pendingSamples>=frameSamples)
+		EncodeFrame();
+}
+
+AudioFrame::shared AudioMixEncoder::Encode(Encoder* encoder)
+{
+	//Set samples of current frame
+	audioBuffer->SetSamples(encoder->buffer.data(),frameSamples);
+	audioBuffer->SetClockRate(rate);
+	audioBuffer->SetTimestamp(encodedSamples);
+
+	//Update encoded silence
+	if (std::all_of(encoder->buffer.begin(),encoder->buffer.begin()+frameSamples,[](SWORD sample){ return !sample; }))
+		encoder->silence += frameSamples;
+	else
+		encoder->silence = 0;
+
+	//Encode them
+	AudioFrame::shared frame = encoder->codec->Encode(audioBuffer);
+
+	//Check
+	if (!frame)
+	{
+		Error("-AudioMixEncoder::Encode() | Error encoding audio\n");
+		return frame;
+	}
+
+	//All encoders share the mixer timeline, so outputs can be switched between them
+	frame->SetClockRate(rate);
+	frame->SetTimestamp(encodedSamples);
+	frame->SetSenderTime(encodedSamples*1000/rate);
+	//Set encoded time
+	frame->SetTime(getTime()/1000);
+	//Set frame duration
+	frame->SetDuration(frameSamples);
+	//Mono
+	frame->SetNumChannels(1);
+	//Set rtp info
+	frame->ClearRTPPacketizationInfo();
+	frame->AddRtpPacket(0,frame->GetLength(),NULL,0);
+
+	return frame;
+}
+
+void AudioMixEncoder::EncodeFrame()
+{
+	//For each shared encoder
+	for (auto& [sidebar,encoder] : sidebarEncoders)
+	{
+		//If nobody is using it, it will be seeded when needed
+		if (!HasSharing(sidebar))
+			continue;
+		//Encode only once for all of them
+		AudioFrame::shared frame = Encode(encoder.get());
+		//Check
+		if (!frame)
+			continue;
+		//For each participant sharing it
+		for (const auto& [id,participant] : participants)
+			//If it is
+			if (participant.active && !participant.individual && participant.sidebar==sidebar)
+				//Send it
+				for (const auto& listener : participant.listeners)
+					listener->onMediaFrame(*frame);
+	}
+
+	//For each participant with its own encoder
+	for (const auto& [id,participant] : participants)
+	{
+		//Check it is encoded alone
+		if (!participant.active || !participant.individual)
+			continue;
+		//Encode them
+		AudioFrame::shared frame = Encode(participant.encoder.get());
+		//Check
+		if (!frame)
+			continue;
+		//Send it
+		for (const auto& listener : participant.listeners)
+			listener->onMediaFrame(*frame);
+	}
+
+	//Remove encoded samples
+	pendingSamples -= frameSamples;
+	encodedSamples += frameSamples;
+
+	//Move the rest to the begining of the shared buffers
+	for (auto& [sidebar,encoder] : sidebarEncoders)
+		std::copy_n(encoder->buffer.begin()+frameSamples,pendingSamples,encoder->buffer.begin());
+
+	//Digital silence needed on both encoders before switching one output between them
+	QWORD resetSamples = static_cast<QWORD>(ResetTime)*rate/1000;
+
+	//And the individual ones
+	for (auto& [id,participant] : participants)
+	{
+		//Skip if not encoded alone
+		if (!participant.active || !participant.individual)
+			continue;
+		//Move the rest
+		std::copy_n(participant.encoder->buffer.begin()+frameSamples,pendingSamples,participant.encoder->buffer.begin());
+		//If it has contributed to the pending samples, they are not the shared ones
+		if (!shareable || participant.quiet<pendingSamples)
+			continue;
+		//Get shared encoder
+		Encoder* shared = GetSidebarEncoder(participant.sidebar);
+		//Check
+		if (!shared)
+			continue;
+		//If nobody else is using it
+		if (!HasSharing(participant.sidebar))
+		{
+			//Continue from the participant state
+			if (!Seed(shared,participant.encoder.get()))
+				continue;
+		}
+		//Otherwise both must have no history left
+		else if (shared->silence<resetSamples || participant.encoder->silence<resetSamples)
+		{
+			continue;
+		}
+		//Share again
+		participant.individual = false;
+	}
+}
+
+bool AudioMixEncoder::AddListener(int id, const MediaFrame::Listener::shared& listener)
+{
+	//Add to set
+	participants[id].listeners.insert(listener);
+	return true;
+}
+
+bool AudioMixEncoder::RemoveListener(int id, const MediaFrame::Listener::shared& listener)
+{
+	//Find participant
+	auto it = participants.find(id);
+	//If not found
+	if (it==participants.end())
+		return false;
+	//Erase listener
+	it->second.listeners.erase(listener);
+	//If it was the last one
+	if (it->second.listeners.empty())
+		//Not encoded anymore
+		participants.erase(it);
+	return true;
+}
+
+bool AudioMixEncoder::IsEncoded(int id) const
+{
+	return factory && participants.find(id)!=participants.end();
+}
+
+bool AudioMixEncoder::IsSharing(int id) const
+{
+	auto it = participants.find(id);
+	return it!=participants.end() && it->second.active && !it->second.individual;
+}
+
+void AudioMixEncoder::RemoveParticipant(int id)
+{
+	participants.erase(id);
+}
+
+void AudioMixEncoder::RemoveSidebar(Sidebar* sidebar)
+{
+	//Remove shared encoder
+	sidebarEncoders.erase(sidebar);
+	//Participants using it have no output until they get a new one
+	for (auto& [id,participant] : participants)
+	{
+		if (participant.sidebar==sidebar)
+		{
+			participant.sidebar = nullptr;
+			participant.active = false;
+		}
+	}
+}
+
+void AudioMixEncoder::Clear()
+{
+	sidebarEncoders.clear();
+	participants.clear();
+	pendingSamples = 0;
+}
+
+DWORD AudioMixEncoder::GetNumSharedEncoders() const
+{
+	DWORD num = 0;
+	for (const auto& [sidebar,encoder] : sidebarEncoders)
+		if (HasSharing(sidebar))
+			num++;
+	return num;
+}
+
+DWORD AudioMixEncoder::GetNumIndividualEncoders() const
+{
+	DWORD num = 0;
+	for (const auto& [id,participant] : participants)
+		if (participant.active && participant.individual)
+			num++;
+	return num;
+}
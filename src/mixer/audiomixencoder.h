@@ -0,0 +1,108 @@
+#ifndef _AUDIOMIXENCODER_H_
+#define _AUDIOMIXENCODER_H_
+#include "config.h"
+#include "audio.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <map>
+#include <set>
+
+class Sidebar;
+
+/**
+ * Encodes the outputs of the audio mixer.
+ *
+ * Participants that do not contribute to the sidebar they listen to receive
+ * the same mix, so they share a single encoder per sidebar and each encoded
+ * frame is fanned out to all of them. Participants that are contributing get
+ * their own mix-minus encoder.
+ *
+ * A participant's output must come from the same encoder state all the time,
+ * so when it stops sharing its own encoder is seeded with the shared encoder
+ * state. It only goes back to the shared encoder when nobody else is using it,
+ * as then the shared encoder can be seeded from its own, or at a reset point,
+ * when both encoders have been fed with digital silence long enough to have no
+ * history left. If the codec can't copy its state, participants never share.
+ */
+class AudioMixEncoder
+{
+public:
+	using Factory = std::function<AudioEncoder*()>;
+	//Digital silence needed on both encoders to switch back to the shared one
+	static constexpr DWORD ResetTime = 100;
+public:
+	//Create encoders with the factory for mono audio at mixer rate, or stop encoding if null
+	bool SetEncoding(DWORD rate, DWORD maxSamples, const Factory& factory);
+	bool IsEncoding() const			{ return (bool)factory;	}
+
+	bool AddListener(int id, const MediaFrame::Listener::shared& listener);
+	bool RemoveListener(int id, const MediaFrame::Listener::shared& listener);
+	//Check if participant output is encoded by the mixer
+	bool IsEncoded(int id) const;
+	void RemoveParticipant(int id);
+	void RemoveSidebar(Sidebar* sidebar);
+	void Clear();
+
+	//Mixing round for an encoded participant, returns true if it needs its own mix-minus appended
+	bool Update(int id, Sidebar* sidebar, bool contributing, DWORD numSamples);
+	void Append(int id, const SWORD* samples, DWORD numSamples);
+	//Append the shared sidebar mixes and encode complete frames
+	void Process(DWORD numSamples);
+
+	//Number of shared and individual encoders in use
+	DWORD GetNumSharedEncoders() const;
+	DWORD GetNumIndividualEncoders() const;
+	bool IsSharing(int id) const;
+
+private:
+	typedef std::set<MediaFrame::Listener::shared> Listeners;
+
+	//Encoder with the mixed samples pending to be encoded on current frame
+	struct Encoder
+	{
+		std::unique_ptr<AudioEncoder> codec;
+		std::vector<SWORD> buffer;
+		//Trailing samples of digital silence already encoded
+		QWORD silence = 0;
+	};
+
+	struct Participant
+	{
+		Listeners listeners;
+		Sidebar* sidebar = nullptr;
+		//Updated on current round
+		bool active = false;
+		bool updated = false;
+		bool individual = false;
+		//Trailing samples not contributing to its sidebar mix
+		QWORD quiet = 0;
+		std::unique_ptr<Encoder> encoder;
+	};
+
+	typedef std::map<int,Participant> Participants;
+	typedef std::map<Sidebar*,std::unique_ptr<Encoder>> SidebarEncoders;
+
+private:
+	std::unique_ptr<Encoder> CreateEncoder();
+	Encoder* GetSidebarEncoder(Sidebar* sidebar);
+	bool Seed(Encoder* encoder, const Encoder* from);
+	bool HasSharing(Sidebar* sidebar) const;
+	AudioFrame::shared Encode(Encoder* encoder);
+	void EncodeFrame();
+
+private:
+	Factory		factory;
+	bool		shareable = false;
+	DWORD		rate = 0;
+	DWORD		maxSamples = 0;
+	DWORD		frameSamples = 0;
+	DWORD		pendingSamples = 0;
+	QWORD		encodedSamples = 0;
+
+	Participants	participants;
+	SidebarEncoders	sidebarEncoders;
+	AudioBuffer::shared audioBuffer;
+};
+
+#endif
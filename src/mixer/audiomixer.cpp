@@ -8,6 +8,7 @@
 #include "pipeaudioinput.h"
 #include "pipeaudiooutput.h"
 #include "sidebar.h"
+#include "AudioCodecFactory.h"
 
 int AudioMixer::SidebarDefault = 0;
 int AudioMixer::NoSidebar = -1;
@@ -133,6 +134,10 @@ void AudioMixer::Process(DWORD numSamples)
 		memset(audio->buffer+audio->len,0,(Sidebar::MIXER_BUFFER_SIZE-audio->len)*sizeof(SWORD));
 		//Get VAD value
 		audio->vad = audio->output->GetVAD(numSamples);
+		//If it is encoded by the mixer and not speaking
+		if (vad && mixEncoder.IsEncoded(id) && !audio->vad)
+			//Do not mix it so it can share the encoded output
+			audio->len = 0;
 		//For each sidebar
 		for (Sidebars::iterator sit = sidebars.begin(); sit!=sidebars.end(); ++sit)
 		{
@@ -165,6 +170,14 @@ void AudioMixer::Process(DWORD numSamples)
 		//And the audio buffer for participant
 		SWORD *buffer = audio->buffer;
 
+		//Check if it is encoded by the mixer
+		bool encoded = mixEncoder.IsEncoded(id);
+
+		//If it can share the encoded sidebar mix
+		if (encoded && !mixEncoder.Update(id,audio->sidebar,audio->len && audio->sidebar->HasParticipant(id),numSamples))
+			//Nothing to do, shared mix is appended once per sidebar
+			continue;
+
 		//Check if we are also an input to the sidebar to remove ound sound
 		if (audio->sidebar->HasParticipant(id))
 		{
@@ -185,18 +198,99 @@ void AudioMixer::Process(DWORD numSamples)
 			if (audio->len<numSamples)
 				//Copy the rest
 				memcpy(buffer+audio->len,mixed+audio->len,(numSamples-audio->len)*sizeof(SWORD));
-			//Put the output
-			audio->input->PutSamples(buffer,numSamples);
 		} else {
-			//Copy everything as it is
-			audio->input->PutSamples((SWORD*)mixed,numSamples);
+			//Use everything as it is
+			buffer = mixed;
 		}
+
+		//If it is encoded by the mixer
+		if (encoded)
+			//Append to its frame
+			mixEncoder.Append(id,buffer,numSamples);
+		else
+			//Put the output
+			audio->input->PutSamples(buffer,numSamples);
 	}
 
+	//Encode shared mixes and complete frames
+	mixEncoder.Process(numSamples);
+
 	//Unblock list
 	lstAudiosUse.Unlock();
 }
 
+int AudioMixer::SetEncoding(AudioCodec::Type codec, const Properties& properties)
+{
+	Log("-AudioMixer::SetEncoding() [%s]\n",AudioCodec::GetNameFor(codec));
+
+	//Lock
+	lstAudiosUse.WaitUnusedAndLock();
+
+	//Encoders for mono audio at mixer rate
+	bool ok = mixEncoder.SetEncoding(rate,Sidebar::MIXER_BUFFER_SIZE,[=](){
+		return AudioCodecFactory::CreateEncoder(codec,properties);
+	});
+
+	//Unlock
+	lstAudiosUse.Unlock();
+
+	//Check
+	if (!ok)
+		return Error("-AudioMixer::SetEncoding() | Could not create encoder\n");
+
+	//OK
+	return 1;
+}
+
+bool AudioMixer::AddMixerListener(int id, const MediaFrame::Listener::shared& listener)
+{
+	Debug("-AudioMixer::AddMixerListener() [id:%d,listener:%p]\n",id,listener.get());
+
+	//Lock
+	lstAudiosUse.WaitUnusedAndLock();
+
+	//Find it
+	Audios::iterator it = audios.find(id);
+
+	//If not found
+	if (it==audios.end())
+	{
+		//Unlock
+		lstAudiosUse.Unlock();
+		//Error
+		return Error("-AudioMixer::AddMixerListener() | Mixer not found [id:%d]\n",id);
+	}
+
+	//Add it
+	mixEncoder.AddListener(id,listener);
+
+	//Unlock
+	lstAudiosUse.Unlock();
+
+	return true;
+}
+
+bool AudioMixer::RemoveMixerListener(int id, const MediaFrame::Listener::shared& listener)
+{
+	Debug("-AudioMixer::RemoveMixerListener() [id:%d,listener:%p]\n",id,listener.get());
+
+	//Lock
+	lstAudiosUse.WaitUnusedAndLock();
+
+	//Find it
+	Audios::iterator it = audios.find(id);
+
+	//If found
+	if (it!=audios.end())
+		//Erase it
+		mixEncoder.RemoveListener(id,listener);
+
+	//Unlock
+	lstAudiosUse.Unlock();
+
+	return true;
+}
+
 int AudioMixer::SetCalculateVAD(bool vad)
 {
 	Log("-SetCalculateVAD [vad:%d]\n",vad);
@@ -294,6 +388,9 @@ int AudioMixer::End()
 	//Clear list
 	sidebars.clear();
 
+	//Remove encoders
+	mixEncoder.Clear();
+
 	//Unlock
 	lstAudiosUse.Unlock();
 	
@@ -477,6 +574,9 @@ int AudioMixer::DeleteMixer(int id)
 	//Lo quitamos de la lista
 	audios.erase(it);
 
+	//Remove encoded output
+	mixEncoder.RemoveParticipant(id);
+
 	//Desprotegemos la lista
 	lstAudiosUse.Unlock();
 
@@ -704,6 +804,9 @@ int AudioMixer::DeleteSidebar(int sidebarId)
 	//Remove sidebar
 	sidebars.erase(it);
 
+	//Remove shared encoder for the sidebar
+	mixEncoder.RemoveSidebar(sidebar);
+
 	//UnBlock
 	lstAudiosUse.Unlock();
 
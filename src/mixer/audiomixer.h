@@ -6,6 +6,7 @@
 #include "pipeaudioinput.h"
 #include "pipeaudiooutput.h"
 #include "sidebar.h"
+#include "audiomixencoder.h"
 #include <map>
 
 class AudioMixer : public VADProxy
@@ -36,6 +37,11 @@ public:
 	
 	int SetCalculateVAD(bool vad);
 
+	//Encoded outputs, participants not contributing to its sidebar share a single encoder
+	int SetEncoding(AudioCodec::Type codec, const Properties& properties);
+	bool AddMixerListener(int id, const MediaFrame::Listener::shared& listener);
+	bool RemoveMixerListener(int id, const MediaFrame::Listener::shared& listener);
+
 public:
 	static int SidebarDefault;
 	static int NoSidebar;
@@ -89,6 +95,9 @@ private:
 	bool		vad;
 	DWORD		rate;
 
+	//Encoded outputs
+	AudioMixEncoder	mixEncoder;
+
 };
 
 #endif
@@ -0,0 +1,338 @@
+#include "overlay.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+Canvas::Canvas(DWORD width,DWORD height)
+{
+	//Store values
+	this->width = width;
+	this->height = height;
+	//Calculate size for overlay iage with alpha
+	overlaySize = width*height*4+AV_INPUT_BUFFER_PADDING_SIZE+32;
+	//Create overlay image
+	overlay = (BYTE*)malloc32(overlaySize);
+	//Clean it
+	memset(overlay,0,overlaySize);
+	//Do not display
+	display = false;
+	//Split overlay in tiles
+	tilesX = (width+TileSize-1)/TileSize;
+	tilesY = (height+TileSize-1)/TileSize;
+	//All transparent as overlay is clean
+	tiles.resize(tilesX*tilesY,Transparent);
+	dirtyTiles.resize(tilesX*tilesY,false);
+	dirty = false;
+}
+
+Overlay::Overlay(DWORD width,DWORD height) : Canvas(width,height)
+{
+	//Calculate size for final image i.e. without alpha
+	imageSize = width*height*4+AV_INPUT_BUFFER_PADDING_SIZE+32;
+	//Create final image
+	image = (BYTE*)malloc32(imageSize);
+}
+
+Canvas::~Canvas()
+{
+	//Free memor
+	free(overlay);
+}
+
+Overlay::~Overlay()
+{
+	free(image);
+}
+
+BYTE* Overlay::Display(uint8_t* frame)
+{
+	//check if we have overlay
+	if (!display)
+		//Return the same frame
+		return frame;
+	//Draw
+	Draw(image,frame);
+	
+	//Return internal image
+	return image;
+}
+
+void Canvas::Reset()
+{
+	//Clean overlay memory
+	memset(overlay,0,overlaySize);
+	//Everything is transparent now
+	std::fill(tiles.begin(),tiles.end(),Transparent);
+	std::fill(dirtyTiles.begin(),dirtyTiles.end(),false);
+	//Nothing pending
+	dirty = false;
+}
+
+void Canvas::SetDirty(DWORD x,DWORD y,DWORD width,DWORD height)
+{
+	//Check it is inside the canvas
+	if (!width || !height || x>=this->width || y>=this->height)
+		//Nothing to do
+		return;
+	//Get affected tiles
+	DWORD tx0 = x/TileSize;
+	DWORD ty0 = y/TileSize;
+	DWORD tx1 = std::min(x+width,this->width)-1;
+	DWORD ty1 = std::min(y+height,this->height)-1;
+	//Mark them
+	for (DWORD ty=ty0;ty<=ty1/TileSize;++ty)
+		for (DWORD tx=tx0;tx<=tx1/TileSize;++tx)
+			dirtyTiles[ty*tilesX+tx] = true;
+	//Analyze before next draw
+	dirty = true;
+}
+
+void Canvas::Analyze()
+{
+	//If nothing has changed
+	if (!dirty)
+		//Done
+		return;
+	//Get alpha plane
+	const BYTE* alpha = overlay+width*height*3/2;
+	//For each tile
+	for (DWORD ty=0;ty<tilesY;++ty)
+	{
+		for (DWORD tx=0;tx<tilesX;++tx)
+		{
+			DWORD i = ty*tilesX+tx;
+			//Skip unmodified tiles
+			if (!dirtyTiles[i])
+				continue;
+			//Get tile limits
+			DWORD x0 = tx*TileSize;
+			DWORD y0 = ty*TileSize;
+			DWORD x1 = std::min(x0+TileSize,width);
+			DWORD y1 = std::min(y0+TileSize,height);
+			//Count transparent and opaque pixels
+			DWORD transparent = 0;
+			DWORD opaque = 0;
+			for (DWORD y=y0;y<y1;++y)
+			{
+				for (DWORD x=x0;x<x1;++x)
+				{
+					BYTE a = alpha[y*width+x];
+					transparent += a==0;
+					opaque += a==255;
+				}
+			}
+			DWORD num = (x1-x0)*(y1-y0);
+			//Classify
+			if (transparent==num)
+				tiles[i] = Transparent;
+			else if (opaque==num)
+				tiles[i] = Opaque;
+			else
+				tiles[i] = Partial;
+			//Done
+			dirtyTiles[i] = false;
+		}
+	}
+	//Up to date
+	dirty = false;
+}
+
+//Exact x/255 for x in [0,255*255]
+static inline BYTE Div255(DWORD x)
+{
+	return (x + 1 + (x>>8)) >> 8;
+}
+
+static void BlendLine(BYTE* dst,const BYTE* src,const BYTE* ovr,const BYTE* alpha,DWORD len)
+{
+	DWORD i = 0;
+#if defined(__AVX2__)
+	const __m256i max = _mm256_set1_epi16(255);
+	const __m256i one = _mm256_set1_epi16(1);
+	for (;i+32<=len;i+=32)
+	{
+		__m256i r[2];
+		for (DWORD h=0;h<2;++h)
+		{
+			//Widen 16 pixels to 16 bits
+			__m256i s = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src+i+h*16)));
+			__m256i o = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(ovr+i+h*16)));
+			__m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(alpha+i+h*16)));
+			//o*a + s*(255-a), fits in unsigned 16 bits
+			__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(o,a),_mm256_mullo_epi16(s,_mm256_sub_epi16(max,a)));
+			//Divide by 255
+			r[h] = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x,one),_mm256_srli_epi16(x,8)),8);
+		}
+		//Pack back to 8 bits, fixing lane interleaving
+		_mm256_storeu_si256((__m256i*)(dst+i),_mm256_permute4x64_epi64(_mm256_packus_epi16(r[0],r[1]),0xD8));
+	}
+#elif defined(__SSE4_1__)
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i one = _mm_set1_epi16(1);
+	for (;i+16<=len;i+=16)
+	{
+		__m128i r[2];
+		for (DWORD h=0;h<2;++h)
+		{
+			//Widen 8 pixels to 16 bits
+			__m128i s = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(src+i+h*8)));
+			__m128i o = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(ovr+i+h*8)));
+			__m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(alpha+i+h*8)));
+			//o*a + s*(255-a), fits in unsigned 16 bits
+			__m128i x = _mm_add_epi16(_mm_mullo_epi16(o,a),_mm_mullo_epi16(s,_mm_sub_epi16(max,a)));
+			//Divide by 255
+			r[h] = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x,one),_mm_srli_epi16(x,8)),8);
+		}
+		//Pack back to 8 bits
+		_mm_storeu_si128((__m128i*)(dst+i),_mm_packus_epi16(r[0],r[1]));
+	}
+#endif
+	//Remaining pixels
+	for (;i<len;++i)
+		dst[i] = Div255(ovr[i]*alpha[i] + src[i]*(255-alpha[i]));
+}
+
+static void BlendChromaLine(BYTE* dst,const BYTE* src,const BYTE* ovr,const BYTE* alpha1,const BYTE* alpha2,DWORD len)
+{
+	DWORD i = 0;
+#if defined(__AVX2__)
+	const __m256i max = _mm256_set1_epi16(255);
+	const __m256i one = _mm256_set1_epi16(1);
+	const __m256i two = _mm256_set1_epi16(2);
+	const __m256i ones = _mm256_set1_epi8(1);
+	for (;i+16<=len;i+=16)
+	{
+		//Sum the 2x2 luma alphas of each chroma sample and average them
+		__m256i a1 = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(alpha1+i*2)),ones);
+		__m256i a2 = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(alpha2+i*2)),ones);
+		__m256i a = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(a1,a2),two),2);
+		//Widen 16 samples to 16 bits
+		__m256i s = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src+i)));
+		__m256i o = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(ovr+i)));
+		//Blend and divide by 255
+		__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(o,a),_mm256_mullo_epi16(s,_mm256_sub_epi16(max,a)));
+		__m256i r = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x,one),_mm256_srli_epi16(x,8)),8);
+		//Pack back to 8 bits
+		_mm_storeu_si128((__m128i*)(dst+i),_mm_packus_epi16(_mm256_castsi256_si128(r),_mm256_extracti128_si256(r,1)));
+	}
+#elif defined(__SSE4_1__)
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i two = _mm_set1_epi16(2);
+	const __m128i ones = _mm_set1_epi8(1);
+	for (;i+8<=len;i+=8)
+	{
+		//Sum the 2x2 luma alphas of each chroma sample and average them
+		__m128i a1 = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(alpha1+i*2)),ones);
+		__m128i a2 = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(alpha2+i*2)),ones);
+		__m128i a = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(a1,a2),two),2);
+		//Widen 8 samples to 16 bits
+		__m128i s = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(src+i)));
+		__m128i o = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(ovr+i)));
+		//Blend and divide by 255
+		__m128i x = _mm_add_epi16(_mm_mullo_epi16(o,a),_mm_mullo_epi16(s,_mm_sub_epi16(max,a)));
+		__m128i r = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x,one),_mm_srli_epi16(x,8)),8);
+		//Pack back to 8 bits
+		_mm_storel_epi64((__m128i*)(dst+i),_mm_packus_epi16(r,r));
+	}
+#endif
+	//Remaining samples
+	for (;i<len;++i)
+	{
+		DWORD a = (alpha1[i*2] + alpha1[i*2+1] + alpha2[i*2] + alpha2[i*2+1] + 2) >> 2;
+		dst[i] = Div255(ovr[i]*a + src[i]*(255-a));
+	}
+}
+
+void Canvas::Draw(BYTE*image,BYTE* frame)
+{
+	//Update tile classification if overlay has changed
+	Analyze();
+
+	DWORD numPixels = width*height;
+	DWORD chromaWidth = width/2;
+	//Get source
+	const BYTE* srcY = frame;
+	const BYTE* srcU = frame+numPixels;
+	const BYTE* srcV = frame+numPixels*5/4;
+	//Get overlay
+	const BYTE* ovrY = overlay;
+	const BYTE* ovrU = overlay+numPixels;
+	const BYTE* ovrV = overlay+numPixels*5/4;
+	const BYTE* ovrA = overlay+numPixels*3/2;
+	//Get destingation
+	BYTE* dstY = image;
+	BYTE* dstU = image+numPixels;
+	BYTE* dstV = image+numPixels*5/4;
+
+	//For each row of tiles
+	for (DWORD ty=0;ty<tilesY;++ty)
+	{
+		DWORD y0 = ty*TileSize;
+		DWORD y1 = std::min(y0+TileSize,height);
+		DWORD tx = 0;
+		//Process consecutive tiles of same type at once
+		while (tx<tilesX)
+		{
+			Tile type = tiles[ty*tilesX+tx];
+			DWORD end = tx+1;
+			while (end<tilesX && tiles[ty*tilesX+end]==type)
+				++end;
+			//Get horizontal span
+			DWORD x0 = tx*TileSize;
+			DWORD x1 = std::min(end*TileSize,width);
+			DWORD len = x1-x0;
+			//Luma
+			for (DWORD y=y0;y<y1;++y)
+			{
+				DWORD pos = y*width+x0;
+				switch (type)
+				{
+					case Transparent:
+						memcpy(dstY+pos,srcY+pos,len);
+						break;
+					case Opaque:
+						memcpy(dstY+pos,ovrY+pos,len);
+						break;
+					case Partial:
+						BlendLine(dstY+pos,srcY+pos,ovrY+pos,ovrA+pos,len);
+						break;
+				}
+			}
+			//Chroma
+			for (DWORD y=y0/2;y<y1/2;++y)
+			{
+				DWORD pos = y*chromaWidth+x0/2;
+				switch (type)
+				{
+					case Transparent:
+						memcpy(dstU+pos,srcU+pos,len/2);
+						memcpy(dstV+pos,srcV+pos,len/2);
+						break;
+					case Opaque:
+						memcpy(dstU+pos,ovrU+pos,len/2);
+						memcpy(dstV+pos,ovrV+pos,len/2);
+						break;
+					case Partial:
+					{
+						//Get the two alpha lines of the chroma sample
+						const BYTE* alpha1 = ovrA+y*2*width+x0;
+						const BYTE* alpha2 = alpha1+width;
+						BlendChromaLine(dstU+pos,srcU+pos,ovrU+pos,alpha1,alpha2,len/2);
+						BlendChromaLine(dstV+pos,srcV+pos,ovrV+pos,alpha1,alpha2,len/2);
+						break;
+					}
+				}
+			}
+			//Next span
+			tx = end;
+		}
+	}
+}
@@ -18,40 +18,6 @@ extern "C" {
 #include "utf8.h"
 
 
-Canvas::Canvas(DWORD width,DWORD height)
-{
-	//Store values
-	this->width = width;
-	this->height = height;
-	//Calculate size for overlay iage with alpha
-	overlaySize = width*height*4+AV_INPUT_BUFFER_PADDING_SIZE+32;
-	//Create overlay image
-	overlay = (BYTE*)malloc32(overlaySize);
-	//Clean it
-	memset(overlay,0,overlaySize);
-	//Do not display
-	display = false;
-}
-
-Overlay::Overlay(DWORD width,DWORD height) : Canvas(width,height)
-{
-	//Calculate size for final image i.e. without alpha
-	imageSize = width*height*4+AV_INPUT_BUFFER_PADDING_SIZE+32;
-	//Create final image
-	image = (BYTE*)malloc32(imageSize);
-}
-
-Canvas::~Canvas()
-{
-	//Free memor
-	free(overlay);
-}
-
-Overlay::~Overlay()
-{
-	free(image);
-}
-
 int Canvas::LoadPNG(const char* filename)
 {
 	AVFormatContext *fctx = NULL;
@@ -203,6 +169,9 @@ int Canvas::LoadPNG(const char* filename)
 	//Everything was ok
 	res = 1;
 	
+	//Whole overlay has changed
+	SetDirty(0,0,width,height);
+	
 	//Display it then
 	display = true;
 end:
@@ -280,6 +249,9 @@ int Canvas::LoadSVG(const char* svg)
 		av_free(logo);
 		sws_freeContext(sws);
 		
+		//Whole overlay has changed
+		SetDirty(0,0,width,height);
+		
 		//Done
 		display = true;
 	} catch ( Magick::Exception &error ) {
@@ -441,6 +413,8 @@ int Canvas::RenderText(const std::string& utf8,DWORD x,DWORD y,DWORD width,DWORD
 		av_free(rgba);
 		av_free(yuva);
 		sws_freeContext(sws);
+		//Only the text area has changed
+		SetDirty(x,y,width,height);
 		//OK
 		display = true;
 	} catch ( Magick::Exception &error ) {
@@ -451,175 +425,3 @@ int Canvas::RenderText(const std::string& utf8,DWORD x,DWORD y,DWORD width,DWORD
 	//OK
 	return 1;
 }
-
-BYTE* Overlay::Display(uint8_t* frame)
-{
-	//check if we have overlay
-	if (!display)
-		//Return the same frame
-		return frame;
-	//Draw
-	Draw(image,frame);
-	
-	//Return internal image
-	return image;
-}
-
-void Canvas::Reset()
-{
-	//Clean overlay memory
-	memset(overlay,0,overlaySize);
-}
-
-void Canvas::Draw(BYTE*image,BYTE* frame)
-{
-	//Get source
-	BYTE* srcY1 = frame;
-	BYTE* srcY2 = frame+width;
-	BYTE* srcU  = frame+width*height;
-	BYTE* srcV  = frame+width*height*5/4;
-	//Get overlay
-	BYTE* ovrY1 = overlay;
-	BYTE* ovrY2 = overlay+width;
-	BYTE* ovrU  = overlay+width*height;
-	BYTE* ovrV  = overlay+width*height*5/4;
-	BYTE* ovrA1 = overlay+width*height*3/2;
-	BYTE* ovrA2 = overlay+width*height*3/2+width;
-	//Get destingation
-	BYTE* dstY1 = image;
-	BYTE* dstY2 = image+width;
-	BYTE* dstU  = image+width*height;
-	BYTE* dstV  = image+width*height*5/4;
-
-	for (int j=0; j<height/2; ++j)
-	{
-		for (int i=0; i<width/2; ++i)
-		{
-			//Get alpha values
-			BYTE a11 = *(ovrA1++);
-			BYTE a12 = *(ovrA1++);
-			BYTE a21 = *(ovrA2++);
-			BYTE a22 = *(ovrA2++);
-			//Check
-			if (a11==0)
-			{
-				//Set alpha
-				*(dstY1++) = *(srcY1++);
-				//Increase pointer
-				++ovrY1;
-			} else if (a11==255) {
-				//Set original image
-				*(dstY1++) = *(ovrY1++);
-				//Increase pointer
-				++srcY1;
-			} else {
-				DWORD n = 255-a11;
-				DWORD oY = *(ovrY1++);
-				DWORD sY = *(srcY1++);
-				*(dstY1++) = (oY*a11+sY*n)/255;
-				//Calculate and move pointer
-				//*(dstY1++) = (((DWORD)(*(ovrY1++)))*a11 + (((DWORD)(*(srcY1++)))*(~a11)))/255;
-			}
-			//Check
-			if (a12==0)
-			{
-				//Set alpha
-				*(dstY1++) = *(srcY1++);
-				//Increase pointer
-				++ovrY1;
-			} else if (a12==255) {
-				//Set original image
-				*(dstY1++) = *(ovrY1++);
-				//Increase pointer
-				++srcY1;
-			} else {
-				DWORD n = 255-a12;
-				DWORD oY = *(ovrY1++);
-				DWORD sY = *(srcY1++);
-				*(dstY1++) = (oY*a12+sY*n)/255;
-				//Calculate and move pointer
-				//*(dstY1++) = (((DWORD)(*(ovrY1++)))*a12 + (((DWORD)(*(srcY1++)))*(~a12)))/255;
-			}
-			//Check
-			if (a21==0)
-			{
-				//Set alpha
-				*(dstY2++) = *(srcY2++);
-				//Increase pointer
-				++ovrY2;
-			} else if (a21==255) {
-				//Set original image
-				*(dstY2++) = *(ovrY2++);
-				//Increase pointer
-				++srcY2;
-			} else {
-				DWORD n = 255-a21;
-				DWORD oY = *(ovrY2++);
-				DWORD sY = *(srcY2++);
-				*(dstY2++) = (oY*a21+sY*n)/255;
-				//Calculate and move pointer
-				//*(dstY2++) = (((DWORD)(*(ovrY2++)))*a21 + (((DWORD)(*(srcY2++)))*(~a21)))/255;
-			}
-			//Check
-			if (a22==0)
-			{
-				//Set alpha
-				*(dstY2++) = *(srcY2++);
-				//Increase pointer
-				++ovrY2;
-			} else if (a22==255) {
-				//Set original image
-				*(dstY2++) = *(ovrY2++);
-				//Increase pointer
-				++srcY2;
-			} else {
-				DWORD n = 255-a22;
-				DWORD oY = *(ovrY2++);
-				DWORD sY = *(srcY2++);
-				*(dstY2++) = (oY*a22+sY*n)/255;
-				//Calculate and move pointer
-				//*(dstY2++) = (((DWORD)(*(ovrY2++)))*a22 + (((DWORD)(*(srcY2++)))*(~a22)))/255;
-			}
-			//Summ all alphas
-			DWORD alpha = a11+a21+a21+a22;
-			//Check UV
-			if (alpha==0)
-			{
-				//Set UV
-				*(dstU++) = *(srcU++);
-				*(dstV++) = *(srcV++);
-				//Increase pointers
-				++ovrU;
-				++ovrV;
-			} else if (alpha == 1020) {
-				//Set UV
-				*(dstU++) = *(ovrU++);
-				*(dstV++) = *(ovrV++);
-				//Increase pointers
-				++srcU;
-				++srcV;
-			} else {
-				DWORD negalpha = 1020-alpha;
-				DWORD oU = *(ovrU++);
-				DWORD oV = *(ovrV++);
-				DWORD sU = *(srcU++);
-				DWORD sV = *(srcV++);
-				*(dstU++) = (oU*alpha+sU*negalpha)/1020;
-				*(dstV++) = (oV*alpha+sV*negalpha)/1020;
-				//Calculate and move pointer
-				//*(dstU++) = (((DWORD)(*(ovrU++)))*alpha + (((DWORD)(*(srcU++)))*negalpha))/1020;
-				//*(dstV++) = (((DWORD)(*(ovrV++)))*alpha + (((DWORD)(*(srcV++)))*negalpha))/1020;
-
-			}
-		}
-		//Skip Y line
-		srcY1 += width;
-		srcY2 += width;
-		dstY1 += width;
-		dstY2 += width;
-		ovrY1 += width;
-		ovrY2 += width;
-		ovrA1 += width;
-		ovrA2 += width;
-	}
-}
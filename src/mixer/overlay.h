@@ -8,6 +8,8 @@
 #ifndef OVERLAY_H
 #define	OVERLAY_H
 #include "config.h"
+#include <string>
+#include <vector>
 
 
 class Canvas
@@ -22,13 +24,31 @@ public:
 	int RenderText(const std::string& utf8,DWORD x,DWORD y,DWORD width,DWORD height,const Properties& properties);
 	void Draw(BYTE*image, BYTE* frame);
 	void Reset();
+	//Mark an area of the canvas as modified so its tiles are analyzed again before next draw
+	void SetDirty(DWORD x,DWORD y,DWORD width,DWORD height);
 	BYTE* GetCanvas()	{ return overlay;	}
+protected:
+	void Analyze();
+protected:
+	//Alpha classification of each tile, so we only blend where it is needed
+	enum Tile : BYTE
+	{
+		Transparent	= 0,
+		Opaque		= 1,
+		Partial		= 2
+	};
+	static constexpr DWORD TileSize = 16;
 protected:
 	DWORD overlaySize;
 	BYTE* overlay;
 	DWORD width;
 	DWORD height;
-	bool display;	
+	bool display;
+	DWORD tilesX;
+	DWORD tilesY;
+	std::vector<Tile> tiles;
+	std::vector<bool> dirtyTiles;
+	bool dirty;
 };
 
 class Overlay : public Canvas
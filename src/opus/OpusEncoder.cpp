@@ -76,6 +76,20 @@ DWORD OpusEncoder::TrySetRate(DWORD rate, DWORD numChannels)
 	return this->rate;
 }
 
+bool OpusEncoder::CopyState(const AudioEncoder& other)
+{
+	//Only from other opus encoder with same config
+	if (other.type!=AudioCodec::OPUS)
+		return false;
+	const OpusEncoder& encoder = static_cast<const OpusEncoder&>(other);
+	if (!enc || !encoder.enc || encoder.rate!=rate || encoder.numChannels!=numChannels || encoder.mode!=mode)
+		return false;
+	//Encoder state is position independent and can be copied
+	memcpy((void*)enc, (const void*)encoder.enc, opus_encoder_get_size(numChannels));
+	//Done
+	return true;
+}
+
 OpusEncoder::~OpusEncoder()
 {
 	if (enc)
@@ -14,19 +14,25 @@ MediaFrame* OpusDepacketizer::AddPacket(const RTPPacket::shared& packet)
 	frame.SetSenderTime(packet->GetSenderTime());
 	//Set SSRC
 	frame.SetSSRC(packet->GetSSRC());
-	//Add payload
-	AddPayload(packet->GetMediaData(),packet->GetMediaLength());
+	//Add payload, referencing packet data instead of copying it
+	AddPayload(packet->GetMediaData(),packet->GetMediaLength(),packet->SharePayload());
 	//Return frame
 	return &frame;
 }
 
 MediaFrame* OpusDepacketizer::AddPayload(const BYTE* payload,DWORD payloadLen)
+{
+	//No owner, data will be copied
+	return AddPayload(payload,payloadLen,nullptr);
+}
+
+MediaFrame* OpusDepacketizer::AddPayload(const BYTE* payload,DWORD payloadLen,const RTPPayload::shared& owner)
 {
 	//Check lenght
 	if (!payloadLen)
 		return nullptr;
 	//And data
-	DWORD pos = frame.AppendMedia(payload, payloadLen);
+	DWORD pos = frame.AppendMediaReference(owner, payload, payloadLen);
 	//Add RTP packet
 	frame.AddRtpPacket(pos,payloadLen,NULL,0);
 	
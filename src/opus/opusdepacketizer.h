@@ -24,6 +24,8 @@ public:
 	
 	
 private:
+	MediaFrame* AddPayload(const BYTE* payload,DWORD payloadLen,const RTPPayload::shared& owner);
+
 	AudioFrame frame;
 	OpusConfig config;
 };
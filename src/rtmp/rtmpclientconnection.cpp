@@ -299,8 +299,8 @@ void RTMPClientConnection::SignalWriteNeeded()
 	//Unlock
 	pthread_mutex_unlock(&mutex);
 
-	//Signal will cause the poll call to exit
-	Signal();
+	//Update mask, signal will cause the poll call to exit
+	UpdatePollEventMask();
 }
 
 DWORD RTMPClientConnection::SerializeChunkData(BYTE* data, DWORD size)
@@ -310,6 +310,9 @@ DWORD RTMPClientConnection::SerializeChunkData(BYTE* data, DWORD size)
 	//Lock mutex
 	pthread_mutex_lock(&mutex);
 
+	//Store current mask
+	auto prevEventMask = eventMask;
+
 	//Remove the write signal
 	eventMask = Poll::Event::In;
 
@@ -338,9 +341,17 @@ DWORD RTMPClientConnection::SerializeChunkData(BYTE* data, DWORD size)
 		}
 	}
 end:
+	//Check if mask has changed
+	bool changed = eventMask != prevEventMask;
+
 	//Un Lock mutex
 	pthread_mutex_unlock(&mutex);
 
+	//If write events are not needed anymore or needed again
+	if (changed)
+		//Update poll mask
+		UpdatePollEventMask();
+
 	//Return chunks data length
 	return len;
 }
@@ -161,7 +161,7 @@ std::optional<TemplateDependencyStructure> TemplateDependencyStructure::Parse(Bi
 	return tds;
 }
 	
-std::optional<DependencyDescriptor> DependencyDescriptor::Parse(BitReader& reader, const std::optional<TemplateDependencyStructure>& templateDependencyStructure)
+std::optional<DependencyDescriptor> DependencyDescriptor::Parse(BitReader& reader, const TemplateDependencyStructure::shared& templateDependencyStructure)
 {
 	auto dd = std::make_optional<DependencyDescriptor>({});
 	
@@ -185,7 +185,18 @@ std::optional<DependencyDescriptor> DependencyDescriptor::Parse(BitReader& reade
 		if (templateDependencyStructurePresent)
 		{
 			//Parse template dependency
-			dd->templateDependencyStructure = TemplateDependencyStructure::Parse(reader); 
+			auto parsed = TemplateDependencyStructure::Parse(reader); 
+			//Check it was correct
+			if (!parsed)
+				//Error
+				throw std::runtime_error("invalid templateDependencyStructure");
+			//If it has not changed
+			if (templateDependencyStructure && *templateDependencyStructure==*parsed)
+				//Share current one
+				dd->templateDependencyStructure = templateDependencyStructure;
+			else
+				//Store new one
+				dd->templateDependencyStructure = std::make_shared<const TemplateDependencyStructure>(std::move(*parsed));
 			//Set counts
 			dtsCount	= dd->templateDependencyStructure->dtsCount;
 			chainsCount	= dd->templateDependencyStructure->chainsCount;
@@ -223,7 +234,7 @@ std::optional<DependencyDescriptor> DependencyDescriptor::Parse(BitReader& reade
 			//Create custom dtis
 			dd->customDecodeTargetIndications.emplace();
 			//Fill custom dtis up to count
-			while (dd->customDecodeTargetIndications->size() < customDtis)
+			while (dd->customDecodeTargetIndications->size() < dtsCount)
 			{
 				//frame_dti[dtIndex] = f(2)
 				dd->customDecodeTargetIndications->push_back((DecodeTargetIndication)reader.Get(2)); 
@@ -389,7 +400,7 @@ bool DependencyDescriptor::Serialize(BitWriter& writter) const
 		if (templateDependencyStructure || activeDecodeTargets || customDecodeTargetIndications || customFrameDiffs || customFrameDiffsChains ) 
 		{
 			//extended_descriptor_fields()	
-			writter.Put(1, templateDependencyStructure.has_value());
+			writter.Put(1, templateDependencyStructure != nullptr);
 			writter.Put(1, activeDecodeTargets.has_value());
 			writter.Put(1, customDecodeTargetIndications.has_value());
 			writter.Put(1, customFrameDiffs.has_value());
@@ -156,6 +156,183 @@ RTCPCompoundPacket::shared RTCPCompoundPacket::Parse(const BYTE *data,DWORD size
 	return rtcp;
 }
 
+static void VisitReports(const BYTE* data,BYTE count,RTCPCompoundPacket::Visitor& visitor)
+{
+	//Reused for each report block
+	RTCPReport report;
+	//For each one
+	for (BYTE i=0;i<count;++i)
+	{
+		//Copy it
+		report.Parse(data+i*24,24);
+		//Deliver
+		visitor.onReport(report);
+	}
+}
+
+bool RTCPCompoundPacket::Parse(const BYTE *data,DWORD size,Visitor& visitor)
+{
+	//Check if it is an RTCP valid header
+	if (!IsRTCP(data,size))
+	{
+		Error("not rtcp packet");
+		//Exit
+		return false;
+	}
+	//Init pointers
+	const BYTE *buffer = data;
+	DWORD bufferLen = size;
+	//Parse
+	while (bufferLen)
+	{
+		RTCPCommonHeader header;
+		//Get type from header
+		DWORD len = header.Parse(buffer,bufferLen);
+		//If not parsed
+		if (!len)
+		{
+			//error
+			Warning("Wrong rtcp header\n");
+			//Exit
+			return false;
+		}
+		//Check len
+		if (header.length>bufferLen || header.length==0)
+		{
+			//error
+			Warning("Wrong rtcp packet size [headerLen:%d,bufferLen:%d]\n", header.length, bufferLen);
+			//Exit
+			return false;
+		}
+		//Get packet size
+		DWORD packetSize = header.length;
+
+		//Decode in place
+		switch (header.packetType)
+		{
+			case RTCPPacket::SenderReport:
+			{
+				//Check size
+				if (packetSize<len+24+header.count*24)
+					break;
+				//Only sender info, report blocks are delivered on their own
+				RTCPSenderReport sr;
+				sr.SetSSRC(get4(buffer,len));
+				sr.SetNTPSec(get4(buffer,len+4));
+				sr.SetNTPFrac(get4(buffer,len+8));
+				sr.SetRtpTimestamp(get4(buffer,len+12));
+				sr.SetPacketsSent(get4(buffer,len+16));
+				sr.SetOctectsSent(get4(buffer,len+20));
+				//Deliver
+				visitor.onSenderReport(sr);
+				//Deliver reports
+				VisitReports(buffer+len+24,header.count,visitor);
+				break;
+			}
+			case RTCPPacket::ReceiverReport:
+				//Check size
+				if (packetSize<len+4+header.count*24)
+					break;
+				//Deliver reports, skip sender ssrc
+				VisitReports(buffer+len+4,header.count,visitor);
+				break;
+			case RTCPPacket::Bye:
+				//For each ssrc present
+				for (BYTE i=0;i<header.count && len+i*4+4<=packetSize;++i)
+					//Deliver
+					visitor.onBye(get4(buffer,len+i*4));
+				break;
+			case RTCPPacket::RTPFeedback:
+			{
+				//Check size
+				if (packetSize<len+8)
+					break;
+				//Get media ssrc
+				DWORD ssrc = get4(buffer,len+4);
+				//Skip ssrcs
+				DWORD pos = len+8;
+				//Check feedback type
+				switch (header.count)
+				{
+					case RTCPRTPFeedback::NACK:
+						//For each field
+						for (;pos+4<=packetSize;pos+=4)
+							//Deliver
+							visitor.onNACK(ssrc,get2(buffer,pos),get2(buffer,pos+2));
+						break;
+					case RTCPRTPFeedback::TransportWideFeedbackMessage:
+						//While we have more
+						while (pos<packetSize)
+						{
+							RTCPRTPFeedback::TransportWideFeedbackMessageField field;
+							//Parse field
+							DWORD parsed = field.Parse(buffer+pos,packetSize-pos);
+							//If not parsed
+							if (!parsed)
+								break;
+							//Deliver
+							visitor.onTransportWideFeedback(field);
+							//Skip
+							pos += parsed;
+						}
+						break;
+				}
+				break;
+			}
+			case RTCPPacket::PayloadFeedback:
+			{
+				//Check size
+				if (packetSize<len+8)
+					break;
+				//Get media ssrc
+				DWORD ssrc = get4(buffer,len+4);
+				//Get application payload
+				const BYTE* payload = buffer+len+8;
+				DWORD payloadLen = packetSize-len-8;
+				//Check feedback type
+				switch (header.count)
+				{
+					case RTCPPayloadFeedback::PictureLossIndication:
+					case RTCPPayloadFeedback::FullIntraRequest:
+						//Deliver
+						visitor.onPLI(ssrc);
+						break;
+					case RTCPPayloadFeedback::ApplicationLayerFeeedbackMessage:
+						//Check if it is a REMB
+						if (payloadLen>8 && payload[0]=='R' && payload[1]=='E' && payload[2]=='M' && payload[3]=='B')
+						{
+							//Get SSRC count
+							BYTE num = payload[4];
+							//GEt exponent
+							BYTE exp = payload[5] >> 2;
+							DWORD mantisa = payload[5] & 0x03;
+							mantisa = mantisa << 8 | payload[6];
+							mantisa = mantisa << 8 | payload[7];
+							//Get bitrate
+							DWORD bitrate = mantisa << exp;
+							//For each ssrc present
+							for (DWORD i=0;i<num && 8+4*i+4<=payloadLen;++i)
+								//Deliver
+								visitor.onREMB(get4(payload,8+4*i),bitrate);
+						}
+						break;
+				}
+				break;
+			}
+			default:
+				//Not handled
+				break;
+		}
+		//Remove size
+		bufferLen -= header.length;
+		//Increase pointer
+		buffer    += header.length;
+	}
+
+	//Done
+	return true;
+}
+
 void RTCPCompoundPacket::Dump() const
 {
 	Debug("[RTCPCompoundPacket count=%llu size=%d]\n",packets.size(),GetSize());
@@ -280,20 +280,20 @@ DWORD RTPHeaderExtension::Parse(const RTPMap &extMap,const BYTE* data,const DWOR
 				break;
 			// SDES string items
 			case Type::RTPStreamId:
-				hasRId = true;
-				rid.assign((const char*)ext+i,len);
+				//Decoded on demand
+				hasRId = SetRaw(RTPStreamId,ext+i,len);
 				break;	
 			case Type::RepairedRTPStreamId:
-				hasRepairedId = true;
-				repairedId.assign((const char*)ext+i,len);
+				//Decoded on demand
+				hasRepairedId = SetRaw(RepairedRTPStreamId,ext+i,len);
 				break;	
 			case Type::MediaStreamId:
-				hasMediaStreamId = true;
-				mid.assign((const char*)ext+i,len);
+				//Decoded on demand
+				hasMediaStreamId = SetRaw(MediaStreamId,ext+i,len);
 				break;
 			case Type::DependencyDescriptor:
-				//Leave it for later
-				dependencyDescryptorReader.emplace(ext+i,len);
+				//Leave it for later, it needs the current template structure
+				SetRaw(DependencyDescriptor,ext+i,len);
 				break;
 			case Type::AbsoluteCaptureTime:
 				//	Data layout of the shortened version of abs-capture-time with a 1-byte header + 8 bytes of data:
@@ -399,70 +399,14 @@ DWORD RTPHeaderExtension::Parse(const RTPMap &extMap,const BYTE* data,const DWOR
 				//
 				if (len!=4 && len!=28)
 					break;
-				//Init flag and optional data
-				hasColorSpace = true;
-				colorSpace.emplace();
-
-				//Get reader
-				BufferReader reader(ext+i, len);
-
-				//Get base config
-				colorSpace->primaries	 = reader.Get1();
-				colorSpace->transfer	 = reader.Get1();
-				colorSpace->matrix	 = reader.Get1();
-				BYTE rangeChromaSiting	 = reader.Get1();
-
-				//Range and chroma siting : (range << 4) + (horz << 2) + vert.
-				colorSpace->range			= rangeChromaSiting >> 4;
-				colorSpace->chromeSitingHorizontal	= (rangeChromaSiting >> 2 ) & 0b11;
-				colorSpace->chromeSitingVertical	= rangeChromaSiting & 0b11;
-
-				//Check if we have hdr metadata
-				if (len == 28)
-				{
-					//Init data
-					colorSpace->hdrMetadata.emplace();
-
-					//Luminance
-					colorSpace->hdrMetadata->luminanceMax	= reader.Get1();
-					colorSpace->hdrMetadata->luminanceMin	= reader.Get1();
-					//Red
-					BYTE primaryR = reader.Get1();
-					colorSpace->hdrMetadata->primaryRX	= primaryR >>4;
-					colorSpace->hdrMetadata->primaryRY	= primaryR & 0b1111;
-					//Green
-					BYTE primaryG = reader.Get1();
-					colorSpace->hdrMetadata->primaryGX	= primaryG >> 4;
-					colorSpace->hdrMetadata->primaryGY	= primaryG & 0b1111;
-					//Blue
-					BYTE primaryB = reader.Get1();
-					colorSpace->hdrMetadata->primaryBX	= primaryB >> 4;
-					colorSpace->hdrMetadata->primaryBY	= primaryB & 0b1111;
-					//White
-					BYTE white = reader.Get1();
-					colorSpace->hdrMetadata->whiteX		= white >> 4;
-					colorSpace->hdrMetadata->whiteY		= white & 0b1111;
-					//Light
-					colorSpace->hdrMetadata->maxContentLightLevel		= reader.Get2();
-					colorSpace->hdrMetadata->maxFrameAverageLightLevel	= reader.Get2();
-				}
-
+				//Decoded on demand
+				hasColorSpace = SetRaw(ColorSpace,ext+i,len);
 				break;
 			}
 			case Type::VideoLayersAllocation:
-			{
-				
-				//Get reader for extension data
-				BufferReader reader(ext + i, len);
-
-				//Init data, flag will be set when parsing is ok
-				videoLayersAllocation = VideoLayersAllocation::Parse(reader);
-				
-				//Check if correctly parsed
-				hasVideoLayersAllocation = videoLayersAllocation.has_value();
-
+				//Decoded on demand
+				hasVideoLayersAllocation = SetRaw(VideoLayersAllocation,ext+i,len);
 				break;
-			}
 			default:
 				UltraDebug("-RTPHeaderExtension::Parse() | Unknown or unmapped extension [%d]\n",id);
 				break;
@@ -474,25 +418,157 @@ DWORD RTPHeaderExtension::Parse(const RTPMap &extMap,const BYTE* data,const DWOR
 	return 4+length;
 }
 
-bool RTPHeaderExtension::ParseDependencyDescriptor(const std::optional<TemplateDependencyStructure>& templateDependencyStructure)
+bool RTPHeaderExtension::ParseDependencyDescriptor(const TemplateDependencyStructure::shared& templateDependencyStructure)
 {
+	//Get raw data
+	const auto& element = GetRaw(DependencyDescriptor);
 	//Check we have anything to read
-	if (!dependencyDescryptorReader)
+	if (!element.present)
 		//Error
 		return false;
 	
 	//Parse it
-	BitReader bitrader(*dependencyDescryptorReader);
+	BufferReader reader(raw.data()+element.pos,element.len);
+	BitReader bitrader(reader);
 	dependencyDescryptor = DependencyDescriptor::Parse(bitrader,templateDependencyStructure);
 	//Was it parsed correctly?
 	hasDependencyDescriptor = dependencyDescryptor.has_value();
-	//Release reader
-	dependencyDescryptorReader.reset();
 
 	//Done
 	return hasDependencyDescriptor;
 }
 
+bool RTPHeaderExtension::SetRaw(Type type, const BYTE* data, DWORD size)
+{
+	auto& element = elements[type];
+
+	//Check max extension length
+	if (size>0xff)
+		return Warning("-RTPHeaderExtension::SetRaw() | Extension too big [type:%s,size:%d]\n",GetNameFor(type),size);
+
+	//If it doesn't fit on previous position
+	if (!element.present || element.len<size)
+	{
+		//Check we have enought space
+		if (rawLength+size>MaxRawSize)
+			return Warning("-RTPHeaderExtension::SetRaw() | Not enought space [type:%s,size:%d,used:%d]\n",GetNameFor(type),size,rawLength);
+		//Append at the end
+		element.pos = rawLength;
+		rawLength += size;
+	}
+
+	//Copy data
+	memcpy(raw.data()+element.pos,data,size);
+	element.len = size;
+	element.present = true;
+
+	//Done
+	return true;
+}
+
+std::string RTPHeaderExtension::GetRawString(Type type) const
+{
+	const auto& element = GetRaw(type);
+	//Check we have it
+	if (!element.present)
+		return std::string();
+	//Create string from data
+	return std::string((const char*)raw.data()+element.pos,element.len);
+}
+
+const std::optional<struct RTPHeaderExtension::ColorSpace>& RTPHeaderExtension::GetColorSpace() const
+{
+	const auto& element = GetRaw(ColorSpace);
+
+	//If already decoded or nothing to decode
+	if (colorSpace || !element.present)
+		return colorSpace;
+
+	//Init optional data
+	colorSpace.emplace();
+
+	//Get reader
+	BufferReader reader(raw.data()+element.pos, element.len);
+
+	//Get base config
+	colorSpace->primaries	 = reader.Get1();
+	colorSpace->transfer	 = reader.Get1();
+	colorSpace->matrix	 = reader.Get1();
+	BYTE rangeChromaSiting	 = reader.Get1();
+
+	//Range and chroma siting : (range << 4) + (horz << 2) + vert.
+	colorSpace->range			= rangeChromaSiting >> 4;
+	colorSpace->chromeSitingHorizontal	= (rangeChromaSiting >> 2 ) & 0b11;
+	colorSpace->chromeSitingVertical	= rangeChromaSiting & 0b11;
+
+	//Check if we have hdr metadata
+	if (element.len == 28)
+	{
+		//Init data
+		colorSpace->hdrMetadata.emplace();
+
+		//Luminance
+		colorSpace->hdrMetadata->luminanceMax	= reader.Get1();
+		colorSpace->hdrMetadata->luminanceMin	= reader.Get1();
+		//Red
+		BYTE primaryR = reader.Get1();
+		colorSpace->hdrMetadata->primaryRX	= primaryR >>4;
+		colorSpace->hdrMetadata->primaryRY	= primaryR & 0b1111;
+		//Green
+		BYTE primaryG = reader.Get1();
+		colorSpace->hdrMetadata->primaryGX	= primaryG >> 4;
+		colorSpace->hdrMetadata->primaryGY	= primaryG & 0b1111;
+		//Blue
+		BYTE primaryB = reader.Get1();
+		colorSpace->hdrMetadata->primaryBX	= primaryB >> 4;
+		colorSpace->hdrMetadata->primaryBY	= primaryB & 0b1111;
+		//White
+		BYTE white = reader.Get1();
+		colorSpace->hdrMetadata->whiteX		= white >> 4;
+		colorSpace->hdrMetadata->whiteY		= white & 0b1111;
+		//Light
+		colorSpace->hdrMetadata->maxContentLightLevel		= reader.Get2();
+		colorSpace->hdrMetadata->maxFrameAverageLightLevel	= reader.Get2();
+	}
+
+	return colorSpace;
+}
+
+const std::optional<VideoLayersAllocation>& RTPHeaderExtension::GetVideoLayersAllocation() const
+{
+	const auto& element = GetRaw(VideoLayersAllocation);
+
+	//If already decoded or nothing to decode
+	if (videoLayersAllocation || !element.present)
+		return videoLayersAllocation;
+
+	//Get reader for extension data
+	BufferReader reader(raw.data()+element.pos, element.len);
+
+	//Parse it, will be empty if not valid
+	videoLayersAllocation = VideoLayersAllocation::Parse(reader);
+
+	return videoLayersAllocation;
+}
+
+void RTPHeaderExtension::SetColorSpace(const struct ColorSpace& colorSpace)
+{
+	//Set decoded value
+	this->colorSpace = colorSpace;
+	hasColorSpace = true;
+	//Raw data is not valid anymore
+	elements[ColorSpace].present = false;
+}
+
+void RTPHeaderExtension::SetVideoLayersAllocation(const ::VideoLayersAllocation& videoLayersAllocation)
+{
+	//Set decoded value
+	this->videoLayersAllocation = videoLayersAllocation;
+	hasVideoLayersAllocation = true;
+	//Raw data is not valid anymore
+	elements[VideoLayersAllocation].present = false;
+}
+
 DWORD RTPHeaderExtension::Serialize(const RTPMap &extMap,BYTE* data,const DWORD size) const
 {
 	size_t n;
@@ -505,12 +581,16 @@ DWORD RTPHeaderExtension::Serialize(const RTPMap &extMap,BYTE* data,const DWORD
 	//Try with 1 byte header length first
 	int headerLength = 1;
 
-	//Check if any of the ids is too big
-	if (hasRId && rid.length() > 0x0f)
+	//Check if any of the ids or undecoded extensions is too big
+	if (hasRId && GetRaw(RTPStreamId).len > 0x0f)
+		headerLength = 2;
+	else if (hasRepairedId && GetRaw(RepairedRTPStreamId).len > 0x0f)
+		headerLength = 2;
+	else if (hasMediaStreamId && GetRaw(MediaStreamId).len > 0x0f)
 		headerLength = 2;
-	else if (hasRepairedId && repairedId.length() > 0x0f)
+	else if (hasVideoLayersAllocation && GetRaw(VideoLayersAllocation).len > 0x0f)
 		headerLength = 2;
-	else if (hasMediaStreamId && mid.length() > 0x0f)
+	else if (hasColorSpace && (GetRaw(ColorSpace).len > 0x0f || (colorSpace && colorSpace->hdrMetadata)))
 		headerLength = 2;
 			
 
@@ -554,8 +634,25 @@ DWORD RTPHeaderExtension::Serialize(const RTPMap &extMap,BYTE* data,const DWORD
 		}
 	}
 
-	if (hasVideoLayersAllocation && videoLayersAllocation)
+	if (hasVideoLayersAllocation && GetRaw(VideoLayersAllocation).present)
 	{
+		//Copy it as it was received
+		const auto& element = GetRaw(VideoLayersAllocation);
+
+		//Get id for extension
+		BYTE id = extMap.GetTypeForCodec(VideoLayersAllocation);
+
+		//Write header 
+		if ((n = WriteHeaderIdAndLength(data, len, id, element.len, headerLength)))
+		{
+			//Inc header len
+			len += n;
+			//Copy contents
+			memcpy(data + len, raw.data() + element.pos, element.len);
+			//Append length
+			len += element.len;
+		}
+	} else if (hasVideoLayersAllocation && videoLayersAllocation) {
 		//Use a temporary memory to serialize and check final size
 		BYTE ext[255];
 
@@ -782,54 +879,32 @@ DWORD RTPHeaderExtension::Serialize(const RTPMap &extMap,BYTE* data,const DWORD
 		}
 	}
 	
-	if (hasRId)
-	{
-		//Get id for extension
-		BYTE id = extMap.GetTypeForCodec(RTPStreamId);
-		
-		//Write header 
-		if ((n = WriteHeaderIdAndLength(data,len,id,rid.length(),headerLength)))
-		{
-			//Inc header len
-			len += n;
-			//Copy str contents
-			memcpy(data+len,rid.c_str(),rid.length());
-			//Append length
-			len+=rid.length();
-		}
-	}
-	
-	if (hasRepairedId)
-	{
-		//Get id for extension
-		BYTE id = extMap.GetTypeForCodec(RepairedRTPStreamId);
-		
-		//Write header 
-		if ((n = WriteHeaderIdAndLength(data,len,id,repairedId.length(),headerLength)))
-		{
-			//Inc header len
-			len += n;
-			//Copy str contents
-			memcpy(data+len,repairedId.c_str(),repairedId.length());
-			//Append length
-			len+=repairedId.length();
-		}
-	}
-	
-	if (hasMediaStreamId)
+	//SDES string items are always kept undecoded
+	const std::pair<Type,bool> sdes[] = {
+		{RTPStreamId,		hasRId},
+		{RepairedRTPStreamId,	hasRepairedId},
+		{MediaStreamId,		hasMediaStreamId}
+	};
+	for (const auto& [type,enabled] : sdes)
 	{
+		//Get data
+		const auto& element = GetRaw(type);
+		//Check if present
+		if (!enabled || !element.present)
+			continue;
+
 		//Get id for extension
-		BYTE id = extMap.GetTypeForCodec(MediaStreamId);
+		BYTE id = extMap.GetTypeForCodec(type);
 		
 		//Write header 
-		if ((n = WriteHeaderIdAndLength(data,len,id,mid.length(),headerLength)))
+		if ((n = WriteHeaderIdAndLength(data,len,id,element.len,headerLength)))
 		{
 			//Inc header len
 			len += n;
 			//Copy str contents
-			memcpy(data+len,mid.c_str(),mid.length());
+			memcpy(data+len,raw.data()+element.pos,element.len);
 			//Append length
-			len+=mid.length();
+			len+=element.len;
 		}
 	}
 	
@@ -886,8 +961,25 @@ DWORD RTPHeaderExtension::Serialize(const RTPMap &extMap,BYTE* data,const DWORD
 
 	}
 
-	if (hasColorSpace && colorSpace)
+	if (hasColorSpace && GetRaw(ColorSpace).present)
 	{
+		//Copy it as it was received
+		const auto& element = GetRaw(ColorSpace);
+
+		//Get id for extension
+		BYTE id = extMap.GetTypeForCodec(ColorSpace);
+
+		//Write header 
+		if ((n = WriteHeaderIdAndLength(data, len, id, element.len, headerLength)))
+		{
+			//Inc header len
+			len += n;
+			//Copy contents
+			memcpy(data + len, raw.data() + element.pos, element.len);
+			//Append length
+			len += element.len;
+		}
+	} else if (hasColorSpace && colorSpace) {
 		//Get id for extension
 		BYTE id = extMap.GetTypeForCodec(ColorSpace);
 
@@ -976,11 +1068,11 @@ void RTPHeaderExtension::Dump() const
 		);
 	
 	if (hasRId)
-		Debug("\t\t\t[RId str=\"%s\"]\n",rid.c_str());
+		Debug("\t\t\t[RId str=\"%s\"]\n",GetRId().c_str());
 	if (hasRepairedId)
-		Debug("\t\t\t[RepairedId str=\"%s\"]\n",repairedId.c_str());
+		Debug("\t\t\t[RepairedId str=\"%s\"]\n",GetRepairedId().c_str());
 	if (hasMediaStreamId)
-		Debug("\t\t\t[MediaStreamId str=\"%s\"]\n",mid.c_str());
+		Debug("\t\t\t[MediaStreamId str=\"%s\"]\n",GetMediaStreamId().c_str());
 	if (hasDependencyDescriptor && dependencyDescryptor)
 		dependencyDescryptor->Dump();
 	if (hasAbsoluteCaptureTime)
@@ -992,7 +1084,7 @@ void RTPHeaderExtension::Dump() const
 		);
 	if (hasPlayoutDelay)
 		Debug("\t\t\t[PlayoutDelay min=%u max=%u]\n", playoutDelay.min, playoutDelay.max);
-	if (hasColorSpace && colorSpace)
+	if (hasColorSpace && GetColorSpace())
 	{
 		Debug("\t\t\t[ColorSpace primaries=%u transfer=%u matrix=%u range=%u chromeSitingHorizontal=%u chromeSitingVertical=%u/]\n",
 			colorSpace->primaries,
@@ -0,0 +1,185 @@
+#include "rtp/RTPHeaderTemplate.h"
+#include "rtp/RTPPacket.h"
+#include "tools.h"
+#include "log.h"
+
+void RTPHeaderTemplate::Init(MediaFrame::Type type, DWORD ssrc, const std::string& mid, const std::string& rid, const std::optional<struct RTPHeaderExtension::PlayoutDelay>& playoutDelay, const RTPMap& extMap)
+{
+	//Get extension ids, in the same cases they are set on the packets by the transport
+	BYTE transportWideCCId	= type == MediaFrame::Video ? extMap.GetTypeForCodec(RTPHeaderExtension::TransportWideCC) : RTPMap::NotFound;
+	BYTE absSentTimeId	= extMap.GetTypeForCodec(RTPHeaderExtension::AbsoluteSendTime);
+	BYTE audioLevelId	= type == MediaFrame::Audio ? extMap.GetTypeForCodec(RTPHeaderExtension::SSRCAudioLevel) : RTPMap::NotFound;
+	BYTE playoutDelayId	= playoutDelay ? extMap.GetTypeForCodec(RTPHeaderExtension::PlayoutDelay) : RTPMap::NotFound;
+	BYTE midId		= !mid.empty() ? extMap.GetTypeForCodec(RTPHeaderExtension::MediaStreamId) : RTPMap::NotFound;
+	BYTE ridId		= !mid.empty() && !rid.empty() ? extMap.GetTypeForCodec(RTPHeaderExtension::RTPStreamId) : RTPMap::NotFound;
+
+	//Too long ids can not be sent
+	if (mid.length()>255)
+		midId = ridId = RTPMap::NotFound;
+	if (rid.length()>255)
+		ridId = RTPMap::NotFound;
+
+	//Elements to write
+	std::vector<std::pair<BYTE,DWORD>> elements = {
+		{ transportWideCCId,	2		},
+		{ absSentTimeId,	3		},
+		{ audioLevelId,		1		},
+		{ playoutDelayId,	3		},
+		{ midId,		mid.length()	},
+		{ ridId,		rid.length()	},
+	};
+
+	//Use 1 byte headers unless an id or length does not fit
+	int headerLength = 1;
+	bool extension = false;
+	for (const auto& [id,length] : elements)
+	{
+		//Skip not negotiated ones
+		if (id==RTPMap::NotFound)
+			continue;
+		//Got one
+		extension = true;
+		//Check if it fits
+		if (id>14 || length>16)
+			headerLength = 2;
+	}
+
+	//Start clean
+	Reset();
+
+	//Fixed header
+	header.resize(12);
+	//Version 2, extension bit
+	header[0] = 0x80 | (extension ? 0x10 : 0x00);
+	//Set ssrc
+	set4(header.data(),8,ssrc);
+
+	//If no extensions
+	if (!extension)
+	{
+		//Done
+		initialized = true;
+		return;
+	}
+
+	//Reserve space for extensions header and all elements
+	header.resize(12+4+elements.size()*2+2+3+1+3+mid.length()+rid.length()+3);
+	DWORD len = 16;
+
+	//Write element header and return its value position
+	auto write = [&](BYTE id, DWORD length) -> DWORD {
+		if (headerLength==1)
+		{
+			header[len++] = id << 4 | (length-1);
+		} else {
+			header[len++] = id;
+			header[len++] = length;
+		}
+		DWORD pos = len;
+		len += length;
+		return pos;
+	};
+
+	if (transportWideCCId!=RTPMap::NotFound)
+		transportWideCCPos = write(transportWideCCId,2);
+	if (absSentTimeId!=RTPMap::NotFound)
+		absSentTimePos = write(absSentTimeId,3);
+	if (audioLevelId!=RTPMap::NotFound)
+		audioLevelPos = write(audioLevelId,1);
+	if (playoutDelayId!=RTPMap::NotFound)
+	{
+		//Constant for the stream
+		set3(header.data(),write(playoutDelayId,3),((playoutDelay->min / RTPHeaderExtension::PlayoutDelay::GranularityMs) << 12) | ((playoutDelay->max / RTPHeaderExtension::PlayoutDelay::GranularityMs ) & 0xfff));
+		hasPlayoutDelay = true;
+	}
+	if (midId!=RTPMap::NotFound)
+		memcpy(header.data()+write(midId,mid.length()),mid.data(),mid.length());
+	if (ridId!=RTPMap::NotFound)
+		memcpy(header.data()+write(ridId,rid.length()),rid.data(),rid.length());
+
+	//Pad to 32 bit words
+	while(len%4)
+		header[len++] = 0;
+
+	//Set magic header
+	set2(header.data(),12,headerLength==1 ? 0xBEDE : 0x1000);
+	//Set length
+	set2(header.data(),14,(len-12)/4-1);
+
+	//Remove unused space
+	header.resize(len);
+
+	//Done
+	initialized = true;
+}
+
+void RTPHeaderTemplate::Reset()
+{
+	header.clear();
+	initialized		= false;
+	transportWideCCPos	= 0;
+	absSentTimePos		= 0;
+	audioLevelPos		= 0;
+	hasPlayoutDelay		= false;
+}
+
+bool RTPHeaderTemplate::CanSerialize(const RTPPacket& packet) const
+{
+	//Check we have it
+	if (!initialized)
+		return false;
+
+	//Per packet extensions must match the ones on the template
+	if (packet.HasTransportWideCC()!=(transportWideCCPos>0)
+		|| packet.HasAbsSentTime()!=(absSentTimePos>0)
+		|| packet.HasAudioLevel()!=(audioLevelPos>0)
+		|| packet.HasPlayoutDelay()!=hasPlayoutDelay)
+		return false;
+
+	//Any other extension or header field not in the template requires a full serialization
+	return packet.GetRTPHeader().csrcs.empty()
+		&& !packet.HasOSN()
+		&& !(packet.rewitePictureIds && packet.vp8PayloadDescriptor)
+		&& !packet.HasTimeOffeset()
+		&& !packet.HasVideoOrientation()
+		&& !packet.HasDependencyDestriptor()
+		&& !packet.HasAbsoluteCaptureTime()
+		&& !packet.GetRTPHeaderExtension().hasColorSpace
+		&& !packet.GetRTPHeaderExtension().hasVideoLayersAllocation;
+}
+
+DWORD RTPHeaderTemplate::Serialize(BYTE* data, DWORD size, const RTPPacket& packet) const
+{
+	//Check template can be used
+	if (!CanSerialize(packet))
+		return 0;
+
+	//Get lengths
+	DWORD len = header.size();
+	DWORD mediaLength = packet.GetMediaLength();
+
+	//Check size
+	if (len+mediaLength>size)
+		//Error
+		return Error("-RTPHeaderTemplate::Serialize() | Media overflow\n");
+
+	//Copy template
+	memcpy(data,header.data(),len);
+
+	//Patch per packet fields
+	data[1] = (packet.GetMark() ? 0x80 : 0x00) | (packet.GetPayloadType() & 0x7f);
+	set2(data,2,packet.GetSeqNum());
+	set4(data,4,packet.GetTimestamp());
+	if (transportWideCCPos)
+		set2(data,transportWideCCPos,packet.GetTransportSeqNum());
+	if (absSentTimePos)
+		set3(data,absSentTimePos,((packet.GetAbsSendTime() << 18) / 1000));
+	if (audioLevelPos)
+		data[audioLevelPos] = (packet.GetVAD() ? 0x80 : 0x00) | (packet.GetLevel() & 0x7f);
+
+	//Copy media payload
+	memcpy(data+len,packet.GetMediaData(),mediaLength);
+
+	//Done
+	return len+mediaLength;
+}
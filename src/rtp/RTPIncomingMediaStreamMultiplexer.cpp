@@ -88,12 +88,18 @@ void RTPIncomingMediaStreamMultiplexer::onRTP(const RTPIncomingMediaStream* stre
 		AsyncSafe([=,ssrc = stream->GetMediaSSRC()](auto now){
 			//Trace method
 			TRACE_EVENT("rtp", "RTPIncomingMediaStreamMultiplexer::onRTP async", "ssrc", ssrc, "packets", packets.size());
+			//Deliver whole batch to the listeners that can process it at once
+			for (auto listener : listeners)
+				if (listener->HandlesBatches())
+					//Dispatch rtp packets
+					listener->onRTP(this,packets);
 			//Process each packet in order, if we reverse the order of the loops, the last listeners would have a lot of delay
 			for (const auto& packet : packets)
 				//Deliver to all listeners
 				for (auto listener : listeners)
-					//Dispatch rtp packet
-					listener->onRTP(this,packet);
+					if (!listener->HandlesBatches())
+						//Dispatch rtp packet
+						listener->onRTP(this,packet);
 		});
 	}
 }
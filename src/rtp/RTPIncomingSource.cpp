@@ -317,22 +317,22 @@ void RTPIncomingSource::Update(QWORD now)
 	//UltraDebug("-RTPIncomingSource::Update() [frameDelay:%d,frameDelayMax:%d,frameDelayMax:%d,frameCaptureDelayMax:%d]\n", frameDelay, frameDelayMax, frameCaptureDelay, frameCaptureDelayMax);
 }
 
-void RTPIncomingSource::Process(QWORD now, const RTCPSenderReport::shared& sr)
+void RTPIncomingSource::Process(QWORD now, const RTCPSenderReport& sr)
 {
 	//If first
 	if (!firstReceivedSenderTime)
 	{
 		//Store time
-		firstReceivedSenderTime = sr->GetTimestamp()/1000;
-		firstReceivedSenderTimestamp = sr->GetRTPTimestamp();
+		firstReceivedSenderTime = sr.GetTimestamp()/1000;
+		firstReceivedSenderTimestamp = sr.GetRTPTimestamp();
 		//Debug
 		UltraDebug("-RTPIncomingSource::Process() | Got first Report [ssrc:0x%x,firstTime:%lld,firstTimestamp:%lld]\n", ssrc, firstReceivedSenderTime, firstReceivedSenderTimestamp);
 	}
 
 	//Store info
-	lastReceivedSenderNTPTimestamp = sr->GetNTPTimestamp();
-	lastReceivedSenderTime = sr->GetTimestamp()/1000;
-	lastReceivedSenderRTPTimestampExtender.ExtendOrReset(sr->GetRTPTimestamp());
+	lastReceivedSenderNTPTimestamp = sr.GetNTPTimestamp();
+	lastReceivedSenderTime = sr.GetTimestamp()/1000;
+	lastReceivedSenderRTPTimestampExtender.ExtendOrReset(sr.GetRTPTimestamp());
 	lastReceivedSenderReport = now;
 	
 	//Ensure we have clock rate configured
@@ -345,7 +345,7 @@ void RTPIncomingSource::Process(QWORD now, const RTCPSenderReport::shared& sr)
 		skew = deltaTimeMs - deltaTimeThroughTimestampMs;
 		drift = deltaTimeMs ? (double)deltaTimeThroughTimestampMs/deltaTimeMs : 1;
 		//Debug
-		UltraDebug("-RTPIncomingSource::Process() | Sender Report [ssrc:0x%x,skew:%lld,deltaTime:%llu,deltaTimestamp:%llu,senderTime:%llu,firstTime:%lld,firstTimestamp:%lld,rtpTimestamp:%d,lastExtSeqNum:%llu,clockrate:%u]\n",ssrc,skew,deltaTimeMs,deltaTimeThroughTimestampMs,lastReceivedSenderTime, firstReceivedSenderTime, firstReceivedSenderTimestamp, sr->GetRTPTimestamp(), lastReceivedSenderRTPTimestampExtender.GetExtSeqNum(),clockrate);
+		UltraDebug("-RTPIncomingSource::Process() | Sender Report [ssrc:0x%x,skew:%lld,deltaTime:%llu,deltaTimestamp:%llu,senderTime:%llu,firstTime:%lld,firstTimestamp:%lld,rtpTimestamp:%d,lastExtSeqNum:%llu,clockrate:%u]\n",ssrc,skew,deltaTimeMs,deltaTimeThroughTimestampMs,lastReceivedSenderTime, firstReceivedSenderTime, firstReceivedSenderTimestamp, sr.GetRTPTimestamp(), lastReceivedSenderRTPTimestampExtender.GetExtSeqNum(),clockrate);
 	}
 }
 
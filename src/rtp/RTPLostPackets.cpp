@@ -2,97 +2,97 @@
 
 RTPLostPackets::RTPLostPackets(WORD num)
 {
-	//Store number of packets
-	size = num;
-	//Create buffer
-	packets = (QWORD*) malloc(num*sizeof(QWORD));
-	//Set to 0
-	memset(packets,0,size*sizeof(QWORD));
+	//Store number of packets, rounded to whole bitmask words
+	size = (num + 63) & ~63;
+	//Create buffers, all not received and never requested
+	received.resize(size/64, 0);
+	attempts.resize(size, 0);
+	requested.resize(size, 0);
 }
 
 void RTPLostPackets::Reset()
 {
 	//Set to 0
-	memset(packets,0,size*sizeof(QWORD));
+	std::fill(received.begin(), received.end(), 0);
+	std::fill(attempts.begin(), attempts.end(), 0);
+	std::fill(requested.begin(), requested.end(), 0);
 	//No first packet
 	first = 0;
 	//None yet
 	len = 0;
 	total = 0;
-}
-
-RTPLostPackets::~RTPLostPackets()
-{
-	free(packets);
+	recovered = 0;
 }
 
 WORD RTPLostPackets::AddPacket(const RTPPacket::shared &packet)
 {
-	int lost = 0;
+	WORD lost = 0;
 	
 	//Get the packet number
 	DWORD extSeq = packet->GetExtSeqNum();
 	
 	//Check if is before first
-	if (first && extSeq<first)
+	if (len && extSeq<first)
 		//Exit, very old packet
 		return 0;
 
 	//If we are first
-	if (!first)
+	if (!len)
 		//Set to us
 		first = extSeq;
 	       
 	//Get our position
-	WORD pos = extSeq-first;
+	DWORD pos = extSeq-first;
 	
 	//Check if we are still in window
-	if (pos+1>size) 
+	if (pos>=size) 
 	{
 		//How much do we need to remove?
-		int n = pos+1-size;
-		//Check if we have to much to remove
-		if (n>size)
-			//cap it
-			n = size;
-		//Caculate total count
-		for (int i=0;i<n;++i)
+		DWORD n = pos+1-size;
+		//Only the ones already seen can be removed
+		DWORD removed = std::min<DWORD>(n,len);
+		//Release them
+		for (DWORD i=0;i<removed;++i)
+		{
+			DWORD index = GetIndex(first+i);
 			//If it was lost
-			if (!packets[i])
+			if (!IsReceived(index))
 				//Decrease total
 				total--;
-		//Move the rest
-		memmove(packets,packets+n,(size-n)*sizeof(QWORD));
-		//Fill with 0 the new ones
-		memset(packets+(size-n),0,n*sizeof(QWORD));
+			//Clean state
+			Clear(index);
+		}
 		//Set first
 		first = extSeq-size+1;
-		//Full
-		len = size-1;
+		//Update length
+		len -= removed;
 		//We are last
 		pos = size-1;
 	} 
 	
+	//Get ring position
+	DWORD index = GetIndex(extSeq);
+	
 	//Check if it is last
 	if (len<pos+1)
 	{
-		//look until we find a non lost and increase counter in the meanwhile
-		for (int i=pos; i>0 && !packets[i-1];--i)
-			//Lost
-			lost++;
+		//All the ones in between are lost
+		lost = pos-len;
 		//Increase lost
 		total += lost;
 		//Update last
 		len = pos+1;
-	} else {
-		//If it was lost
-		if (!packets[pos])
-			//One lost total less
-			total--;
+	} else if (!IsReceived(index)) {
+		//One lost total less
+		total--;
+		//If we have requested it
+		if (attempts[index])
+			//Recovered by retransmission
+			recovered++;
 	}
 	
 	//Set
-	packets[pos] = packet->GetTime();
+	SetReceived(index);
 	
 	//Return lost ones
 	return lost;
@@ -109,11 +109,12 @@ std::list<RTCPRTPFeedback::NACKField::shared> RTPLostPackets::GetNacks() const
 	//Iterate packets
 	for(WORD i=0;i<len;i++)
 	{
+		bool isLost = !IsReceived(GetIndex(first+i));
 		//Are we in a lost count?
 		if (lost)
 		{
 			//It was lost?
-			if (packets[i]==0)
+			if (isLost)
 				//Update mask
 				mask |= 1 << n;
 			//Increase mask len
@@ -130,7 +131,7 @@ std::list<RTCPRTPFeedback::NACKField::shared> RTPLostPackets::GetNacks() const
 			}
 		}
 		//Is this the first one lost
-		else if (!packets[i]) {
+		else if (isLost) {
 			//This is the first one
 			lost = first+i;
 		}
@@ -145,10 +146,83 @@ std::list<RTCPRTPFeedback::NACKField::shared> RTPLostPackets::GetNacks() const
 	return nacks;
 }
 
+DWORD RTPLostPackets::WriteNacks(BYTE* data, DWORD size, QWORD now, DWORD rtt)
+{
+	DWORD written = 0;
+	bool pending = false;
+	DWORD pid = 0;
+	WORD blp = 0;
+	
+	//Do not request again before a retransmission could have arrived
+	DWORD interval = std::max(rtt, MinRetransmissionInterval);
+	
+	//Iterate packets
+	for (DWORD i=0;i<len;++i)
+	{
+		DWORD extSeq = first+i;
+		DWORD index = GetIndex(extSeq);
+		
+		//Skip whole words of received packets
+		if ((index & 63)==0 && received[index >> 6]==~0ull)
+		{
+			//Skip the rest of the word
+			i += 63;
+			continue;
+		}
+		
+		//If received or suppressed
+		if (IsReceived(index) 
+			|| attempts[index]>=MaxRetransmissionAttempts 
+			|| (attempts[index] && now<requested[index]+interval))
+			//Skip
+			continue;
+		
+		//If it fits in current field
+		if (pending && extSeq-pid<=16)
+		{
+			//Update mask
+			blp |= 1 << (extSeq-pid-1);
+		} else {
+			//Check there is room for a new field
+			if (written+(pending ? 4 : 0)+4>size)
+				//Stop here
+				break;
+			//Write previous one
+			if (pending)
+			{
+				set2(data,written,pid);
+				set2(data,written+2,blp);
+				written += 4;
+			}
+			//Start new field
+			pending = true;
+			pid = extSeq;
+			blp = 0;
+		}
+		
+		//Update request state
+		attempts[index]++;
+		requested[index] = now;
+	}
+	
+	//Write last one
+	if (pending)
+	{
+		set2(data,written,pid);
+		set2(data,written+2,blp);
+		written += 4;
+	}
+	
+	return written;
+}
+
 void  RTPLostPackets::Dump() const
 {
-	Debug("[RTPLostPackets size=%d first=%d len=%d]\n",size,first,len);
-	for(int i=0;i<len;i++)
-		Debug("[%.3d,%.8llu]\n",i,packets[i]);
+	Debug("[RTPLostPackets size=%d first=%d len=%d total=%d recovered=%d]\n",size,first,len,total,recovered);
+	for(DWORD i=0;i<len;i++)
+	{
+		DWORD index = GetIndex(first+i);
+		Debug("[%.3d,%d,%d,%llu]\n",i,IsReceived(index),attempts[index],requested[index]);
+	}
 	Debug("[/RTPLostPackets]\n");
 }
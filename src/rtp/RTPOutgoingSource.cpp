@@ -160,30 +160,30 @@ RTCPSenderReport::shared RTPOutgoingSource::CreateSenderReport(QWORD now)
 	return sr;
 }
 
-bool RTPOutgoingSource::ProcessReceiverReport(QWORD now, const RTCPReport::shared& report)
+bool RTPOutgoingSource::ProcessReceiverReport(QWORD now, const RTCPReport& report)
 {
 	//Increate report count
 	reportCount++;
 	reportCountDelta = reportCountAcumulator.Update(now, 1);
 	
 	//Increase lost counter
-	DWORD lostCount = report->GetLostCount();
+	DWORD lostCount = report.GetLostCount();
 	reportedLostCount += lostCount;
 	reportedLostCountDelta = reportedlostCountAcumulator.Update(now, lostCount);
 	
 	//Get fraction loss
-	reportedFractionLossAcumulator.Update(now, report->GetFactionLost());
+	reportedFractionLossAcumulator.Update(now, report.GetFactionLost());
 	
 	//Get jitter
-	reportedJitter	=  report->GetJitter();
+	reportedJitter	=  report.GetJitter();
 	
 	//Calculate RTT
-	if (!IsLastSenderReportNTP(report->GetLastSR()))
+	if (!IsLastSenderReportNTP(report.GetLastSR()))
 		//Rtt not updated
 		return false;
 	
 	//Calculate new rtt in ms
-	rtt = now - lastSenderReport/1000-report->GetDelaySinceLastSRMilis();
+	rtt = now - lastSenderReport/1000-report.GetDelaySinceLastSRMilis();
 	
 	//RTT updated
 	return true;
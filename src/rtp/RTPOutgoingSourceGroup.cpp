@@ -110,6 +110,16 @@ void RTPOutgoingSourceGroup::onREMB(DWORD ssrc, DWORD bitrate)
 	});
 }
 
+void RTPOutgoingSourceGroup::SetForcedPlayoutDelay(uint16_t min, uint16_t max)
+{
+	//Set it on the sending thread, as serialized headers are used there
+	AsyncSafe([=](auto) {
+		forcedPlayoutDelay.emplace(min, max);
+		//Header has changed, build it again on next packet
+		headerTemplate.Reset();
+	});
+}
+
 void RTPOutgoingSourceGroup::UpdateAsync(std::function<void(std::chrono::milliseconds)> callback)
 {
 	//Update it sync
@@ -354,7 +354,7 @@ void RTPPacket::Dump() const
 }
 
 
-bool RTPPacket::ParseDependencyDescriptor(const std::optional<TemplateDependencyStructure>& templateDependencyStructure, std::optional<std::vector<bool>>& activeDecodeTargets)
+bool RTPPacket::ParseDependencyDescriptor(const TemplateDependencyStructure::shared& templateDependencyStructure, const std::optional<DependencyDescriptor::ActiveDecodeTargets>& activeDecodeTargets)
 {
 	//parse it
 	if (!extension.ParseDependencyDescriptor(templateDependencyStructure))
@@ -364,7 +364,7 @@ bool RTPPacket::ParseDependencyDescriptor(const std::optional<TemplateDependency
 	//If packet has a new dependency structure
 	if (extension.dependencyDescryptor && extension.dependencyDescryptor->templateDependencyStructure)
 	{
-		//Store it
+		//Store it, will be the current one if it has not changed
 		this->templateDependencyStructure = extension.dependencyDescryptor->templateDependencyStructure;
 		this->activeDecodeTargets	  = extension.dependencyDescryptor->activeDecodeTargets;
 	} else {
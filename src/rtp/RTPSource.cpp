@@ -1,9 +1,9 @@
 #include "rtp/RTPSource.h"
 
 RTPSource::RTPSource() :
-	acumulator(1E3, 1E3, 1E3),
-	acumulatorTotalBitrate(1E3, 1E3, 1E3),
-	acumulatorPackets(1E3, 1E3, 1E3)
+	acumulator(1E3, 1E3, 0, 100),
+	acumulatorTotalBitrate(1E3, 1E3, 0, 100),
+	acumulatorPackets(1E3, 1E3, 0, 100)
 {
 
 }
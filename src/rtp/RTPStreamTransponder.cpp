@@ -4,6 +4,11 @@
 #include "waitqueue.h"
 #include "vp8/vp8.h"
 #include "av1/AV1LayerSelector.h"
+#include "Metrics.h"
+
+static Metrics::Counter& relayedPackets = Metrics::GetInstance().GetCounter("rtp_relay_packets_total", "RTP packets relayed by stream transponders");
+static Metrics::Counter& crossLoopPackets = Metrics::GetInstance().GetCounter("rtp_relay_cross_loop_hops_total", "RTP packets relayed by stream transponders from another loop");
+static Metrics::Counter& droppedPackets = Metrics::GetInstance().GetCounter("rtp_relay_dropped_packets_total", "RTP packets dropped by stream transponders because their loop was not keeping up");
 
 
 RTPStreamTransponder::RTPStreamTransponder(const RTPOutgoingSourceGroup::shared& outgoing, const RTPSender::shared& sender) :
@@ -20,6 +25,18 @@ RTPStreamTransponder::RTPStreamTransponder(const RTPOutgoingSourceGroup::shared&
 	Debug("-RTPStreamTransponder() | [outgoing:%p,sender:%p,ssrc:%u]\n",outgoing,sender,ssrc);
 }
 
+void RTPStreamTransponder::OnCreated()
+{
+	//Incoming batches are delivered through a channel to avoid creating a task for each one
+	rtpChannel = CreateChannelSafe<RTPMessage>([this](auto now, RTPMessage& message) {
+		//Check it is still from one of our incoming streams
+		if (message.stream != incomingNext.get() && message.stream != incoming.get())
+			return;
+
+		onRTPAsync(now, message.stream, message.packets);
+	});
+}
+
 void RTPStreamTransponder::ResetIncoming()
 {
 	SetIncoming(nullptr, nullptr);
@@ -155,26 +172,73 @@ void RTPStreamTransponder::Close()
 
 
 void RTPStreamTransponder::onRTP(const RTPIncomingMediaStream* stream,const RTPPacket::shared& packet)
+{
+	if (!packet)
+		//Exit
+		return;
+
+	//Deliver it as a batch of one
+	onRTP(stream, std::vector<RTPPacket::shared>{ packet });
+}
+
+void RTPStreamTransponder::onRTP(const RTPIncomingMediaStream* stream,const std::vector<RTPPacket::shared>& packets)
 {
 	//Trace method
-	TRACE_EVENT("rtp","RTPStreamTransponder::onRTP", "ssrc", packet->GetSSRC(), "seqnum", packet->GetSeqNum());
+	TRACE_EVENT("rtp","RTPStreamTransponder::onRTP", "packets", packets.size());
 
-	if (!packet)
+	//Clone them as we are going to modify them
+	std::vector<RTPPacket::shared> cloned;
+	cloned.reserve(packets.size());
+	for (const auto& packet : packets)
+		if (packet)
+			cloned.emplace_back(packet->Clone());
+
+	if (cloned.empty())
 		//Exit
 		return;
 
-	//Run async
-	AsyncSafe([=, packet = packet->Clone()](auto now){
+	relayedPackets.Add(cloned.size());
 
-		// In theory this check is not necessary as it is already checked in onRTPAsync but 
-		// more encapsulated and safer against future maintainence duplicating it here.
+	//If we are already on our loop, ie. source is colocated with us, process it synchronously unless there are queued batches it would overtake
+	if (GetTimeService().IsCurrentThread() && (!rtpChannel || rtpChannel->IsEmpty()))
+	{
+		//Check it is from one of our incoming streams
 		if (stream != incomingNext.get() && stream != incoming.get())
-		{
 			return;
-		}
+		//Process whole batch
+		onRTPAsync(GetTimeService().GetNow(), stream, cloned);
+		return;
+	}
+
+	crossLoopPackets.Add(cloned.size());
+
+	//Whole batch is sent in a single message
+	RTPMessage message = { stream, std::move(cloned) };
+
+	//Send to our loop, message is only moved if pushed
+	if (rtpChannel && rtpChannel->Push(std::move(message)))
+		return;
 
+	//If it is full our loop is way behind, drop the batch instead of running it out of order with the queued ones
+	droppedPackets.Add(message.packets.size());
+	UltraDebug("-RTPStreamTransponder::onRTP() | Channel full, dropping packets [this:%p,packets:%zu]\n", this, message.packets.size());
+}
+
+void RTPStreamTransponder::onRTPAsync(std::chrono::milliseconds now, const RTPIncomingMediaStream* stream, const std::vector<RTPPacket::shared>& packets)
+{
+	//Trace method
+	TRACE_EVENT("rtp","RTPStreamTransponder::onRTPAsync", "packets", packets.size());
+
+	//Rewrite all packets, outgoing ones are accumulated
+	for (const auto& packet : packets)
 		onRTPAsync(now, stream, packet);
-	});
+
+	//Send them at once
+	if (sender && !outgoingPackets.empty())
+		sender->Enqueue(outgoingPackets);
+
+	//Keep capacity for next batch
+	outgoingPackets.clear();
 }
 
 void RTPStreamTransponder::onRTPAsync(std::chrono::milliseconds now, const RTPIncomingMediaStream* stream, const RTPPacket::shared& packet)
@@ -256,7 +320,7 @@ void RTPStreamTransponder::onRTPAsync(std::chrono::milliseconds now, const RTPIn
 			rtp->SetMark(true);
 			rtp->SetExtTimestamp(lastTimestamp);
 			//Send it
-			if (sender) sender->Enqueue(rtp);
+			outgoingPackets.push_back(rtp);
 		}
 		//No source
 		lastCompleted = true;
@@ -476,9 +540,7 @@ void RTPStreamTransponder::onRTPAsync(std::chrono::milliseconds now, const RTPIn
 		//Change ssrc
 		cloned->SetSSRC(ssrc);
 		//Send packet
-		if (sender)
-			//Create clone on sender thread
-			sender->Enqueue(cloned);
+		outgoingPackets.push_back(cloned);
 		//Add new packet
 		added ++;
 		extSeqNum ++;
@@ -487,7 +549,7 @@ void RTPStreamTransponder::onRTPAsync(std::chrono::milliseconds now, const RTPIn
 	}
 
 	//Dependency descriptor active decodte target mask
-	std::optional<std::vector<bool>> forwaredDecodeTargets;
+	std::optional<DependencyDescriptor::ActiveDecodeTargets> forwaredDecodeTargets;
 
 	//If it is AV1
 	if (codec==VideoCodec::AV1 && selector)
@@ -500,7 +562,7 @@ void RTPStreamTransponder::onRTPAsync(std::chrono::milliseconds now, const RTPIn
 	if (packet->HasDependencyDestriptor())
 	{
 		//Get it
-		auto dd = packet->GetDependencyDescriptor();
+		auto& dd = packet->GetDependencyDescriptor();
 
 		//Double check
 		if (dd)
@@ -552,10 +614,8 @@ void RTPStreamTransponder::onRTPAsync(std::chrono::milliseconds now, const RTPIn
 		//Update it
 		packet->OverrideFrameNumber(static_cast<uint16_t>(continousFrameNumber));
 
-	//Send packet
-	if (sender)
-		//Enqueue it
-		sender->Enqueue(packet);
+	//Send packet with the rest of the batch
+	outgoingPackets.push_back(packet);
 }
 
 void RTPStreamTransponder::onBye(const RTPIncomingMediaStream* stream)
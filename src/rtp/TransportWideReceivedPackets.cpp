@@ -0,0 +1,335 @@
+#include "rtp/TransportWideReceivedPackets.h"
+#include "rtp/RTCPRTPFeedback.h"
+#include "tools.h"
+#include "log.h"
+#include <algorithm>
+#include <limits>
+
+using PacketStatus = RTCPRTPFeedback::TransportWideFeedbackMessageField::PacketStatus;
+
+/*
+ * Packet status chunk being built. Symbols are added while they fit in a run
+ * length chunk or in a one or two bit status vector chunk, when the next one
+ * does not fit the chunk is emitted.
+ */
+class StatusChunk
+{
+public:
+	static constexpr BYTE MaxTwoBitSymbols	= 7;
+	static constexpr BYTE MaxOneBitSymbols	= 14;
+	static constexpr WORD MaxRunLength	= 0x1FFF;
+public:
+	bool CanAdd(BYTE status) const
+	{
+		//Any symbol fits in a two bit vector
+		if (count<MaxTwoBitSymbols)
+			return true;
+		//One bit vector only if there are no large deltas
+		if (count<MaxOneBitSymbols && !hasLarge && status!=PacketStatus::LargeOrNegativeDelta)
+			return true;
+		//Run of same symbol
+		return count<MaxRunLength && allSame && symbols[0]==status;
+	}
+
+	void Add(BYTE status)
+	{
+		//Store symbol if it could be used on a vector
+		if (count<MaxOneBitSymbols)
+			symbols[count] = status;
+		//Update state
+		allSame = allSame && symbols[0]==status;
+		hasLarge = hasLarge || status==PacketStatus::LargeOrNegativeDelta;
+		count++;
+	}
+
+	WORD Emit()
+	{
+		//If it is a full run or one bit vector
+		if (allSame || count==MaxOneBitSymbols)
+		{
+			WORD chunk = allSame ? EncodeRunLength() : EncodeOneBit(count);
+			//Start again
+			count = 0;
+			allSame = true;
+			hasLarge = false;
+			return chunk;
+		}
+		//Two bit vector with first symbols
+		WORD chunk = EncodeTwoBit(MaxTwoBitSymbols);
+		//Move the rest to the begining
+		count -= MaxTwoBitSymbols;
+		std::copy(symbols.begin()+MaxTwoBitSymbols, symbols.begin()+MaxTwoBitSymbols+count, symbols.begin());
+		//Update state
+		allSame = std::all_of(symbols.begin(), symbols.begin()+count, [&](BYTE status) { return status==symbols[0]; });
+		hasLarge = std::any_of(symbols.begin(), symbols.begin()+count, [](BYTE status) { return status==PacketStatus::LargeOrNegativeDelta; });
+		return chunk;
+	}
+
+	WORD EmitLast() const
+	{
+		//Use the shortest one
+		if (allSame)
+			return EncodeRunLength();
+		if (count<=MaxTwoBitSymbols)
+			return EncodeTwoBit(count);
+		return EncodeOneBit(count);
+	}
+
+private:
+	WORD EncodeRunLength() const
+	{
+		//|T=0| S |       Run Length        |
+		return symbols[0] << 13 | count;
+	}
+
+	WORD EncodeOneBit(WORD num) const
+	{
+		//|T=1|S=0|       symbol list         |
+		WORD chunk = 0x8000;
+		for (WORD i=0;i<num;++i)
+			chunk |= symbols[i] << (13-i);
+		return chunk;
+	}
+
+	WORD EncodeTwoBit(WORD num) const
+	{
+		//|T=1|S=1|        symbol list        |
+		WORD chunk = 0xC000;
+		for (WORD i=0;i<num;++i)
+			chunk |= symbols[i] << (12-2*i);
+		return chunk;
+	}
+private:
+	std::array<BYTE,MaxOneBitSymbols> symbols = {};
+	WORD count	= 0;
+	bool allSame	= true;
+	bool hasLarge	= false;
+};
+
+bool TransportWideReceivedPackets::AddPacket(WORD transportSeqNum, QWORD time, DWORD size)
+{
+	//Get extended sequence number
+	QWORD extSeqNum = extender.Extend(transportSeqNum) << 16 | transportSeqNum;
+
+	//If first one
+	if (!initialized)
+	{
+		//Start from it
+		first = extSeqNum;
+		initialized = true;
+	}
+
+	//If it has already been reported
+	if (extSeqNum<first)
+		//Drop it
+		return true;
+
+	//If it does not fit in current feedback
+	if (extSeqNum>=first+MaxPackets)
+	{
+		//Pending ones must be reported first
+		if (pending)
+			return false;
+		//Skip the gap
+		first = extSeqNum;
+	}
+
+	//Get ring position
+	DWORD index = extSeqNum % MaxPackets;
+
+	//If duplicated
+	if (arrivals[index])
+		//Ignore
+		return true;
+
+	//Store arrival time in 250us units
+	arrivals[index] = time/250+1;
+
+	//If first pending
+	if (!pending)
+	{
+		//Start from it
+		last = extSeqNum;
+		firstPendingTime = time;
+	}
+	//Update last one
+	last = std::max(last, extSeqNum);
+	pending++;
+	//Update incoming bytes
+	bytes += size;
+
+	//Done
+	return true;
+}
+
+DWORD TransportWideReceivedPackets::WriteFeedback(BYTE* data, DWORD size, BYTE feedbackPacketCount, QWORD now)
+{
+	//If we have no packets
+	if (!pending)
+		return 0;
+
+	//Number of packets reported, including not received ones
+	WORD packetStatusCount = last-first+1;
+
+	//Calculate temporal info
+	bool firstReceived	= false;
+	QWORD referenceTime	= 0;
+	//Current time in 250us units
+	int64_t time		= 0;
+
+	//Get status and deltas for each one
+	for (WORD i=0;i<packetStatusCount;++i)
+	{
+		//Get arrival
+		DWORD arrival = arrivals[(first+i) % MaxPackets];
+		//If not received
+		if (!arrival)
+		{
+			statuses[i] = PacketStatus::NotReceived;
+			continue;
+		}
+		//Remove offset
+		int64_t ticks = arrival-1;
+		//If first received
+		if (!firstReceived)
+		{
+			//Got it
+			firstReceived = true;
+			//Reference time is in 64ms units
+			referenceTime = ticks/256;
+			//Get initial time
+			time = referenceTime*256;
+		}
+		//Get delta, clamped to the max we can signal
+		int16_t delta = std::clamp<int64_t>(ticks-time, std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
+		//Small deltas are sent as unsigned byte
+		statuses[i] = delta>=0 && delta<=255 ? PacketStatus::SmallDelta : PacketStatus::LargeOrNegativeDelta;
+		deltas[i] = delta;
+		//Set next time
+		time += delta;
+	}
+
+	//Check header size
+	if (size<8)
+		return Error("-TransportWideReceivedPackets::WriteFeedback() | Not enough space [size:%u]\n", size);
+
+	/*
+		0                   1                   2                   3
+		0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+	       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+	       |      base sequence number     |      packet status count      |
+	       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+	       |                 reference time                | fb pkt. count |
+	       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+	 */
+	set2(data,0,first);
+	set2(data,2,packetStatusCount);
+	set3(data,4,referenceTime & 0x7FFFFF);
+	set1(data,7,feedbackPacketCount);
+
+	DWORD len = 8;
+
+	//Write packet status chunks
+	StatusChunk chunk;
+	for (WORD i=0;i<packetStatusCount;++i)
+	{
+		//If it does not fit in current chunk
+		if (!chunk.CanAdd(statuses[i]))
+		{
+			//Check size
+			if (len+2>size)
+				return Error("-TransportWideReceivedPackets::WriteFeedback() | Not enough space [size:%u]\n", size);
+			//Write it
+			set2(data,len,chunk.Emit());
+			len += 2;
+		}
+		//Add to the chunk
+		chunk.Add(statuses[i]);
+	}
+	//Check size
+	if (len+2>size)
+		return Error("-TransportWideReceivedPackets::WriteFeedback() | Not enough space [size:%u]\n", size);
+	//Write last one
+	set2(data,len,chunk.EmitLast());
+	len += 2;
+
+	//Write deltas
+	for (WORD i=0;i<packetStatusCount;++i)
+	{
+		//Check status
+		if (statuses[i]==PacketStatus::SmallDelta)
+		{
+			//Check size
+			if (len+1>size)
+				return Error("-TransportWideReceivedPackets::WriteFeedback() | Not enough space [size:%u]\n", size);
+			//1 byte
+			set1(data,len,deltas[i]);
+			len++;
+		} else if (statuses[i]==PacketStatus::LargeOrNegativeDelta) {
+			//Check size
+			if (len+2>size)
+				return Error("-TransportWideReceivedPackets::WriteFeedback() | Not enough space [size:%u]\n", size);
+			//2 bytes signed
+			set2(data,len,deltas[i]);
+			len += 2;
+		}
+	}
+
+	//Add zero padding
+	while (len%4)
+	{
+		//Check size
+		if (len+1>size)
+			return Error("-TransportWideReceivedPackets::WriteFeedback() | Not enough space [size:%u]\n", size);
+		//Add padding
+		data[len++] = 0;
+	}
+
+	//Clear reported ones
+	for (WORD i=0;i<packetStatusCount;++i)
+		arrivals[(first+i) % MaxPackets] = 0;
+	//Next one to report
+	first = last+1;
+	pending = 0;
+
+	//If we have a previous one
+	if (lastFeedbackTime && now>lastFeedbackTime)
+	{
+		//Get incoming bitrate since last feedback
+		DWORD current = bytes*8*1000000/(now-lastFeedbackTime);
+		//Smooth it
+		bitrate = bitrate ? (bitrate*7+current)/8 : current;
+	}
+	//Start counting again
+	lastFeedbackTime = now;
+	bytes = 0;
+
+	//Done
+	return len;
+}
+
+QWORD TransportWideReceivedPackets::GetFeedbackInterval() const
+{
+	//Until we know the bitrate send them as often as possible
+	if (!bitrate)
+		return MinFeedbackInterval;
+	//Time needed to keep overhead below the max
+	QWORD interval = EstimatedFeedbackSize*8*1000/(MaxFeedbackOverhead*bitrate);
+	//Limit it
+	return std::clamp(interval, MinFeedbackInterval, MaxFeedbackInterval);
+}
+
+void TransportWideReceivedPackets::Reset()
+{
+	//Clean all
+	arrivals.fill(0);
+	extender.Reset();
+	first = 0;
+	last = 0;
+	pending = 0;
+	initialized = false;
+	firstPendingTime = 0;
+	bytes = 0;
+	lastFeedbackTime = 0;
+	bitrate = 0;
+}
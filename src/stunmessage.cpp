@@ -175,8 +175,7 @@ STUNMessage* STUNMessage::Parse(const BYTE* data,DWORD size)
 
 		// Compute the CRC32 of the received message up to (but excluding) the
 		// FINGERPRINT attribute and XOR it with 0x5354554e.
-		CRC32Calc crc32calc;
-		DWORD computed = crc32calc.Update(data, posFingerprint) ^ 0x5354554e;
+		DWORD computed = CRC32Calc::IEEE(data, posFingerprint) ^ 0x5354554e;
 
 		// Compare them.
 		if (announced != computed)
@@ -293,7 +292,6 @@ DWORD STUNMessage::AuthenticatedFingerPrint(BYTE* data,DWORD size,const char* pw
 	}
 
 	DWORD len;
-	CRC32Calc crc32calc;
 
 	//Change length to omit the Fingerprint attribute from the HMAC calculation of the message integrity
 	set2(data,2,msgSize-20-8);
@@ -312,7 +310,7 @@ DWORD STUNMessage::AuthenticatedFingerPrint(BYTE* data,DWORD size,const char* pw
 	set2(data,2,msgSize-20);
 
 	//Calculate crc 32 XOR'ed with the 32-bit value 0x5354554e
-	DWORD crc32 = crc32calc.Update(data,i) ^ 0x5354554e;
+	DWORD crc32 = CRC32Calc::IEEE(data,i) ^ 0x5354554e;
 
 	//Set fingerprint attribute
 	set2(data,i,Attribute::FingerPrint);
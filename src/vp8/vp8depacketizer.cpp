@@ -84,8 +84,8 @@ MediaFrame* VP8Depacketizer::AddPacket(const RTPPacket::shared& packet)
 
 	if (state != State::Error)
 	{
-		//Add payload
-		AddPayload(packet->GetMediaData(),packet->GetMediaLength());
+		//Add payload, referencing packet data instead of copying it
+		AddPayload(packet->GetMediaData(),packet->GetMediaLength(),packet->SharePayload());
 	}
 
 	//Check if it has vp8 descriptor
@@ -129,6 +129,12 @@ MediaFrame* VP8Depacketizer::AddPacket(const RTPPacket::shared& packet)
 }
 
 MediaFrame* VP8Depacketizer::AddPayload(const BYTE* payload, DWORD len)
+{
+	//No owner, data will be copied
+	return AddPayload(payload,len,nullptr);
+}
+
+MediaFrame* VP8Depacketizer::AddPayload(const BYTE* payload, DWORD len, const RTPPayload::shared& owner)
 {
 	//Check lenght
 	if (!len)
@@ -155,7 +161,7 @@ MediaFrame* VP8Depacketizer::AddPayload(const BYTE* payload, DWORD len)
 	}
 
 	//Skip desc
-	DWORD pos = frame.AppendMedia(payload+descLen, len-descLen);
+	DWORD pos = frame.AppendMediaReference(owner, payload+descLen, len-descLen);
 
 	//Add RTP packet
 	frame.AddRtpPacket(pos,len-descLen,payload,descLen);
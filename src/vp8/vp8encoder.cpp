@@ -24,6 +24,17 @@
 #define VPX_PLANE_V   2
 #endif
 
+//Vp8 buffers used for each of the scalability mode ones
+static int GetReferenceFlag(BYTE buffer)
+{
+	return buffer==0 ? VP8_EFLAG_NO_REF_LAST : buffer==ScalabilityMode::MaxSpatialLayers ? VP8_EFLAG_NO_REF_GF : VP8_EFLAG_NO_REF_ARF;
+}
+
+static int GetUpdateFlag(BYTE buffer)
+{
+	return buffer==0 ? VP8_EFLAG_NO_UPD_LAST : buffer==ScalabilityMode::MaxSpatialLayers ? VP8_EFLAG_NO_UPD_GF : VP8_EFLAG_NO_UPD_ARF;
+}
+
 
 VP8Encoder::VP8Encoder(const Properties& properties) : frame(VideoCodec::VP8)
 {
@@ -49,6 +60,20 @@ VP8Encoder::VP8Encoder(const Properties& properties) : frame(VideoCodec::VP8)
 	staticThreshold			= properties.GetProperty("vp8.static_thresh"		, 100);
 	noiseReductionSensitivity	= properties.GetProperty("vp8.noise_sensitivity"	, 0);
 
+	//Get scalability mode
+	std::string mode = properties.GetProperty("vp8.scalability_mode", std::string("L1T1"));
+	//Parse it
+	if (auto parsed = ScalabilityMode::Parse(mode))
+		scalabilityMode = *parsed;
+	else
+		Warning("-VP8Encoder::VP8Encoder() | Unknown scalability mode, not using layers [mode:%s]\n", mode.c_str());
+	//Only temporal layers are supported by vp8
+	if (scalabilityMode.GetSpatialLayers()>1)
+	{
+		Warning("-VP8Encoder::VP8Encoder() | Spatial layers not supported, using only temporal ones [mode:%s]\n", mode.c_str());
+		scalabilityMode = ScalabilityMode(1, scalabilityMode.GetTemporalLayers());
+	}
+
 	//Disable sharing buffer on clone
 	frame.DisableSharedBuffer();
 
@@ -116,6 +141,8 @@ int VP8Encoder::SetFrameRate(int frames,int kbits,int intraPeriod)
 		config.rc_target_bitrate = bitrate;
 		config.kf_mode = intraPeriod ? VPX_KF_AUTO : VPX_KF_DISABLED;
 		config.kf_max_dist = intraPeriod;
+		//Set layer bitrates
+		ConfigureLayers();
 		//Reconfig
 		if (vpx_codec_enc_config_set(&encoder,&config)!=VPX_CODEC_OK)
 			//Exit
@@ -213,6 +240,8 @@ int VP8Encoder::OpenCodec()
 	//	Use the target bitrate (rc_target_bitrate) to convert to
 	//	bits/bytes, if necessary.
 	config.rc_buf_optimal_sz = bufferOptimalSize;
+	//Set temporal layers
+	ConfigureLayers();
 	
 	//Check result
 	if (vpx_codec_enc_init(&encoder, interface, &config, VPX_CODEC_USE_OUTPUT_PARTITION)!=VPX_CODEC_OK)
@@ -242,6 +271,27 @@ int VP8Encoder::OpenCodec()
 	return 1;
 }
 
+void VP8Encoder::ConfigureLayers()
+{
+	//Check if we are using temporal layers
+	if (!scalabilityMode.IsLayered())
+		return;
+
+	//Key frames are forced by us so they are always at the start of the temporal pattern
+	config.kf_mode = VPX_KF_DISABLED;
+
+	config.ts_number_layers = scalabilityMode.GetTemporalLayers();
+	config.ts_periodicity = scalabilityMode.GetPeriodicity();
+	for (BYTE i=0;i<scalabilityMode.GetTemporalLayers();++i)
+	{
+		//Accumulated bitrate
+		config.ts_target_bitrate[i] = bitrate * scalabilityMode.GetTemporalBitrateRatio(i);
+		config.ts_rate_decimator[i] = scalabilityMode.GetRateDecimator(i);
+	}
+	for (BYTE i=0;i<scalabilityMode.GetPeriodicity();++i)
+		config.ts_layer_id[i] = scalabilityMode.GetTemporalLayerId(i);
+}
+
 int VP8Encoder::FastPictureUpdate()
 {
 	forceKeyFrame = true;
@@ -269,6 +319,42 @@ VideoFrame* VP8Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 
 	uint32_t duration = 1000 / fps;
 
+	//Check if key frames are due
+	if (scalabilityMode.IsLayered() && intraPeriod && layerIndex>=(DWORD)intraPeriod)
+		flags = VPX_EFLAG_FORCE_KF;
+
+	//Get layer config for this frame
+	auto layer = scalabilityMode.GetLayerFrameConfig(flags & VPX_EFLAG_FORCE_KF || !layerIndex, layerIndex, 0);
+
+	//If we are using temporal layers
+	if (scalabilityMode.IsLayered())
+	{
+		//For non key frames, only use buffers of the layer pattern
+		if (!layer.keyFrame)
+		{
+			//Disable all references and updates
+			flags = VP8_EFLAG_NO_REF_LAST | VP8_EFLAG_NO_REF_GF | VP8_EFLAG_NO_REF_ARF | VP8_EFLAG_NO_UPD_LAST | VP8_EFLAG_NO_UPD_GF | VP8_EFLAG_NO_UPD_ARF;
+			//Enable the ones used by this frame
+			flags &= ~GetReferenceFlag(*layer.temporalReference);
+			if (layer.update)
+				flags &= ~GetUpdateFlag(*layer.update);
+			//Upper layers can be dropped, so they can not change the entropy context
+			if (layer.temporalLayerId)
+				flags |= VP8_EFLAG_NO_UPD_ENTROPY;
+		} else {
+			//Restart pattern
+			flags = VPX_EFLAG_FORCE_KF;
+			layerIndex = 0;
+		}
+		//Set layer id
+		vpx_codec_control(&encoder, VP8E_SET_TEMPORAL_LAYER_ID, layer.temporalLayerId);
+		//Next picture
+		pictureId = (pictureId + 1) & 0x7FFF;
+		//Increase base layer index
+		if (!layer.temporalLayerId)
+			temporalLevelZeroIndex++;
+	}
+
 	if (videoBuffer)
 	{
 		//Get planes
@@ -347,6 +433,8 @@ VideoFrame* VP8Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 
 	//Increase timestamp
 	pts += duration;
+	//Next frame in pattern
+	layerIndex++;
 
 	vpx_codec_iter_t iter = NULL;
 	int partitionIndex = 0;
@@ -378,6 +466,19 @@ VideoFrame* VP8Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 			desc.nonReferencePicture = pkt->data.frame.flags & VPX_FRAME_IS_DROPPABLE;
 			desc.startOfPartition	 = true;
 			desc.partitionIndex	 = partitionIndex;
+			//Set layer info
+			if (scalabilityMode.IsLayered())
+			{
+				desc.extendedControlBitsPresent = 1;
+				desc.pictureIdPresent		= 1;
+				desc.pictureIdLength		= 2;
+				desc.pictureId			= pictureId;
+				desc.temporalLevelZeroIndexPresent = 1;
+				desc.temporalLevelZeroIndex	= temporalLevelZeroIndex;
+				desc.temporalLayerIndexPresent	= 1;
+				desc.temporalLayerIndex		= layer.temporalLayerId;
+				desc.layerSync			= layer.layerSync;
+			}
 			//Split into MTU
 			DWORD cur = 0;
 			//For each
@@ -11,6 +11,7 @@
 #include "video.h"
 #include "vpx/vpx_encoder.h"
 #include "vpx/vp8cx.h"
+#include "ScalabilityMode.h"
 
 class VP8Encoder : public VideoEncoder
 {
@@ -23,6 +24,7 @@ public:
 	virtual int SetFrameRate(int fps,int kbits,int intraPeriod);
 private:
 	int OpenCodec();
+	void ConfigureLayers();
 private:
 	vpx_codec_ctx_t		encoder = {};
 	vpx_codec_enc_cfg_t	config = {};
@@ -55,6 +57,11 @@ private:
 	int bufferOptimalSize = 0;
 	int staticThreshold = 0;
 	int noiseReductionSensitivity = 0;
+	ScalabilityMode scalabilityMode;
+	//Frames since last key frame, temporal pattern is restarted on each one
+	DWORD layerIndex = 0;
+	WORD pictureId = 0;
+	BYTE temporalLevelZeroIndex = 0;
 
 };
 
@@ -19,6 +19,40 @@
 #define VPX_PLANE_V   2
 #endif
 
+//Get the size of each layer frame from the superframe index, if present
+static std::vector<DWORD> GetSuperframeSizes(const BYTE* data, DWORD size)
+{
+	//Check marker on last byte
+	if (size && (data[size-1] & 0xE0)==0xC0)
+	{
+		BYTE marker = data[size-1];
+		BYTE frames = (marker & 0x07) + 1;
+		BYTE mag = ((marker >> 3) & 0x03) + 1;
+		DWORD indexSize = 2 + mag * frames;
+		//Index is enclosed by markers
+		if (size>=indexSize && data[size-indexSize]==marker)
+		{
+			std::vector<DWORD> sizes;
+			DWORD total = 0;
+			const BYTE* index = data + size - indexSize + 1;
+			for (BYTE i=0;i<frames;++i)
+			{
+				//Little endian sizes
+				DWORD frameSize = 0;
+				for (BYTE j=0;j<mag;++j)
+					frameSize |= index[i*mag+j] << (j*8);
+				sizes.push_back(frameSize);
+				total += frameSize;
+			}
+			//Check they are valid
+			if (total<=size-indexSize)
+				return sizes;
+		}
+	}
+	//Only one frame
+	return { size };
+}
+
 
 VP9Encoder::VP9Encoder(const Properties& properties) : frame(VideoCodec::VP9)
 {
@@ -45,6 +79,14 @@ VP9Encoder::VP9Encoder(const Properties& properties) : frame(VideoCodec::VP9)
 	noiseReductionSensitivity = properties.GetProperty("vp9.noise_sensitivity", 0);
 	aqMode = properties.GetProperty("vp9.aq_mode", 3);
 
+	//Get scalability mode
+	std::string mode = properties.GetProperty("vp9.scalability_mode", std::string("L1T1"));
+	//Parse it
+	if (auto parsed = ScalabilityMode::Parse(mode))
+		scalabilityMode = *parsed;
+	else
+		Warning("-VP9Encoder::VP9Encoder() | Unknown scalability mode, not using layers [mode:%s]\n", mode.c_str());
+
 	//Disable sharing buffer on clone
 	frame.DisableSharedBuffer();
 
@@ -112,6 +154,8 @@ int VP9Encoder::SetFrameRate(int frames, int kbits, int intraPeriod)
 		config.rc_target_bitrate = bitrate;
 		config.kf_mode = intraPeriod ? VPX_KF_AUTO : VPX_KF_DISABLED;
 		config.kf_max_dist = intraPeriod;
+		//Set layer bitrates
+		ConfigureLayers();
 		//Reconfig
 		if (vpx_codec_enc_config_set(&encoder, &config) != VPX_CODEC_OK)
 			//Exit
@@ -203,6 +247,8 @@ int VP9Encoder::OpenCodec()
 	//	Use the target bitrate (rc_target_bitrate) to convert to
 	//	bits/bytes, if necessary.
 	config.rc_buf_optimal_sz = bufferOptimalSize;
+	//Set spatial and temporal layers
+	ConfigureLayers();
 
 	//Check result
 	if (vpx_codec_enc_init(&encoder, interface, &config, 0) != VPX_CODEC_OK)
@@ -236,6 +282,28 @@ int VP9Encoder::OpenCodec()
 
 	vpx_codec_control(&encoder, VP9E_SET_FRAME_PARALLEL_DECODING, 0);
 
+	//If using svc
+	if (scalabilityMode.IsLayered())
+	{
+		vpx_svc_extra_cfg_t svc = {};
+		for (BYTE i=0;i<scalabilityMode.GetSpatialLayers()*scalabilityMode.GetTemporalLayers();++i)
+		{
+			svc.max_quantizers[i] = maxQuantizer;
+			svc.min_quantizers[i] = minQuantizer;
+		}
+		for (BYTE i=0;i<scalabilityMode.GetSpatialLayers();++i)
+		{
+			//Each spatial layer halves the resolution of the upper one
+			svc.scaling_factor_num[i] = 1;
+			svc.scaling_factor_den[i] = 1 << scalabilityMode.GetSpatialScaleShift(i);
+		}
+		//Enable it
+		vpx_codec_control(&encoder, VP9E_SET_SVC, 1);
+		vpx_codec_control(&encoder, VP9E_SET_SVC_PARAMETERS, &svc);
+		//Predict from lower spatial layer on all frames
+		vpx_codec_control(&encoder, VP9E_SET_SVC_INTER_LAYER_PRED, 0);
+	}
+
 	// We are opened
 	opened = true;
 
@@ -245,6 +313,38 @@ int VP9Encoder::OpenCodec()
 	return 1;
 }
 
+void VP9Encoder::ConfigureLayers()
+{
+	//Check if we are using svc
+	if (!scalabilityMode.IsLayered())
+		return;
+
+	//Key frames are forced by us so they are always at the start of the temporal pattern
+	config.kf_mode = VPX_KF_DISABLED;
+	config.g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT;
+
+	config.ss_number_layers = scalabilityMode.GetSpatialLayers();
+	config.ts_number_layers = scalabilityMode.GetTemporalLayers();
+	//Use encoder temporal patterns, which match the ones of the scalability mode
+	switch (scalabilityMode.GetTemporalLayers())
+	{
+		case 2:
+			config.temporal_layering_mode = VP9E_TEMPORAL_LAYERING_MODE_0101;
+			break;
+		case 3:
+			config.temporal_layering_mode = VP9E_TEMPORAL_LAYERING_MODE_0212;
+			break;
+		default:
+			config.temporal_layering_mode = VP9E_TEMPORAL_LAYERING_MODE_NOLAYERING;
+	}
+	for (BYTE i=0;i<scalabilityMode.GetTemporalLayers();++i)
+		config.ts_rate_decimator[i] = scalabilityMode.GetRateDecimator(i);
+	//Bitrate of each temporal layer is accumulated inside each spatial layer
+	for (BYTE s=0;s<scalabilityMode.GetSpatialLayers();++s)
+		for (BYTE t=0;t<scalabilityMode.GetTemporalLayers();++t)
+			config.layer_target_bitrate[s*scalabilityMode.GetTemporalLayers()+t] = bitrate * scalabilityMode.GetSpatialBitrateRatio(s) * scalabilityMode.GetTemporalBitrateRatio(t);
+}
+
 int VP9Encoder::FastPictureUpdate()
 {
 	forceKeyFrame = true;
@@ -272,6 +372,10 @@ VideoFrame* VP9Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 
 	uint32_t duration = 1000 / fps;
 
+	//Check if key frames are due
+	if (scalabilityMode.IsLayered() && intraPeriod && layerIndex>=(DWORD)intraPeriod)
+		flags = VPX_EFLAG_FORCE_KF;
+
 	if (videoBuffer)
 	{
 		//Get planes
@@ -350,6 +454,20 @@ VideoFrame* VP9Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 
 	//Increase timestamp
 	pts += duration;
+	//Next frame in pattern
+	layerIndex++;
+
+	//Get temporal layer of this superframe
+	vpx_svc_layer_id_t layerId = {};
+	if (scalabilityMode.IsLayered())
+	{
+		vpx_codec_control(&encoder, VP9E_GET_SVC_LAYER_ID, &layerId);
+		//Next picture
+		pictureId = (pictureId + 1) & 0x7FFF;
+		//Increase base layer index
+		if (!layerId.temporal_layer_id)
+			temporalLayer0Index++;
+	}
 
 	vpx_codec_iter_t iter = NULL;
 	const vpx_codec_cx_pkt_t* pkt = NULL;
@@ -360,6 +478,7 @@ VideoFrame* VP9Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 
 	//Emtpy rtp info
 	frame.ClearRTPPacketizationInfo();
+	frame.ClearLayerFrames();
 
 	//Emtpy
 	frame.SetLength(0);
@@ -372,42 +491,87 @@ VideoFrame* VP9Encoder::EncodeFrame(const VideoBuffer::const_shared& videoBuffer
 
 		if (pkt->kind == VPX_CODEC_CX_FRAME_PKT)
 		{
-			VP9PayloadDescription desc = {};
+			bool isKey = pkt->data.frame.flags & VPX_FRAME_IS_KEY;
 			//Append data to the frame
 			DWORD pos = frame.AppendMedia((BYTE*)pkt->data.frame.buf, pkt->data.frame.sz);
-			//Set data
-			desc.interPicturePredictedLayerFrame = !pkt->data.frame.flags & VPX_FRAME_IS_KEY;
-			desc.switchingPoint = desc.interPicturePredictedLayerFrame;
-			desc.startOfLayerFrame = true;
-			desc.endOfLayerFrame = false;
-			//Split into MTU
-			DWORD cur = 0;
-			//For each
-			while (cur < pkt->data.frame.sz)
+			//Restart pattern
+			if (isKey)
+				layerIndex = 1;
+			//Svc superframes contain a layer frame for each spatial layer, each one sent on its own packets
+			auto sizes = scalabilityMode.IsLayered() ? GetSuperframeSizes((BYTE*)pkt->data.frame.buf, pkt->data.frame.sz) : std::vector<DWORD>{ (DWORD)pkt->data.frame.sz };
+			//For each layer frame
+			for (BYTE spatialLayerId = 0; spatialLayerId < sizes.size(); pos += sizes[spatialLayerId++])
 			{
-				//Serialized desc
-				BYTE aux[16];
-				//Serialize
-				DWORD auxLen = desc.Serialize(aux, 16);
-				//Get
-				DWORD len = RTPPAYLOADSIZE - desc.GetSize();
-				//Check iw we have enought
-				if (cur + len > pkt->data.frame.sz)
-					//Reduce
-					len = pkt->data.frame.sz - cur;
-				//Check if it is the last
-				if (cur + len >= pkt->data.frame.sz)
+				DWORD size = sizes[spatialLayerId];
+				VP9PayloadDescription desc = {};
+				//Set data
+				desc.interPicturePredictedLayerFrame = !isKey;
+				desc.switchingPoint = desc.interPicturePredictedLayerFrame;
+				desc.startOfLayerFrame = true;
+				desc.endOfLayerFrame = false;
+				//Set layer info
+				if (scalabilityMode.IsLayered())
+				{
+					desc.pictureIdPresent = true;
+					desc.extendedPictureIdPresent = true;
+					desc.pictureId = pictureId;
+					desc.layerIndicesPresent = true;
+					desc.flexibleMode = false;
+					desc.temporalLayerId = layerId.temporal_layer_id;
+					//Temporal layer frames only referencing the base layer allow switching up
+					desc.switchingPoint = scalabilityMode.GetLayerFrameConfig(isKey, layerIndex - 1, spatialLayerId).layerSync;
+					desc.spatialLayerId = spatialLayerId;
+					desc.interlayerDependencyUsed = spatialLayerId > 0;
+					desc.temporalLayer0Index = temporalLayer0Index;
+					//Send resolutions of all spatial layers on key frames
+					if (isKey && !spatialLayerId)
+					{
+						desc.scalabiltiyStructureDataPresent = true;
+						desc.scalabilityStructure.numberSpatialLayers = scalabilityMode.GetSpatialLayers();
+						desc.scalabilityStructure.spatialLayerFrameResolutionPresent = true;
+						for (BYTE i=0;i<scalabilityMode.GetSpatialLayers();++i)
+							desc.scalabilityStructure.spatialLayerFrameResolutions.emplace_back(width >> scalabilityMode.GetSpatialScaleShift(i), height >> scalabilityMode.GetSpatialScaleShift(i));
+					}
+					//Add layer frame info
+					LayerFrame layer;
+					layer.pos = pos;
+					layer.size = size;
+					layer.width = width >> scalabilityMode.GetSpatialScaleShift(spatialLayerId);
+					layer.height = height >> scalabilityMode.GetSpatialScaleShift(spatialLayerId);
+					layer.info = LayerInfo(layerId.temporal_layer_id, spatialLayerId);
+					frame.AddLayerFrame(layer);
+				}
+				//Split into MTU
+				DWORD cur = 0;
+				//For each
+				while (cur < size)
 				{
-					//Change header
-					desc.endOfLayerFrame = false;
-					auxLen = desc.Serialize(aux, 16);
+					//Serialized desc
+					BYTE aux[64];
+					//Serialize
+					DWORD auxLen = desc.Serialize(aux, sizeof(aux));
+					//Get
+					DWORD len = RTPPAYLOADSIZE - desc.GetSize();
+					//Check iw we have enought
+					if (cur + len > size)
+						//Reduce
+						len = size - cur;
+					//Check if it is the last
+					if (cur + len >= size)
+					{
+						//Change header
+						desc.endOfLayerFrame = true;
+						auxLen = desc.Serialize(aux, sizeof(aux));
+					}
+					//Append hint
+					frame.AddRtpPacket(pos + cur, len, aux, auxLen);
+					//Increase current
+					cur += len;
+					//Not first in partition
+					desc.startOfLayerFrame = false;
+					//Scalability structure only on first packet
+					desc.scalabiltiyStructureDataPresent = false;
 				}
-				//Append hint
-				frame.AddRtpPacket(pos + cur, len, aux, auxLen);
-				//Increase current
-				cur += len;
-				//Not first in partition
-				desc.startOfLayerFrame = false;
 			}
 		}
 	}
@@ -4,6 +4,7 @@
 #include "video.h"
 #include "vpx/vpx_encoder.h"
 #include "vpx/vp8cx.h"
+#include "ScalabilityMode.h"
 
 class VP9Encoder : public VideoEncoder
 {
@@ -16,6 +17,7 @@ public:
 	virtual int SetFrameRate(int fps, int kbits, int intraPeriod);
 private:
 	int OpenCodec();
+	void ConfigureLayers();
 private:
 	vpx_codec_ctx_t		encoder = {};
 	vpx_codec_enc_cfg_t	config = {};
@@ -49,6 +51,11 @@ private:
 	int staticThreshold = 0;
 	int noiseReductionSensitivity = 0;
 	int aqMode = 0;
+	ScalabilityMode scalabilityMode;
+	//Frames since last key frame
+	DWORD layerIndex = 0;
+	WORD pictureId = 0;
+	BYTE temporalLayer0Index = 0;
 	
 
 };
@@ -0,0 +1,48 @@
+#include "test.h"
+#include "tools.h"
+#include "crc32calc.h"
+#include <vector>
+
+class CRC32TestPlan : public TestPlan
+{
+public:
+	CRC32TestPlan() : TestPlan("CRC32 benchmark")
+	{
+	}
+
+	virtual void Execute()
+	{
+		Log("-CRC32 [clmul:%d,sse42:%d]\n", CRC32Calc::IsCLMULAccelerated(), CRC32Calc::IsSSE42Accelerated());
+
+		std::vector<BYTE> data(64*1024);
+		for (auto& byte : data)
+			byte = rand();
+
+		for (DWORD size = 64; size <= data.size(); size *= 4)
+		{
+			Log("-%6d bytes\n", size);
+			benchmark("IEEE slice-by-8", size, [&]() { return CRC32Calc::IEEESliceBy8(data.data(), size); });
+			benchmark("IEEE", size, [&]() { return CRC32Calc::IEEE(data.data(), size); });
+			benchmark("MPEG2 slice-by-8", size, [&]() { return CRC32Calc::MPEG2SliceBy8(data.data(), size); });
+			benchmark("MPEG2", size, [&]() { return CRC32Calc::MPEG2(data.data(), size); });
+			benchmark("CRC32C slice-by-8", size, [&]() { return CRC32Calc::CRC32CSliceBy8(data.data(), size); });
+			benchmark("CRC32C", size, [&]() { return CRC32Calc::CRC32C(data.data(), size); });
+		}
+	}
+
+	void benchmark(const char* name, DWORD size, const std::function<DWORD()>& crc)
+	{
+		//Process 64MB per run
+		DWORD iterations = 64*1024*1024 / size;
+		DWORD result = 0;
+
+		QWORD ini = getTime();
+		for (DWORD i = 0; i < iterations; ++i)
+			result += crc();
+		QWORD elapsed = getTime() - ini;
+
+		Log("\t%-18s %8.1f MB/s [crc:%.8x]\n", name, elapsed ? (double)size * iterations / elapsed : 0.0, result);
+	}
+};
+
+CRC32TestPlan crc32;
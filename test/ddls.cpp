@@ -72,13 +72,15 @@ struct FrameDescription
 {
 	uint32_t idx;
 	uint32_t frameNumber;
-	std::optional<std::vector<uint32_t>> customFrameDiffs;
-	std::optional<std::vector<uint32_t>> customFrameDiffsChains;
+	std::optional<DependencyDescriptor::FrameDiffs> customFrameDiffs;
+	std::optional<DependencyDescriptor::FrameDiffsChains> customFrameDiffsChains;
 };
 
 std::vector<RTPPacket::shared> generateRTPStream(const std::vector<FrameDescription>& frames, const TemplateDependencyStructure& templateDependencyStructure, const std::vector<int> lost = {})
 {
 	std::vector<RTPPacket::shared> packets;
+	//Shared by all packets
+	auto shared = std::make_shared<const TemplateDependencyStructure>(templateDependencyStructure);
 	
 	//For each frame
 	for (const auto& frame : frames)
@@ -109,11 +111,11 @@ std::vector<RTPPacket::shared> generateRTPStream(const std::vector<FrameDescript
 		dependencyDescriptor.customFrameDiffsChains = frame.customFrameDiffsChains;
 		//Only send template structure on intra
 		if (isIntra)
-			dependencyDescriptor.templateDependencyStructure = templateDependencyStructure;
+			dependencyDescriptor.templateDependencyStructure = shared;
 			
 		//Set dependency descriptor and template dependency structure
 		packet->SetDependencyDescriptor(dependencyDescriptor);
-		packet->OverrideTemplateDependencyStructure(templateDependencyStructure);
+		packet->OverrideTemplateDependencyStructure(shared);
 		
 		packets.push_back(packet);
 	}
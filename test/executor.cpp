@@ -0,0 +1,131 @@
+#include "test.h"
+#include "tools.h"
+#include "Executor.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ExecutorTestPlan : public TestPlan
+{
+public:
+	//Simulate 20ms frames taking 50us each to process during 2s
+	static constexpr QWORD FrameInterval = 20;
+	static constexpr QWORD FrameWork = 50;
+	static constexpr QWORD Duration = 2000;
+
+	ExecutorTestPlan() : TestPlan("Executor benchmark")
+	{
+	}
+
+	virtual void Execute()
+	{
+		Log("-Executor [threads:%zu]\n", Executor::GetDefault().GetNumThreads());
+
+		for (size_t streams : { 50, 200, 500 })
+		{
+			Log("-%zu streams\n", streams);
+			benchmark("thread per stream", streams, false);
+			benchmark("executor", streams, true);
+		}
+	}
+
+	static void work(QWORD sent, std::vector<QWORD>& latencies, std::mutex& mutex)
+	{
+		//Busy wait to simulate decoding
+		QWORD ini = getTime();
+		while (getTime() - ini < FrameWork);
+		//Store latency
+		std::lock_guard<std::mutex> lock(mutex);
+		latencies.push_back(getTime() - sent);
+	}
+
+	void benchmark(const char* name, size_t streams, bool useExecutor)
+	{
+		std::mutex mutex;
+		std::vector<QWORD> latencies;
+
+		//Thread per stream queues
+		struct Queue
+		{
+			std::mutex mutex;
+			std::condition_variable cond;
+			std::deque<QWORD> frames;
+			bool running = true;
+			std::thread thread;
+		};
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<Executor::Strand::shared> strands;
+
+		for (size_t i = 0; i < streams; ++i)
+		{
+			if (useExecutor)
+			{
+				strands.push_back(Executor::GetDefault().CreateStrand(true));
+				continue;
+			}
+			auto queue = std::make_unique<Queue>();
+			queue->thread = std::thread([&, queue = queue.get()]() {
+				std::unique_lock<std::mutex> lock(queue->mutex);
+				while (queue->running)
+				{
+					if (queue->frames.empty())
+					{
+						queue->cond.wait(lock);
+						continue;
+					}
+					QWORD sent = queue->frames.front();
+					queue->frames.pop_front();
+					lock.unlock();
+					work(sent, latencies, mutex);
+					lock.lock();
+				}
+			});
+			queues.push_back(std::move(queue));
+		}
+
+		QWORD ini = getTimeMS();
+		//Produce frames
+		for (QWORD now = ini; now - ini < Duration; now = getTimeMS())
+		{
+			for (size_t i = 0; i < streams; ++i)
+			{
+				QWORD sent = getTime();
+				if (useExecutor)
+				{
+					strands[i]->Post(now + FrameInterval, [&, sent]() { work(sent, latencies, mutex); });
+				} else {
+					std::lock_guard<std::mutex> lock(queues[i]->mutex);
+					queues[i]->frames.push_back(sent);
+					queues[i]->cond.notify_one();
+				}
+			}
+			//Wait for next frame
+			msleep((FrameInterval - (getTimeMS() - now) % FrameInterval) * 1000);
+		}
+
+		//Stop
+		for (auto& strand : strands)
+			strand->Close();
+		for (auto& queue : queues)
+		{
+			{
+				std::lock_guard<std::mutex> lock(queue->mutex);
+				queue->running = false;
+				queue->cond.notify_one();
+			}
+			queue->thread.join();
+		}
+		QWORD elapsed = getTimeMS() - ini;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		std::sort(latencies.begin(), latencies.end());
+		QWORD p99 = latencies.size() ? latencies[latencies.size() * 99 / 100] : 0;
+		Log("\t%-18s %8.1f frames/s p99 %6llu us\n", name, elapsed ? latencies.size() * 1000.0 / elapsed : 0.0, p99);
+	}
+};
+
+ExecutorTestPlan executor;
@@ -0,0 +1,74 @@
+#include "test.h"
+#include "log.h"
+#include <fcntl.h>
+#include <thread>
+#include <vector>
+
+class LoggerTestPlan : public TestPlan
+{
+public:
+	static constexpr size_t Messages = 100000;
+
+	LoggerTestPlan() : TestPlan("Logger benchmark")
+	{
+	}
+
+	virtual void Execute()
+	{
+		for (size_t threads : { 1, 4, 16 })
+		{
+			Log("-%zu threads\n", threads);
+			benchmark("synchronous", threads, false);
+			benchmark("deferred", threads, true);
+		}
+	}
+
+	void benchmark(const char* name, size_t threads, bool deferred)
+	{
+		std::vector<std::thread> workers;
+		std::vector<QWORD> elapsed(threads);
+		QWORD dropped = DeferredLogger::GetInstance().GetDropped();
+
+		//Discard output while measuring
+		fflush(stdout);
+		int saved = dup(fileno(stdout));
+		int null = open("/dev/null", O_WRONLY);
+		dup2(null, fileno(stdout));
+		FILE* output = fdopen(dup(null), "w");
+		DeferredLogger::GetInstance().SetOutput(output);
+		Logger::EnableDeferred(deferred);
+
+		for (size_t i = 0; i < threads; ++i)
+		{
+			workers.emplace_back([&, i]() {
+				QWORD ini = getTime();
+				for (size_t j = 0; j < Messages; ++j)
+					Log("-Logging message [thread:%zu,num:%zu,name:%s,time:%llu]\n", i, j, name, ini);
+				elapsed[i] = getTime() - ini;
+			});
+		}
+		for (auto& worker : workers)
+			worker.join();
+
+		//Wait for pending ones
+		QWORD ini = getTime();
+		Logger::EnableDeferred(false);
+		QWORD drain = getTime() - ini;
+		dropped = DeferredLogger::GetInstance().GetDropped() - dropped;
+
+		//Restore output
+		fflush(stdout);
+		dup2(saved, fileno(stdout));
+		close(saved);
+		close(null);
+		DeferredLogger::GetInstance().SetOutput(stdout);
+		fclose(output);
+
+		QWORD total = 0;
+		for (auto time : elapsed)
+			total += time;
+		Log("\t%-12s %8.1f ns/call drain %6llu us dropped %llu\n", name, total * 1000.0 / (threads * Messages), drain, dropped);
+	}
+};
+
+LoggerTestPlan logger;
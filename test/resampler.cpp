@@ -0,0 +1,67 @@
+#include "test.h"
+#include "tools.h"
+#include "AudioResampler.h"
+#include "speex/speex_resampler.h"
+#include <cmath>
+#include <vector>
+
+class ResamplerTestPlan : public TestPlan
+{
+public:
+	ResamplerTestPlan() : TestPlan("Resampler benchmark")
+	{
+	}
+
+	virtual void Execute()
+	{
+		Log("-Resampler [avx2:%d,sse2:%d]\n", AudioResampler::IsAVX2Accelerated(), AudioResampler::IsSSE2Accelerated());
+
+		const DWORD rates[] = { 8000, 16000, 32000, 44100, 48000 };
+		for (DWORD numChannels = 1; numChannels <= 2; ++numChannels)
+			for (auto in : rates)
+				for (auto out : rates)
+					if (in != out)
+						benchmark(in, out, numChannels);
+	}
+
+	void benchmark(DWORD inputRate, DWORD outputRate, DWORD numChannels)
+	{
+		//10 seconds of audio in 20ms frames
+		DWORD frameSamples = inputRate / 50;
+		DWORD frames = 500;
+		std::vector<int16_t> in(frameSamples * numChannels);
+		std::vector<int16_t> out((frameSamples * outputRate / inputRate + 64) * numChannels);
+		for (DWORD i = 0; i < frameSamples; ++i)
+			for (DWORD ch = 0; ch < numChannels; ++ch)
+				in[i * numChannels + ch] = 10000 * std::sin(2 * M_PI * 440 * (ch + 1) * i / inputRate);
+
+		//Same quality as AudioTransrater
+		int err;
+		SpeexResamplerState* speex = mcu_resampler_init(numChannels, inputRate, outputRate, 10, &err);
+		QWORD ini = getTime();
+		for (DWORD i = 0; i < frames; ++i)
+		{
+			spx_uint32_t inLen = frameSamples;
+			spx_uint32_t outLen = out.size() / numChannels;
+			mcu_resampler_process_interleaved_int(speex, in.data(), &inLen, out.data(), &outLen);
+		}
+		QWORD speexElapsed = getTime() - ini;
+		mcu_resampler_destroy(speex);
+
+		QWORD elapsed[3] = {};
+		const AudioResampler::Quality qualities[] = { AudioResampler::Quality::Low, AudioResampler::Quality::Medium, AudioResampler::Quality::High };
+		for (DWORD q = 0; q < 3; ++q)
+		{
+			AudioResampler resampler;
+			resampler.Open(inputRate, outputRate, numChannels, qualities[q]);
+			ini = getTime();
+			for (DWORD i = 0; i < frames; ++i)
+				resampler.Process(in.data(), frameSamples, out.data(), out.size() / numChannels);
+			elapsed[q] = getTime() - ini;
+		}
+
+		Log("\t%5u -> %5u %s speex:%6lluus low:%6lluus medium:%6lluus high:%6lluus\n", inputRate, outputRate, numChannels == 1 ? "mono  " : "stereo", speexElapsed, elapsed[0], elapsed[1], elapsed[2]);
+	}
+};
+
+ResamplerTestPlan resampler;
@@ -354,7 +354,7 @@ public:
 			//Check
 			assert(len);
 			assert(extension.hasRId);
-			assert(strcmp(extension.rid.c_str(),kStreamId)==0);
+			assert(strcmp(extension.GetRId().c_str(),kStreamId)==0);
 			
 			//Serialize and ensure it is the same
 			BYTE aux[128];
@@ -393,7 +393,7 @@ public:
 			//Check
 			assert(len);
 			assert(extension.hasMediaStreamId);
-			assert(strcmp(extension.mid.c_str(),kMid)==0);
+			assert(strcmp(extension.GetMediaStreamId().c_str(),kMid)==0);
 			
 			//Serialize and ensure it is the same
 			BYTE aux[128];
@@ -433,11 +433,11 @@ public:
 			//Check
 			assert(len);
 			assert(extension.hasRId);
-			assert(strcmp(extension.rid.c_str(),kStreamId)==0);
+			assert(strcmp(extension.GetRId().c_str(),kStreamId)==0);
 			assert(extension.hasRepairedId);
-			assert(strcmp(extension.repairedId.c_str(),kRepairedStreamId)==0);
+			assert(strcmp(extension.GetRepairedId().c_str(),kRepairedStreamId)==0);
 			assert(extension.hasMediaStreamId);
-			assert(strcmp(extension.mid.c_str(),kMid)==0);
+			assert(strcmp(extension.GetMediaStreamId().c_str(),kMid)==0);
 			
 			//Serialize and ensure it is the same
 			BYTE aux[128];
@@ -461,7 +461,6 @@ public:
 			extension.hasAbsSentTime = true;
 			extension.hasTransportWideCC = true;
 			extension.hasFrameMarking = true;
-			extension.hasMediaStreamId = true;
 			extension.timeOffset = 1800;
 			extension.absSentTime = 15069;
 			extension.transportSeqNum = 116;
@@ -473,7 +472,7 @@ public:
 			extension.frameMarks.temporalLayerId = 0;
 			extension.frameMarks.layerId = 0;
 			extension.frameMarks.tl0PicIdx = 0;
-			extension.mid = "sdparta_0";
+			extension.SetMediaStreamId("sdparta_0");
 			
 			
 			//Serialize and ensure it is the same
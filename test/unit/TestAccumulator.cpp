@@ -93,4 +93,35 @@ TEST(TestAccumulator, UpdateSameTimestamp)
 			ASSERT_EQ(acu.GetMinValueInWindow(), *min.GetMin());
 		}
 	}
-}
\ No newline at end of file
+}
+TEST(TestAccumulator, Bucket)
+{
+	std::vector<std::pair<uint64_t, DWORD>> values;
+
+	MinMaxAcumulator acu(1000, 1000, 0, 100);
+	uint64_t ini = 0;
+	for (uint64_t i = 0; i < 1E5; i++)
+	{
+		ini += 50 * ((double)rand() / (RAND_MAX));
+		DWORD val = 1000 * ((double)rand() / (RAND_MAX));
+
+		acu.Update(ini, val);
+
+		//Values expire when its whole bucket gets out of the window
+		values.emplace_back(ini - ini % 100, val);
+		values.erase(std::remove_if(values.begin(), values.end(), [=](auto& pair) { return pair.first + 1000 <= ini; }), values.end());
+		DWORD instant = 0;
+		DWORD min = std::numeric_limits<DWORD>::max();
+		DWORD max = 0;
+		for (const auto& value : values)
+		{
+			instant += value.second;
+			min = std::min(min, value.second);
+			max = std::max(max, value.second);
+		}
+
+		ASSERT_EQ(acu.GetInstant(), instant);
+		ASSERT_EQ(acu.GetMaxValueInWindow(), max);
+		ASSERT_EQ(acu.GetMinValueInWindow(), min);
+	}
+}
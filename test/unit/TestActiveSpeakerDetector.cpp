@@ -0,0 +1,190 @@
+#include "TestCommon.h"
+#include "ActiveSpeakerDetector.h"
+#include "AudioLevelDetector.h"
+
+#include <cmath>
+#include <vector>
+
+class ActiveSpeakerListener : public ActiveSpeakerDetector::Listener
+{
+public:
+	virtual void onActiveSpeakerChanded(uint32_t id) override
+	{
+		changes.push_back(id);
+	}
+
+	std::vector<uint32_t> changes;
+};
+
+static std::vector<int16_t> Sine(DWORD rate, DWORD samples, double amplitude)
+{
+	std::vector<int16_t> pcm(samples);
+	for (DWORD i = 0; i < samples; ++i)
+		pcm[i] = std::lrint(amplitude * std::sin(2 * M_PI * 1000 * i / rate));
+	return pcm;
+}
+
+TEST(TestAudioLevelDetector, Level)
+{
+	std::vector<int16_t> silence(960);
+	EXPECT_EQ(127, AudioLevelDetector::CalcLevel(silence.data(), silence.size()));
+
+	//Full scale square wave is the overload point
+	std::vector<int16_t> square(960);
+	for (size_t i = 0; i < square.size(); ++i)
+		square[i] = i % 2 ? 32767 : -32768;
+	EXPECT_EQ(0, AudioLevelDetector::CalcLevel(square.data(), square.size()));
+
+	//Sine is 3dB below its peak
+	for (auto db : { 10, 20, 40, 60 })
+	{
+		auto pcm = Sine(48000, 960, 32768 * std::pow(10, -db / 20.0));
+		EXPECT_NEAR(db + 3, AudioLevelDetector::CalcLevel(pcm.data(), pcm.size()), 1) << db;
+	}
+}
+
+TEST(TestAudioLevelDetector, Energy)
+{
+	//Odd sizes to check the tail of the vector kernels
+	for (DWORD size : { 0u, 1u, 7u, 15u, 17u, 160u, 333u, 960u })
+	{
+		std::vector<int16_t> pcm(size);
+		QWORD expected = 0;
+		for (DWORD i = 0; i < size; ++i)
+		{
+			pcm[i] = i % 3 ? -32768 : 32767 - i;
+			expected += (int64_t)pcm[i] * pcm[i];
+		}
+		EXPECT_EQ(expected, AudioLevelDetector::CalcEnergy(pcm.data(), pcm.size())) << size;
+	}
+}
+
+TEST(TestAudioLevelDetector, Batch)
+{
+	AudioLevelDetector detector;
+
+	auto loud = Sine(16000, 320, 8000);
+	auto quiet = Sine(16000, 320, 10);
+	std::vector<int16_t> silence(320);
+
+	std::vector<AudioLevelDetector::Block> blocks(3);
+	blocks[0].id = 1; blocks[0].samples = loud.data(); blocks[0].numSamples = loud.size(); blocks[0].rate = 16000;
+	blocks[1].id = 2; blocks[1].samples = quiet.data(); blocks[1].numSamples = quiet.size(); blocks[1].rate = 16000;
+	blocks[2].id = 3; blocks[2].samples = silence.data(); blocks[2].numSamples = silence.size(); blocks[2].rate = 16000;
+
+	detector.Process(blocks);
+
+	EXPECT_EQ(AudioLevelDetector::CalcLevel(loud.data(), loud.size()), blocks[0].level);
+	EXPECT_EQ(AudioLevelDetector::CalcLevel(quiet.data(), quiet.size()), blocks[1].level);
+	EXPECT_EQ(127, blocks[2].level);
+
+	//Below the silence threshold there is no voice
+	EXPECT_FALSE(blocks[1].vad);
+	EXPECT_FALSE(blocks[2].vad);
+
+	//Digital silence is never voice
+	detector.SetSilenceThreshold(127);
+	detector.Process(blocks);
+	EXPECT_FALSE(blocks[2].vad);
+}
+
+TEST(TestActiveSpeakerDetector, Accumulate)
+{
+	ActiveSpeakerListener listener;
+	ActiveSpeakerDetector detector(&listener);
+	detector.SetMinChangePeriod(0);
+
+	uint64_t now = 0;
+
+	//Silence does not select anyone
+	detector.Accumulate(1, false, 127, now);
+	detector.Accumulate(2, true, 127, now);
+	EXPECT_TRUE(listener.changes.empty());
+
+	//First speaker
+	for (DWORD i = 0; i < 10; ++i)
+	{
+		now += 20;
+		detector.Accumulate(1, true, 30, now);
+	}
+	ASSERT_EQ(1u, listener.changes.size());
+	EXPECT_EQ(1u, listener.changes.back());
+
+	//Second one speaks louder for a while
+	for (DWORD i = 0; i < 100; ++i)
+	{
+		now += 20;
+		detector.Accumulate(2, true, 0, now);
+	}
+	ASSERT_EQ(2u, listener.changes.size());
+	EXPECT_EQ(2u, listener.changes.back());
+
+	//Releasing the active one selects the other one when it speaks again
+	detector.Release(2);
+	now += 20;
+	detector.Accumulate(1, true, 30, now);
+	ASSERT_EQ(3u, listener.changes.size());
+	EXPECT_EQ(1u, listener.changes.back());
+}
+
+TEST(TestActiveSpeakerDetector, Batch)
+{
+	ActiveSpeakerListener listener;
+	ActiveSpeakerDetector detector(&listener);
+	detector.SetMinChangePeriod(0);
+
+	std::vector<AudioLevelDetector::Block> blocks(500);
+	for (DWORD i = 0; i < blocks.size(); ++i)
+		blocks[i].id = i + 1;
+
+	uint64_t now = 0;
+
+	//All silent
+	detector.Accumulate(blocks, now);
+	EXPECT_TRUE(listener.changes.empty());
+
+	//One of them starts talking
+	blocks[321].vad = true;
+	blocks[321].level = 20;
+	for (DWORD i = 0; i < 10; ++i)
+	{
+		now += 20;
+		detector.Accumulate(blocks, now);
+	}
+	ASSERT_EQ(1u, listener.changes.size());
+	EXPECT_EQ(322u, listener.changes.back());
+
+	//Another one talks louder and takes over
+	blocks[321].vad = false;
+	blocks[42].vad = true;
+	blocks[42].level = 0;
+	for (DWORD i = 0; i < 200; ++i)
+	{
+		now += 20;
+		detector.Accumulate(blocks, now);
+	}
+	ASSERT_EQ(2u, listener.changes.size());
+	EXPECT_EQ(43u, listener.changes.back());
+}
+
+TEST(TestActiveSpeakerDetector, SilentFirst)
+{
+	ActiveSpeakerListener listener;
+	ActiveSpeakerDetector detector(&listener);
+	detector.SetMinChangePeriod(0);
+
+	uint64_t now = 100;
+
+	//First one is seen while silent, second one while speaking
+	detector.Accumulate(1, false, 127, now);
+	now += 20;
+	detector.Accumulate(2, true, 30, now);
+	ASSERT_EQ(1u, listener.changes.size());
+	EXPECT_EQ(2u, listener.changes.back());
+
+	//Silent ones do not get the initial bump when they start speaking, just accumulate from when they were seen
+	now += 20;
+	detector.Accumulate(1, true, 0, now);
+	ASSERT_EQ(1u, listener.changes.size());
+	EXPECT_EQ(2u, listener.changes.back());
+}
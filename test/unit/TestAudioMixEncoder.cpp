@@ -0,0 +1,287 @@
+#include "TestCommon.h"
+#include "mixer/audiomixencoder.h"
+#include "mixer/sidebar.h"
+
+#include <map>
+#include <vector>
+
+namespace
+{
+
+//Encoded frame payload
+struct Payload
+{
+	//Encoder state before and after encoding the frame
+	QWORD prev;
+	QWORD state;
+	SWORD first;
+};
+
+//Encoder whose state is a hash of all the encoded samples
+class FakeEncoder : public AudioEncoder
+{
+public:
+	FakeEncoder(bool copyable, DWORD* encoded) :
+		copyable(copyable),
+		encoded(encoded),
+		frame(std::make_shared<AudioFrame>(AudioCodec::PCMU))
+	{
+		type = AudioCodec::PCMU;
+		numFrameSamples = 160;
+	}
+
+	virtual AudioFrame::shared Encode(const AudioBuffer::const_shared& audioBuffer) override
+	{
+		Payload payload = { state, state, audioBuffer->GetData()[0] };
+		bool silence = true;
+		for (DWORD i = 0; i < audioBuffer->GetNumSamples(); ++i)
+		{
+			payload.state = payload.state * 31 + audioBuffer->GetData()[i] + 1;
+			silence = silence && !audioBuffer->GetData()[i];
+		}
+		//No history left after digital silence
+		if (silence)
+			payload.state = 0;
+		state = payload.state;
+		(*encoded)++;
+		frame->SetMedia((const BYTE*)&payload, sizeof(payload));
+		return frame;
+	}
+	virtual DWORD TrySetRate(DWORD rate, DWORD numChannels) override { return rate; }
+	virtual DWORD GetRate() override { return 8000; }
+	virtual DWORD GetClockRate() override { return 8000; }
+	virtual bool CopyState(const AudioEncoder& other) override
+	{
+		if (!copyable)
+			return false;
+		state = static_cast<const FakeEncoder&>(other).state;
+		return true;
+	}
+
+private:
+	bool copyable;
+	DWORD* encoded;
+	QWORD state = 0;
+	AudioFrame::shared frame;
+};
+
+class FrameListener : public MediaFrame::Listener
+{
+public:
+	virtual void onMediaFrame(const MediaFrame& frame) override
+	{
+		Payload payload;
+		memcpy(&payload, frame.GetData(), sizeof(payload));
+		payloads.push_back(payload);
+		timestamps.push_back(frame.GetTimestamp());
+	}
+	virtual void onMediaFrame(DWORD ssrc, const MediaFrame& frame) override { onMediaFrame(frame); }
+
+	//Check all frames come from the same encoder state
+	bool IsContinuous() const
+	{
+		for (size_t i = 1; i < payloads.size(); ++i)
+			if (payloads[i].prev != payloads[i - 1].state || timestamps[i] != timestamps[i - 1] + 160)
+				return false;
+		return true;
+	}
+
+	std::vector<Payload> payloads;
+	std::vector<QWORD> timestamps;
+};
+
+}
+
+class TestAudioMixEncoder : public ::testing::Test
+{
+protected:
+	static constexpr DWORD Rate = 8000;
+	static constexpr DWORD RoundSamples = 80;
+	static constexpr int Other = 100;
+
+	void Init(std::vector<int> ids, bool copyable = true)
+	{
+		ASSERT_TRUE(encoder.SetEncoding(Rate, Sidebar::MIXER_BUFFER_SIZE, [this, copyable]() {
+			return new FakeEncoder(copyable, &encoded);
+		}));
+		for (auto id : ids)
+		{
+			listeners[id] = std::make_shared<FrameListener>();
+			encoder.AddListener(id, listeners[id]);
+			sidebar.AddParticipant(id);
+			sidebars[id] = &sidebar;
+		}
+		sidebar.AddParticipant(Other);
+		other.Reset();
+		other.AddParticipant(Other);
+	}
+
+	//Run mixing rounds with the participants talking and the level of a non encoded one
+	void Round(std::map<int, SWORD> talking, SWORD level, DWORD rounds = 1)
+	{
+		for (DWORD r = 0; r < rounds; ++r)
+		{
+			alignas(16) SWORD samples[RoundSamples];
+			sidebar.Reset();
+			other.Reset();
+			for (auto& [id, value] : talking)
+			{
+				std::fill_n(samples, RoundSamples, value);
+				sidebars[id]->Update(id, samples, RoundSamples);
+			}
+			std::fill_n(samples, RoundSamples, level);
+			sidebar.Update(Other, samples, RoundSamples);
+			other.Update(Other, samples, RoundSamples);
+
+			for (auto& [id, listener] : listeners)
+			{
+				auto it = talking.find(id);
+				bool contributing = it != talking.end() && sidebars[id]->HasParticipant(id);
+				if (encoder.Update(id, sidebars[id], contributing, RoundSamples))
+				{
+					//Mix minus
+					for (DWORD i = 0; i < RoundSamples; ++i)
+						samples[i] = sidebars[id]->GetBuffer()[i] - (contributing ? it->second : 0);
+					encoder.Append(id, samples, RoundSamples);
+				}
+			}
+			encoder.Process(RoundSamples);
+		}
+	}
+
+	DWORD encoded = 0;
+	AudioMixEncoder encoder;
+	Sidebar sidebar;
+	Sidebar other;
+	std::map<int, Sidebar*> sidebars;
+	std::map<int, std::shared_ptr<FrameListener>> listeners;
+};
+
+TEST_F(TestAudioMixEncoder, Share)
+{
+	Init({ 1, 2, 3 });
+
+	//Nobody encoded is talking, all share the same encoder
+	Round({}, 100, 10);
+	EXPECT_EQ(1, encoder.GetNumSharedEncoders());
+	EXPECT_EQ(0, encoder.GetNumIndividualEncoders());
+	EXPECT_EQ(5, encoded);
+
+	for (auto& [id, listener] : listeners)
+	{
+		ASSERT_EQ(5, listener->payloads.size());
+		EXPECT_EQ(100, listener->payloads.back().first);
+		EXPECT_EQ(listeners[1]->payloads.back().state, listener->payloads.back().state);
+		EXPECT_TRUE(listener->IsContinuous());
+	}
+}
+
+TEST_F(TestAudioMixEncoder, Contributing)
+{
+	Init({ 1, 2, 3 });
+	Round({}, 100, 3);
+
+	//First one starts talking mid frame and gets its own mix minus
+	Round({ { 1, 10 } }, 100, 9);
+	EXPECT_FALSE(encoder.IsSharing(1));
+	EXPECT_TRUE(encoder.IsSharing(2));
+	EXPECT_EQ(1, encoder.GetNumSharedEncoders());
+	EXPECT_EQ(1, encoder.GetNumIndividualEncoders());
+	EXPECT_EQ(100, listeners[1]->payloads.back().first);
+	EXPECT_EQ(110, listeners[2]->payloads.back().first);
+
+	//Output continues from the shared encoder state
+	for (auto& [id, listener] : listeners)
+	{
+		EXPECT_EQ(6, listener->payloads.size());
+		EXPECT_TRUE(listener->IsContinuous()) << id;
+	}
+
+	//When it stops there is still sound on the mix, so it can't move back
+	Round({}, 100, 20);
+	EXPECT_FALSE(encoder.IsSharing(1));
+	EXPECT_TRUE(listeners[1]->IsContinuous());
+
+	//Until both encoders have no history left
+	Round({}, 0, 2);
+	EXPECT_FALSE(encoder.IsSharing(1));
+	Round({}, 0, 20);
+	EXPECT_TRUE(encoder.IsSharing(1));
+	EXPECT_EQ(0, encoder.GetNumIndividualEncoders());
+
+	DWORD frames = encoded;
+	Round({}, 100, 10);
+	EXPECT_EQ(frames + 5, encoded);
+
+	for (auto& [id, listener] : listeners)
+		EXPECT_TRUE(listener->IsContinuous()) << id;
+}
+
+TEST_F(TestAudioMixEncoder, SharedEncoderNotUsed)
+{
+	Init({ 1 });
+
+	Round({ { 1, 10 } }, 100, 5);
+	EXPECT_FALSE(encoder.IsSharing(1));
+	EXPECT_EQ(0, encoder.GetNumSharedEncoders());
+
+	//Nobody else uses the shared encoder, so it continues from the participant state
+	Round({}, 100, 4);
+	EXPECT_TRUE(encoder.IsSharing(1));
+	EXPECT_EQ(1, encoder.GetNumSharedEncoders());
+
+	Round({}, 100, 4);
+	EXPECT_EQ(100, listeners[1]->payloads.back().first);
+	EXPECT_TRUE(listeners[1]->IsContinuous());
+}
+
+TEST_F(TestAudioMixEncoder, SidebarChange)
+{
+	Init({ 1, 2 });
+	Round({}, 100, 4);
+
+	//Second one listens to another sidebar, continuing from the shared encoder state
+	sidebars[2] = &other;
+	Round({}, 50);
+	EXPECT_TRUE(encoder.IsSharing(1));
+	EXPECT_FALSE(encoder.IsSharing(2));
+
+	//It is alone there, so it takes that shared encoder after the frame
+	Round({}, 50);
+	EXPECT_TRUE(encoder.IsSharing(2));
+	EXPECT_EQ(2, encoder.GetNumSharedEncoders());
+
+	Round({}, 50, 4);
+	EXPECT_EQ(50, listeners[2]->payloads.back().first);
+	EXPECT_EQ(50, listeners[1]->payloads.back().first);
+	EXPECT_TRUE(listeners[1]->IsContinuous());
+	EXPECT_TRUE(listeners[2]->IsContinuous());
+}
+
+TEST_F(TestAudioMixEncoder, NotCopyable)
+{
+	Init({ 1, 2, 3 }, false);
+
+	//Outputs can't be moved between encoders, so each one has its own
+	Round({}, 100, 10);
+	EXPECT_EQ(0, encoder.GetNumSharedEncoders());
+	EXPECT_EQ(3, encoder.GetNumIndividualEncoders());
+	EXPECT_EQ(15, encoded);
+
+	for (auto& [id, listener] : listeners)
+		EXPECT_TRUE(listener->IsContinuous());
+}
+
+TEST_F(TestAudioMixEncoder, RemoveListener)
+{
+	Init({ 1, 2 });
+	Round({}, 100, 4);
+
+	ASSERT_TRUE(encoder.RemoveListener(2, listeners[2]));
+	EXPECT_FALSE(encoder.IsEncoded(2));
+	EXPECT_TRUE(encoder.IsEncoded(1));
+
+	Round({}, 100, 4);
+	EXPECT_EQ(2, listeners[2]->payloads.size());
+	EXPECT_EQ(4, listeners[1]->payloads.size());
+}
@@ -0,0 +1,156 @@
+#include "TestCommon.h"
+#include "AudioResampler.h"
+
+#include <cmath>
+#include <vector>
+
+static std::vector<int16_t> Sine(DWORD rate, DWORD numChannels, DWORD samples, const std::vector<double>& frequencies, double amplitude = 10000)
+{
+	std::vector<int16_t> pcm(samples * numChannels);
+	for (DWORD i = 0; i < samples; ++i)
+		for (DWORD ch = 0; ch < numChannels; ++ch)
+			pcm[i * numChannels + ch] = std::lrint(amplitude * std::sin(2 * M_PI * frequencies[ch] * i / rate));
+	return pcm;
+}
+
+static std::vector<int16_t> Resample(AudioResampler& resampler, const std::vector<int16_t>& pcm, DWORD numChannels, DWORD chunk)
+{
+	std::vector<int16_t> resampled;
+	std::vector<int16_t> out;
+	DWORD samples = pcm.size() / numChannels;
+	for (DWORD i = 0; i < samples; i += chunk)
+	{
+		DWORD len = std::min(chunk, samples - i);
+		out.resize(resampler.GetMaxOutputSamples(len) * numChannels);
+		DWORD num = resampler.Process(pcm.data() + i * numChannels, len, out.data(), out.size() / numChannels);
+		resampled.insert(resampled.end(), out.begin(), out.begin() + num * numChannels);
+	}
+	return resampled;
+}
+
+//Fit a sine of the given frequency and return the residual power relative to it in dB
+static double Residual(const std::vector<int16_t>& pcm, DWORD rate, DWORD numChannels, DWORD ch, double frequency, DWORD skip)
+{
+	double ss = 0, cc = 0, sc = 0, xs = 0, xc = 0;
+	DWORD samples = pcm.size() / numChannels;
+	for (DWORD i = skip; i < samples - skip; ++i)
+	{
+		double s = std::sin(2 * M_PI * frequency * i / rate);
+		double c = std::cos(2 * M_PI * frequency * i / rate);
+		double x = pcm[i * numChannels + ch];
+		ss += s * s; cc += c * c; sc += s * c; xs += x * s; xc += x * c;
+	}
+	//Least squares
+	double det = ss * cc - sc * sc;
+	double a = (xs * cc - xc * sc) / det;
+	double b = (xc * ss - xs * sc) / det;
+	double signal = 0, noise = 0;
+	for (DWORD i = skip; i < samples - skip; ++i)
+	{
+		double fit = a * std::sin(2 * M_PI * frequency * i / rate) + b * std::cos(2 * M_PI * frequency * i / rate);
+		double err = pcm[i * numChannels + ch] - fit;
+		signal += fit * fit;
+		noise += err * err;
+	}
+	return 10 * std::log10(noise / signal);
+}
+
+TEST(TestAudioResampler, Supported)
+{
+	const DWORD rates[] = { 8000, 16000, 32000, 44100, 48000 };
+	for (auto in : rates)
+		for (auto out : rates)
+			EXPECT_EQ(in != out, AudioResampler::IsSupported(in, out, 2)) << in << "->" << out;
+
+	EXPECT_FALSE(AudioResampler::IsSupported(44100, 48000, 3));
+	EXPECT_FALSE(AudioResampler::IsSupported(44099, 48000, 1));
+	EXPECT_FALSE(AudioResampler::IsSupported(0, 48000, 1));
+}
+
+TEST(TestAudioResampler, Mono)
+{
+	const DWORD rates[] = { 8000, 16000, 32000, 44100, 48000 };
+	for (auto in : rates)
+	{
+		for (auto out : rates)
+		{
+			if (in == out)
+				continue;
+
+			AudioResampler resampler;
+			ASSERT_TRUE(resampler.Open(in, out, 1));
+
+			//1 second of a tone below both nyquists, in 10ms chunks
+			auto pcm = Sine(in, 1, in, { 1000 });
+			auto resampled = Resample(resampler, pcm, 1, in / 100);
+
+			//Output is delayed but no samples are kept
+			EXPECT_NEAR((double)out, (double)resampled.size(), 1) << in << "->" << out;
+			//Same tone, with low distortion
+			EXPECT_LT(Residual(resampled, out, 1, 0, 1000, out / 50), -40) << in << "->" << out;
+		}
+	}
+}
+
+TEST(TestAudioResampler, Stereo)
+{
+	for (auto quality : { AudioResampler::Quality::Low, AudioResampler::Quality::Medium, AudioResampler::Quality::High })
+	{
+		AudioResampler stereo;
+		AudioResampler left;
+		AudioResampler right;
+		ASSERT_TRUE(stereo.Open(44100, 48000, 2, quality));
+		ASSERT_TRUE(left.Open(44100, 48000, 1, quality));
+		ASSERT_TRUE(right.Open(44100, 48000, 1, quality));
+
+		auto pcm = Sine(44100, 2, 44100, { 440, 3000 });
+		auto resampled = Resample(stereo, pcm, 2, 1024);
+
+		//Each channel keeps its tone
+		EXPECT_LT(Residual(resampled, 48000, 2, 0, 440, 960), -40);
+		EXPECT_LT(Residual(resampled, 48000, 2, 1, 3000, 960), -40);
+
+		//Same as resampling each channel alone
+		std::vector<int16_t> l(44100), r(44100);
+		for (DWORD i = 0; i < 44100; ++i)
+		{
+			l[i] = pcm[i * 2];
+			r[i] = pcm[i * 2 + 1];
+		}
+		auto resampledLeft = Resample(left, l, 1, 1024);
+		auto resampledRight = Resample(right, r, 1, 1024);
+		ASSERT_EQ(resampledLeft.size() * 2, resampled.size());
+		for (size_t i = 0; i < resampledLeft.size(); ++i)
+		{
+			ASSERT_NEAR(resampledLeft[i], resampled[i * 2], 1);
+			ASSERT_NEAR(resampledRight[i], resampled[i * 2 + 1], 1);
+		}
+	}
+}
+
+TEST(TestAudioResampler, Chunks)
+{
+	AudioResampler one;
+	AudioResampler chunked;
+	ASSERT_TRUE(one.Open(48000, 16000, 1));
+	ASSERT_TRUE(chunked.Open(48000, 16000, 1));
+
+	auto pcm = Sine(48000, 1, 48000, { 1000 });
+
+	//Output does not depend on the input chunks
+	EXPECT_EQ(Resample(one, pcm, 1, 48000), Resample(chunked, pcm, 1, 7));
+}
+
+TEST(TestAudioResampler, Reset)
+{
+	AudioResampler resampler;
+	ASSERT_TRUE(resampler.Open(44100, 48000, 1));
+
+	auto pcm = Sine(44100, 1, 4410, { 1000 });
+	auto first = Resample(resampler, pcm, 1, 441);
+	resampler.Reset();
+	auto second = Resample(resampler, pcm, 1, 441);
+
+	//No state kept after reset
+	EXPECT_EQ(first, second);
+}
@@ -0,0 +1,130 @@
+#include "TestCommon.h"
+#include "AudioTranscoder.h"
+#include "./helper/TestAudioDecodingHelper.h"
+
+#include <vector>
+
+namespace
+{
+
+struct EncodedFrame
+{
+	AudioCodec::Type codec;
+	QWORD timestamp;
+	DWORD clockRate;
+	DWORD duration;
+	int numChannels;
+	DWORD length;
+};
+
+class EncodedFrameCollector : public MediaFrame::Listener
+{
+public:
+	virtual void onMediaFrame(const MediaFrame& frame) override
+	{
+		const AudioFrame& audio = static_cast<const AudioFrame&>(frame);
+		frames.push_back({ audio.GetCodec(), audio.GetTimestamp(), audio.GetClockRate(), audio.GetDuration(), audio.GetNumChannels(), audio.GetLength() });
+	}
+	virtual void onMediaFrame(DWORD ssrc, const MediaFrame& frame) override { onMediaFrame(frame); }
+
+	std::vector<EncodedFrame> frames;
+};
+
+void CheckOpusFrames(const std::vector<EncodedFrame>& frames, QWORD first, int numChannels)
+{
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		//20ms frames on 48khz timeline, continuous from the first input timestamp
+		EXPECT_EQ(AudioCodec::OPUS, frames[i].codec);
+		EXPECT_EQ(48000, frames[i].clockRate);
+		EXPECT_EQ(960, frames[i].duration);
+		EXPECT_EQ(first + i * 960, frames[i].timestamp) << i;
+		EXPECT_EQ(numChannels, frames[i].numChannels);
+		EXPECT_LT(0, frames[i].length);
+	}
+}
+
+}
+
+TEST(TestAudioTranscoder, AAC44100ToOpus)
+{
+	static constexpr int AAC_FRAME_SIZE = 1024;
+
+	uint64_t channelLayout = AV_CH_LAYOUT_STEREO;
+	int numAACFrames = 50;
+	int sampleRate = 44100, numChannels = av_get_channel_layout_nb_channels(channelLayout);
+	AudioEncodingParams params = {
+		sampleRate,
+		numChannels,
+		128000,
+		AV_SAMPLE_FMT_FLTP,
+		channelLayout,
+		AV_CODEC_ID_AAC};
+	AudioPacketGenerator avGenerator(params, AAC_FRAME_SIZE * numAACFrames, 1000.0, sampleRate);
+	if (!avGenerator.IsValidSampleFormat(params.sampleFmt))
+		GTEST_SKIP();
+
+	//AAC-LC, 44.1khz, stereo
+	const uint8_t config[2] = { 0x12, 0x10 };
+
+	auto collector = std::make_shared<EncodedFrameCollector>();
+	AudioTranscoder transcoder(AudioCodec::OPUS, Properties());
+	transcoder.AddMediaListener(collector);
+	transcoder.SetAACConfig(config, sizeof(config));
+
+	//Start with an offset so the timeline is rebased to 48khz
+	QWORD pts = sampleRate;
+	std::queue<AVPacket*> packets = avGenerator.GenerateAVPackets(0.5);
+	while (!packets.empty())
+	{
+		auto packet = packets.front();
+		AudioFrame frame(AudioCodec::AAC);
+		frame.SetTimestamp(pts);
+		frame.SetClockRate(sampleRate);
+		frame.SetNumChannels(numChannels);
+		frame.AppendMedia(packet->data, packet->size);
+		transcoder.onMediaFrame(frame);
+		pts += AAC_FRAME_SIZE;
+		av_packet_free(&packet);
+		packets.pop();
+	}
+
+	//Opus does not support 44.1khz, so it is resampled
+	EXPECT_EQ(48000, transcoder.GetRate());
+	EXPECT_EQ(numChannels, transcoder.GetNumChannels());
+
+	//All resampled samples are encoded except the ones pending for next frame and the resampler delay
+	size_t expected = (size_t)numAACFrames * AAC_FRAME_SIZE * 48000 / sampleRate / 960;
+	EXPECT_GE(collector->frames.size(), expected - 2);
+	EXPECT_LE(collector->frames.size(), expected + 1);
+
+	CheckOpusFrames(collector->frames, 48000, numChannels);
+}
+
+TEST(TestAudioTranscoder, PCMUToOpus)
+{
+	auto collector = std::make_shared<EncodedFrameCollector>();
+	AudioTranscoder transcoder(AudioCodec::OPUS, Properties());
+	transcoder.AddMediaListener(collector);
+
+	//20ms of mu-law silence on each frame
+	std::vector<BYTE> payload(160, 0xFF);
+	QWORD pts = 8000;
+	for (int i = 0; i < 50; ++i)
+	{
+		AudioFrame frame(AudioCodec::PCMU);
+		frame.SetTimestamp(pts);
+		frame.SetClockRate(8000);
+		frame.SetNumChannels(1);
+		frame.AppendMedia(payload.data(), payload.size());
+		transcoder.onMediaFrame(frame);
+		pts += payload.size();
+	}
+
+	//Opus encodes at 8khz natively, so there is no resampling and each input frame is encoded on its own
+	EXPECT_EQ(8000, transcoder.GetRate());
+	EXPECT_EQ(1, transcoder.GetNumChannels());
+	ASSERT_EQ(50, collector->frames.size());
+
+	CheckOpusFrames(collector->frames, 48000, 1);
+}
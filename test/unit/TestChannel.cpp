@@ -0,0 +1,142 @@
+#include "TestCommon.h"
+#include "Channel.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+//Time service that keeps scheduled channels until processed manually
+class ManualTimeService : public TestTimeService
+{
+public:
+	virtual void ScheduleChannel(const std::weak_ptr<ChannelBase>& channel) override
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		scheduled.push_back(channel);
+	}
+
+	size_t ProcessChannels()
+	{
+		size_t num = 0;
+		auto channels = std::move(scheduled);
+		scheduled.clear();
+		for (auto& channel : channels)
+			if (auto locked = channel.lock())
+				num += locked->Process(GetNow());
+		return num;
+	}
+
+	std::mutex mutex;
+	std::vector<std::weak_ptr<ChannelBase>> scheduled;
+};
+
+struct Message
+{
+	int producer;
+	int num;
+};
+
+}
+
+TEST(TestChannel, Batching)
+{
+	ManualTimeService timeService;
+	auto owner = std::make_shared<int>(0);
+	std::vector<int> received;
+	auto channel = std::make_shared<Channel<Message>>(timeService, owner, [&](auto now, Message& message) {
+		received.push_back(message.num);
+	}, 4);
+	ASSERT_EQ(4u, channel->GetCapacity());
+
+	//Only first one schedules it
+	ASSERT_TRUE(channel->IsEmpty());
+	ASSERT_TRUE(channel->Push({0, 1}));
+	ASSERT_FALSE(channel->IsEmpty());
+	ASSERT_TRUE(channel->Push({0, 2}));
+	ASSERT_TRUE(channel->Push({0, 3}));
+	ASSERT_EQ(1u, timeService.scheduled.size());
+
+	ASSERT_EQ(3u, timeService.ProcessChannels());
+	ASSERT_TRUE(channel->IsEmpty());
+	ASSERT_EQ((std::vector<int>{1, 2, 3}), received);
+	ASSERT_TRUE(timeService.scheduled.empty());
+
+	//Scheduled again after processed
+	ASSERT_TRUE(channel->Push({0, 4}));
+	ASSERT_EQ(1u, timeService.scheduled.size());
+
+	//Full
+	ASSERT_TRUE(channel->Push({0, 5}));
+	ASSERT_TRUE(channel->Push({0, 6}));
+	ASSERT_TRUE(channel->Push({0, 7}));
+	ASSERT_FALSE(channel->Push({0, 8}));
+	ASSERT_EQ(1u, timeService.scheduled.size());
+
+	ASSERT_EQ(4u, timeService.ProcessChannels());
+	ASSERT_EQ((std::vector<int>{1, 2, 3, 4, 5, 6, 7}), received);
+}
+
+TEST(TestChannel, Owner)
+{
+	ManualTimeService timeService;
+	auto owner = std::make_shared<int>(0);
+	auto packet = std::make_shared<int>(1);
+	int received = 0;
+	auto channel = std::make_shared<Channel<std::shared_ptr<int>>>(timeService, owner, [&](auto now, std::shared_ptr<int>& message) {
+		received++;
+	});
+
+	ASSERT_TRUE(channel->Push(std::shared_ptr<int>(packet)));
+	ASSERT_EQ(2, packet.use_count());
+
+	//Not delivered after owner is gone but released
+	owner.reset();
+	ASSERT_EQ(1u, timeService.ProcessChannels());
+	ASSERT_EQ(0, received);
+	ASSERT_EQ(1, packet.use_count());
+
+	//Pending messages are released on destruction
+	ASSERT_TRUE(channel->Push(std::shared_ptr<int>(packet)));
+	channel.reset();
+	ASSERT_EQ(1, packet.use_count());
+	ASSERT_EQ(0u, timeService.ProcessChannels());
+}
+
+TEST(TestChannel, MultipleProducers)
+{
+	ManualTimeService timeService;
+	auto owner = std::make_shared<int>(0);
+	std::vector<int> last(4, -1);
+	bool ordered = true;
+	size_t received = 0;
+	auto channel = std::make_shared<Channel<Message>>(timeService, owner, [&](auto now, Message& message) {
+		//Messages from same producer are in order
+		ordered = ordered && message.num == last[message.producer] + 1;
+		last[message.producer] = message.num;
+		received++;
+	}, 64);
+
+	std::vector<std::thread> producers;
+	for (int i = 0; i < 4; ++i)
+		producers.emplace_back([&, i]() {
+			for (int j = 0; j < 1000; )
+				//Retry while full
+				if (channel->Push({i, j}))
+					j++;
+		});
+
+	//Consume on this thread
+	while (received < 4000)
+	{
+		std::this_thread::yield();
+		channel->Process(timeService.GetNow());
+	}
+	for (auto& producer : producers)
+		producer.join();
+
+	ASSERT_EQ(4000u, received);
+	ASSERT_TRUE(ordered);
+}
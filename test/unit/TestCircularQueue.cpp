@@ -28,6 +28,38 @@ TEST(TestCircularQueue, Basic)
 	ASSERT_EQ(q.length(), 0);
 }
 
+TEST(TestCircularQueue, PopBack)
+{
+	CircularQueue<size_t> q(4, false);
+
+	ASSERT_FALSE(q.pop_back());
+
+	//Wrap around the end of the buffer
+	for (size_t i = 0; i < 6; ++i)
+		q.push_back(i);
+	ASSERT_EQ(q.length(), 4);
+	ASSERT_EQ(q.front(), 2);
+	ASSERT_EQ(q.back(), 5);
+
+	ASSERT_TRUE(q.pop_back());
+	ASSERT_EQ(q.length(), 3);
+	ASSERT_EQ(q.back(), 4);
+	ASSERT_TRUE(q.pop_back());
+	ASSERT_TRUE(q.pop_back());
+	ASSERT_EQ(q.back(), 2);
+	ASSERT_EQ(q.front(), 2);
+	ASSERT_TRUE(q.pop_back());
+	ASSERT_TRUE(q.empty());
+	ASSERT_FALSE(q.pop_back());
+
+	//Can be used again
+	q.push_back(7);
+	q.push_back(8);
+	ASSERT_EQ(q.length(), 2);
+	ASSERT_EQ(q.front(), 7);
+	ASSERT_EQ(q.back(), 8);
+}
+
 TEST(TestCircularQueue, PushPop)
 {
 	CircularQueue<size_t> q;
@@ -1,9 +1,96 @@
 #include "TestCommon.h"
 
+#include "crc32calc.h"
 #include "mpegts/mpegtscrc32.h"
 
+namespace
+{
+
+//Bit by bit reference implementations
+uint32_t ReflectedCrc(uint32_t poly, const uint8_t* data, size_t size)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc ^= data[i];
+		for (int k = 0; k < 8; ++k)
+			crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+	}
+	return ~crc;
+}
+
+uint32_t MPEG2Crc(const uint8_t* data, size_t size)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc ^= (uint32_t)data[i] << 24;
+		for (int k = 0; k < 8; ++k)
+			crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+	}
+	return crc;
+}
+
+std::vector<uint8_t> RandomData(size_t size)
+{
+	std::vector<uint8_t> data(size);
+	for (auto& byte : data)
+		byte = rand();
+	return data;
+}
+
+}
+
 TEST(TestCrc32, MPEGTSCrc)
 {
 	const uint8_t data[] = {0x01, 0x03, 0x05, 0x08, 0xe0, 0x60};
 	ASSERT_EQ(0x1BD4EF72, mpegts::Crc32(data, sizeof(data)));
 }
+
+TEST(TestCrc32, CheckValues)
+{
+	const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	ASSERT_EQ(0xCBF43926, CRC32Calc::IEEE(check, sizeof(check)));
+	ASSERT_EQ(0x0376E6E7, CRC32Calc::MPEG2(check, sizeof(check)));
+	ASSERT_EQ(0xE3069283, CRC32Calc::CRC32C(check, sizeof(check)));
+}
+
+TEST(TestCrc32, MatchesReference)
+{
+	auto data = RandomData(4096 + 8);
+
+	//Cover tails, folding thresholds and unaligned input
+	for (size_t offset = 0; offset < 4; ++offset)
+	{
+		for (size_t size = 0; size <= 4096; size += (size < 300 ? 1 : 61))
+		{
+			const uint8_t* buffer = data.data() + offset;
+			uint32_t ieee = ReflectedCrc(0xEDB88320, buffer, size);
+			uint32_t crc32c = ReflectedCrc(0x82F63B78, buffer, size);
+			uint32_t mpeg2 = MPEG2Crc(buffer, size);
+
+			ASSERT_EQ(ieee, CRC32Calc::IEEE(buffer, size)) << size;
+			ASSERT_EQ(ieee, CRC32Calc::IEEESliceBy8(buffer, size)) << size;
+			ASSERT_EQ(crc32c, CRC32Calc::CRC32C(buffer, size)) << size;
+			ASSERT_EQ(crc32c, CRC32Calc::CRC32CSliceBy8(buffer, size)) << size;
+			ASSERT_EQ(mpeg2, CRC32Calc::MPEG2(buffer, size)) << size;
+			ASSERT_EQ(mpeg2, CRC32Calc::MPEG2SliceBy8(buffer, size)) << size;
+		}
+	}
+}
+
+TEST(TestCrc32, Incremental)
+{
+	auto data = RandomData(1500);
+
+	for (size_t split : {0, 1, 7, 64, 100, 1499, 1500})
+	{
+		ASSERT_EQ(CRC32Calc::IEEE(data.data(), data.size()), CRC32Calc::IEEE(data.data() + split, data.size() - split, CRC32Calc::IEEE(data.data(), split)));
+		ASSERT_EQ(CRC32Calc::MPEG2(data.data(), data.size()), CRC32Calc::MPEG2(data.data() + split, data.size() - split, CRC32Calc::MPEG2(data.data(), split)));
+		ASSERT_EQ(CRC32Calc::CRC32C(data.data(), data.size()), CRC32Calc::CRC32C(data.data() + split, data.size() - split, CRC32Calc::CRC32C(data.data(), split)));
+
+		CRC32Calc calc;
+		calc.Update(data.data(), split);
+		ASSERT_EQ(CRC32Calc::IEEE(data.data(), data.size()), calc.Update(data.data() + split, data.size() - split));
+	}
+}
@@ -0,0 +1,108 @@
+#include "TestCommon.h"
+#include "log.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+class TestDeferredLogger : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		output = tmpfile();
+		ASSERT_TRUE(output);
+		DeferredLogger::GetInstance().SetOutput(output);
+		Logger::EnableDeferred(true);
+	}
+
+	void TearDown() override
+	{
+		Logger::EnableDeferred(false);
+		DeferredLogger::GetInstance().SetOutput(stdout);
+		DeferredLogger::GetInstance().SetRateLimit(0);
+		fclose(output);
+	}
+
+	std::vector<std::string> GetLines()
+	{
+		DeferredLogger::GetInstance().Flush();
+		std::vector<std::string> lines;
+		char line[4096];
+		rewind(output);
+		while (fgets(line, sizeof(line), output))
+			lines.push_back(line);
+		return lines;
+	}
+
+	FILE* output = nullptr;
+};
+
+}
+
+TEST_F(TestDeferredLogger, Format)
+{
+	ASSERT_TRUE(Logger::IsDeferredEnabled());
+
+	char name[16] = "first";
+	std::string other = "second";
+	Log("-log %d %u %s %s %.2f %c\n", -1, 2u, name, other.c_str(), 3.5, 'x');
+	//String must have been copied
+	strcpy(name, "changed");
+	Warning("-warning %lld\n", (long long)1 << 40);
+	Error("-error no args %%\n");
+	Log2("[prefix]", "-prefixed %s\n", (const char*)nullptr);
+
+	auto lines = GetLines();
+	ASSERT_EQ(4u, lines.size());
+	EXPECT_NE(std::string::npos, lines[0].find("][LOG]-log -1 2 first second 3.50 x\n"));
+	EXPECT_NE(std::string::npos, lines[1].find("][WRN]-warning 1099511627776\n"));
+	EXPECT_NE(std::string::npos, lines[2].find("][ERR]-error no args %\n"));
+	EXPECT_NE(std::string::npos, lines[3].find("][LOG][prefix]-prefixed \n"));
+}
+
+TEST_F(TestDeferredLogger, Threads)
+{
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i)
+		threads.emplace_back([i]() {
+			for (int j = 0; j < 1000; ++j)
+				Log("-thread %d message %d\n", i, j);
+		});
+	for (auto& thread : threads)
+		thread.join();
+
+	//Rings of ended threads are still written
+	auto lines = GetLines();
+	EXPECT_EQ(0u, DeferredLogger::GetInstance().GetDropped());
+	ASSERT_EQ(4000u, lines.size());
+}
+
+TEST_F(TestDeferredLogger, RateLimit)
+{
+	DeferredLogger::GetInstance().SetRateLimit(5);
+
+	//Wait for the start of a second so all are logged within the same one
+	QWORD now = getTime();
+	std::this_thread::sleep_for(std::chrono::microseconds(1000000 - now % 1000000));
+
+	for (int i = 0; i < 20; ++i)
+		Log("-limited %d\n", i);
+	Log("-other call site\n");
+
+	//Next second
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	for (int i = 20; i < 21; ++i)
+		Log("-limited %d\n", i);
+
+	auto lines = GetLines();
+	ASSERT_EQ(8u, lines.size());
+	for (int i = 0; i < 5; ++i)
+		EXPECT_NE(std::string::npos, lines[i].find("-limited " + std::to_string(i) + "\n"));
+	EXPECT_NE(std::string::npos, lines[5].find("-other call site\n"));
+	EXPECT_NE(std::string::npos, lines[6].find("-limited 20\n"));
+	EXPECT_NE(std::string::npos, lines[7].find("][LOG]15 similar messages suppressed\n"));
+}
@@ -48,19 +48,21 @@ TEST(TestDependendyDescriptor, SerializeParser)
 	Logger::EnableDebug(true);
 	Logger::EnableUltraDebug(true);
 
-	DependencyDescriptor dd;
-	dd.templateDependencyStructure = TemplateDependencyStructure{};
-	dd.templateDependencyStructure->dtsCount = 2;
-	dd.templateDependencyStructure->chainsCount = 2;
-	dd.templateDependencyStructure->frameDependencyTemplates.emplace_back(FrameDependencyTemplate{
+	TemplateDependencyStructure tds;
+	tds.dtsCount = 2;
+	tds.chainsCount = 2;
+	tds.frameDependencyTemplates.emplace_back(FrameDependencyTemplate{
 		{0, 0},
 		{DecodeTargetIndication::Switch, DecodeTargetIndication::Required},
 		{1},
 		{2,2}
 		});
-	dd.templateDependencyStructure->decodeTargetProtectedByChain = { 0,0 };
+	tds.decodeTargetProtectedByChain = { 0,0 };
+	tds.CalculateLayerMapping();
+
+	DependencyDescriptor dd;
+	dd.templateDependencyStructure = std::make_shared<const TemplateDependencyStructure>(tds);
 	dd.activeDecodeTargets = { 1,1 };
-	dd.templateDependencyStructure->CalculateLayerMapping();
 	dd.Dump();
 
 	ASSERT_TRUE(dd.Serialize(writter));
@@ -79,11 +81,18 @@ TEST(TestDependendyDescriptor, SerializeParser)
 
 	EXPECT_EQ(dd,parsed.value());
 
+	//Parsing it again with the same structure must reuse it
+	BufferReader bufferReader2(buffer,len);
+	BitReader reader2(bufferReader2);
+	auto reparsed = DependencyDescriptor::Parse(reader2, parsed->templateDependencyStructure);
+	ASSERT_TRUE(reparsed);
+	EXPECT_EQ(parsed->templateDependencyStructure.get(), reparsed->templateDependencyStructure.get());
+
 	writter.Reset();
 	DependencyDescriptor dd2;
-	dd2.customDecodeTargetIndications = std::vector<DecodeTargetIndication>{ DecodeTargetIndication::Switch, DecodeTargetIndication::Required };
-	dd2.customFrameDiffs = std::vector<uint32_t>{ 1 };
-	dd2.customFrameDiffsChains = std::vector<uint32_t>{ 2,2 };
+	dd2.customDecodeTargetIndications = { DecodeTargetIndication::Switch, DecodeTargetIndication::Required };
+	dd2.customFrameDiffs = { 1 };
+	dd2.customFrameDiffsChains = { 2,2 };
 
 	ASSERT_TRUE(dd2.Serialize(writter));
 
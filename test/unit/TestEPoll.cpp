@@ -0,0 +1,146 @@
+#include "TestCommon.h"
+#include "EPoll.h"
+#include "EventLoop.h"
+
+#include <sys/socket.h>
+#include <atomic>
+#include <future>
+
+using Events = std::pair<uint16_t, int>;
+
+class EPollTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		int pair[2];
+		ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, pair));
+		local = FileDescriptor(pair[0]);
+		remote = FileDescriptor(pair[1]);
+	}
+
+	std::vector<int> GetFds()
+	{
+		std::vector<int> fds;
+		poll.ForEachFd([&fds](int fd) { fds.push_back(fd); });
+		return fds;
+	}
+
+	EPoll poll;
+	FileDescriptor local;
+	FileDescriptor remote;
+};
+
+TEST_F(EPollTest, AddRemove)
+{
+	ASSERT_TRUE(poll.AddFd(local));
+	ASSERT_TRUE(poll.AddFd(local));
+	ASSERT_EQ(std::vector<int>{ local }, GetFds());
+
+	ASSERT_TRUE(poll.RemoveFd(local));
+	ASSERT_FALSE(poll.RemoveFd(local));
+	ASSERT_TRUE(GetFds().empty());
+
+	ASSERT_TRUE(poll.AddFd(local));
+	ASSERT_TRUE(poll.AddFd(remote));
+	ASSERT_EQ(2, GetFds().size());
+	poll.Clear();
+	ASSERT_TRUE(GetFds().empty());
+
+	ASSERT_FALSE(poll.SetEventMask(local, Poll::Event::In));
+}
+
+TEST_F(EPollTest, Events)
+{
+	ASSERT_TRUE(poll.AddFd(local));
+
+	//No events until mask is set
+	ASSERT_EQ(0, poll.Wait(0));
+	ASSERT_EQ(Events(0, 0), poll.GetEvents(local));
+
+	//Writable
+	ASSERT_TRUE(poll.SetEventMask(local, Poll::Event::In | Poll::Event::Out));
+	ASSERT_EQ(0, poll.Wait(0));
+	ASSERT_EQ(Events(Poll::Event::Out, 0), poll.GetEvents(local));
+
+	//Readable
+	ASSERT_TRUE(poll.SetEventMask(local, Poll::Event::In));
+	ASSERT_EQ(1, write(remote, "x", 1));
+	ASSERT_EQ(0, poll.Wait(1000));
+	ASSERT_EQ(Events(Poll::Event::In, 0), poll.GetEvents(local));
+
+	//Level triggered, still readable until read
+	ASSERT_EQ(0, poll.Wait(0));
+	ASSERT_EQ(Events(Poll::Event::In, 0), poll.GetEvents(local));
+
+	char data;
+	ASSERT_EQ(1, read(local, &data, 1));
+	ASSERT_EQ(0, poll.Wait(0));
+	ASSERT_EQ(Events(0, 0), poll.GetEvents(local));
+}
+
+TEST_F(EPollTest, Signal)
+{
+	ASSERT_TRUE(poll.AddFd(local));
+	ASSERT_TRUE(poll.SetEventMask(local, Poll::Event::In));
+
+	auto signaled = std::async(std::launch::async, [this]() {
+		std::this_thread::sleep_for(10ms);
+		poll.Signal();
+	});
+
+	//Signal exits the wait without events
+	auto ini = std::chrono::steady_clock::now();
+	ASSERT_EQ(0, poll.Wait(5000));
+	ASSERT_LT(std::chrono::steady_clock::now() - ini, 2s);
+	ASSERT_EQ(Events(0, 0), poll.GetEvents(local));
+	signaled.wait();
+
+	//Signal is cleared
+	ASSERT_EQ(0, poll.Wait(0));
+}
+
+class MaskEventLoop : public EventLoop
+{
+public:
+	using EventLoop::AddFd;
+	using EventLoop::UpdatePollEventMask;
+
+	std::atomic<int> calls = 0;
+	std::atomic<uint16_t> mask = Poll::Event::In;
+
+protected:
+	std::optional<uint16_t> GetPollEventMask(int fd) const override
+	{
+		const_cast<MaskEventLoop*>(this)->calls++;
+		return mask.load();
+	}
+};
+
+TEST(TestEventLoop, PollEventMaskOnlyOnChange)
+{
+	int pair[2];
+	ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, pair));
+	FileDescriptor local(pair[0]);
+	FileDescriptor remote(pair[1]);
+
+	MaskEventLoop loop;
+	ASSERT_TRUE(loop.AddFd(local));
+	ASSERT_TRUE(loop.Start());
+
+	//Run a lot of iterations
+	for (int i = 0; i < 100; ++i)
+		loop.FutureUnsafe([](auto) {}).get();
+
+	//Mask was only got once after adding the fd
+	ASSERT_EQ(1, loop.calls);
+
+	//Change it
+	loop.mask = Poll::Event::In | Poll::Event::Out;
+	loop.UpdatePollEventMask();
+	for (int i = 0; i < 100; ++i)
+		loop.FutureUnsafe([](auto) {}).get();
+	ASSERT_EQ(2, loop.calls);
+
+	loop.Stop();
+}
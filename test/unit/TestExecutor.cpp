@@ -0,0 +1,161 @@
+#include "TestCommon.h"
+#include "Executor.h"
+#include <atomic>
+#include <future>
+
+TEST(TestExecutor, StrandOrder)
+{
+	Executor executor(4);
+	auto strand = executor.CreateStrand();
+
+	std::vector<int> order;
+	std::promise<void> done;
+	for (int i = 0; i < 100; ++i)
+		strand->Post([&order, i]() { order.push_back(i); });
+	strand->Post([&done]() { done.set_value(); });
+
+	ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(std::chrono::seconds(5)));
+	ASSERT_EQ(100, order.size());
+	for (int i = 0; i < 100; ++i)
+		ASSERT_EQ(i, order[i]);
+}
+
+TEST(TestExecutor, StrandIsSerial)
+{
+	Executor executor(4);
+	std::vector<Executor::Strand::shared> strands;
+	std::atomic<int> overlapped = 0;
+	std::atomic<int> pending = 0;
+
+	for (int i = 0; i < 8; ++i)
+		strands.push_back(executor.CreateStrand(i % 2));
+
+	struct State { std::atomic<int> running = 0; };
+	std::vector<State> states(strands.size());
+
+	for (int n = 0; n < 1000; ++n)
+	{
+		for (size_t i = 0; i < strands.size(); ++i)
+		{
+			pending++;
+			strands[i]->Post(n, [&, i]() {
+				if (states[i].running++)
+					overlapped++;
+				std::this_thread::yield();
+				states[i].running--;
+				pending--;
+			});
+		}
+	}
+
+	for (int i = 0; i < 500 && pending; ++i)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	ASSERT_EQ(0, pending);
+	ASSERT_EQ(0, overlapped);
+}
+
+TEST(TestExecutor, DeadlineOrder)
+{
+	Executor executor(1);
+	auto strand = executor.CreateStrand(true);
+
+	std::vector<int> order;
+	std::promise<void> blocked;
+	std::promise<void> release;
+	auto releaseFuture = release.get_future();
+
+	//Block the strand while we post the rest
+	strand->Post(0, [&]() { blocked.set_value(); releaseFuture.wait(); });
+	blocked.get_future().wait();
+
+	std::promise<void> done;
+	strand->Post(300, [&]() { order.push_back(3); });
+	strand->Post(100, [&]() { order.push_back(1); });
+	strand->Post([&]() { order.push_back(4); done.set_value(); });
+	strand->Post(200, [&]() { order.push_back(2); });
+	release.set_value();
+
+	ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(std::chrono::seconds(5)));
+	ASSERT_EQ(std::vector<int>({ 1, 2, 3, 4 }), order);
+}
+
+TEST(TestExecutor, Close)
+{
+	Executor executor(2);
+	auto strand = executor.CreateStrand();
+
+	std::atomic<int> run = 0;
+	std::promise<void> started;
+
+	strand->Post([&]() {
+		started.set_value();
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		run++;
+	});
+	for (int i = 0; i < 10; ++i)
+		strand->Post([&]() { run++; });
+
+	started.get_future().wait();
+	//Must wait for the running task and drop the rest
+	strand->Close();
+	ASSERT_EQ(1, run);
+	ASSERT_FALSE(strand->Post([&]() { run++; }));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	ASSERT_EQ(1, run);
+}
+
+TEST(TestExecutor, IdlePriority)
+{
+	Executor executor(2);
+	ASSERT_TRUE(executor.SetIdlePriority());
+
+	//Tasks run on idle threads
+	std::promise<int> policy;
+	executor.CreateStrand()->Post([&]() {
+		int current;
+		sched_param param;
+		pthread_getschedparam(pthread_self(), &current, &param);
+		policy.set_value(current);
+	});
+	auto future = policy.get_future();
+	ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+	ASSERT_EQ(SCHED_IDLE, future.get());
+}
+
+TEST(TestExecutor, YieldedStrandIsNotStarved)
+{
+	Executor executor(1);
+	auto strand = executor.CreateStrand();
+
+	std::atomic<int> chained = 0;
+	std::atomic<int> chainedWhenDone = -1;
+	std::promise<void> done;
+
+	//Each one creates a new strand on the same worker, for a long time
+	std::function<void()> chain = [&]() {
+		if (++chained < 10000)
+			executor.CreateStrand()->Post([&]() { chain(); });
+	};
+
+	//Strand using more than its batch
+	for (size_t i = 0; i < Executor::MaxBatch * 2; ++i)
+		strand->Post([&, i]() {
+			//Start chain from the first batch
+			if (i == 0)
+				executor.CreateStrand()->Post([&]() { chain(); });
+		});
+	strand->Post([&]() {
+		chainedWhenDone = chained.load();
+		done.set_value();
+	});
+
+	ASSERT_EQ(std::future_status::ready, done.get_future().wait_for(std::chrono::seconds(5)));
+	//It runs again right after the strands that were waiting when it yielded
+	ASSERT_LT(chainedWhenDone, 10);
+
+	//Let the chain finish before the executor is destroyed
+	while (chained < 10000)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
@@ -0,0 +1,122 @@
+#include "TestCommon.h"
+#include "h264/h264depacketizer.h"
+
+#include <thread>
+
+class TestH264Depacketizer : public testing::Test
+{
+public:
+	RTPPacket::shared Packet(const std::vector<BYTE>& payload, bool mark, DWORD timestamp = 1000)
+	{
+		auto packet = std::make_shared<RTPPacket>(MediaFrame::Video, VideoCodec::H264);
+		packet->SetExtSeqNum(seqNum++);
+		packet->SetExtTimestamp(timestamp);
+		packet->SetMark(mark);
+		packet->SetPayload(payload.data(), payload.size());
+		return packet;
+	}
+
+	static std::vector<BYTE> Data(const MediaFrame* frame)
+	{
+		return std::vector<BYTE>(frame->GetData(), frame->GetData() + frame->GetLength());
+	}
+
+protected:
+	H264Depacketizer depacketizer;
+	DWORD seqNum = 0;
+};
+
+TEST_F(TestH264Depacketizer, SingleNal)
+{
+	auto packet = Packet({ 0x65, 0x01, 0x02, 0x03 }, true);
+	auto frame = depacketizer.AddPacket(packet);
+	ASSERT_TRUE(frame);
+	ASSERT_TRUE(((VideoFrame*)frame)->IsIntra());
+
+	//Payload is referenced, not copied
+	ASSERT_TRUE(frame->IsSegmented());
+	ASSERT_EQ(8, frame->GetLength());
+	auto segments = frame->GetSegments();
+	ASSERT_EQ(2, segments.size());
+	ASSERT_EQ(packet->GetMediaData(), segments[1].data);
+
+	//Modifying the packet must not change the frame
+	std::unique_ptr<MediaFrame> cloned(frame->Clone());
+	packet->AdquireMediaData()[1] = 0xFF;
+	ASSERT_NE(packet->GetMediaData(), segments[1].data);
+
+	std::vector<BYTE> expected = { 0x00, 0x00, 0x00, 0x04, 0x65, 0x01, 0x02, 0x03 };
+	ASSERT_EQ(expected, Data(cloned.get()));
+	ASSERT_EQ(expected, Data(frame));
+	ASSERT_FALSE(frame->IsSegmented());
+}
+
+TEST_F(TestH264Depacketizer, FragmentedNal)
+{
+	ASSERT_FALSE(depacketizer.AddPacket(Packet({ 0x7C, 0x85, 0x01, 0x02 }, false)));
+	ASSERT_FALSE(depacketizer.AddPacket(Packet({ 0x7C, 0x05, 0x03, 0x04, 0x05 }, false)));
+	auto frame = depacketizer.AddPacket(Packet({ 0x7C, 0x45, 0x06 }, true));
+	ASSERT_TRUE(frame);
+	ASSERT_TRUE(frame->IsSegmented());
+
+	//Rtp info must point to the fragments data
+	const auto& info = frame->GetRtpPacketizationInfo();
+	ASSERT_EQ(3, info.size());
+	BYTE fragment[3];
+	ASSERT_EQ(3, frame->CopyMedia(info[1].GetPos(), info[1].GetSize(), fragment));
+	ASSERT_EQ(0x03, fragment[0]);
+	ASSERT_EQ(0x05, fragment[2]);
+
+	std::vector<BYTE> expected = { 0x00, 0x00, 0x00, 0x07, 0x65, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+	ASSERT_EQ(expected, Data(frame));
+}
+
+TEST_F(TestH264Depacketizer, AggregatedNals)
+{
+	auto frame = depacketizer.AddPacket(Packet({ 0x78, 0x00, 0x02, 0x09, 0x10, 0x00, 0x03, 0x41, 0x01, 0x02 }, true));
+	ASSERT_TRUE(frame);
+
+	std::vector<BYTE> expected = { 0x00, 0x00, 0x00, 0x02, 0x09, 0x10, 0x00, 0x00, 0x00, 0x03, 0x41, 0x01, 0x02 };
+	ASSERT_EQ(expected.size(), frame->GetLength());
+
+	//Gather all segments
+	std::vector<BYTE> gathered;
+	for (const auto& segment : frame->GetSegments())
+		gathered.insert(gathered.end(), segment.data, segment.data + segment.size);
+	ASSERT_EQ(expected, gathered);
+
+	//Next frame resets references
+	frame = depacketizer.AddPacket(Packet({ 0x41, 0x07 }, true, 2000));
+	ASSERT_TRUE(frame);
+	ASSERT_EQ(6, frame->GetLength());
+}
+
+TEST_F(TestH264Depacketizer, ConcurrentCoalesce)
+{
+	auto frame = depacketizer.AddPacket(Packet({ 0x78, 0x00, 0x02, 0x09, 0x10, 0x00, 0x03, 0x41, 0x01, 0x02 }, true));
+	ASSERT_TRUE(frame);
+	ASSERT_TRUE(frame->IsSegmented());
+
+	std::vector<BYTE> expected = { 0x00, 0x00, 0x00, 0x02, 0x09, 0x10, 0x00, 0x00, 0x00, 0x03, 0x41, 0x01, 0x02 };
+
+	//Segments keep their data alive after the frame is coalesced
+	auto segments = frame->GetSegments();
+
+	//Listeners on different threads read the same const frame
+	const MediaFrame* shared = frame;
+	std::vector<std::vector<BYTE>> read(4);
+	std::vector<std::thread> threads;
+	for (auto& data : read)
+		threads.emplace_back([&data, shared]() { data = Data(shared); });
+	for (auto& thread : threads)
+		thread.join();
+
+	for (const auto& data : read)
+		ASSERT_EQ(expected, data);
+	ASSERT_FALSE(frame->IsSegmented());
+
+	std::vector<BYTE> gathered;
+	for (const auto& segment : segments)
+		gathered.insert(gathered.end(), segment.data, segment.data + segment.size);
+	ASSERT_EQ(expected, gathered);
+}
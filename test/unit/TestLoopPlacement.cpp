@@ -0,0 +1,65 @@
+#include "TestCommon.h"
+#include "LoopPlacement.h"
+
+TEST(TestLoopPlacement, Colocate)
+{
+	TestTimeService first, second;
+	LoopPlacement placement;
+	placement.AddLoop(&first);
+	placement.AddLoop(&second);
+
+	//Sinks are placed on the source loop until it is overloaded
+	ASSERT_EQ(&first, placement.Place(&first));
+	ASSERT_EQ(&first, placement.Place(&first));
+	ASSERT_EQ(&first, placement.Place(&first));
+	ASSERT_EQ(&first, placement.Place(&first));
+	ASSERT_EQ(&second, placement.Place(&first));
+	ASSERT_EQ(4u, placement.GetLoad(&first));
+	ASSERT_EQ(1u, placement.GetLoad(&second));
+
+	//Released ones make room again
+	placement.Release(&first, 2);
+	ASSERT_EQ(&first, placement.Place(&first));
+	ASSERT_EQ(3u, placement.GetLoad(&first));
+
+	//Sources on unknown loops get the least loaded one
+	TestTimeService other;
+	ASSERT_EQ(&second, placement.Place(&other));
+
+	//Removed loops are not used
+	placement.RemoveLoop(&second);
+	ASSERT_EQ(0u, placement.GetLoad(&second));
+	ASSERT_EQ(&first, placement.Place(&second));
+}
+
+TEST(TestLoopPlacement, Rebalance)
+{
+	TestTimeService first, second, third;
+	LoopPlacement placement;
+	placement.AddLoop(&first);
+	placement.AddLoop(&second);
+	placement.AddLoop(&third);
+
+	placement.Place(&first, 3);
+	placement.Place(&second, 2);
+	placement.Place(&third, 1);
+	ASSERT_EQ(3u, placement.GetLoad(&first));
+	ASSERT_EQ(2u, placement.GetLoad(&second));
+	ASSERT_EQ(1u, placement.GetLoad(&third));
+	ASSERT_FALSE(placement.GetRebalance());
+
+	//Check imbalance even with low loads
+	placement.SetMinLoad(0);
+	ASSERT_FALSE(placement.GetRebalance());
+
+	//Loads are not balanced anymore
+	placement.Release(&second, 2);
+	auto rebalance = placement.GetRebalance();
+	ASSERT_TRUE(rebalance);
+	ASSERT_EQ(&first, rebalance->first);
+	ASSERT_EQ(&second, rebalance->second);
+
+	//Allow more imbalance
+	placement.SetMaxImbalance(3);
+	ASSERT_FALSE(placement.GetRebalance());
+}
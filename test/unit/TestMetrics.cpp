@@ -0,0 +1,78 @@
+#include "TestCommon.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <vector>
+
+TEST(TestMetrics, Buckets)
+{
+	//Small values are exact
+	for (QWORD value = 0; value < Metrics::Histogram::SubBuckets; ++value)
+		EXPECT_EQ(value, Metrics::Histogram::GetBucketUpperBound(Metrics::Histogram::GetBucket(value)));
+
+	//Bigger ones are within the relative error
+	for (QWORD value = Metrics::Histogram::SubBuckets; value < 1000000; value = value * 5 / 4)
+	{
+		size_t bucket = Metrics::Histogram::GetBucket(value);
+		ASSERT_LT(bucket, Metrics::Histogram::Buckets);
+		QWORD upper = Metrics::Histogram::GetBucketUpperBound(bucket);
+		EXPECT_GE(upper, value);
+		EXPECT_LE(upper - value, value / Metrics::Histogram::SubBuckets) << value;
+		//Previous bucket is below
+		EXPECT_LT(Metrics::Histogram::GetBucketUpperBound(bucket - 1), value);
+	}
+
+	//Clamped
+	EXPECT_EQ(Metrics::Histogram::Buckets - 1, Metrics::Histogram::GetBucket(std::numeric_limits<QWORD>::max()));
+}
+
+TEST(TestMetrics, Counter)
+{
+	auto& counter = Metrics::GetInstance().GetCounter("test_counter_total", "Test counter");
+	//Same one is returned
+	ASSERT_EQ(&counter, &Metrics::GetInstance().GetCounter("test_counter_total"));
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 32; ++i)
+		threads.emplace_back([&]() {
+			for (int j = 0; j < 10000; ++j)
+				counter.Add();
+		});
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(320000u, counter.GetValue());
+}
+
+TEST(TestMetrics, Snapshot)
+{
+	auto& gauge = Metrics::GetInstance().GetGauge("test_gauge", "Test gauge");
+	auto& histogram = Metrics::GetInstance().GetHistogram("test_histogram", "Test histogram");
+
+	gauge.Add(5);
+	gauge.Sub(2);
+	for (QWORD value = 1; value <= 1000; ++value)
+		histogram.Record(value);
+
+	auto snapshot = Metrics::GetInstance().GetSnapshot();
+
+	auto gaugeIt = std::find_if(snapshot.gauges.begin(), snapshot.gauges.end(), [](const auto& value) { return value.name == "test_gauge"; });
+	ASSERT_NE(snapshot.gauges.end(), gaugeIt);
+	EXPECT_EQ(3, gaugeIt->value);
+
+	auto histogramIt = std::find_if(snapshot.histograms.begin(), snapshot.histograms.end(), [](const auto& value) { return value.name == "test_histogram"; });
+	ASSERT_NE(snapshot.histograms.end(), histogramIt);
+	EXPECT_EQ(1000u, histogramIt->count);
+	EXPECT_EQ(500500u, histogramIt->sum);
+	EXPECT_EQ(1000u, histogramIt->max);
+	EXPECT_NEAR(500, histogramIt->GetQuantile(0.5), 500 / Metrics::Histogram::SubBuckets);
+	EXPECT_NEAR(990, histogramIt->GetQuantile(0.99), 990 / Metrics::Histogram::SubBuckets);
+	EXPECT_EQ(1000u, histogramIt->GetQuantile(1));
+
+	auto prometheus = snapshot.ToPrometheus();
+	EXPECT_NE(std::string::npos, prometheus.find("# TYPE test_gauge gauge\ntest_gauge 3\n"));
+	EXPECT_NE(std::string::npos, prometheus.find("# HELP test_histogram Test histogram\n# TYPE test_histogram summary\n"));
+	EXPECT_NE(std::string::npos, prometheus.find("test_histogram_sum 500500\ntest_histogram_count 1000\n"));
+}
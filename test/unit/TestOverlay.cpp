@@ -0,0 +1,101 @@
+#include "TestCommon.h"
+#include "mixer/overlay.h"
+
+#include <vector>
+
+//Reference per pixel blending
+static std::vector<BYTE> Blend(const BYTE* overlay, const BYTE* frame, DWORD width, DWORD height)
+{
+	DWORD numPixels = width * height;
+	const BYTE* alpha = overlay + numPixels * 3 / 2;
+	std::vector<BYTE> image(numPixels * 3 / 2);
+	for (DWORD i = 0; i < numPixels; ++i)
+		image[i] = (overlay[i] * alpha[i] + frame[i] * (255 - alpha[i])) / 255;
+	for (DWORD y = 0; y < height / 2; ++y)
+	{
+		for (DWORD x = 0; x < width / 2; ++x)
+		{
+			const BYTE* a = alpha + y * 2 * width + x * 2;
+			DWORD avg = (a[0] + a[1] + a[width] + a[width + 1] + 2) >> 2;
+			for (DWORD plane = 0; plane < 2; ++plane)
+			{
+				DWORD pos = numPixels + plane * numPixels / 4 + y * width / 2 + x;
+				image[pos] = (overlay[pos] * avg + frame[pos] * (255 - avg)) / 255;
+			}
+		}
+	}
+	return image;
+}
+
+TEST(TestOverlay, Draw)
+{
+	DWORD width = 352;
+	DWORD height = 288;
+	DWORD numPixels = width * height;
+	Overlay overlay(width, height);
+	BYTE* canvas = overlay.GetCanvas();
+
+	//Fill overlay with a color and a half transparent band in the middle
+	memset(canvas, 200, numPixels * 3 / 2);
+	memset(canvas + numPixels * 3 / 2, 0, numPixels);
+	memset(canvas + numPixels * 3 / 2 + width * 100, 128, width * 32);
+	overlay.SetDirty(0, 100, width, 32);
+
+	std::vector<BYTE> frame(numPixels * 3 / 2, 50);
+	std::vector<BYTE> image(numPixels * 3 / 2);
+
+	//Nothing displayed yet
+	ASSERT_EQ(frame.data(), overlay.Display(frame.data()));
+
+	overlay.Draw(image.data(), frame.data());
+	EXPECT_EQ(50, image[0]);
+	EXPECT_EQ(50, image[width * 99 + 10]);
+	EXPECT_EQ((200 * 128 + 50 * 127) / 255, image[width * 100 + 10]);
+	EXPECT_EQ((200 * 128 + 50 * 127) / 255, image[width * 131 + width - 1]);
+	EXPECT_EQ(50, image[width * 132]);
+	EXPECT_EQ(50, image[numPixels]);
+	EXPECT_EQ((200 * 128 + 50 * 127) / 255, image[numPixels + width / 2 * 50 + 3]);
+
+	//Clean
+	overlay.Reset();
+	overlay.Draw(image.data(), frame.data());
+	EXPECT_EQ(frame, image);
+}
+
+TEST(TestOverlay, Tiles)
+{
+	//Size not multiple of the tile size
+	DWORD width = 200;
+	DWORD height = 120;
+	DWORD numPixels = width * height;
+	Canvas canvas(width, height);
+	BYTE* overlay = canvas.GetCanvas();
+
+	//Random overlay with transparent, opaque and partial areas
+	std::vector<BYTE> frame(numPixels * 3 / 2);
+	for (DWORD i = 0; i < numPixels * 3 / 2; ++i)
+	{
+		overlay[i] = (i * 7919) & 0xFF;
+		frame[i] = (i * 104729) & 0xFF;
+	}
+	BYTE* alpha = overlay + numPixels * 3 / 2;
+	for (DWORD y = 0; y < height; ++y)
+		for (DWORD x = 0; x < width; ++x)
+			alpha[y * width + x] = x < 48 ? 0 : x < 96 ? 255 : (x * y) & 0xFF;
+	canvas.SetDirty(0, 0, width, height);
+
+	std::vector<BYTE> image(numPixels * 3 / 2);
+	canvas.Draw(image.data(), frame.data());
+	EXPECT_EQ(Blend(overlay, frame.data(), width, height), image);
+
+	//Only the dirty area is analyzed again
+	memset(alpha + 40 * width, 255, width * 8);
+	canvas.SetDirty(0, 40, width, 8);
+	canvas.Draw(image.data(), frame.data());
+	EXPECT_EQ(Blend(overlay, frame.data(), width, height), image);
+
+	//Changes not marked as dirty keep previous tile classification, so transparent tiles are copied from the frame
+	memset(alpha, 255, width);
+	canvas.Draw(image.data(), frame.data());
+	EXPECT_EQ(frame[0], image[0]);
+}
@@ -0,0 +1,100 @@
+#include "TestCommon.h"
+#include "rtp/RTCPCompoundPacket.h"
+#include "rtp/RTCPReceiverReport.h"
+#include "rtp/RTCPPayloadFeedback.h"
+#include "rtp/RTCPBye.h"
+
+#include <array>
+
+class RecordingVisitor : public RTCPCompoundPacket::Visitor
+{
+public:
+	void onSenderReport(const RTCPSenderReport& sr) override		{ senderReports.push_back(sr.GetSSRC());		}
+	void onReport(const RTCPReport& report) override			{ reports.push_back(report.GetSSRC());			}
+	void onBye(DWORD ssrc) override						{ byes.push_back(ssrc);					}
+	void onNACK(DWORD ssrc, WORD pid, WORD blp) override			{ nacks.push_back({ssrc, pid, blp});			}
+	void onPLI(DWORD ssrc) override						{ plis.push_back(ssrc);					}
+	void onREMB(DWORD ssrc, DWORD bitrate) override				{ rembs.push_back({ssrc, bitrate});			}
+	void onTransportWideFeedback(const RTCPRTPFeedback::TransportWideFeedbackMessageField& field) override
+	{
+		twcc = field.packets;
+	}
+
+	std::vector<DWORD> senderReports;
+	std::vector<DWORD> reports;
+	std::vector<DWORD> byes;
+	std::vector<std::tuple<DWORD, WORD, WORD>> nacks;
+	std::vector<DWORD> plis;
+	std::vector<std::pair<DWORD, DWORD>> rembs;
+	RTCPRTPFeedback::TransportWideFeedbackMessageField::Packets twcc;
+};
+
+TEST(TestRTCPCompoundPacket, Visitor)
+{
+	auto rtcp = RTCPCompoundPacket::Create();
+
+	auto sr = rtcp->CreatePacket<RTCPSenderReport>();
+	sr->SetSSRC(1);
+	auto report = std::make_shared<RTCPReport>();
+	report->SetSSRC(10);
+	sr->AddReport(report);
+
+	auto rr = rtcp->CreatePacket<RTCPReceiverReport>(2);
+	auto report2 = std::make_shared<RTCPReport>();
+	report2->SetSSRC(20);
+	rr->AddReport(report2);
+
+	auto nack = rtcp->CreatePacket<RTCPRTPFeedback>(RTCPRTPFeedback::NACK, 1, 30);
+	nack->AddField(std::make_shared<RTCPRTPFeedback::NACKField>(100, 0x0003));
+	nack->AddField(std::make_shared<RTCPRTPFeedback::NACKField>(200, 0x0000));
+
+	auto twcc = rtcp->CreatePacket<RTCPRTPFeedback>(RTCPRTPFeedback::TransportWideFeedbackMessage, 1, 30);
+	auto field = twcc->CreateField<RTCPRTPFeedback::TransportWideFeedbackMessageField>(1u);
+	field->referenceTime = 64000;
+	field->packets.insert({1000, 64000});
+	field->packets.insert({1001, 0});
+	field->packets.insert({1002, 65000});
+
+	rtcp->CreatePacket<RTCPPayloadFeedback>(RTCPPayloadFeedback::PictureLossIndication, 1, 40);
+
+	auto remb = rtcp->CreatePacket<RTCPPayloadFeedback>(RTCPPayloadFeedback::ApplicationLayerFeeedbackMessage, 1, WORD(0));
+	remb->AddField(RTCPPayloadFeedback::ApplicationLayerFeeedbackField::CreateReceiverEstimatedMaxBitrate({50, 51}, 300000));
+
+	rtcp->CreatePacket<RTCPBye>(std::vector<DWORD>{60}, "bye");
+
+	std::array<BYTE, MTU> buffer = {};
+	DWORD len = rtcp->Serialize(buffer.data(), buffer.size());
+	ASSERT_GT(len, 0u);
+
+	RecordingVisitor visitor;
+	ASSERT_TRUE(RTCPCompoundPacket::Parse(buffer.data(), len, visitor));
+
+	EXPECT_EQ(visitor.senderReports, std::vector<DWORD>({1}));
+	EXPECT_EQ(visitor.reports, std::vector<DWORD>({10, 20}));
+	ASSERT_EQ(visitor.nacks.size(), 2u);
+	EXPECT_EQ(visitor.nacks[0], std::make_tuple(DWORD(30), WORD(100), WORD(0x0003)));
+	EXPECT_EQ(visitor.nacks[1], std::make_tuple(DWORD(30), WORD(200), WORD(0x0000)));
+	EXPECT_EQ(visitor.twcc.size(), 3u);
+	EXPECT_EQ(visitor.twcc[1001], 0u);
+	EXPECT_EQ(visitor.plis, std::vector<DWORD>({40}));
+	ASSERT_EQ(visitor.rembs.size(), 2u);
+	EXPECT_EQ(visitor.rembs[0].first, 50u);
+	EXPECT_EQ(visitor.rembs[1].first, 51u);
+	EXPECT_EQ(visitor.rembs[0].second, 300000u);
+	EXPECT_EQ(visitor.byes, std::vector<DWORD>({60}));
+}
+
+TEST(TestRTCPCompoundPacket, VisitorWrongSize)
+{
+	auto rtcp = RTCPCompoundPacket::Create();
+	rtcp->CreatePacket<RTCPPayloadFeedback>(RTCPPayloadFeedback::PictureLossIndication, 1, 40);
+
+	std::array<BYTE, MTU> buffer = {};
+	DWORD len = rtcp->Serialize(buffer.data(), buffer.size());
+	ASSERT_GT(len, 0u);
+
+	RecordingVisitor visitor;
+	//Truncated packet
+	EXPECT_FALSE(RTCPCompoundPacket::Parse(buffer.data(), len - 4, visitor));
+	EXPECT_TRUE(visitor.plis.empty());
+}
@@ -0,0 +1,75 @@
+#include "TestCommon.h"
+#include "rtp/RTPHeaderExtension.h"
+
+#include <array>
+
+TEST(TestRTPHeaderExtension, LazySDES)
+{
+	RTPMap extMap;
+	extMap.SetCodecForType(1, RTPHeaderExtension::MediaStreamId);
+	extMap.SetCodecForType(2, RTPHeaderExtension::RTPStreamId);
+	extMap.SetCodecForType(3, RTPHeaderExtension::TransportWideCC);
+
+	RTPHeaderExtension extension;
+	extension.SetMediaStreamId("audio");
+	extension.SetRId("high");
+	extension.hasTransportWideCC = true;
+	extension.transportSeqNum = 1234;
+
+	std::array<BYTE, MTU> buffer = {};
+	DWORD len = extension.Serialize(extMap, buffer.data(), buffer.size());
+	ASSERT_GT(len, 0);
+
+	RTPHeaderExtension parsed;
+	ASSERT_EQ(len, parsed.Parse(extMap, buffer.data(), len));
+	EXPECT_TRUE(parsed.hasMediaStreamId);
+	EXPECT_TRUE(parsed.hasRId);
+	EXPECT_FALSE(parsed.hasRepairedId);
+	EXPECT_EQ("audio", parsed.GetMediaStreamId());
+	EXPECT_EQ("high", parsed.GetRId());
+	EXPECT_EQ("", parsed.GetRepairedId());
+	EXPECT_EQ(1234, parsed.transportSeqNum);
+
+	//Override with a longer one
+	parsed.SetRId("a-very-long-rid-name");
+	EXPECT_EQ("a-very-long-rid-name", parsed.GetRId());
+
+	std::array<BYTE, MTU> buffer2 = {};
+	len = parsed.Serialize(extMap, buffer2.data(), buffer2.size());
+	ASSERT_GT(len, 0);
+
+	RTPHeaderExtension reparsed;
+	ASSERT_EQ(len, reparsed.Parse(extMap, buffer2.data(), len));
+	EXPECT_EQ("audio", reparsed.GetMediaStreamId());
+	EXPECT_EQ("a-very-long-rid-name", reparsed.GetRId());
+}
+
+TEST(TestRTPHeaderExtension, ColorSpacePassthrough)
+{
+	RTPMap extMap;
+	extMap.SetCodecForType(4, RTPHeaderExtension::ColorSpace);
+
+	//One byte header with color space without hdr metadata
+	BYTE data[] = { 0xBE, 0xDE, 0x00, 0x02, 0x43, 0x01, 0x02, 0x03, 0x26, 0x00, 0x00, 0x00 };
+
+	RTPHeaderExtension parsed;
+	ASSERT_EQ(sizeof(data), parsed.Parse(extMap, data, sizeof(data)));
+	ASSERT_TRUE(parsed.hasColorSpace);
+
+	//Serialize it without decoding
+	std::array<BYTE, MTU> buffer = {};
+	DWORD len = parsed.Serialize(extMap, buffer.data(), buffer.size());
+	ASSERT_EQ(sizeof(data), len);
+	EXPECT_EQ(0, memcmp(data, buffer.data(), len));
+
+	//Decode it now
+	auto& colorSpace = parsed.GetColorSpace();
+	ASSERT_TRUE(colorSpace);
+	EXPECT_EQ(1, colorSpace->primaries);
+	EXPECT_EQ(2, colorSpace->transfer);
+	EXPECT_EQ(3, colorSpace->matrix);
+	EXPECT_EQ(2, colorSpace->range);
+	EXPECT_EQ(1, colorSpace->chromeSitingHorizontal);
+	EXPECT_EQ(2, colorSpace->chromeSitingVertical);
+	EXPECT_FALSE(colorSpace->hdrMetadata);
+}
@@ -0,0 +1,129 @@
+#include "TestCommon.h"
+#include "rtp/RTPHeaderTemplate.h"
+#include "rtp/RTPPacket.h"
+#include "codecs.h"
+
+#include <array>
+
+namespace
+{
+
+RTPMap GetExtMap()
+{
+	RTPMap extMap;
+	extMap.SetCodecForType(1, RTPHeaderExtension::MediaStreamId);
+	extMap.SetCodecForType(2, RTPHeaderExtension::RTPStreamId);
+	extMap.SetCodecForType(3, RTPHeaderExtension::TransportWideCC);
+	extMap.SetCodecForType(4, RTPHeaderExtension::AbsoluteSendTime);
+	extMap.SetCodecForType(5, RTPHeaderExtension::SSRCAudioLevel);
+	extMap.SetCodecForType(6, RTPHeaderExtension::PlayoutDelay);
+	return extMap;
+}
+
+RTPPacket::shared CreatePacket(MediaFrame::Type type)
+{
+	auto packet = std::make_shared<RTPPacket>(type, 0);
+	packet->SetSSRC(1234);
+	packet->SetPayloadType(96);
+	packet->SetSeqNum(65000);
+	packet->SetTimestamp(0x12345678);
+	packet->SetMark(true);
+	packet->SetAbsSentTime(1500);
+	BYTE payload[] = { 1, 2, 3, 4, 5 };
+	packet->SetPayload(payload, sizeof(payload));
+	return packet;
+}
+
+}
+
+TEST(TestRTPHeaderTemplate, Video)
+{
+	RTPMap rtpMap;
+	rtpMap.SetCodecForType(96, VideoCodec::VP8);
+	RTPMap extMap = GetExtMap();
+
+	RTPHeaderTemplate headerTemplate;
+	headerTemplate.Init(MediaFrame::Video, 1234, "video", "high", std::make_optional<struct RTPHeaderExtension::PlayoutDelay>(0, 100), extMap);
+	ASSERT_TRUE(headerTemplate.IsInitialized());
+
+	auto packet = CreatePacket(MediaFrame::Video);
+	packet->SetTransportSeqNum(42);
+	packet->SetPlayoutDelay(0, 100);
+	ASSERT_TRUE(headerTemplate.CanSerialize(*packet));
+
+	std::array<BYTE, MTU> buffer = {};
+	DWORD len = headerTemplate.Serialize(buffer.data(), buffer.size(), *packet);
+	ASSERT_GT(len, 0u);
+
+	auto parsed = RTPPacket::Parse(buffer.data(), len, rtpMap, extMap);
+	ASSERT_TRUE(parsed);
+	EXPECT_EQ(1234u, parsed->GetSSRC());
+	EXPECT_EQ(96u, parsed->GetPayloadType());
+	EXPECT_EQ(65000, parsed->GetSeqNum());
+	EXPECT_EQ(0x12345678u, parsed->GetTimestamp());
+	EXPECT_TRUE(parsed->GetMark());
+	EXPECT_EQ(42, parsed->GetTransportSeqNum());
+	EXPECT_TRUE(parsed->HasAbsSentTime());
+	EXPECT_EQ("video", parsed->GetMediaStreamId());
+	EXPECT_EQ("high", parsed->GetRId());
+	EXPECT_FALSE(parsed->HasAudioLevel());
+	EXPECT_TRUE(parsed->HasPlayoutDelay());
+	EXPECT_EQ(100, parsed->GetPlayoutDelay().max);
+	ASSERT_EQ(5u, parsed->GetMediaLength());
+	EXPECT_EQ(0, memcmp(packet->GetMediaData(), parsed->GetMediaData(), 5));
+
+	//Same result as full serialization
+	packet->SetMediaStreamId("video");
+	packet->SetRId("high");
+	std::array<BYTE, MTU> full = {};
+	DWORD fullLen = packet->Serialize(full.data(), full.size(), extMap);
+	EXPECT_EQ(fullLen, len);
+	auto reparsed = RTPPacket::Parse(full.data(), fullLen, rtpMap, extMap);
+	ASSERT_TRUE(reparsed);
+	EXPECT_EQ(reparsed->GetAbsSendTime(), parsed->GetAbsSendTime());
+
+	//Not templated extensions need full serialization
+	packet->SetTimeOffset(10);
+	EXPECT_FALSE(headerTemplate.CanSerialize(*packet));
+	EXPECT_EQ(0u, headerTemplate.Serialize(buffer.data(), buffer.size(), *packet));
+}
+
+TEST(TestRTPHeaderTemplate, Audio)
+{
+	RTPMap rtpMap;
+	rtpMap.SetCodecForType(96, AudioCodec::OPUS);
+	RTPMap extMap = GetExtMap();
+
+	RTPHeaderTemplate headerTemplate;
+	headerTemplate.Init(MediaFrame::Audio, 1234, "a-very-long-media-id", "", std::nullopt, extMap);
+
+	auto packet = CreatePacket(MediaFrame::Audio);
+	//Audio level needed
+	ASSERT_FALSE(headerTemplate.CanSerialize(*packet));
+	RTPHeaderExtension extension = packet->GetRTPHeaderExtension();
+	extension.hasAudioLevel = true;
+	extension.vad = true;
+	extension.level = 30;
+	auto withLevel = std::make_shared<RTPPacket>(MediaFrame::Audio, 0, packet->GetRTPHeader(), extension);
+	BYTE payload[] = { 1, 2, 3 };
+	withLevel->SetPayload(payload, sizeof(payload));
+	ASSERT_TRUE(headerTemplate.CanSerialize(*withLevel));
+
+	std::array<BYTE, MTU> buffer = {};
+	DWORD len = headerTemplate.Serialize(buffer.data(), buffer.size(), *withLevel);
+	ASSERT_GT(len, 0u);
+	//Two byte header extensions
+	EXPECT_EQ(0x1000, get2(buffer.data(), 12));
+
+	auto parsed = RTPPacket::Parse(buffer.data(), len, rtpMap, extMap);
+	ASSERT_TRUE(parsed);
+	EXPECT_EQ("a-very-long-media-id", parsed->GetMediaStreamId());
+	EXPECT_FALSE(parsed->HasRId());
+	EXPECT_FALSE(parsed->HasTransportWideCC());
+	EXPECT_TRUE(parsed->GetVAD());
+	EXPECT_EQ(30, parsed->GetLevel());
+
+	//Reset
+	headerTemplate.Reset();
+	EXPECT_FALSE(headerTemplate.CanSerialize(*withLevel));
+}
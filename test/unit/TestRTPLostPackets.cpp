@@ -0,0 +1,135 @@
+#include "TestCommon.h"
+#include "codecs.h"
+#include "rtp/RTPLostPackets.h"
+
+namespace
+{
+
+RTPPacket::shared CreatePacket(DWORD extSeq)
+{
+	auto packet = std::make_shared<RTPPacket>(MediaFrame::Video, VideoCodec::VP8);
+	packet->SetExtSeqNum(extSeq);
+	return packet;
+}
+
+std::vector<std::pair<WORD,WORD>> ParseNacks(const BYTE* data, DWORD len)
+{
+	std::vector<std::pair<WORD,WORD>> nacks;
+	for (DWORD i = 0; i + 4 <= len; i += 4)
+		nacks.emplace_back(get2(data, i), get2(data, i + 2));
+	return nacks;
+}
+
+}
+
+TEST(TestRTPLostPackets, CountLost)
+{
+	RTPLostPackets losts(1024);
+
+	ASSERT_EQ(0, losts.AddPacket(CreatePacket(100)));
+	ASSERT_EQ(0, losts.AddPacket(CreatePacket(101)));
+	ASSERT_EQ(3, losts.AddPacket(CreatePacket(105)));
+	ASSERT_EQ(3, losts.GetTotal());
+
+	//Old one
+	ASSERT_EQ(0, losts.AddPacket(CreatePacket(50)));
+	//Recover one
+	ASSERT_EQ(0, losts.AddPacket(CreatePacket(103)));
+	ASSERT_EQ(2, losts.GetTotal());
+	//Duplicated
+	ASSERT_EQ(0, losts.AddPacket(CreatePacket(103)));
+	ASSERT_EQ(2, losts.GetTotal());
+
+	auto nacks = losts.GetNacks();
+	ASSERT_EQ(1, nacks.size());
+	auto nack = std::static_pointer_cast<RTCPRTPFeedback::NACKField>(nacks.front());
+	ASSERT_EQ(102, nack->pid);
+	ASSERT_EQ(0x0002, nack->blp);
+}
+
+TEST(TestRTPLostPackets, SlideWindow)
+{
+	RTPLostPackets losts(64);
+
+	ASSERT_EQ(0, losts.AddPacket(CreatePacket(0xFFF0)));
+	ASSERT_EQ(1, losts.AddPacket(CreatePacket(0xFFF2)));
+	ASSERT_EQ(1, losts.GetTotal());
+
+	//Move window so the lost one goes out of it
+	ASSERT_EQ(63, losts.AddPacket(CreatePacket(0xFFF2 + 64 + 10)));
+	//Only the ones inside the window are accounted
+	ASSERT_EQ(63, losts.GetTotal());
+}
+
+TEST(TestRTPLostPackets, WriteNacks)
+{
+	RTPLostPackets losts(1024);
+	BYTE data[RTPPAYLOADSIZE];
+
+	losts.AddPacket(CreatePacket(1000));
+	losts.AddPacket(CreatePacket(1002));
+	losts.AddPacket(CreatePacket(1020));
+
+	DWORD len = losts.WriteNacks(data, sizeof(data), 0, 100);
+	auto nacks = ParseNacks(data, len);
+	ASSERT_EQ(2, nacks.size());
+	//1001, 1003-1017
+	ASSERT_EQ(1001, nacks[0].first);
+	ASSERT_EQ(0xFFFE, nacks[0].second);
+	//1018-1019
+	ASSERT_EQ(1018, nacks[1].first);
+	ASSERT_EQ(0x0001, nacks[1].second);
+
+	//Not requested again before rtt
+	ASSERT_EQ(0, losts.WriteNacks(data, sizeof(data), 50, 100));
+
+	//New loss is requested alone
+	losts.AddPacket(CreatePacket(1022));
+	len = losts.WriteNacks(data, sizeof(data), 60, 100);
+	nacks = ParseNacks(data, len);
+	ASSERT_EQ(1, nacks.size());
+	ASSERT_EQ(1021, nacks[0].first);
+	ASSERT_EQ(0, nacks[0].second);
+
+	//Retransmission recovered
+	losts.AddPacket(CreatePacket(1001));
+	ASSERT_EQ(1, losts.GetRecovered());
+
+	//After rtt the rest are requested again, but not the last one
+	len = losts.WriteNacks(data, sizeof(data), 100, 100);
+	nacks = ParseNacks(data, len);
+	ASSERT_EQ(1, nacks.size());
+	ASSERT_EQ(1003, nacks[0].first);
+	ASSERT_EQ(0xFFFF, nacks[0].second);
+}
+
+TEST(TestRTPLostPackets, MaxAttempts)
+{
+	RTPLostPackets losts(1024);
+	BYTE data[RTPPAYLOADSIZE];
+
+	losts.AddPacket(CreatePacket(0));
+	losts.AddPacket(CreatePacket(2));
+
+	for (DWORD i = 0; i < RTPLostPackets::MaxRetransmissionAttempts; ++i)
+		ASSERT_EQ(4, losts.WriteNacks(data, sizeof(data), i * 1000, 100));
+	ASSERT_EQ(0, losts.WriteNacks(data, sizeof(data), 1000000, 100));
+}
+
+TEST(TestRTPLostPackets, BufferFull)
+{
+	RTPLostPackets losts(1024);
+	BYTE data[8];
+
+	//Lose every other packet
+	for (DWORD i = 0; i <= 200; i += 2)
+		losts.AddPacket(CreatePacket(i));
+
+	//Only two fields fit, 1-17 and 19-35
+	ASSERT_EQ(8, losts.WriteNacks(data, sizeof(data), 0, 100));
+	ASSERT_EQ(1, get2(data, 0));
+	ASSERT_EQ(19, get2(data, 4));
+	//Pending ones are requested on next call
+	ASSERT_EQ(8, losts.WriteNacks(data, sizeof(data), 0, 100));
+	ASSERT_EQ(37, get2(data, 0));
+}
@@ -12,6 +12,17 @@ public:
 		return 0;
 	};
 
+	virtual int Enqueue(const std::vector<RTPPacket::shared>& packets)
+	{
+		batches++;
+		return RTPSender::Enqueue(packets);
+	};
+
+	inline size_t GetBatches() const
+	{
+		return batches;
+	}
+
 
 	inline const RTPPacket::shared& GetLastPacket()
 	{
@@ -20,6 +31,7 @@ public:
 
 private:
 	RTPPacket::shared lastPacket;
+	size_t batches = 0;
 };
 
 class MockRTPIncomingMediaStream : public RTPIncomingMediaStream
@@ -138,6 +150,23 @@ TEST_P(TestRTPStreamTransponder, Dropping)
 	ASSERT_NO_FATAL_FAILURE(Add(MarkerPacket(3000, 0), GetExpectedPicId(3), GetExpectedTl0PicId(3)));
 }
 
+TEST_P(TestRTPStreamTransponder, Batch)
+{
+	//Whole frame delivered at once
+	std::vector<RTPPacket::shared> packets = { StartPacket(1000, 0), MiddlePacket(1000, 0), MiddlePacket(1000, 0), MarkerPacket(1000, 0) };
+	transponder->onRTP(stream.get(), packets);
+
+	//Sent in a single batch
+	ASSERT_EQ(1, sender->GetBatches());
+	ASSERT_TRUE(sender->GetLastPacket());
+	ASSERT_TRUE(sender->GetLastPacket()->GetMark());
+	ASSERT_EQ(GetExpectedPicId(1), sender->GetLastPacket()->vp8PayloadDescriptor->pictureId);
+
+	//Next packets are sent in their own batch
+	ASSERT_NO_FATAL_FAILURE(Add(StartPacket(2000, 0), GetExpectedPicId(2), GetExpectedTl0PicId(2)));
+	ASSERT_EQ(2, sender->GetBatches());
+}
+
 INSTANTIATE_TEST_SUITE_P(TestVP8LayerSelectorCases,
 	TestRTPStreamTransponder,
 	testing::Values(std::pair(0, 0),
@@ -0,0 +1,120 @@
+#include "TestCommon.h"
+#include "ScalabilityMode.h"
+#include "bitstream/BitReader.h"
+#include "bitstream/BitWriter.h"
+
+#include <map>
+
+TEST(TestScalabilityMode, Parse)
+{
+	auto mode = ScalabilityMode::Parse("L3T3");
+	ASSERT_TRUE(mode);
+	EXPECT_EQ(3, mode->GetSpatialLayers());
+	EXPECT_EQ(3, mode->GetTemporalLayers());
+	EXPECT_EQ("L3T3", mode->ToString());
+	EXPECT_TRUE(mode->IsLayered());
+
+	EXPECT_FALSE(ScalabilityMode::Parse("L1T1")->IsLayered());
+	EXPECT_FALSE(ScalabilityMode::Parse("L4T1"));
+	EXPECT_FALSE(ScalabilityMode::Parse("L1T0"));
+	EXPECT_FALSE(ScalabilityMode::Parse("S2T1"));
+	EXPECT_FALSE(ScalabilityMode::Parse("L1T3h"));
+}
+
+TEST(TestScalabilityMode, TemporalPattern)
+{
+	ScalabilityMode l1t3(1, 3);
+	EXPECT_EQ(4, l1t3.GetPeriodicity());
+	EXPECT_EQ(0, l1t3.GetTemporalLayerId(0));
+	EXPECT_EQ(2, l1t3.GetTemporalLayerId(1));
+	EXPECT_EQ(1, l1t3.GetTemporalLayerId(2));
+	EXPECT_EQ(2, l1t3.GetTemporalLayerId(3));
+	EXPECT_EQ(0, l1t3.GetTemporalLayerId(4));
+	EXPECT_EQ(4, l1t3.GetRateDecimator(0));
+	EXPECT_EQ(2, l1t3.GetRateDecimator(1));
+	EXPECT_EQ(1, l1t3.GetRateDecimator(2));
+	EXPECT_DOUBLE_EQ(1.0, l1t3.GetTemporalBitrateRatio(2));
+
+	//Layer sync frames only reference the base layer
+	EXPECT_TRUE(l1t3.GetLayerFrameConfig(false, 1, 0).layerSync);
+	EXPECT_TRUE(l1t3.GetLayerFrameConfig(false, 2, 0).layerSync);
+	EXPECT_FALSE(l1t3.GetLayerFrameConfig(false, 3, 0).layerSync);
+	EXPECT_FALSE(l1t3.GetLayerFrameConfig(false, 4, 0).layerSync);
+
+	ScalabilityMode l3t1(3, 1);
+	EXPECT_DOUBLE_EQ(1.0, l3t1.GetSpatialBitrateRatio(0) + l3t1.GetSpatialBitrateRatio(1) + l3t1.GetSpatialBitrateRatio(2));
+	EXPECT_EQ(2, l3t1.GetSpatialScaleShift(0));
+}
+
+TEST(TestScalabilityMode, TemplateDependencyStructure)
+{
+	for (const auto& name : { "L1T2", "L1T3", "L2T1", "L2T2", "L2T3", "L3T3" })
+	{
+		auto mode = ScalabilityMode::Parse(name).value();
+		auto structure = std::make_shared<const TemplateDependencyStructure>(mode.GetTemplateDependencyStructure(1280, 720));
+
+		//Serialize and parse it back
+		BYTE buffer[256];
+		BitWriter writter(buffer, sizeof(buffer));
+		DependencyDescriptor dd;
+		dd.templateDependencyStructure = structure;
+		ASSERT_TRUE(dd.Serialize(writter)) << name;
+		auto len = writter.Flush();
+		BufferReader bufferReader(buffer, len);
+		BitReader reader(bufferReader);
+		auto parsed = DependencyDescriptor::Parse(reader);
+		ASSERT_TRUE(parsed) << name;
+		ASSERT_TRUE(parsed->templateDependencyStructure) << name;
+		EXPECT_EQ(*structure, *parsed->templateDependencyStructure) << name;
+
+		//Top decode target is the full resolution
+		ASSERT_EQ(mode.GetSpatialLayers() * mode.GetTemporalLayers(), structure->decodeTargetLayerMapping.size());
+		EXPECT_EQ(mode.GetSpatialLayers() - 1, structure->decodeTargetLayerMapping.front().second.spatialLayerId);
+		EXPECT_EQ(mode.GetTemporalLayers() - 1, structure->decodeTargetLayerMapping.front().second.temporalLayerId);
+		EXPECT_EQ(1280u, structure->resolutions.back().width);
+
+		//Simulate encoding and check templates match the references of each frame
+		std::map<BYTE,uint16_t> buffers;
+		std::map<BYTE,uint16_t> chains;
+		uint16_t frameNumber = 0;
+		for (DWORD index = 0; index < 20; ++index)
+		{
+			//Key frame every 10 superframes
+			bool keyFrame = index % 10 == 0;
+			if (keyFrame)
+				chains.clear();
+			for (BYTE spatialLayerId = 0; spatialLayerId < mode.GetSpatialLayers(); ++spatialLayerId, ++frameNumber)
+			{
+				auto config = mode.GetLayerFrameConfig(keyFrame, index % 10, spatialLayerId);
+				ASSERT_LT(config.templateId, structure->frameDependencyTemplates.size());
+				const auto& frameDependencyTemplate = structure->GetFrameDependencyTemplate(config.templateId);
+				EXPECT_EQ(config.spatialLayerId, frameDependencyTemplate.spatialLayerId) << name << " " << index;
+				EXPECT_EQ(config.temporalLayerId, frameDependencyTemplate.temporalLayerId) << name << " " << index;
+
+				FrameDependencyTemplate::FrameDiffs frameDiffs;
+				if (config.temporalReference)
+					frameDiffs.push_back(frameNumber - buffers.at(*config.temporalReference));
+				if (config.interLayerReference)
+					frameDiffs.push_back(frameNumber - buffers.at(*config.interLayerReference));
+				EXPECT_EQ(frameDiffs, frameDependencyTemplate.frameDiffs) << name << " " << index;
+
+				for (BYTE chain = 0; chain < mode.GetSpatialLayers(); ++chain)
+				{
+					auto it = chains.find(chain);
+					EXPECT_EQ(it != chains.end() ? frameNumber - it->second : 0, frameDependencyTemplate.frameDiffsChains[chain]) << name << " " << index;
+				}
+
+				//Key frames refresh all buffers
+				if (keyFrame && !spatialLayerId)
+					for (BYTE i = 0; i < ScalabilityMode::NumBuffers; ++i)
+						buffers[i] = frameNumber;
+				if (config.update)
+					buffers[*config.update] = frameNumber;
+				//Base temporal layer frames are part of the chains of its spatial layer and the upper ones
+				if (!config.temporalLayerId)
+					for (BYTE chain = spatialLayerId; chain < mode.GetSpatialLayers(); ++chain)
+						chains[chain] = frameNumber;
+			}
+		}
+	}
+}
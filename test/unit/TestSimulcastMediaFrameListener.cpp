@@ -766,4 +766,58 @@ TEST_F(TestSimulcastMediaFrameListener, ActualDataInput)
 	}
 
 	ASSERT_NO_FATAL_FAILURE(CheckResetForwardedFrames(1920));
-}
\ No newline at end of file
+}
+
+TEST_F(TestSimulcastMediaFrameListener, SharedBuffers)
+{
+	TestFrameGenerator low(1, 480, 270,   1000, 10000);
+	TestFrameGenerator high(3, 1920, 1080, 1000, 30000);
+
+	listener->SetNumLayers(2);
+
+	PushFrame(low.Generate(true));
+	PushFrame(high.Generate(true));
+
+	// Selected layer frame is queued until the other layer reaches it, sharing the media buffer
+	auto frame = high.Generate();
+	listener->onMediaFrame(frame->GetSSRC(), *frame);
+	ASSERT_EQ(2, frame->GetBuffer().use_count());
+
+	// Non selected layer frame is not kept
+	auto other = low.Generate();
+	listener->onMediaFrame(other->GetSSRC(), *other);
+	ASSERT_EQ(1, other->GetBuffer().use_count());
+
+	// But its timestamp allows forwarding the queued one on next frame
+	PushFrame(high.Generate());
+	ASSERT_EQ(1, frame->GetBuffer().use_count());
+
+	std::vector<std::tuple<uint32_t, uint64_t, uint64_t>> expectedFrames = {
+		{1920, 0, 1000},
+		{1920, 2970, 1033}
+	};
+	ASSERT_NO_FATAL_FAILURE(CheckResetForwardedFrames(expectedFrames));
+}
+
+TEST_F(TestSimulcastMediaFrameListener, MaxQueueBytes)
+{
+	TestFrameGenerator low(1, 480, 270,   1000, 10000);
+	TestFrameGenerator mid(2, 960, 540,   1000, 20000);
+	TestFrameGenerator high(3, 1920, 1080, 1000, 30000);
+
+	// Room for three high layer frames
+	listener->SetMaxQueueBytes(3 * 1920 * 1080);
+
+	FramePushHelper fp(listener, low, mid, high);
+	fp.PushAdvance(FramePushHelper::ALL_INTRA);
+
+	// Other layers are stalled, so frames are forwarded when the queue gets too big
+	fp.PushAdvance(FramePushHelper::HIGH, 5);
+
+	std::vector<std::tuple<uint32_t, uint64_t, uint64_t>> expectedFrames = {
+		{1920, 0, 1000},
+		{1920, 2970, 1033},
+		{1920, 5940, 1066}
+	};
+	ASSERT_NO_FATAL_FAILURE(CheckResetForwardedFrames(expectedFrames));
+}
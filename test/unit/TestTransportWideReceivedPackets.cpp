@@ -0,0 +1,150 @@
+#include "TestCommon.h"
+#include "rtp/TransportWideReceivedPackets.h"
+#include "rtp/RTCPRTPFeedback.h"
+
+#include <array>
+
+namespace
+{
+
+RTCPRTPFeedback::TransportWideFeedbackMessageField::Packets Write(TransportWideReceivedPackets& received, BYTE count, QWORD now)
+{
+	std::array<BYTE, MTU> buffer = {};
+	DWORD len = received.WriteFeedback(buffer.data(), buffer.size(), count, now);
+	EXPECT_GT(len, 0u);
+	EXPECT_EQ(len % 4, 0u);
+
+	RTCPRTPFeedback::TransportWideFeedbackMessageField field;
+	EXPECT_EQ(len, field.Parse(buffer.data(), len));
+	EXPECT_EQ(count, field.feedbackPacketCount);
+	return field.packets;
+}
+
+}
+
+TEST(TestTransportWideReceivedPackets, Feedback)
+{
+	TransportWideReceivedPackets received;
+
+	//Small deltas, one lost, one large and one negative
+	ASSERT_TRUE(received.AddPacket(100, 1000000, 1000));
+	ASSERT_TRUE(received.AddPacket(101, 1001000, 1000));
+	ASSERT_TRUE(received.AddPacket(103, 1002000, 1000));
+	ASSERT_TRUE(received.AddPacket(104, 1200000, 1000));
+	ASSERT_TRUE(received.AddPacket(105, 1199000, 1000));
+	ASSERT_EQ(5, received.GetPendingCount());
+
+	auto packets = Write(received, 1, 1200000);
+	ASSERT_FALSE(received.HasPending());
+	ASSERT_EQ(6u, packets.size());
+	EXPECT_EQ(1000000u, packets[100]);
+	EXPECT_EQ(1001000u, packets[101]);
+	EXPECT_EQ(0u, packets[102]);
+	EXPECT_EQ(1002000u, packets[103]);
+	EXPECT_EQ(1200000u, packets[104]);
+	EXPECT_EQ(1199000u, packets[105]);
+
+	//Already reported ones are ignored
+	ASSERT_TRUE(received.AddPacket(104, 1300000, 1000));
+	ASSERT_FALSE(received.HasPending());
+
+	//Next one continues from last reported, reporting the lost ones in between
+	ASSERT_TRUE(received.AddPacket(108, 1300000, 1000));
+	packets = Write(received, 2, 1300000);
+	ASSERT_EQ(3u, packets.size());
+	EXPECT_EQ(0u, packets[106]);
+	EXPECT_EQ(0u, packets[107]);
+	EXPECT_EQ(1300000u, packets[108]);
+}
+
+TEST(TestTransportWideReceivedPackets, LongRuns)
+{
+	TransportWideReceivedPackets received;
+
+	//Runs and vectors mixed
+	QWORD time = 64000;
+	for (WORD i = 0; i < 200; ++i)
+	{
+		//Lose some bursts
+		if ((i / 20) % 3 == 2)
+			continue;
+		ASSERT_TRUE(received.AddPacket(i, time, 100));
+		//Some large deltas
+		time += i % 17 ? 250 : 100000;
+	}
+
+	auto packets = Write(received, 1, time);
+	ASSERT_EQ(200u, packets.size());
+	time = 64000;
+	for (WORD i = 0; i < 200; ++i)
+	{
+		if ((i / 20) % 3 == 2)
+		{
+			EXPECT_EQ(0u, packets[i]) << i;
+			continue;
+		}
+		EXPECT_EQ(time, packets[i]) << i;
+		time += i % 17 ? 250 : 100000;
+	}
+}
+
+TEST(TestTransportWideReceivedPackets, Window)
+{
+	TransportWideReceivedPackets received;
+
+	ASSERT_TRUE(received.AddPacket(65530, 1000, 100));
+	//Wraps
+	ASSERT_TRUE(received.AddPacket(5, 2000, 100));
+	//Too far ahead while there are pending ones
+	ASSERT_FALSE(received.AddPacket(5 + TransportWideReceivedPackets::MaxPackets + 10, 3000, 100));
+
+	auto packets = Write(received, 1, 3000);
+	ASSERT_EQ(12u, packets.size());
+
+	//Now it can skip the gap
+	ASSERT_TRUE(received.AddPacket(5 + TransportWideReceivedPackets::MaxPackets + 10, 3000, 100));
+	packets = Write(received, 2, 4000);
+	ASSERT_EQ(1u, packets.size());
+}
+
+TEST(TestTransportWideReceivedPackets, Reset)
+{
+	TransportWideReceivedPackets received;
+
+	ASSERT_TRUE(received.AddPacket(100, 1000, 100));
+	ASSERT_FALSE(received.AddPacket(100 + TransportWideReceivedPackets::MaxPackets, 2000, 100));
+
+	//Dropping the pending ones, as when they can't be sent, allows adding new ones
+	received.Reset();
+	ASSERT_FALSE(received.HasPending());
+	ASSERT_TRUE(received.AddPacket(100 + TransportWideReceivedPackets::MaxPackets, 2000, 100));
+	auto packets = Write(received, 1, 3000);
+	ASSERT_EQ(1u, packets.size());
+}
+
+TEST(TestTransportWideReceivedPackets, FeedbackInterval)
+{
+	TransportWideReceivedPackets received;
+
+	//No bitrate yet
+	ASSERT_EQ(TransportWideReceivedPackets::MinFeedbackInterval, received.GetFeedbackInterval());
+
+	//Audio like stream, 50 packets per second of 100 bytes
+	QWORD time = 0;
+	for (WORD i = 0; i < 500; ++i, time += 20000)
+	{
+		ASSERT_TRUE(received.AddPacket(i, time, 100));
+		if (received.IsFeedbackDue(time))
+			Write(received, i, time);
+	}
+	EXPECT_EQ(TransportWideReceivedPackets::MaxFeedbackInterval, received.GetFeedbackInterval());
+
+	//Video like stream, 2Mbps
+	for (WORD i = 500; i < 5000; ++i, time += 4000)
+	{
+		ASSERT_TRUE(received.AddPacket(i, time, 1000));
+		if (received.IsFeedbackDue(time))
+			Write(received, i, time);
+	}
+	EXPECT_EQ(TransportWideReceivedPackets::MinFeedbackInterval, received.GetFeedbackInterval());
+}
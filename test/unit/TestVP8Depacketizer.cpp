@@ -105,4 +105,22 @@ TEST_F(TestVP8Depacketizer, NormalPacketsMaxSeqnum)
 	ASSERT_NE(nullptr, Add(MarkerPacket(1000, 0)));
 
 	ASSERT_EQ(3, currentSeqNum);
-}
\ No newline at end of file
+}
+TEST_F(TestVP8Depacketizer, ReferencedPayload)
+{
+	auto start = StartPacket(1000, 0);
+	auto marker = MarkerPacket(1000, 0);
+	ASSERT_EQ(nullptr, Add(start));
+	auto frame = Add(marker);
+	ASSERT_NE(nullptr, frame);
+
+	//Payloads are referenced, not copied
+	ASSERT_TRUE(frame->IsSegmented());
+	auto segments = frame->GetSegments();
+	ASSERT_EQ(2, segments.size());
+	const auto& info = frame->GetRtpPacketizationInfo();
+	ASSERT_EQ(2, info.size());
+	ASSERT_EQ(start->GetMediaData() + info[0].GetPrefixLen(), segments[0].data);
+	ASSERT_EQ(marker->GetMediaData() + info[1].GetPrefixLen(), segments[1].data);
+	ASSERT_EQ(info[0].GetSize() + info[1].GetSize(), frame->GetLength());
+}
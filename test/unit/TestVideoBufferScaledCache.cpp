@@ -0,0 +1,62 @@
+#include "TestCommon.h"
+#include "VideoBufferScaledCache.h"
+
+TEST(TestVideoBufferScaledCache, ScaleOnce)
+{
+	VideoBufferScaledCache cache;
+
+	auto input = std::make_shared<VideoBuffer>(640, 480);
+	input->Fill(0, (BYTE)-128, (BYTE)-128);
+	input->SetTimestamp(1000);
+
+	//First consumer scales it
+	auto first = cache.GetScaled(input, 320, 240);
+	ASSERT_TRUE(first);
+	ASSERT_EQ(320, first->GetWidth());
+	ASSERT_EQ(240, first->GetHeight());
+	ASSERT_EQ(1000, first->GetTimestamp());
+
+	//Second one gets the same rendition
+	auto second = cache.GetScaled(input, 320, 240);
+	ASSERT_EQ(first, second);
+	ASSERT_EQ(1, cache.GetScaledFrames());
+	ASSERT_EQ(1, cache.GetCachedFrames());
+
+	//Different size is a different rendition
+	auto other = cache.GetScaled(input, 160, 120);
+	ASSERT_TRUE(other);
+	ASSERT_NE(first, other);
+	ASSERT_EQ(160, other->GetWidth());
+	ASSERT_EQ(2, cache.GetRenditions());
+	ASSERT_EQ(2, cache.GetScaledFrames());
+
+	//Same size is not scaled
+	ASSERT_EQ(input, cache.GetScaled(input, 640, 480));
+}
+
+TEST(TestVideoBufferScaledCache, NewInput)
+{
+	VideoBufferScaledCache cache;
+
+	auto input = std::make_shared<VideoBuffer>(640, 480);
+	auto first = cache.GetScaled(input, 320, 240);
+	ASSERT_TRUE(first);
+
+	//Next frame from the source must be scaled again
+	auto next = std::make_shared<VideoBuffer>(640, 480);
+	auto second = cache.GetScaled(next, 320, 240);
+	ASSERT_TRUE(second);
+	ASSERT_NE(first, second);
+	ASSERT_EQ(2, cache.GetScaledFrames());
+	ASSERT_EQ(0, cache.GetCachedFrames());
+	ASSERT_EQ(1, cache.GetRenditions());
+
+	//Released input must not be matched even if memory is reused
+	next.reset();
+	auto third = cache.GetScaled(std::make_shared<VideoBuffer>(640, 480), 320, 240);
+	ASSERT_TRUE(third);
+	ASSERT_EQ(3, cache.GetScaledFrames());
+
+	cache.Clear();
+	ASSERT_EQ(0, cache.GetRenditions());
+}
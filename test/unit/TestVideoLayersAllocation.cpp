@@ -19,18 +19,18 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseLayersAllocationWithZeroSpatialL
 	RTPHeaderExtension parsed;
 
 	//Empty layer
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
+	VideoLayersAllocation videoLayersAllocation;
 
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
 
 	EXPECT_GE(parsed.Parse(extMap, buffer.data(), len), 0);
 	EXPECT_TRUE(parsed.hasVideoLayersAllocation);
-	EXPECT_TRUE(parsed.videoLayersAllocation.has_value());
-	EXPECT_EQ(extension.videoLayersAllocation, parsed.videoLayersAllocation.value());
+	EXPECT_TRUE(parsed.GetVideoLayersAllocation().has_value());
+	EXPECT_EQ(videoLayersAllocation, parsed.GetVideoLayersAllocation().value());
 }
 
 TEST(TestVideoLayersAllocation, CanWriteAndParse2SpatialWith2TemporalLayers)
@@ -43,12 +43,11 @@ TEST(TestVideoLayersAllocation, CanWriteAndParse2SpatialWith2TemporalLayers)
 	RTPHeaderExtension extension;
 	RTPHeaderExtension parsed;
 
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
+	VideoLayersAllocation videoLayersAllocation;
 
-	extension.videoLayersAllocation->streamIdx = 1;
-	extension.videoLayersAllocation->numRtpStreams = 2;
-	extension.videoLayersAllocation->activeSpatialLayers = 
+	videoLayersAllocation.streamIdx = 1;
+	videoLayersAllocation.numRtpStreams = 2;
+	videoLayersAllocation.activeSpatialLayers = 
 	{
 		{
 			/*streamIdx*/ 0,
@@ -63,6 +62,7 @@ TEST(TestVideoLayersAllocation, CanWriteAndParse2SpatialWith2TemporalLayers)
 	};
 	
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
@@ -70,8 +70,8 @@ TEST(TestVideoLayersAllocation, CanWriteAndParse2SpatialWith2TemporalLayers)
 	//Parse
 	EXPECT_GE(parsed.Parse(extMap, buffer.data(), len), 0);
 	EXPECT_TRUE(parsed.hasVideoLayersAllocation);
-	EXPECT_TRUE(parsed.videoLayersAllocation.has_value());
-	EXPECT_EQ(extension.videoLayersAllocation, parsed.videoLayersAllocation.value());
+	EXPECT_TRUE(parsed.GetVideoLayersAllocation().has_value());
+	EXPECT_EQ(videoLayersAllocation, parsed.GetVideoLayersAllocation().value());
 }
 
 
@@ -88,12 +88,11 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithDifferentNumerOfSp
 	RTPHeaderExtension extension;
 	RTPHeaderExtension parsed;
 
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
+	VideoLayersAllocation videoLayersAllocation;
 
-	extension.videoLayersAllocation->streamIdx = 1;
-	extension.videoLayersAllocation->numRtpStreams = 2;
-	extension.videoLayersAllocation->activeSpatialLayers =
+	videoLayersAllocation.streamIdx = 1;
+	videoLayersAllocation.numRtpStreams = 2;
+	videoLayersAllocation.activeSpatialLayers =
 	{
 		{
 			/*streamIdx*/ 0,
@@ -113,6 +112,7 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithDifferentNumerOfSp
 	};
 	
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
@@ -120,10 +120,10 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithDifferentNumerOfSp
 	//Parse
 	ASSERT_GE(parsed.Parse(extMap, buffer.data(), len), 0);
 	EXPECT_TRUE(parsed.hasVideoLayersAllocation);
-	ASSERT_TRUE(parsed.videoLayersAllocation.has_value());
-	EXPECT_EQ(extension.videoLayersAllocation, parsed.videoLayersAllocation.value());
-	extension.videoLayersAllocation->Dump();
-	parsed.videoLayersAllocation->Dump();
+	ASSERT_TRUE(parsed.GetVideoLayersAllocation().has_value());
+	EXPECT_EQ(videoLayersAllocation, parsed.GetVideoLayersAllocation().value());
+	videoLayersAllocation.Dump();
+	parsed.GetVideoLayersAllocation()->Dump();
 }
 
 
@@ -137,12 +137,11 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithSkippedLowerSpatia
 	RTPHeaderExtension extension;
 	RTPHeaderExtension parsed;
 
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
+	VideoLayersAllocation videoLayersAllocation;
 
-	extension.videoLayersAllocation->streamIdx = 1;
-	extension.videoLayersAllocation->numRtpStreams = 2;
-	extension.videoLayersAllocation->activeSpatialLayers =
+	videoLayersAllocation.streamIdx = 1;
+	videoLayersAllocation.numRtpStreams = 2;
+	videoLayersAllocation.activeSpatialLayers =
 	{
 		{
 			/*streamIdx*/ 0,
@@ -157,6 +156,7 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithSkippedLowerSpatia
 	};
 	
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
@@ -164,8 +164,8 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithSkippedLowerSpatia
 	//Parse
 	EXPECT_GE(parsed.Parse(extMap, buffer.data(), len), 0);
 	EXPECT_TRUE(parsed.hasVideoLayersAllocation);
-	EXPECT_TRUE(parsed.videoLayersAllocation.has_value());
-	EXPECT_EQ(extension.videoLayersAllocation, parsed.videoLayersAllocation.value());
+	EXPECT_TRUE(parsed.GetVideoLayersAllocation().has_value());
+	EXPECT_EQ(videoLayersAllocation, parsed.GetVideoLayersAllocation().value());
 }
 
 
@@ -179,12 +179,11 @@ TEST(TestVideoLayersAllocation,	CanWriteAndParseAllocationWithSkippedRtpStreamId
 	RTPHeaderExtension extension;
 	RTPHeaderExtension parsed;
 
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
+	VideoLayersAllocation videoLayersAllocation;
 
-	extension.videoLayersAllocation->streamIdx = 2;
-	extension.videoLayersAllocation->numRtpStreams = 3;
-	extension.videoLayersAllocation->activeSpatialLayers =
+	videoLayersAllocation.streamIdx = 2;
+	videoLayersAllocation.numRtpStreams = 3;
+	videoLayersAllocation.activeSpatialLayers =
 	{
 		{
 			/*streamIdx*/ 0,
@@ -199,6 +198,7 @@ TEST(TestVideoLayersAllocation,	CanWriteAndParseAllocationWithSkippedRtpStreamId
 	};
 	
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
@@ -206,8 +206,8 @@ TEST(TestVideoLayersAllocation,	CanWriteAndParseAllocationWithSkippedRtpStreamId
 	//Parse
 	EXPECT_GE(parsed.Parse(extMap, buffer.data(), len), 0);
 	EXPECT_TRUE(parsed.hasVideoLayersAllocation);
-	EXPECT_TRUE(parsed.videoLayersAllocation.has_value());
-	EXPECT_EQ(extension.videoLayersAllocation, parsed.videoLayersAllocation.value());
+	EXPECT_TRUE(parsed.GetVideoLayersAllocation().has_value());
+	EXPECT_EQ(videoLayersAllocation, parsed.GetVideoLayersAllocation().value());
 
 }
 
@@ -223,12 +223,11 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithDifferentNumerOfTe
 	RTPHeaderExtension extension;
 	RTPHeaderExtension parsed;
 
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
+	VideoLayersAllocation videoLayersAllocation;
 
-	extension.videoLayersAllocation->streamIdx = 1;
-	extension.videoLayersAllocation->numRtpStreams = 3;
-	extension.videoLayersAllocation->activeSpatialLayers =
+	videoLayersAllocation.streamIdx = 1;
+	videoLayersAllocation.numRtpStreams = 3;
+	videoLayersAllocation.activeSpatialLayers =
 	{
 		{
 			/*streamIdx*/ 0,
@@ -243,6 +242,7 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithDifferentNumerOfTe
 	};
 	
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
@@ -259,12 +259,11 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithResolution)
 	RTPHeaderExtension extension;
 	RTPHeaderExtension parsed;
 
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
+	VideoLayersAllocation videoLayersAllocation;
 
-	extension.videoLayersAllocation->streamIdx = 1;
-	extension.videoLayersAllocation->numRtpStreams = 3;
-	extension.videoLayersAllocation->activeSpatialLayers =
+	videoLayersAllocation.streamIdx = 1;
+	videoLayersAllocation.numRtpStreams = 3;
+	videoLayersAllocation.activeSpatialLayers =
 	{
 		{
 			/*streamIdx*/ 0,
@@ -285,6 +284,7 @@ TEST(TestVideoLayersAllocation, CanWriteAndParseAllocationWithResolution)
 	};
 	
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
@@ -301,11 +301,11 @@ TEST(TestVideoLayersAllocation, WriteEmptyAllocationCanHaveAnyRtpStreamIndex)
 	RTPHeaderExtension parsed;
 
 	//Empty layer
-	extension.hasVideoLayersAllocation = true;
-	extension.videoLayersAllocation.emplace();
-	extension.videoLayersAllocation->streamIdx = 1;
+	VideoLayersAllocation videoLayersAllocation;
+	videoLayersAllocation.streamIdx = 1;
 
 	//Serialize
+	extension.SetVideoLayersAllocation(videoLayersAllocation);
 	int len = extension.Serialize(extMap, buffer.data(), buffer.size());
 
 	EXPECT_GE(len, 0);
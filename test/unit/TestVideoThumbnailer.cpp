@@ -0,0 +1,239 @@
+#include "TestCommon.h"
+#include "VideoThumbnailer.h"
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+
+//Thumbnailer that records the frames of each snapshot instead of decoding them
+class FakeThumbnailer : public VideoThumbnailer
+{
+public:
+	struct Call
+	{
+		std::vector<QWORD> times;
+		bool intraOnly;
+	};
+
+	using VideoThumbnailer::VideoThumbnailer;
+
+	virtual ~FakeThumbnailer()
+	{
+		//Stop before we are destroyed, as snapshots call us
+		Stop();
+	}
+
+	//Block snapshots until released
+	void Block()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		blocked = true;
+	}
+
+	void Release()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		blocked = false;
+		cond.notify_all();
+	}
+
+	bool WaitCalls(size_t num)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return cond.wait_for(lock, std::chrono::seconds(5), [&]() { return calls.size()>=num; });
+	}
+
+	bool WaitSnapshots(QWORD num)
+	{
+		for (int i = 0; i < 5000 && GetSnapshots()<num; ++i)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return GetSnapshots()>=num;
+	}
+
+	std::vector<Call> GetCalls()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return calls;
+	}
+
+protected:
+	virtual VideoFrame* CreateSnapshot(const std::vector<VideoFrame::const_shared>& frames, bool intraOnly) override
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		Call call = { {}, intraOnly };
+		for (const auto& frame : frames)
+			call.times.push_back(frame->GetTime());
+		calls.push_back(call);
+		cond.notify_all();
+		//Wait until released
+		cond.wait(lock, [this]() { return !blocked; });
+		return new VideoFrame(VideoCodec::JPEG);
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::vector<Call> calls;
+	bool blocked = false;
+};
+
+std::unique_ptr<VideoFrame> CreateFrame(QWORD time, bool intra)
+{
+	auto frame = std::make_unique<VideoFrame>(VideoCodec::H264);
+	frame->SetTime(time);
+	frame->SetTimestamp(time * 90);
+	frame->SetClockRate(90000);
+	frame->SetIntra(intra);
+	return frame;
+}
+
+}
+
+TEST(TestVideoThumbnailer, IntraOnly)
+{
+	FakeThumbnailer thumbnailer(VideoCodec::JPEG, 320, 0);
+
+	//Not started
+	thumbnailer.onMediaFrame(*CreateFrame(0, true));
+	ASSERT_EQ(0, thumbnailer.GetCalls().size());
+
+	ASSERT_EQ(1, thumbnailer.Start());
+
+	//Only intra frames are taken
+	thumbnailer.onMediaFrame(*CreateFrame(10, false));
+	thumbnailer.onMediaFrame(*CreateFrame(20, true));
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(1));
+
+	auto calls = thumbnailer.GetCalls();
+	ASSERT_EQ(1, calls.size());
+	EXPECT_TRUE(calls[0].intraOnly);
+	EXPECT_EQ(std::vector<QWORD>{ 20 }, calls[0].times);
+
+	//Snapshot has the stream time
+	auto thumbnail = thumbnailer.GetThumbnail();
+	ASSERT_TRUE(thumbnail);
+	EXPECT_EQ(VideoCodec::JPEG, thumbnail->GetCodec());
+	EXPECT_EQ(20, thumbnail->GetTime());
+	EXPECT_EQ(20 * 90, thumbnail->GetTimestamp());
+
+	//Skipped while previous one is being taken
+	thumbnailer.Block();
+	thumbnailer.onMediaFrame(*CreateFrame(30, true));
+	ASSERT_TRUE(thumbnailer.WaitCalls(2));
+	thumbnailer.onMediaFrame(*CreateFrame(40, true));
+	thumbnailer.Release();
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(2));
+	EXPECT_EQ(2, thumbnailer.GetCalls().size());
+	EXPECT_EQ(30, thumbnailer.GetThumbnail()->GetTime());
+}
+
+TEST(TestVideoThumbnailer, Interval)
+{
+	FakeThumbnailer thumbnailer(VideoCodec::JPEG, 320, 200);
+	ASSERT_EQ(1, thumbnailer.Start());
+
+	thumbnailer.onMediaFrame(*CreateFrame(0, true));
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(1));
+
+	//Too early
+	thumbnailer.onMediaFrame(*CreateFrame(10, true));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(1, thumbnailer.GetSnapshots());
+
+	//After the interval
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	thumbnailer.onMediaFrame(*CreateFrame(20, true));
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(2));
+	EXPECT_EQ(20, thumbnailer.GetThumbnail()->GetTime());
+}
+
+TEST(TestVideoThumbnailer, RequestTime)
+{
+	//Long interval so only requested snapshots are taken
+	FakeThumbnailer thumbnailer(VideoCodec::JPEG, 320, 1000000);
+	ASSERT_EQ(1, thumbnailer.Start());
+
+	thumbnailer.onMediaFrame(*CreateFrame(0, true));
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(1));
+
+	thumbnailer.Request(100);
+
+	//Waits for an intra frame and restarts on each one
+	thumbnailer.onMediaFrame(*CreateFrame(10, false));
+	thumbnailer.onMediaFrame(*CreateFrame(20, true));
+	thumbnailer.onMediaFrame(*CreateFrame(30, false));
+	thumbnailer.onMediaFrame(*CreateFrame(50, true));
+	thumbnailer.onMediaFrame(*CreateFrame(80, false));
+	thumbnailer.onMediaFrame(*CreateFrame(110, false));
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(2));
+
+	auto calls = thumbnailer.GetCalls();
+	ASSERT_EQ(2, calls.size());
+	EXPECT_FALSE(calls[1].intraOnly);
+	EXPECT_EQ((std::vector<QWORD>{ 50, 80, 110 }), calls[1].times);
+	EXPECT_EQ(110, thumbnailer.GetThumbnail()->GetTime());
+
+	//Request is done
+	thumbnailer.onMediaFrame(*CreateFrame(120, false));
+	thumbnailer.onMediaFrame(*CreateFrame(130, true));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(2, thumbnailer.GetCalls().size());
+}
+
+TEST(TestVideoThumbnailer, MaxPendingFrames)
+{
+	FakeThumbnailer thumbnailer(VideoCodec::JPEG, 320, 1000000);
+	ASSERT_EQ(1, thumbnailer.Start());
+
+	QWORD time = 0;
+	thumbnailer.Request(VideoThumbnailer::MaxPendingFrames + 10);
+
+	//Buffer is dropped when full, so the requested time is only reached from next intra
+	thumbnailer.onMediaFrame(*CreateFrame(time++, true));
+	while (time <= VideoThumbnailer::MaxPendingFrames + 10)
+		thumbnailer.onMediaFrame(*CreateFrame(time++, false));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(0, thumbnailer.GetCalls().size());
+
+	thumbnailer.onMediaFrame(*CreateFrame(time++, true));
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(1));
+	EXPECT_EQ(std::vector<QWORD>{ time - 1 }, thumbnailer.GetCalls()[0].times);
+}
+
+TEST(TestVideoThumbnailer, Stop)
+{
+	FakeThumbnailer thumbnailer(VideoCodec::JPEG, 320, 0);
+	ASSERT_EQ(1, thumbnailer.Start());
+	ASSERT_EQ(0, thumbnailer.Start());
+
+	//Block first snapshot and queue a requested one after it
+	thumbnailer.Block();
+	thumbnailer.onMediaFrame(*CreateFrame(0, true));
+	ASSERT_TRUE(thumbnailer.WaitCalls(1));
+	thumbnailer.Request(10);
+	thumbnailer.onMediaFrame(*CreateFrame(10, true));
+
+	//Stop waits for the running one
+	auto stopped = std::async(std::launch::async, [&]() { return thumbnailer.Stop(); });
+	EXPECT_EQ(std::future_status::timeout, stopped.wait_for(std::chrono::milliseconds(50)));
+
+	thumbnailer.Release();
+	ASSERT_EQ(std::future_status::ready, stopped.wait_for(std::chrono::seconds(5)));
+	EXPECT_EQ(1, stopped.get());
+
+	//Queued one is dropped and nothing is taken afterwards
+	EXPECT_EQ(1, thumbnailer.GetSnapshots());
+	thumbnailer.onMediaFrame(*CreateFrame(20, true));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(1, thumbnailer.GetCalls().size());
+	EXPECT_EQ(0, thumbnailer.Stop());
+
+	//Can be started again
+	ASSERT_EQ(1, thumbnailer.Start());
+	thumbnailer.onMediaFrame(*CreateFrame(30, true));
+	ASSERT_TRUE(thumbnailer.WaitSnapshots(2));
+}